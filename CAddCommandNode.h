@@ -18,6 +18,7 @@ public:
 	CAddCommandNode( CParseTree* inTree, size_t inLineNum ) : CCommandNode( inTree, "AddTo", inLineNum ) {};
 
 	virtual void	GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void	WriteToArchive( CParseTreeWriter& ioWriter )		{ WriteCommandToArchive( ioWriter, ENodeKindAddCommand ); };
 };
 
 } // namespace Carlson
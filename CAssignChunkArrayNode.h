@@ -24,6 +24,7 @@ public:
 		: CCommandNode( inTree, "AssignChunkArray", inLineNum ) {};
 
 	virtual void	GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void	WriteToArchive( CParseTreeWriter& ioWriter )		{ WriteCommandToArchive( ioWriter, ENodeKindAssignChunkArray ); };
 };
 
 } // namespace Carlson
@@ -18,6 +18,7 @@ public:
 	CAssignCommandNode( CParseTree* inTree, size_t inLineNum ) : CCommandNode( inTree, "=", inLineNum ) {};
 
 	virtual void	GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void	WriteToArchive( CParseTreeWriter& ioWriter )		{ WriteCommandToArchive( ioWriter, ENodeKindAssignCommand ); };
 };
 
 } // namespace Carlson
@@ -0,0 +1,341 @@
+/*
+ *  CBytecodeArchive.cpp
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#include "CBytecodeArchive.h"
+#include <vector>
+#include <map>
+#include <stdexcept>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+extern "C" {
+#include "LEOInterpreter.h"
+#include "LEOInstructions.h"
+#include "LEOScript.h"
+#include "LEOContextGroup.h"
+#include "ForgeInstructions.h"
+}
+
+
+namespace Carlson
+{
+
+#pragma mark [Writing]
+
+/*static*/ void	CBytecodeArchive::AppendUInt16( std::string& ioData, uint16_t inNumber )
+{
+	ioData.push_back( (char)(inNumber & 0xFF) );
+	ioData.push_back( (char)((inNumber >> 8) & 0xFF) );
+}
+
+
+/*static*/ void	CBytecodeArchive::AppendUInt32( std::string& ioData, uint32_t inNumber )
+{
+	for( int x = 0; x < 4; x++ )
+		ioData.push_back( (char)((inNumber >> (x * 8)) & 0xFF) );
+}
+
+
+/*static*/ void	CBytecodeArchive::AppendUInt64( std::string& ioData, uint64_t inNumber )
+{
+	for( int x = 0; x < 8; x++ )
+		ioData.push_back( (char)((inNumber >> (x * 8)) & 0xFF) );
+}
+
+
+/*static*/ void	CBytecodeArchive::AppendString( std::string& ioData, const char* inString )
+{
+	size_t	len = strlen( inString );
+	AppendUInt32( ioData, (uint32_t) len );
+	ioData.append( inString, len +1 );	// Including the zero byte.
+}
+
+
+/*static*/ bool	CBytecodeArchive::InstructionRefersToString( uint16_t inInstructionID )
+{
+	return inInstructionID == PUSH_STR_FROM_TABLE_INSTR || inInstructionID == PUSH_STR_VARIANT_FROM_TABLE_INSTR;
+}
+
+
+/*static*/ size_t	CBytecodeArchive::InstructionIDForName( const char* inName )
+{
+	for( size_t x = 0; x < gNumInstructions; x++ )
+	{
+		if( gInstructionNames[x] && strcmp( gInstructionNames[x], inName ) == 0 )
+			return x;
+	}
+	
+	return gNumInstructions;
+}
+
+
+/*static*/ void	CBytecodeArchive::AppendScript( LEOScript* inScript, LEOContextGroup* inGroup, const char* inFileName, std::string& ioData )
+{
+	std::vector<LEOHandler*>		handlers;
+	std::vector<uint32_t>			handlerFlags;
+	for( size_t x = 0; x < inScript->numCommands; x++ )
+	{
+		handlers.push_back( inScript->commands +x );
+		handlerFlags.push_back( 0 );
+	}
+	for( size_t x = 0; x < inScript->numFunctions; x++ )
+	{
+		handlers.push_back( inScript->functions +x );
+		handlerFlags.push_back( kBytecodeHandlerIsFunction );
+	}
+	
+	// Number all handler names we need, those of the handlers and those they
+	//	call, and all instructions they use:
+	std::map<LEOHandlerID,uint32_t>			nameIndexes;
+	std::vector<LEOHandlerID>				namesInOrder;
+	std::map<LEOInstructionID,uint16_t>		instructionIndexes;
+	std::vector<LEOInstructionID>			instructionsInOrder;
+	for( size_t x = 0; x < handlers.size(); x++ )
+	{
+		if( nameIndexes.find( handlers[x]->handlerName ) == nameIndexes.end() )
+		{
+			nameIndexes[handlers[x]->handlerName] = (uint32_t) namesInOrder.size();
+			namesInOrder.push_back( handlers[x]->handlerName );
+		}
+		for( size_t y = 0; y < handlers[x]->numInstructions; y++ )
+		{
+			LEOInstruction&	instr = handlers[x]->instructions[y];
+			if( kFirstForgeInstruction != 0 && instr.instructionID == kFirstForgeInstruction +COMPILE_HANDLER_LAZILY_INSTR )
+				throw std::logic_error( "Can't archive handlers that haven't been compiled yet." );
+			if( instr.instructionID == CALL_HANDLER_INSTR && nameIndexes.find( instr.param2 ) == nameIndexes.end() )
+			{
+				nameIndexes[instr.param2] = (uint32_t) namesInOrder.size();
+				namesInOrder.push_back( instr.param2 );
+			}
+			if( instructionIndexes.find( instr.instructionID ) == instructionIndexes.end() )
+			{
+				if( instr.instructionID >= gNumInstructions || InstructionIDForName( gInstructionNames[instr.instructionID] ) != instr.instructionID )
+					throw std::logic_error( "Can only archive scripts whose instructions have been registered under unique names." );
+				instructionIndexes[instr.instructionID] = (uint16_t) instructionsInOrder.size();
+				instructionsInOrder.push_back( instr.instructionID );
+			}
+		}
+	}
+	
+	ioData.append( BYTECODE_ARCHIVE_MAGIC, 4 );
+	AppendUInt32( ioData, BYTECODE_ARCHIVE_VERSION );
+	AppendString( ioData, inFileName ? inFileName : "" );
+	
+	AppendUInt32( ioData, (uint32_t) inScript->numStrings );
+	for( size_t x = 0; x < inScript->numStrings; x++ )
+		AppendString( ioData, inScript->strings[x] );
+	
+	AppendUInt32( ioData, (uint32_t) namesInOrder.size() );
+	for( size_t x = 0; x < namesInOrder.size(); x++ )
+	{
+		const char*	handlerName = LEOContextGroupHandlerNameForHandlerID( inGroup, namesInOrder[x] );
+		if( !handlerName )
+			throw std::logic_error( "Script refers to a handler ID that isn't in its context group." );
+		AppendString( ioData, handlerName );
+	}
+	
+	AppendUInt32( ioData, (uint32_t) instructionsInOrder.size() );
+	for( size_t x = 0; x < instructionsInOrder.size(); x++ )
+		AppendString( ioData, gInstructionNames[instructionsInOrder[x]] );
+	
+	AppendUInt32( ioData, (uint32_t) handlers.size() );
+	for( size_t x = 0; x < handlers.size(); x++ )
+	{
+		LEOHandler*	handler = handlers[x];
+		AppendUInt32( ioData, handlerFlags[x] );
+		AppendUInt32( ioData, nameIndexes[handler->handlerName] );
+		
+		AppendUInt32( ioData, (uint32_t) handler->numInstructions );
+		for( size_t y = 0; y < handler->numInstructions; y++ )
+		{
+			LEOInstruction&	instr = handler->instructions[y];
+			AppendUInt16( ioData, instructionIndexes[instr.instructionID] );
+			AppendUInt16( ioData, instr.param1 );
+			AppendUInt32( ioData, (instr.instructionID == CALL_HANDLER_INSTR) ? nameIndexes[instr.param2] : instr.param2 );
+		}
+		
+		AppendUInt32( ioData, (uint32_t) handler->numVarNames );
+		for( size_t y = 0; y < handler->numVarNames; y++ )
+		{
+			AppendString( ioData, handler->varNames[y].variableName );
+			AppendString( ioData, handler->varNames[y].realVariableName );
+			AppendUInt64( ioData, handler->varNames[y].bpRelativeAddress );
+		}
+	}
+}
+
+
+/*static*/ void	CBytecodeArchive::WriteScriptToFile( LEOScript* inScript, LEOContextGroup* inGroup, const char* inFileName, const char* inFilePath )
+{
+	std::string		data;
+	AppendScript( inScript, inGroup, inFileName, data );
+	
+	FILE*	theFile = fopen( inFilePath, "wb" );
+	if( !theFile )
+		throw std::runtime_error( std::string("Couldn't create file \"") +inFilePath +"\"." );
+	bool	success = fwrite( data.data(), 1, data.length(), theFile ) == data.length();
+	success = (fclose( theFile ) == 0) && success;
+	if( !success )
+	{
+		unlink( inFilePath );
+		throw std::runtime_error( std::string("Couldn't write file \"") +inFilePath +"\"." );
+	}
+}
+
+
+#pragma mark -
+#pragma mark [Reading]
+
+// -----------------------------------------------------------------------------
+//	AddHandlersFromData:
+//		Checks everything and looks up the instructions first, so damaged
+//		data doesn't leave half a script behind. Then adds the strings and
+//		handlers, copying each handler's instructions into an array of the
+//		right size and fixing up their IDs and table indexes on the way.
+// -----------------------------------------------------------------------------
+
+/*static*/ void	CBytecodeArchive::AddHandlersFromData( const char* inData, size_t inDataLength, LEOScript* inScript, LEOContextGroup* inGroup, std::string* outFileName )
+{
+	CBytecodeReader		reader( inData, inDataLength );
+	if( memcmp( reader.ReadBytes( 4 ), BYTECODE_ARCHIVE_MAGIC, 4 ) != 0 )
+		throw std::runtime_error( "Not a compiled script." );
+	if( reader.ReadUInt32() != BYTECODE_ARCHIVE_VERSION )
+		throw std::runtime_error( "Compiled script was written by a different version of Forge." );
+	const char*		fileName = reader.ReadString();
+	
+	std::vector<const char*>	strings( reader.ReadCount( 5 ) );
+	for( size_t x = 0; x < strings.size(); x++ )
+		strings[x] = reader.ReadString();
+	
+	std::vector<const char*>	handlerNames( reader.ReadCount( 5 ) );
+	for( size_t x = 0; x < handlerNames.size(); x++ )
+		handlerNames[x] = reader.ReadString();
+	
+	std::vector<LEOInstructionID>	instructionIDs( reader.ReadCount( 5 ) );
+	for( size_t x = 0; x < instructionIDs.size(); x++ )
+	{
+		const char*	instructionName = reader.ReadString();
+		size_t		instructionID = InstructionIDForName( instructionName );
+		if( instructionID >= gNumInstructions )
+			throw std::runtime_error( std::string("Compiled script needs the instruction \"") +instructionName +"\", which hasn't been registered." );
+		instructionIDs[x] = (LEOInstructionID) instructionID;
+	}
+	
+	std::vector<size_t>		handlerOffsets( reader.ReadCount( 16 ) );
+	for( size_t x = 0; x < handlerOffsets.size(); x++ )
+	{
+		handlerOffsets[x] = reader.GetOffset();
+		reader.ReadUInt32();	// Flags.
+		if( reader.ReadUInt32() >= handlerNames.size() )
+			throw std::runtime_error( "Compiled script data is damaged." );
+		
+		uint32_t	numInstructions = reader.ReadCount( 8 );
+		for( size_t y = 0; y < numInstructions; y++ )
+		{
+			uint16_t	instructionIndex = reader.ReadUInt16();
+			reader.ReadUInt16();	// param1
+			uint32_t	param2 = reader.ReadUInt32();
+			if( instructionIndex >= instructionIDs.size()
+				|| (InstructionRefersToString( instructionIDs[instructionIndex] ) && param2 >= strings.size())
+				|| (instructionIDs[instructionIndex] == CALL_HANDLER_INSTR && param2 >= handlerNames.size()) )
+				throw std::runtime_error( "Compiled script data is damaged." );
+		}
+		
+		uint32_t	numVarNames = reader.ReadCount( 18 );
+		for( size_t y = 0; y < numVarNames; y++ )
+		{
+			reader.ReadString();
+			reader.ReadString();
+			reader.ReadUInt64();
+		}
+	}
+	
+	// Now that we know it's all there, map strings and names to this script and group:
+	std::vector<uint32_t>		stringIndexes( strings.size() );
+	for( size_t x = 0; x < strings.size(); x++ )
+		stringIndexes[x] = (uint32_t) LEOScriptAddString( inScript, strings[x] );
+	
+	std::vector<LEOHandlerID>	handlerIDs( handlerNames.size() );
+	for( size_t x = 0; x < handlerNames.size(); x++ )
+		handlerIDs[x] = LEOContextGroupHandlerIDForHandlerName( inGroup, handlerNames[x] );
+	
+	for( size_t x = 0; x < handlerOffsets.size(); x++ )
+	{
+		CBytecodeReader	handlerReader( inData, inDataLength, handlerOffsets[x] );
+		uint32_t		flags = handlerReader.ReadUInt32();
+		LEOHandlerID	handlerID = handlerIDs[handlerReader.ReadUInt32()];
+		LEOHandler*		handler = (flags & kBytecodeHandlerIsFunction) ? LEOScriptAddFunctionHandlerWithID( inScript, handlerID ) : LEOScriptAddCommandHandlerWithID( inScript, handlerID );
+		
+		uint32_t		numInstructions = handlerReader.ReadUInt32();
+		if( numInstructions > 0 )
+		{
+			LEOInstruction*	instructions = (LEOInstruction*) realloc( handler->instructions, numInstructions * sizeof(LEOInstruction) );	// Same as LEOHandlerAddInstruction() would do, just once.
+			if( !instructions )
+				throw std::bad_alloc();
+			handler->instructions = instructions;
+			handler->numInstructions = numInstructions;
+		}
+		for( size_t y = 0; y < numInstructions; y++ )
+		{
+			LEOInstruction&	instr = handler->instructions[y];
+			instr.instructionID = instructionIDs[handlerReader.ReadUInt16()];
+			instr.param1 = handlerReader.ReadUInt16();
+			instr.param2 = handlerReader.ReadUInt32();
+			if( InstructionRefersToString( instr.instructionID ) )
+				instr.param2 = stringIndexes[instr.param2];
+			else if( instr.instructionID == CALL_HANDLER_INSTR )
+				instr.param2 = (uint32_t) handlerIDs[instr.param2];
+		}
+		
+		uint32_t		numVarNames = handlerReader.ReadUInt32();
+		for( size_t y = 0; y < numVarNames; y++ )
+		{
+			const char*	varName = handlerReader.ReadString();
+			const char*	realVarName = handlerReader.ReadString();
+			LEOHandlerAddVariableNameMapping( handler, varName, realVarName, (size_t) handlerReader.ReadUInt64() );
+		}
+	}
+	
+	if( outFileName )
+		outFileName->assign( fileName );
+}
+
+
+/*static*/ void	CBytecodeArchive::AddHandlersFromFile( const char* inFilePath, LEOScript* inScript, LEOContextGroup* inGroup, std::string* outFileName )
+{
+	int		fd = open( inFilePath, O_RDONLY );
+	if( fd < 0 )
+		throw std::runtime_error( std::string("Couldn't open file \"") +inFilePath +"\"." );
+	
+	struct stat		fileInfo;
+	void*			fileContents = MAP_FAILED;
+	if( fstat( fd, &fileInfo ) == 0 && fileInfo.st_size > 0 )
+		fileContents = mmap( NULL, (size_t) fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );	// The mapping stays valid without the descriptor.
+	if( fileContents == MAP_FAILED )
+		throw std::runtime_error( std::string("Couldn't read file \"") +inFilePath +"\"." );
+	
+	try
+	{
+		AddHandlersFromData( (const char*) fileContents, (size_t) fileInfo.st_size, inScript, inGroup, outFileName );
+	}
+	catch( ... )
+	{
+		munmap( fileContents, (size_t) fileInfo.st_size );
+		throw;
+	}
+	munmap( fileContents, (size_t) fileInfo.st_size );
+}
+
+}
@@ -0,0 +1,141 @@
+/*
+ *  CBytecodeArchive.h
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#pragma once
+
+#include <string>
+#include <stdint.h>
+#include <stdexcept>
+
+struct LEOScript;
+struct LEOContextGroup;
+
+
+namespace Carlson
+{
+
+#define BYTECODE_ARCHIVE_MAGIC			"FGBC"
+#define BYTECODE_ARCHIVE_VERSION		2	// Bump whenever the layout below changes.
+
+
+// Flattens the compiled handlers of a LEOScript into bytes and back. This is
+//	also the format of precompiled script files.
+//	All numbers are little-endian, whatever CPU wrote them. Handler IDs,
+//	string table indexes and instruction IDs only mean something in one
+//	group, script or host, so the archive has the handler names, strings and
+//	instruction names, and instructions refer to those by index. Loading
+//	fixes them up for the script, group and host it loads into, so the host
+//	may register its instructions in a different order than the one that
+//	wrote the archive.
+//
+//	Layout:
+//		char[4]		BYTECODE_ARCHIVE_MAGIC
+//		uint32		BYTECODE_ARCHIVE_VERSION
+//		string		name of the file the script was compiled from, may be empty
+//		uint32		number of strings, then each string
+//		uint32		number of handler names, then each name
+//		uint32		number of instruction names, then each name
+//		uint32		number of handlers, then for each:
+//			uint32		flags (kBytecodeHandlerIsFunction)
+//			uint32		index of its name
+//			uint32		number of instructions, then for each:
+//				uint16		index of its instruction name
+//				uint16		param1
+//				uint32		param2 (string index or handler name index for
+//							instructions that refer to those)
+//			uint32		number of variable name mappings, then for each:
+//				string		name as the user wrote it
+//				string		real name
+//				uint64		bp-relative address
+//	A string is a uint32 length, that many bytes of UTF8, and a zero byte,
+//	so the loader can hand them to Leonie without copying them first.
+class CBytecodeArchive
+{
+public:
+	static void	AppendScript( LEOScript* inScript, LEOContextGroup* inGroup, const char* inFileName, std::string& ioData );	// Handler IDs in inScript must be from inGroup. inFileName may be NULL. Throws if a handler hasn't been compiled yet.
+	static void	AddHandlersFromData( const char* inData, size_t inDataLength, LEOScript* inScript, LEOContextGroup* inGroup, std::string* outFileName = NULL );	// Throws std::runtime_error without adding anything if the data is damaged or needs instructions the host hasn't registered.
+	
+	static void	WriteScriptToFile( LEOScript* inScript, LEOContextGroup* inGroup, const char* inFileName, const char* inFilePath );	// Throws std::runtime_error if the file can't be written.
+	static void	AddHandlersFromFile( const char* inFilePath, LEOScript* inScript, LEOContextGroup* inGroup, std::string* outFileName = NULL );	// Maps the file into memory instead of reading it.
+	
+	static void		AppendUInt16( std::string& ioData, uint16_t inNumber );	// Little-endian.
+	static void		AppendUInt32( std::string& ioData, uint32_t inNumber );
+	static void		AppendUInt64( std::string& ioData, uint64_t inNumber );
+	static void		AppendString( std::string& ioData, const char* inString );	// Length, bytes and zero byte, as CBytecodeReader::ReadString() expects.
+	
+	static bool		InstructionRefersToString( uint16_t inInstructionID );	// Does param2 of this instruction hold a string table index?
+	static size_t	InstructionIDForName( const char* inName );	// The ID a host gave the instruction with this name, or gNumInstructions if it didn't register one.
+	
+	enum
+	{
+		kBytecodeHandlerIsFunction	= (1 << 0)
+	};
+};
+
+
+// Walks through archive data, throwing if it would run off the end. Starts
+//	at inOffset, which may be past the end:
+class CBytecodeReader
+{
+public:
+	CBytecodeReader( const char* inData, size_t inDataLength, size_t inOffset = 0 ) : mData((const uint8_t*) inData), mDataLength(inDataLength), mOffset(inOffset) {};
+	
+	const uint8_t*	ReadBytes( size_t inLength )
+	{
+		if( mOffset > mDataLength || inLength > (mDataLength -mOffset) )
+			throw std::runtime_error( "Compiled script data is damaged." );
+		const uint8_t*	bytes = mData +mOffset;
+		mOffset += inLength;
+		return bytes;
+	}
+	
+	uint16_t	ReadUInt16()
+	{
+		const uint8_t*	bytes = ReadBytes( 2 );
+		return (uint16_t)(bytes[0] | (bytes[1] << 8));
+	}
+	
+	uint32_t	ReadUInt32()
+	{
+		const uint8_t*	bytes = ReadBytes( 4 );
+		return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+	}
+	
+	uint64_t	ReadUInt64()
+	{
+		uint64_t	lowBits = ReadUInt32();
+		return lowBits | ((uint64_t)ReadUInt32() << 32);
+	}
+	
+	const char*	ReadString()	// Points into the data.
+	{
+		uint32_t		len = ReadUInt32();
+		const uint8_t*	str = ReadBytes( (size_t)len +1 );
+		if( str[len] != 0 )
+			throw std::runtime_error( "Compiled script data is damaged." );
+		return (const char*) str;
+	}
+	
+	uint32_t	ReadCount( size_t inMinBytesPerItem )	// So damaged counts can't make us reserve gigabytes.
+	{
+		uint32_t	count = ReadUInt32();
+		if( mOffset > mDataLength || count > (mDataLength -mOffset) / inMinBytesPerItem )
+			throw std::runtime_error( "Compiled script data is damaged." );
+		return count;
+	}
+	
+	size_t		GetOffset() const	{ return mOffset; };
+	
+protected:
+	const uint8_t*	mData;
+	size_t			mDataLength;
+	size_t			mOffset;
+};
+
+}
@@ -8,6 +8,8 @@
  */
 
 #include "CCodeBlock.h"
+#include <vector>
+#include <stdexcept>
 extern "C"
 {
 #include "LEOScript.h"
@@ -20,11 +22,15 @@ extern "C"
 namespace Carlson
 {
 
-CCodeBlock::CCodeBlock( LEOContextGroup * inGroup, LEOScript* inScript )
-	: mGroup(NULL), mCurrentHandler(NULL), mScript(NULL)
+CCodeBlock::CCodeBlock( LEOContextGroup * inGroup, LEOScript* inScript, pthread_mutex_t* inGroupLock )
+	: mGroup(NULL), mGroupLock(inGroupLock), mCurrentHandler(NULL), mHandlerToReplace(NULL), mScript(NULL)
 {
 	mScript = LEOScriptRetain( inScript );
+	if( mGroupLock )
+		pthread_mutex_lock( mGroupLock );
 	mGroup = LEOContextGroupRetain( inGroup );
+	if( mGroupLock )
+		pthread_mutex_unlock( mGroupLock );
 }
 
 
@@ -33,44 +39,91 @@ CCodeBlock::~CCodeBlock()
 	LEOScriptRelease( mScript );
 	mCurrentHandler = NULL;
 	mScript = NULL;
+	if( mGroupLock )
+		pthread_mutex_lock( mGroupLock );
 	LEOContextGroupRelease( mGroup );
+	if( mGroupLock )
+		pthread_mutex_unlock( mGroupLock );
 	mGroup = NULL;
 }
 
 
-void	CCodeBlock::GenerateFunctionPrologForName( bool isCommand, const std::string& inName, const std::map<std::string,CVariableEntry>& inLocals, size_t lineNumber )
+LEOHandlerID	CCodeBlock::HandlerIDForName( const std::string& inName )
+{
+	std::map<std::string,LEOHandlerID>::iterator	foundID = mHandlerIDs.find( inName );
+	if( foundID != mHandlerIDs.end() )
+		return foundID->second;
+	
+	if( mGroupLock )
+		pthread_mutex_lock( mGroupLock );
+	LEOHandlerID	handlerID = LEOContextGroupHandlerIDForHandlerName( mGroup, inName.c_str() );
+	if( mGroupLock )
+		pthread_mutex_unlock( mGroupLock );
+	
+	mHandlerIDs[inName] = handlerID;
+	
+	return handlerID;
+}
+
+
+void	CCodeBlock::GenerateFunctionPrologForName( bool isCommand, const std::string& inName, const std::map<CSymbolID,CVariableEntry>& inLocals, const CSymbolTable& inSymbols, size_t lineNumber )
 {
 	// Create the handler:
-	LEOHandlerID handlerID = LEOContextGroupHandlerIDForHandlerName( mGroup, inName.c_str() );
-	if( isCommand )
-		mCurrentHandler = LEOScriptAddCommandHandlerWithID( mScript, handlerID );
+	if( mHandlerToReplace )
+	{
+		mCurrentHandler = mHandlerToReplace;
+		mCurrentHandler->numInstructions = 0;	// LEOHandlerAddInstruction() grows the array as needed.
+		mHandlerToReplace = NULL;
+	}
 	else
-		mCurrentHandler = LEOScriptAddFunctionHandlerWithID( mScript, handlerID );
+	{
+		LEOHandlerID handlerID = HandlerIDForName( inName );
+		if( isCommand )
+			mCurrentHandler = LEOScriptAddCommandHandlerWithID( mScript, handlerID );
+		else
+			mCurrentHandler = LEOScriptAddFunctionHandlerWithID( mScript, handlerID );
+	}
+	
+	// Variables got their stack slots in the order they were first used, so
+	//	sort them by slot to push each one's initial value in the right place:
+	std::map<CSymbolID,CVariableEntry>::const_iterator		itty;
+	std::vector<std::map<CSymbolID,CVariableEntry>::const_iterator>	varsBySlot;
+	for( itty = inLocals.begin(); itty != inLocals.end(); itty++ )
+	{
+		if( itty->second.mBPRelativeOffset != LONG_MAX )
+			varsBySlot.push_back( inLocals.end() );
+	}
+	for( itty = inLocals.begin(); itty != inLocals.end(); itty++ )
+	{
+		if( itty->second.mBPRelativeOffset != LONG_MAX )
+		{
+			if( itty->second.mBPRelativeOffset < 0 || itty->second.mBPRelativeOffset >= (long) varsBySlot.size() )
+				throw std::logic_error( "Local variable stack slots aren't contiguous." );
+			varsBySlot[itty->second.mBPRelativeOffset] = itty;
+		}
+	}
 	
 	// Allocate stack space for our local variables:
 	LEOHandlerAddInstruction( mCurrentHandler, LINE_MARKER_INSTR, 0, (uint32_t)lineNumber );
 	size_t	emptyStringIndex = LEOScriptAddString( mScript, "" );
-	std::map<std::string,CVariableEntry>::const_iterator		itty;
 	mNumLocals = 0;
 	
-	for( itty = inLocals.begin(); itty != inLocals.end(); itty++ )
+	for( size_t x = 0; x < varsBySlot.size(); x++ )
 	{
-		if( itty->second.mBPRelativeOffset != LONG_MAX )
+		itty = varsBySlot[x];
+		if( itty->second.mIsGlobal )
+		{
+			size_t	stringIndex = LEOScriptAddString( mScript, itty->second.mRealName.c_str() );
+			LEOHandlerAddInstruction( mCurrentHandler, PUSH_STR_VARIANT_FROM_TABLE_INSTR, 0, (uint32_t)stringIndex );
+			LEOHandlerAddInstruction( mCurrentHandler, PUSH_GLOBAL_REFERENCE_INSTR, 0, 0 );
+		}
+		else
 		{
-			if( itty->second.mIsGlobal )
-			{
-				size_t	stringIndex = LEOScriptAddString( mScript, itty->second.mRealName.c_str() );
-				LEOHandlerAddInstruction( mCurrentHandler, PUSH_STR_VARIANT_FROM_TABLE_INSTR, 0, (uint32_t)stringIndex );
-				LEOHandlerAddInstruction( mCurrentHandler, PUSH_GLOBAL_REFERENCE_INSTR, 0, 0 );
-			}
-			else
-			{
-				size_t	stringIndex = itty->second.mInitWithName ? LEOScriptAddString( mScript, itty->second.mRealName.c_str() ) : emptyStringIndex;
-				LEOHandlerAddInstruction( mCurrentHandler, PUSH_STR_VARIANT_FROM_TABLE_INSTR, 0, (uint32_t)stringIndex );
-			}
-			LEOHandlerAddVariableNameMapping( mCurrentHandler, itty->first.c_str(), itty->second.mRealName.c_str(), itty->second.mBPRelativeOffset );
-			mNumLocals++;
+			size_t	stringIndex = itty->second.mInitWithName ? LEOScriptAddString( mScript, itty->second.mRealName.c_str() ) : emptyStringIndex;
+			LEOHandlerAddInstruction( mCurrentHandler, PUSH_STR_VARIANT_FROM_TABLE_INSTR, 0, (uint32_t)stringIndex );
 		}
+		LEOHandlerAddVariableNameMapping( mCurrentHandler, inSymbols.TextForSymbol( itty->first ).c_str(), itty->second.mRealName.c_str(), itty->second.mBPRelativeOffset );
+		mNumLocals++;
 	}
 }
 
@@ -79,13 +132,13 @@ void	CCodeBlock::PrepareToExitFunction( size_t lineNumber )
 {
 	LEOHandlerAddInstruction( mCurrentHandler, LINE_MARKER_INSTR, 0, (uint32_t)lineNumber );
 	// Get rid of stack space allocated for our local variables:
-	std::map<std::string,CVariableEntry>::const_iterator		itty;
+	std::map<CSymbolID,CVariableEntry>::const_iterator		itty;
 	for( size_t	x = 0; x < mNumLocals; x++ )
 		LEOHandlerAddInstruction( mCurrentHandler, POP_VALUE_INSTR, BACK_OF_STACK, 0 );
 }
 
 
-void	CCodeBlock::GenerateFunctionEpilogForName( bool isCommand, const std::string& inName, const std::map<std::string,CVariableEntry>& inLocals, size_t lineNumber )
+void	CCodeBlock::GenerateFunctionEpilogForName( bool isCommand, const std::string& inName, const std::map<CSymbolID,CVariableEntry>& inLocals, size_t lineNumber )
 {
 	PrepareToExitFunction( lineNumber );
 	
@@ -102,7 +155,7 @@ void	CCodeBlock::GenerateFunctionEpilogForName( bool isCommand, const std::strin
 
 void	CCodeBlock::GenerateFunctionCallInstruction( bool isCommand, bool isMessagePassing, const std::string& inName )
 {
-	LEOHandlerID handlerID = LEOContextGroupHandlerIDForHandlerName( mGroup, inName.c_str() );
+	LEOHandlerID handlerID = HandlerIDForName( inName );
 	LEOHandlerAddInstruction( mCurrentHandler, CALL_HANDLER_INSTR, (isCommand ? kLEOCallHandler_IsCommandFlag : kLEOCallHandler_IsFunctionFlag) | (isMessagePassing ? kLEOCallHandler_PassMessage : 0), handlerID );
 }
 
@@ -9,7 +9,9 @@
 
 #include <string>
 #include "CVariableEntry.h"
+#include "CSymbolTable.h"
 #include <map>
+#include <pthread.h>
 extern "C" {
 #include "LEOInterpreter.h"
 }
@@ -26,12 +28,13 @@ class CCodeBlock;
 class CCodeBlock
 {
 public:
-	CCodeBlock( LEOContextGroup * inGroup, LEOScript* inScript );
+	CCodeBlock( LEOContextGroup * inGroup, LEOScript* inScript, pthread_mutex_t* inGroupLock = NULL );	// If several threads generate code for the same group, give them all the same inGroupLock. Only one thread may generate code into the same script.
 	virtual ~CCodeBlock();
 	
-	void		GenerateFunctionPrologForName( bool isCommand, const std::string& inName, const std::map<std::string,CVariableEntry>& inLocals, size_t lineNumber );
+	void		SetHandlerToReplace( LEOHandler* inHandler )	{ mHandlerToReplace = inHandler; };	// The next prolog generates into inHandler (e.g. a lazy stub) instead of adding a new handler, replacing its instructions.
+	void		GenerateFunctionPrologForName( bool isCommand, const std::string& inName, const std::map<CSymbolID,CVariableEntry>& inLocals, const CSymbolTable& inSymbols, size_t lineNumber );	// inSymbols provides the variables' names for the debugger.
 	void		PrepareToExitFunction( size_t lineNumber );
-	void		GenerateFunctionEpilogForName( bool isCommand, const std::string& inName, const std::map<std::string,CVariableEntry>& inLocals, size_t lineNumber );	// Calls PrepareToExitFunction.
+	void		GenerateFunctionEpilogForName( bool isCommand, const std::string& inName, const std::map<CSymbolID,CVariableEntry>& inLocals, size_t lineNumber );	// Calls PrepareToExitFunction.
 	void		GenerateFunctionCallInstruction( bool isCommand, bool isMessagePassing, const std::string& inName );
 	
 	void		GeneratePushIntInstruction( int inNumber );
@@ -77,10 +80,16 @@ public:
 	void		GenerateSetPropertyOfObjectInstruction();
 	void		GeneratePushMeInstruction();
 	
+protected:
+	LEOHandlerID	HandlerIDForName( const std::string& inName );	// Looks up each name in the group only once per code block.
+	
 protected:
 	LEOScript*				mScript;
 	LEOContextGroup*		mGroup;
+	pthread_mutex_t*		mGroupLock;	// Held while we touch mGroup, or NULL if only one thread uses it.
+	std::map<std::string,LEOHandlerID>	mHandlerIDs;
 	LEOHandler*				mCurrentHandler;
+	LEOHandler*				mHandlerToReplace;
 	size_t					mNumLocals;
 };
 
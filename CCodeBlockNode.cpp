@@ -9,14 +9,15 @@
 
 #include "CCodeBlockNode.h"
 #include "CParser.h"
+#include "CParseTreeArchive.h"
 
 namespace Carlson
 {
 
-bool	CCodeBlockNodeBase::LocalVariableExists( const std::string& inStr )
+bool	CCodeBlockNodeBase::LocalVariableExists( CSymbolID inName )
 {
-	std::map<std::string,CVariableEntry>&	locals = GetLocals();
-	return locals.find( inStr ) != locals.end();
+	std::map<CSymbolID,CVariableEntry>&	locals = GetLocals();
+	return locals.find( inName ) != locals.end();
 }
 
 
@@ -36,7 +37,7 @@ void	CCodeBlockNodeBase::DebugPrintInner( std::ostream& destStream, size_t inden
 	
 	destStream << indentChars << "{" << std::endl;
 	
-	std::vector<CNode*>::iterator itty;
+	CNodeList::iterator itty;
 	
 	for( itty = mCommands.begin(); itty != mCommands.end(); itty++ )
 	{
@@ -47,20 +48,22 @@ void	CCodeBlockNodeBase::DebugPrintInner( std::ostream& destStream, size_t inden
 }
 
 
-void	CCodeBlockNodeBase::Simplify()
+CNode*	CCodeBlockNodeBase::Simplify()
 {
-	std::vector<CNode*>::iterator itty;
+	CNodeList::iterator itty;
 	
 	for( itty = mCommands.begin(); itty != mCommands.end(); itty++ )
 	{
-		(*itty)->Simplify();
+		(*itty) = (*itty)->Simplify();
 	}
+	
+	return this;
 }
 
 
 void	CCodeBlockNodeBase::GenerateCode( CCodeBlock* inCodeBlock )
 {
-	std::vector<CNode*>::iterator itty;
+	CNodeList::iterator itty;
 	
 	for( itty = mCommands.begin(); itty != mCommands.end(); itty++ )
 	{
@@ -69,26 +72,14 @@ void	CCodeBlockNodeBase::GenerateCode( CCodeBlock* inCodeBlock )
 }
 
 
-CCodeBlockNodeBase::~CCodeBlockNodeBase()
-{
-	std::vector<CNode*>::iterator itty;
-	
-	for( itty = mCommands.begin(); itty != mCommands.end(); itty++ )
-	{
-		delete *itty;
-		*itty = NULL;
-	}
-}
-
-
-void	CCodeBlockNode::AddLocalVar( const std::string& inName, const std::string& inUserName,
+void	CCodeBlockNode::AddLocalVar( CSymbolID inName, const std::string& inUserName,
 								TVariantType theType, bool initWithName,
 								bool isParam, bool isGlobal,
 								bool dontDispose )
 {
 	CVariableEntry	newEntry( inUserName, theType, initWithName,
 								isParam, isGlobal, dontDispose );
-	std::map<std::string,CVariableEntry>::iterator	foundVariable = (*mLocals).find( inName );
+	std::map<CSymbolID,CVariableEntry>::iterator	foundVariable = (*mLocals).find( inName );
 	if( foundVariable == (*mLocals).end() )
 		(*mLocals)[inName] = newEntry;
 	if( isGlobal )
@@ -100,9 +91,9 @@ void	CCodeBlockNode::AddLocalVar( const std::string& inName, const std::string&
 }
 
 
-long	CCodeBlockNode::GetBPRelativeOffsetForLocalVar( const std::string& inName )
+long	CCodeBlockNode::GetBPRelativeOffsetForLocalVar( CSymbolID inName )
 {
-	std::map<std::string,CVariableEntry>::iterator	foundVariable = (*mLocals).find( inName );
+	std::map<CSymbolID,CVariableEntry>::iterator	foundVariable = (*mLocals).find( inName );
 	if( foundVariable != (*mLocals).end() )
 	{
 		long	bpRelOffs = foundVariable->second.mBPRelativeOffset;
@@ -118,5 +109,19 @@ long	CCodeBlockNode::GetBPRelativeOffsetForLocalVar( const std::string& inName )
 }
 
 
+void	CCodeBlockNodeBase::WriteCommandsToArchive( CParseTreeWriter& ioWriter )
+{
+	ioWriter.WriteNodes( mCommands );
+}
+
+
+void	CCodeBlockNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	ioWriter.WriteNumber( ENodeKindCodeBlock );
+	ioWriter.WriteNodeReference( mOwningBlock );
+	ioWriter.WriteNumber( mLineNum );
+	WriteCommandsToArchive( ioWriter );
+}
+
 
 } // namespace Carlson
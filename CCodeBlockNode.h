@@ -28,35 +28,38 @@ class CCodeBlockNodeBase : public CNode
 {
 public:
 	CCodeBlockNodeBase( CParseTree* inTree, size_t inLineNum )
-		: CNode(inTree), mLineNum( inLineNum ) {};
-	virtual ~CCodeBlockNodeBase();
+		: CNode(inTree), mLineNum( inLineNum ), mCommands( GetNodeArena() ) {};
+	virtual ~CCodeBlockNodeBase()	{};
 	
-	virtual void	AddCommand( CNode* inCmd )	{ mCommands.push_back( inCmd ); mParseTree->NodeWasAdded( inCmd ); };	// Function node now owns this command and will delete it!
+	virtual void	AddCommand( CNode* inCmd )	{ mCommands.push_back( inCmd ); mParseTree->NodeWasAdded( inCmd ); };
 	
-	virtual void	AddLocalVar( const std::string& inName, const std::string& inUserName,
+	virtual void	AddLocalVar( CSymbolID inName, const std::string& inUserName,
 									TVariantType theType, bool initWithName = false,
 									bool isParam = false, bool isGlobal = false,
 									bool dontDispose = false ) = 0;	// It's OK to call this several times with the same variable. Subsequent calls will be ignored.
-	virtual long	GetBPRelativeOffsetForLocalVar( const std::string& inName ) = 0;
+	virtual long	GetBPRelativeOffsetForLocalVar( CSymbolID inName ) = 0;
 	
 	// Sub-blocks retrieve and modify these three as needed: // TODO: This isn't really very OO.
 	virtual size_t&										GetLocalVariableCount() = 0;
-	virtual std::map<std::string,CVariableEntry>&		GetLocals() = 0;
-	virtual std::map<std::string,CVariableEntry>&		GetGlobals() = 0;
-	virtual bool										LocalVariableExists( const std::string& inStr );
+	virtual std::map<CSymbolID,CVariableEntry>&			GetLocals() = 0;
+	virtual std::map<CSymbolID,CVariableEntry>&			GetGlobals() = 0;
+	virtual bool										LocalVariableExists( CSymbolID inName );
 		
 	virtual void	DebugPrint( std::ostream& destStream, size_t indentLevel );
 
-	virtual void	Simplify();
+	virtual CNode*	Simplify();
 	virtual void	GenerateCode( CCodeBlock* inCodeBlock );
 	
 	virtual void	DebugPrintInner( std::ostream& destStream, size_t indentLevel );
 
 	virtual CCodeBlockNodeBase*	GetContainingFunction()				{ return NULL; };
 	
+	size_t			GetLineNum()						{ return mLineNum; };
+	void			WriteCommandsToArchive( CParseTreeWriter& ioWriter );	// For subclasses' WriteToArchive(), and for blocks an owner writes itself.
+	
 protected:
 	size_t									mLineNum;
-	std::vector<CNode*>						mCommands;
+	CNodeList								mCommands;
 };
 
 
@@ -74,24 +77,26 @@ public:
 	};
 	virtual ~CCodeBlockNode()	{};
 
-	virtual void	AddLocalVar( const std::string& inName, const std::string& inUserName,
+	virtual void	AddLocalVar( CSymbolID inName, const std::string& inUserName,
 									TVariantType theType, bool initWithName = false,
 									bool isParam = false, bool isGlobal = false,
 									bool dontDispose = false );
-	virtual long	GetBPRelativeOffsetForLocalVar( const std::string& inName );
+	virtual long	GetBPRelativeOffsetForLocalVar( CSymbolID inName );
 
 	// Sub-blocks retrieve and modify these two as needed: // TODO: This isn't really very OO.
 	virtual size_t&										GetLocalVariableCount()	{ return *mLocalVariableCount; };
-	virtual std::map<std::string,CVariableEntry>&		GetLocals()				{ return *mLocals; };
-	virtual std::map<std::string,CVariableEntry>&		GetGlobals()			{ return *mGlobals; };
+	virtual std::map<CSymbolID,CVariableEntry>&			GetLocals()				{ return *mLocals; };
+	virtual std::map<CSymbolID,CVariableEntry>&			GetGlobals()			{ return *mGlobals; };
 
 	virtual CCodeBlockNodeBase*	GetContainingFunction()				{ return mOwningBlock->GetContainingFunction(); };
 	
+	virtual void	WriteToArchive( CParseTreeWriter& ioWriter );
+	
 protected:
-	std::map<std::string,CVariableEntry>*	mLocals;
+	std::map<CSymbolID,CVariableEntry>*		mLocals;
 	size_t*									mLocalVariableCount;
 	CCodeBlockNodeBase*						mOwningBlock;
-	std::map<std::string,CVariableEntry>*	mGlobals;
+	std::map<CSymbolID,CVariableEntry>*		mGlobals;
 };
 
 }
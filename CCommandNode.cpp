@@ -22,7 +22,7 @@ void	CCommandNode::DebugPrint( std::ostream& destStream, size_t indentLevel )
 	destStream << indentChars << "Command \"" << mSymbolName << "\"" << std::endl
 				<< indentChars << "{" << std::endl;
 	
-	std::vector<CValueNode*>::iterator itty;
+	CValueNodeList::iterator itty;
 	
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
 	{
@@ -40,20 +40,22 @@ void	CCommandNode::AddParam( CValueNode* val )
 }
 
 
-void	CCommandNode::Simplify()
+CNode*	CCommandNode::Simplify()
 {
-	std::vector<CValueNode*>::iterator itty;
+	CValueNodeList::iterator itty;
 	
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
 	{
-		(*itty)->Simplify();
+		(*itty) = (*itty)->Simplify();
 	}
+	
+	return this;
 }
 
 
 void	CCommandNode::GenerateCode( CCodeBlock* inCodeBlock )
 {
-	std::vector<CValueNode*>::iterator itty;
+	CValueNodeList::iterator itty;
 	
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
 	{
@@ -62,4 +64,13 @@ void	CCommandNode::GenerateCode( CCodeBlock* inCodeBlock )
 }
 
 
+void	CCommandNode::WriteCommandToArchive( CParseTreeWriter& ioWriter, int inKind )
+{
+	ioWriter.WriteNumber( inKind );
+	ioWriter.WriteString( mSymbolName );
+	ioWriter.WriteNumber( mLineNum );
+	ioWriter.WriteNodes( mParams );
+}
+
+
 } // namespace Carlson
@@ -14,6 +14,7 @@
 // -----------------------------------------------------------------------------
 
 #include "CNode.h"
+#include "CParseTreeArchive.h"
 #include <string>
 #include <vector>
 
@@ -31,7 +32,7 @@ class CValueNode;
 class CCommandNode : public CNode
 {
 public:
-	CCommandNode( CParseTree* inTree, const std::string& inSymbolName, size_t inLineNum ) : CNode(inTree), mSymbolName(inSymbolName), mLineNum(inLineNum) {};
+	CCommandNode( CParseTree* inTree, const std::string& inSymbolName, size_t inLineNum ) : CNode(inTree), mSymbolName(inSymbolName), mParams(GetNodeArena()), mLineNum(inLineNum) {};
 	virtual ~CCommandNode() {};
 	
 	virtual void		GetSymbolName( std::string& outSymbolName )			{ outSymbolName = mSymbolName; };
@@ -44,12 +45,16 @@ public:
 	
 	virtual void		DebugPrint( std::ostream& destStream, size_t indentLevel );
 	
-	virtual void		Simplify();
+	virtual CNode*		Simplify();
 	virtual void		GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void		WriteToArchive( CParseTreeWriter& ioWriter )		{ WriteCommandToArchive( ioWriter, ENodeKindCommand ); };
+	
+protected:
+	void				WriteCommandToArchive( CParseTreeWriter& ioWriter, int inKind );	// Subclasses only differ in their kind.
 	
 protected:
 	std::string					mSymbolName;
-	std::vector<CValueNode*>	mParams;
+	CValueNodeList				mParams;
 	size_t						mLineNum;
 };
 
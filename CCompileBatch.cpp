@@ -0,0 +1,134 @@
+/*
+ *  CCompileBatch.cpp
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#include "CCompileBatch.h"
+#include "CParser.h"
+#include "CParseTree.h"
+#include "CCodeBlock.h"
+#include "CToken.h"
+#include <map>
+#include <algorithm>
+#include <stdexcept>
+#include <unistd.h>
+
+
+namespace Carlson
+{
+
+CCompileBatch::CCompileBatch( std::vector<CCompileBatchItem>& ioItems, LEOContextGroup* inGroup, CCompilerContext* inContext )
+	: mItems(ioItems), mNextScript(0), mGroup(inGroup), mContext(inContext)
+{
+	std::map<LEOScript*,size_t>		listForScript;
+	for( size_t x = 0; x < mItems.size(); x++ )
+	{
+		std::map<LEOScript*,size_t>::iterator	foundList = listForScript.find( mItems[x].mScript );
+		if( foundList == listForScript.end() )
+		{
+			foundList = listForScript.insert( std::make_pair( mItems[x].mScript, mItemsByScript.size() ) ).first;
+			mItemsByScript.push_back( std::vector<size_t>() );
+		}
+		mItemsByScript[foundList->second].push_back( x );
+	}
+	
+	pthread_mutex_init( &mNextScriptLock, NULL );
+	pthread_mutex_init( &mGroupLock, NULL );
+}
+
+
+CCompileBatch::~CCompileBatch()
+{
+	pthread_mutex_destroy( &mNextScriptLock );
+	pthread_mutex_destroy( &mGroupLock );
+}
+
+
+// -----------------------------------------------------------------------------
+//	Compile:
+//		Main entrypoint. Each item gets its own parse tree, so all that needs
+//		locking is taking work off the list and the group's handler IDs.
+// -----------------------------------------------------------------------------
+
+/*static*/ void	CCompileBatch::Compile( std::vector<CCompileBatchItem>& ioItems, LEOContextGroup* inGroup, CCompilerContext* inContext, size_t inMaxThreads )
+{
+	CCompileBatch	batch( ioItems, inGroup, inContext );
+	
+	if( inMaxThreads == 0 )
+	{
+		long	numCPUs = sysconf( _SC_NPROCESSORS_ONLN );
+		inMaxThreads = (numCPUs > 0) ? numCPUs : 1;
+	}
+	size_t		numThreads = std::min( inMaxThreads, batch.mItemsByScript.size() / COMPILE_BATCH_MIN_ITEMS_PER_THREAD );
+	
+	// This thread works, too, so start one less:
+	std::vector<pthread_t>	threads;
+	for( size_t x = 1; x < numThreads; x++ )
+	{
+		pthread_t	newThread;
+		if( pthread_create( &newThread, NULL, CompileThread, &batch ) == 0 )
+			threads.push_back( newThread );
+	}
+	CompileThread( &batch );
+	
+	std::vector<pthread_t>::iterator	itty;
+	for( itty = threads.begin(); itty != threads.end(); itty++ )
+		pthread_join( *itty, NULL );
+}
+
+
+void*	CCompileBatch::CompileThread( void* inBatch )
+{
+	CCompileBatch*	self = (CCompileBatch*) inBatch;
+	
+	while( true )
+	{
+		pthread_mutex_lock( &self->mNextScriptLock );
+		size_t	scriptIndex = self->mNextScript++;
+		pthread_mutex_unlock( &self->mNextScriptLock );
+		if( scriptIndex >= self->mItemsByScript.size() )
+			break;
+		
+		const std::vector<size_t>&			itemIndexes = self->mItemsByScript[scriptIndex];
+		std::vector<size_t>::const_iterator	itty;
+		for( itty = itemIndexes.begin(); itty != itemIndexes.end(); itty++ )
+			self->CompileItem( self->mItems[*itty] );
+	}
+	
+	return NULL;
+}
+
+
+void	CCompileBatch::CompileItem( CCompileBatchItem& ioItem )
+{
+	try
+	{
+		CParseTree		parseTree;
+		CTokenList		tokens = CToken::TokenListFromText( ioItem.mCode, ioItem.mCodeLength, &parseTree.GetSymbols() );
+		CParser			parser( mContext );
+		parser.Parse( ioItem.mFileName, tokens, parseTree );
+		parseTree.Simplify();
+		
+		CCodeBlock		block( mGroup, ioItem.mScript, &mGroupLock );
+		parseTree.GenerateCode( &block );
+		
+		ioItem.mSucceeded = true;
+		ioItem.mErrorMessage.clear();
+	}
+	catch( std::exception& err )
+	{
+		ioItem.mSucceeded = false;
+		ioItem.mErrorMessage = err.what();
+	}
+	catch( ... )
+	{
+		ioItem.mSucceeded = false;
+		ioItem.mErrorMessage = "Unknown error.";
+	}
+}
+
+}
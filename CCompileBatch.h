@@ -0,0 +1,74 @@
+/*
+ *  CCompileBatch.h
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+struct LEOScript;
+struct LEOContextGroup;
+
+
+namespace Carlson
+{
+
+class CCompilerContext;
+
+
+// One script for CCompileBatch to compile:
+struct CCompileBatchItem
+{
+	const char*		mCode;			// UTF8 text, must stay around until Compile() returns.
+	size_t			mCodeLength;
+	const char*		mFileName;
+	LEOScript*		mScript;		// Handlers get added to this.
+	bool			mSucceeded;		// Set by Compile().
+	std::string		mErrorMessage;	// Set by Compile() if mSucceeded is FALSE.
+	
+	CCompileBatchItem( const char* inCode = NULL, size_t inCodeLength = 0, const char* inFileName = NULL, LEOScript* inScript = NULL )
+		: mCode(inCode), mCodeLength(inCodeLength), mFileName(inFileName), mScript(inScript), mSucceeded(false) {};
+};
+
+
+#define COMPILE_BATCH_MIN_ITEMS_PER_THREAD		4	// Don't start a thread for fewer scripts than this.
+
+
+// Compiles many scripts into the same context group on a pool of threads:
+//	Each thread takes the next script whose LEOScript no other thread is
+//	compiling into, and tokenizes, parses, simplifies and generates code for
+//	it. The group's handler ID table is the only thing the threads share, and
+//	CCodeBlock only touches it with the batch's lock held.
+class CCompileBatch
+{
+public:
+	static void	Compile( std::vector<CCompileBatchItem>& ioItems, LEOContextGroup* inGroup, CCompilerContext* inContext = NULL, size_t inMaxThreads = 0 );	// Uses one thread per CPU if inMaxThreads is 0. inContext is only read, NULL means the default one. Scripts for the same LEOScript are compiled in the order they're in ioItems.
+	
+protected:
+	CCompileBatch( std::vector<CCompileBatchItem>& ioItems, LEOContextGroup* inGroup, CCompilerContext* inContext );
+	~CCompileBatch();
+	
+	static void*	CompileThread( void* inBatch );
+	void			CompileItem( CCompileBatchItem& ioItem );
+	
+	CCompileBatch( const CCompileBatch& inOriginal );	// Not copyable, the threads point at us.
+	CCompileBatch&	operator =( const CCompileBatch& inOriginal );
+	
+protected:
+	std::vector<CCompileBatchItem>&		mItems;
+	std::vector< std::vector<size_t> >	mItemsByScript;		// Indexes into mItems, one list per LEOScript, each list in order.
+	size_t								mNextScript;		// Next list in mItemsByScript nobody has taken yet.
+	pthread_mutex_t						mNextScriptLock;	// Held while taking a list from mItemsByScript.
+	pthread_mutex_t						mGroupLock;			// Held while anyone touches mGroup.
+	LEOContextGroup*					mGroup;
+	CCompilerContext*					mContext;
+};
+
+}
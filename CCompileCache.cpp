@@ -0,0 +1,375 @@
+/*
+ *  CCompileCache.cpp
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#include "CCompileCache.h"
+#include "CBytecodeArchive.h"
+#include "CParser.h"
+#include "CParseTree.h"
+#include "CCodeBlock.h"
+#include "CToken.h"
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
+
+extern "C" {
+#include "LEOScript.h"
+#include "LEOMsgInstructions.h"
+#include "LEOPropertyInstructions.h"
+}
+
+
+namespace Carlson
+{
+
+// 64-bit constants. C++98 has no 64-bit literals, so they're put together from two halves:
+#define FNV1A_OFFSET_BASIS		((((uint64_t) 0xCBF29CE4) << 32) | 0x84222325)
+#define FNV1A_PRIME				((((uint64_t) 0x00000100) << 32) | 0x000001B3)
+#define SECOND_HASH_SEED		((((uint64_t) 0x6A09E667) << 32) | 0xF3BCC908)
+
+
+// Two differently seeded FNV-1a hashes, so a cache file name has 128 bits:
+class CCacheKeyHasher
+{
+public:
+	CCacheKeyHasher()	{ mHashes[0] = FNV1A_OFFSET_BASIS; mHashes[1] = SECOND_HASH_SEED; };
+	
+	void	AddBytes( const void* inBytes, size_t inLength )
+	{
+		const uint8_t*	bytes = (const uint8_t*) inBytes;
+		for( size_t x = 0; x < inLength; x++ )
+		{
+			mHashes[0] = (mHashes[0] ^ bytes[x]) * FNV1A_PRIME;
+			mHashes[1] = (mHashes[1] ^ bytes[x]) * FNV1A_PRIME;
+		}
+	}
+	
+	void	AddNumber( uint64_t inNumber )	// Little-endian, so the key doesn't depend on the CPU.
+	{
+		uint8_t		bytes[8];
+		for( int x = 0; x < 8; x++ )
+			bytes[x] = (uint8_t)(inNumber >> (x * 8));
+		AddBytes( bytes, sizeof(bytes) );
+	}
+	
+	uint64_t	mHashes[2];
+};
+
+
+CCompileCache::CCompileCache()
+	: mMaxBytes(COMPILE_CACHE_DEFAULT_MAX_BYTES), mKnownBytes(0), mKnowsDirectorySize(false), mContextHashGeneration((size_t) -1),
+		mNumHits(0), mNumMisses(0), mNumEvictions(0)
+{
+	mContextHash[0] = mContextHash[1] = 0;
+}
+
+
+void	CCompileCache::SetDirectory( const std::string& inPath, size_t inMaxBytes )
+{
+	mDirectory = inPath;
+	mMaxBytes = inMaxBytes;
+	mKnownBytes = 0;
+	mKnowsDirectorySize = false;
+	
+	if( !mDirectory.empty() && mkdir( mDirectory.c_str(), 0777 ) != 0 && errno != EEXIST )
+	{
+		std::string	path( mDirectory );
+		mDirectory.clear();
+		throw std::runtime_error( "Couldn't create compile cache folder \"" +path +"\"." );
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//	CompileAndAddScript:
+//		Load the script's handlers from the cache, or compile them, archive
+//		them into the cache and load them from the archive, so both ways give
+//		exactly the same handlers.
+// -----------------------------------------------------------------------------
+
+void	CCompileCache::CompileAndAddScript( CCompilerContext& inContext, LEOScript* inScript, LEOContextGroup* inGroup, const char* inCode, size_t inCodeLength, const char* inFileName )
+{
+	if( mDirectory.empty() )
+	{
+		CompileScript( inContext, inScript, inGroup, inCode, inCodeLength, inFileName );
+		return;
+	}
+	
+	std::string		key = KeyForCode( inContext, inCode, inCodeLength );
+	std::string		path = mDirectory +"/" +key +COMPILE_CACHE_FILE_SUFFIX;
+	std::string		archive;
+	if( ReadEntry( path, key, archive ) )
+	{
+		try
+		{
+			CBytecodeArchive::AddHandlersFromData( archive.data(), archive.length(), inScript, inGroup );
+			mNumHits++;
+			utimes( path.c_str(), NULL );	// Mark it as recently used, so it's evicted last.
+			return;
+		}
+		catch( std::runtime_error& )
+		{
+			// Damaged, or from another Forge. Compile it again and overwrite it.
+		}
+	}
+	
+	mNumMisses++;
+	
+	LEOScript*		compiledScript = LEOScriptCreateForOwner( 0, 0 );	// Only holds the handlers until we've archived them.
+	try
+	{
+		CompileScript( inContext, compiledScript, inGroup, inCode, inCodeLength, inFileName );
+		archive.clear();
+		CBytecodeArchive::AppendScript( compiledScript, inGroup, NULL, archive );
+	}
+	catch( ... )
+	{
+		LEOScriptRelease( compiledScript );
+		throw;
+	}
+	LEOScriptRelease( compiledScript );
+	
+	WriteEntry( path, key, archive );
+	CBytecodeArchive::AddHandlersFromData( archive.data(), archive.length(), inScript, inGroup );
+}
+
+
+/*static*/ void	CCompileCache::CompileScript( CCompilerContext& inContext, LEOScript* inScript, LEOContextGroup* inGroup, const char* inCode, size_t inCodeLength, const char* inFileName )
+{
+	CParseTree		parseTree;
+	CParser			parser( &inContext );
+	CTokenizer		tokenizer( inCode, inCodeLength );
+	CTokenList		tokens( &tokenizer, &parseTree.GetSymbols() );	// Tokenizes while parsing.
+	tokens.TokenizeInParallel();	// Unless it's big, then tokenize it on all cores right now.
+	parser.ParseInParallel( inFileName, tokens, parseTree );
+	parseTree.Simplify();
+	
+	CCodeBlock		block( inGroup, inScript );
+	parseTree.GenerateCode( &block );
+}
+
+
+// -----------------------------------------------------------------------------
+//	KeyForCode:
+//		Everything that changes the code we generate for a script goes into
+//		its key. Host instructions are hashed with the IDs the host gave
+//		them, so registering them in a different order gives other keys.
+// -----------------------------------------------------------------------------
+
+std::string	CCompileCache::KeyForCode( CCompilerContext& inContext, const char* inCode, size_t inCodeLength )
+{
+	if( mContextHashGeneration != inContext.GetGeneration() )
+	{
+		CCacheKeyHasher		hasher;
+		hasher.AddNumber( COMPILE_CACHE_VERSION );
+		hasher.AddNumber( BYTECODE_ARCHIVE_VERSION );
+		hasher.AddNumber( kFirstMsgInstruction );
+		hasher.AddNumber( kFirstPropertyInstruction );
+		
+		const TGlobalPropertyList*	globalProperties = inContext.GlobalPropertiesByType();
+		const THostCommandList*		hostCommandLists[2] = { inContext.HostCommandsByType(), inContext.HostFunctionsByType() };
+		for( size_t x = 0; x <= ELastIdentifier_Sentinel; x++ )
+		{
+			TGlobalPropertyList::const_iterator	propItty;
+			for( propItty = globalProperties[x].begin(); propItty != globalProperties[x].end(); propItty++ )
+			{
+				hasher.AddNumber( propItty->mType );
+				hasher.AddNumber( propItty->mSetterInstructionID );
+				hasher.AddNumber( propItty->mGetterInstructionID );
+			}
+			
+			for( size_t listIdx = 0; listIdx < 2; listIdx++ )
+			{
+				hasher.AddNumber( listIdx );	// So moving an entry from commands to functions changes the key.
+				THostCommandList::const_iterator	cmdItty;
+				for( cmdItty = hostCommandLists[listIdx][x].begin(); cmdItty != hostCommandLists[listIdx][x].end(); cmdItty++ )
+				{
+					hasher.AddNumber( cmdItty->mType );
+					hasher.AddNumber( cmdItty->mInstructionID );
+					hasher.AddNumber( cmdItty->mInstructionParam1 );
+					hasher.AddNumber( cmdItty->mInstructionParam2 );
+					for( size_t paramIdx = 0; paramIdx <= LEO_MAX_HOST_PARAMS && cmdItty->mParam[paramIdx].mType != EHostParam_Sentinel; paramIdx++ )
+					{
+						const THostParameterEntry&	param = cmdItty->mParam[paramIdx];
+						hasher.AddNumber( param.mType );
+						hasher.AddNumber( param.mIdentifierType );
+						hasher.AddNumber( param.mIsOptional );
+						hasher.AddNumber( param.mInstructionID );
+						hasher.AddNumber( param.mInstructionParam1 );
+						hasher.AddNumber( param.mInstructionParam2 );
+					}
+				}
+			}
+			
+			hasher.AddNumber( (x < ELastIdentifier_Sentinel && inContext.StatementParserForType( (TIdentifierSubtype) x ) != NULL) ? 1 : 0 );	// Addresses change between launches.
+		}
+		
+		mContextHash[0] = hasher.mHashes[0];
+		mContextHash[1] = hasher.mHashes[1];
+		mContextHashGeneration = inContext.GetGeneration();
+	}
+	
+	CCacheKeyHasher		hasher;
+	hasher.AddNumber( mContextHash[0] );
+	hasher.AddNumber( mContextHash[1] );
+	hasher.AddNumber( inCodeLength );
+	hasher.AddBytes( inCode, inCodeLength );
+	
+	char		keyStr[33];
+	snprintf( keyStr, sizeof(keyStr), "%08lx%08lx%08lx%08lx", (unsigned long)(hasher.mHashes[0] >> 32), (unsigned long)(hasher.mHashes[0] & 0xFFFFFFFF),
+				(unsigned long)(hasher.mHashes[1] >> 32), (unsigned long)(hasher.mHashes[1] & 0xFFFFFFFF) );	// No %llx in C++98.
+	
+	return std::string( keyStr );
+}
+
+
+// Read a whole cache file with one read, and give back the archive after its
+//	header if the header has the right key:
+bool	CCompileCache::ReadEntry( const std::string& inPath, const std::string& inKey, std::string& outArchive )
+{
+	int		fd = open( inPath.c_str(), O_RDONLY );
+	if( fd < 0 )
+		return false;
+	
+	struct stat	fileInfo;
+	size_t		headerLength = sizeof(COMPILE_CACHE_MAGIC) -1 +inKey.length();
+	bool		success = fstat( fd, &fileInfo ) == 0 && (size_t) fileInfo.st_size > headerLength;
+	if( success )
+	{
+		std::string	fileData( (size_t) fileInfo.st_size, '\0' );
+		success = read( fd, &fileData[0], fileData.length() ) == (ssize_t) fileData.length()
+					&& fileData.compare( 0, headerLength, COMPILE_CACHE_MAGIC +inKey ) == 0;
+		if( success )
+			outArchive.assign( fileData, headerLength, std::string::npos );
+	}
+	close( fd );
+	
+	return success;
+}
+
+
+// Write to a temporary file and rename it into place, so nobody ever reads
+//	half an entry. Failing to write just means it's compiled again next time:
+void	CCompileCache::WriteEntry( const std::string& inPath, const std::string& inKey, const std::string& inArchive )
+{
+	std::string		header = COMPILE_CACHE_MAGIC +inKey;
+	std::string		tempPath = inPath +".XXXXXX";
+	int				fd = mkstemp( &tempPath[0] );
+	if( fd < 0 )
+		return;
+	
+	bool	success = write( fd, header.data(), header.length() ) == (ssize_t) header.length()
+						&& write( fd, inArchive.data(), inArchive.length() ) == (ssize_t) inArchive.length();
+	fchmod( fd, 0644 );	// mkstemp() makes it readable only by us, but other users' processes may share the cache.
+	success = (close( fd ) == 0) && success;
+	if( !success || rename( tempPath.c_str(), inPath.c_str() ) != 0 )
+	{
+		unlink( tempPath.c_str() );
+		return;
+	}
+	
+	mKnownBytes += header.length() +inArchive.length();
+	if( !mKnowsDirectorySize || mKnownBytes > mMaxBytes )
+		EvictDownTo( mMaxBytes -(mMaxBytes / 4) );	// Leave some room, so we don't have to look at the whole directory again for every script.
+}
+
+
+struct CCacheFileInfo
+{
+	std::string		mPath;
+	time_t			mLastUsed;
+	size_t			mSize;
+	
+	bool	operator <( const CCacheFileInfo& inOther ) const	{ return mLastUsed < inOther.mLastUsed; };
+};
+
+
+// Is this the name of a temp file WriteEntry() makes, i.e. an entry's name
+//	followed by a dot and the six characters mkstemp() filled in?
+static bool	IsCacheTempFileName( const char* inName, size_t inNameLength )
+{
+	size_t	suffixLength = sizeof(COMPILE_CACHE_FILE_SUFFIX ".XXXXXX") -1;
+	if( inNameLength <= suffixLength )
+		return false;
+	const char*	suffix = inName +inNameLength -suffixLength;
+	return strncmp( suffix, COMPILE_CACHE_FILE_SUFFIX ".", sizeof(COMPILE_CACHE_FILE_SUFFIX) ) == 0
+			&& strchr( suffix +sizeof(COMPILE_CACHE_FILE_SUFFIX), '.' ) == NULL;
+}
+
+
+// Find out how big the directory really is, other processes may have added
+//	to it, and if it's over the limit, delete entries starting with the one
+//	that was used longest ago. Temp files count toward the size too, and
+//	once they're too old to still be written by anyone, their writer must
+//	have crashed before renaming them, so they're deleted right away:
+void	CCompileCache::EvictDownTo( size_t inMaxBytes )
+{
+	DIR*	dir = opendir( mDirectory.c_str() );
+	if( !dir )
+		return;
+	
+	std::vector<CCacheFileInfo>	files;
+	size_t						totalBytes = 0;
+	size_t						suffixLength = sizeof(COMPILE_CACHE_FILE_SUFFIX) -1;
+	time_t						staleTempTime = time( NULL ) -COMPILE_CACHE_STALE_TEMP_FILE_AGE;
+	struct dirent*				entry = NULL;
+	while( (entry = readdir( dir )) != NULL )
+	{
+		size_t	nameLength = strlen( entry->d_name );
+		bool	isTempFile = IsCacheTempFileName( entry->d_name, nameLength );
+		if( !isTempFile && (nameLength <= suffixLength || strcmp( entry->d_name +nameLength -suffixLength, COMPILE_CACHE_FILE_SUFFIX ) != 0) )
+			continue;
+		
+		CCacheFileInfo	fileInfo;
+		struct stat		statInfo;
+		fileInfo.mPath = mDirectory +"/" +entry->d_name;
+		if( stat( fileInfo.mPath.c_str(), &statInfo ) != 0 )
+			continue;	// Someone else just evicted it, or renamed it into place.
+		if( isTempFile )
+		{
+			if( statInfo.st_mtime < staleTempTime && unlink( fileInfo.mPath.c_str() ) == 0 )
+				mNumEvictions++;
+			else
+				totalBytes += (size_t) statInfo.st_size;	// Still being written, or not ours to delete. Only count it.
+			continue;
+		}
+		fileInfo.mLastUsed = statInfo.st_mtime;
+		fileInfo.mSize = (size_t) statInfo.st_size;
+		totalBytes += fileInfo.mSize;
+		files.push_back( fileInfo );
+	}
+	closedir( dir );
+	
+	if( totalBytes > mMaxBytes )
+	{
+		std::sort( files.begin(), files.end() );
+		std::vector<CCacheFileInfo>::iterator	itty;
+		for( itty = files.begin(); itty != files.end() && totalBytes > inMaxBytes; itty++ )
+		{
+			if( unlink( itty->mPath.c_str() ) == 0 )
+				mNumEvictions++;
+			totalBytes -= itty->mSize;
+		}
+	}
+	
+	mKnownBytes = totalBytes;
+	mKnowsDirectorySize = true;
+}
+
+}
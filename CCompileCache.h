@@ -0,0 +1,77 @@
+/*
+ *  CCompileCache.h
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#pragma once
+
+#include <string>
+#include <stdint.h>
+
+struct LEOScript;
+struct LEOContextGroup;
+
+
+namespace Carlson
+{
+
+class CCompilerContext;
+
+
+#define COMPILE_CACHE_VERSION				1					// Bump whenever Forge generates different code for the same script, so old entries don't get used.
+#define COMPILE_CACHE_DEFAULT_MAX_BYTES		(64 * 1024 * 1024)
+#define COMPILE_CACHE_FILE_SUFFIX			".fgc"
+#define COMPILE_CACHE_MAGIC					"FGCE"
+#define COMPILE_CACHE_STALE_TEMP_FILE_AGE	(10 * 60)			// Seconds after which a temp file is assumed to be left over from a writer that crashed.
+
+
+// Compiled scripts on disk, so unchanged scripts don't get parsed again on
+//	the next launch: Each entry is a file named after a hash of the script's
+//	text, Forge's version and the context's host commands, functions and
+//	properties, holding the key again and a CBytecodeArchive of the script.
+//	Entries are written to a temporary file and renamed into place, so
+//	several processes can share a directory and never see half an entry.
+//	When the directory gets bigger than the limit, the entries that were
+//	used least recently are deleted, and so are temp files that writers
+//	which crashed left behind. Off until you give it a directory.
+//	Statement parsers are only hashed by which identifiers have one, so use
+//	a different directory when you change what they generate.
+class CCompileCache
+{
+public:
+	CCompileCache();
+	
+	void		SetDirectory( const std::string& inPath, size_t inMaxBytes = COMPILE_CACHE_DEFAULT_MAX_BYTES );	// Creates the folder if needed, but not its parents. Empty path turns off the cache.
+	bool		IsEnabled() const		{ return !mDirectory.empty(); };
+	
+	void		CompileAndAddScript( CCompilerContext& inContext, LEOScript* inScript, LEOContextGroup* inGroup, const char* inCode, size_t inCodeLength, const char* inFileName );	// Throws on syntax errors, which aren't cached. Just compiles if the cache is off.
+	
+	size_t		GetNumHits() const		{ return mNumHits; };
+	size_t		GetNumMisses() const	{ return mNumMisses; };
+	size_t		GetNumEvictions() const	{ return mNumEvictions; };	// Entries we deleted, whichever process wrote them.
+	
+	static void	CompileScript( CCompilerContext& inContext, LEOScript* inScript, LEOContextGroup* inGroup, const char* inCode, size_t inCodeLength, const char* inFileName );	// Tokenizes, parses and generates code without looking at any cache.
+
+protected:
+	std::string	KeyForCode( CCompilerContext& inContext, const char* inCode, size_t inCodeLength );
+	bool		ReadEntry( const std::string& inPath, const std::string& inKey, std::string& outArchive );
+	void		WriteEntry( const std::string& inPath, const std::string& inKey, const std::string& inArchive );
+	void		EvictDownTo( size_t inMaxBytes );
+
+protected:
+	std::string		mDirectory;
+	size_t			mMaxBytes;
+	size_t			mKnownBytes;			// Size of the directory when we last looked, plus what we wrote since.
+	bool			mKnowsDirectorySize;	// FALSE until we've looked at the directory.
+	size_t			mContextHashGeneration;	// CCompilerContext generation mContextHash is for.
+	uint64_t		mContextHash[2];		// Hash of the context's host entries, so we don't redo it for every script.
+	size_t			mNumHits;
+	size_t			mNumMisses;
+	size_t			mNumEvictions;
+};
+
+}
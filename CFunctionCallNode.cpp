@@ -11,6 +11,7 @@
 #include "CParseTree.h"
 #include "CCodeBlock.h"
 #include "LEOInstructions.h"
+#include "CParseTreeArchive.h"
 
 
 namespace Carlson
@@ -18,9 +19,9 @@ namespace Carlson
 
 CValueNode*	CFunctionCallNode::Copy()
 {
-	CFunctionCallNode	*	nodeCopy = new CFunctionCallNode( mParseTree, mIsCommand, mSymbolName, mLineNum );
+	CFunctionCallNode	*	nodeCopy = new( mParseTree ) CFunctionCallNode( mParseTree, mIsCommand, mSymbolName, mLineNum );
 	
-	std::vector<CValueNode*>::const_iterator	itty;
+	CValueNodeList::const_iterator	itty;
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
 	{
 		nodeCopy->AddParam( (*itty)->Copy() );
@@ -37,7 +38,7 @@ void	CFunctionCallNode::DebugPrint( std::ostream& destStream, size_t indentLevel
 	destStream << indentChars << "Function Call \"" << mSymbolName << "\"" << std::endl
 				<< indentChars << "{" << std::endl;
 	
-	std::vector<CValueNode*>::iterator itty;
+	CValueNodeList::iterator itty;
 	
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
 	{
@@ -55,13 +56,15 @@ void	CFunctionCallNode::AddParam( CValueNode* val )
 }
 
 
-void	CFunctionCallNode::Simplify()
+CValueNode*	CFunctionCallNode::Simplify()
 {
-	std::vector<CValueNode*>::iterator itty;
+	CValueNodeList::iterator itty;
 	
 	// Push all params on stack (in reverse order!):
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
-		(*itty)->Simplify();
+		(*itty) = (*itty)->Simplify();
+	
+	return this;
 }
 
 
@@ -87,7 +90,7 @@ void	CFunctionCallNode::GenerateCode( CCodeBlock* inCodeBlock )
 	}
 	else
 	{
-		std::vector<CValueNode*>::reverse_iterator itty;
+		CValueNodeList::reverse_iterator itty;
 		
 		inCodeBlock->GeneratePushStringInstruction( "" );	// Reserve space for the result.
 		
@@ -112,4 +115,21 @@ void	CFunctionCallNode::GenerateCode( CCodeBlock* inCodeBlock )
 	}
 }
 
+
+void	CFunctionCallNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	WriteCallToArchive( ioWriter, ENodeKindFunctionCall );
+}
+
+
+void	CFunctionCallNode::WriteCallToArchive( CParseTreeWriter& ioWriter, int inKind )
+{
+	ioWriter.WriteNumber( inKind );
+	ioWriter.WriteBool( mIsCommand );
+	ioWriter.WriteString( mSymbolName );
+	ioWriter.WriteNumber( mLineNum );
+	ioWriter.WriteBool( mIsMessagePassing );
+	ioWriter.WriteNodes( mParams );
+}
+
 } // namespace Carlson
@@ -23,7 +23,7 @@ class CFunctionCallNode : public CValueNode
 {
 public:
 	CFunctionCallNode( CParseTree* inTree, bool isCommand, const std::string& inSymbolName, size_t inLineNum )
-		: CValueNode(inTree), mSymbolName(inSymbolName), mLineNum(inLineNum), mIsCommand(isCommand) {};
+		: CValueNode(inTree), mSymbolName(inSymbolName), mLineNum(inLineNum), mIsCommand(isCommand), mIsMessagePassing(false), mParams(GetNodeArena()) {};
 	virtual ~CFunctionCallNode() {};
 	
 	virtual void		GetSymbolName( std::string& outSymbolName )		{ outSymbolName = mSymbolName; };
@@ -36,16 +36,20 @@ public:
 	
 	virtual void		DebugPrint( std::ostream& destStream, size_t indentLevel );
 
-	virtual void		Simplify();
+	virtual CValueNode*	Simplify();
 	virtual void		GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void		WriteToArchive( CParseTreeWriter& ioWriter );
 	
 	virtual void		SetIsMessagePassing( bool inState )	{ mIsMessagePassing = inState; };
 
+protected:
+	void				WriteCallToArchive( CParseTreeWriter& ioWriter, int inKind );	// For subclasses that are read back as a different kind.
+
 protected:
 	std::string					mSymbolName;
 	bool						mIsCommand;
 	bool						mIsMessagePassing;
-	std::vector<CValueNode*>	mParams;
+	CValueNodeList				mParams;
 	size_t						mLineNum;
 };
 
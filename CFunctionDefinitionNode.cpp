@@ -10,18 +10,31 @@
 #include "CFunctionDefinitionNode.h"
 #include "CParser.h"
 #include "CCodeBlock.h"
+#include "CParseTreeArchive.h"
 
 
 namespace Carlson
 {
 
+static void	MapVariableSymbols( std::map<CSymbolID,CVariableEntry>& ioVariables, const std::vector<CSymbolID>& inSymbolMap )
+{
+	std::map<CSymbolID,CVariableEntry>				mappedVariables;
+	std::map<CSymbolID,CVariableEntry>::iterator	itty;
+	
+	for( itty = ioVariables.begin(); itty != ioVariables.end(); itty++ )
+		mappedVariables[ inSymbolMap[itty->first] ] = itty->second;
+	
+	ioVariables.swap( mappedVariables );	// Swap, don't assign: Our code blocks point at these maps.
+}
+
+
 CFunctionDefinitionNode::~CFunctionDefinitionNode()
 {
 	
 }
 
 
-void	CFunctionDefinitionNode::AddLocalVar( const std::string& inName,
+void	CFunctionDefinitionNode::AddLocalVar( CSymbolID inName,
 												const std::string& inUserName,
 												TVariantType theType,
 												bool initWithName,
@@ -31,7 +44,7 @@ void	CFunctionDefinitionNode::AddLocalVar( const std::string& inName,
 {
 	CVariableEntry	newEntry( inUserName, theType, initWithName,
 								isParam, isGlobal, dontDispose );
-	std::map<std::string,CVariableEntry>::iterator	foundVariable = mLocals.find( inName );
+	std::map<CSymbolID,CVariableEntry>::iterator	foundVariable = mLocals.find( inName );
 	if( foundVariable == mLocals.end() )
 		mLocals[inName] = newEntry;
 	if( isGlobal )
@@ -43,9 +56,9 @@ void	CFunctionDefinitionNode::AddLocalVar( const std::string& inName,
 }
 
 
-long	CFunctionDefinitionNode::GetBPRelativeOffsetForLocalVar( const std::string& inName )
+long	CFunctionDefinitionNode::GetBPRelativeOffsetForLocalVar( CSymbolID inName )
 {
-	std::map<std::string,CVariableEntry>::iterator	foundVariable = mLocals.find( inName );
+	std::map<CSymbolID,CVariableEntry>::iterator	foundVariable = mLocals.find( inName );
 	if( foundVariable != mLocals.end() )
 	{
 		long	bpRelOffs = foundVariable->second.mBPRelativeOffset;
@@ -74,11 +87,35 @@ void	CFunctionDefinitionNode::DebugPrint( std::ostream& destStream, size_t inden
 
 void	CFunctionDefinitionNode::GenerateCode( CCodeBlock* inCodeBlock )
 {
-	inCodeBlock->GenerateFunctionPrologForName( mIsCommand, mName, mLocals, mLineNum );
+	inCodeBlock->GenerateFunctionPrologForName( mIsCommand, mName, mLocals, mParseTree->GetSymbols(), mLineNum );
 	
 	CCodeBlockNodeBase::GenerateCode( inCodeBlock );
 	
 	inCodeBlock->GenerateFunctionEpilogForName( mIsCommand, mName, mLocals, mEndLineNum );
 }
 
+
+void	CFunctionDefinitionNode::MoveToTree( CParseTree* inTree, const std::vector<CSymbolID>& inSymbolMap )
+{
+	CCodeBlockNodeBase::MoveToTree( inTree, inSymbolMap );
+	
+	MapVariableSymbols( mLocals, inSymbolMap );
+	MapVariableSymbols( mGlobals, inSymbolMap );
+}
+
+
+void	CFunctionDefinitionNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	ioWriter.WriteNumber( ENodeKindFunctionDefinition );
+	ioWriter.WriteBool( mIsCommand );
+	ioWriter.WriteString( mName );
+	ioWriter.WriteNumber( mLineNum );
+	ioWriter.WriteNumber( mEndLineNum );
+	ioWriter.WriteVariables( mLocals );
+	ioWriter.WriteVariables( mGlobals );
+	ioWriter.WriteNumber( mLocalVariableCount );
+	WriteCommandsToArchive( ioWriter );
+}
+
+
 } /* namespace Carlson */
@@ -27,34 +27,39 @@ public:
 	};
 	virtual ~CFunctionDefinitionNode();
 		
-	virtual void	AddLocalVar( const std::string& inName, const std::string& inUserName,
+	virtual void	AddLocalVar( CSymbolID inName, const std::string& inUserName,
 									TVariantType theType, bool initWithName = false,
 									bool isParam = false, bool isGlobal = false,
 									bool dontDispose = false );
-	virtual long	GetBPRelativeOffsetForLocalVar( const std::string& inName );
+	virtual long	GetBPRelativeOffsetForLocalVar( CSymbolID inName );
 	
 	// Sub-blocks retrieve and modify these two as needed: // TODO: This isn't really very OO.
 	virtual size_t&										GetLocalVariableCount()	{ return mLocalVariableCount; };
-	virtual std::map<std::string,CVariableEntry>&		GetLocals()				{ return mLocals; };
-	virtual std::map<std::string,CVariableEntry>&		GetGlobals()			{ return mGlobals; };
+	virtual std::map<CSymbolID,CVariableEntry>&			GetLocals()				{ return mLocals; };
+	virtual std::map<CSymbolID,CVariableEntry>&			GetGlobals()			{ return mGlobals; };
 	
 	virtual void	DebugPrint( std::ostream& destStream, size_t indentLevel );
 	
 	virtual void	GenerateCode( CCodeBlock* inCodeBlock );
 	
+	virtual void	MoveToTree( CParseTree* inTree, const std::vector<CSymbolID>& inSymbolMap );
+	
+	virtual void	WriteToArchive( CParseTreeWriter& ioWriter );
+	
 	void			SetEndLineNum( size_t inEndLineNum )	{ mEndLineNum = inEndLineNum; };	// Line number of function's "end" marker, so we can indicate end to the debugger.
 	
 	virtual CCodeBlockNodeBase*	GetContainingFunction()				{ return this; };
 	bool			GetIsCommand()									{ return mIsCommand; };
+	const std::string&	GetName()									{ return mName; };
 	
 protected:
 	std::string								mName;
 	bool									mIsCommand;
 	size_t									mLineNum;
 	size_t									mEndLineNum;
-	std::map<std::string,CVariableEntry>	mLocals;
+	std::map<CSymbolID,CVariableEntry>		mLocals;
 	size_t									mLocalVariableCount;
-	std::map<std::string,CVariableEntry>	mGlobals;
+	std::map<CSymbolID,CVariableEntry>		mGlobals;
 };
 
 
@@ -24,6 +24,7 @@ public:
 		: CCommandNode( inTree, "GetArrayItemCount", inLineNum ) {};
 
 	virtual void	GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void	WriteToArchive( CParseTreeWriter& ioWriter )		{ WriteCommandToArchive( ioWriter, ENodeKindGetArrayItemCount ); };
 };
 
 } // namespace Carlson
@@ -24,6 +24,7 @@ public:
 		: CCommandNode( inTree, "GetArrayItem", inLineNum ) {};
 
 	virtual void	GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void	WriteToArchive( CParseTreeWriter& ioWriter )		{ WriteCommandToArchive( ioWriter, ENodeKindGetArrayItem ); };
 };
 
 } // namespace Carlson
@@ -19,6 +19,7 @@ public:
 		: CCommandNode( inTree, "GetParameter", inLineNum ) {};
 
 	virtual void	GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void	WriteToArchive( CParseTreeWriter& ioWriter )		{ WriteCommandToArchive( ioWriter, ENodeKindGetParamCommand ); };
 };
 
 } // namespace Carlson
@@ -11,6 +11,7 @@
 #include "CParseTree.h"
 #include "CCodeBlock.h"
 #include "LEOInstructions.h"
+#include "CParseTreeArchive.h"
 
 
 namespace Carlson
@@ -23,7 +24,7 @@ void	CGlobalPropertyNode::DebugPrint( std::ostream& destStream, size_t indentLev
 	destStream << indentChars << "Global Property \"" << gInstructionNames[mGetterInstructionID] << "\"" << std::endl
 				<< indentChars << "{" << std::endl;
 	
-	std::vector<CValueNode*>::iterator itty;
+	CValueNodeList::iterator itty;
 	
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
 	{
@@ -41,18 +42,20 @@ void	CGlobalPropertyNode::AddParam( CValueNode* val )
 }
 
 
-void	CGlobalPropertyNode::Simplify()
+CValueNode*	CGlobalPropertyNode::Simplify()
 {
-	std::vector<CValueNode*>::iterator itty;
+	CValueNodeList::iterator itty;
 	
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
-		(*itty)->Simplify();
+		(*itty) = (*itty)->Simplify();
+	
+	return this;
 }
 
 
 void	CGlobalPropertyNode::GenerateCode( CCodeBlock* inCodeBlock )
 {
-	std::vector<CValueNode*>::iterator itty;
+	CValueNodeList::iterator itty;
 	
 	// Push all params on stack:
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
@@ -64,7 +67,7 @@ void	CGlobalPropertyNode::GenerateCode( CCodeBlock* inCodeBlock )
 
 void	CGlobalPropertyNode::GenerateSetterCode( CCodeBlock* inCodeBlock, CValueNode* newValueNode )
 {
-	std::vector<CValueNode*>::iterator itty;
+	CValueNodeList::iterator itty;
 	
 	// Push all params on stack:
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
@@ -75,4 +78,14 @@ void	CGlobalPropertyNode::GenerateSetterCode( CCodeBlock* inCodeBlock, CValueNod
 	inCodeBlock->GenerateOperatorInstruction( mSetterInstructionID );
 }
 
+
+void	CGlobalPropertyNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	ioWriter.WriteNumber( ENodeKindGlobalProperty );
+	ioWriter.WriteInstructionID( mSetterInstructionID );
+	ioWriter.WriteInstructionID( mGetterInstructionID );
+	ioWriter.WriteNumber( mLineNum );
+	ioWriter.WriteNodes( mParams );
+}
+
 } // namespace Carlson
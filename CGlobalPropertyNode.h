@@ -25,7 +25,7 @@ class CGlobalPropertyNode : public CValueNode
 {
 public:
 	CGlobalPropertyNode( CParseTree* inTree, LEOInstructionID inSetterInstructionID, LEOInstructionID inGetterInstructionID, size_t inLineNum )
-		: CValueNode(inTree), mSetterInstructionID(inSetterInstructionID), mGetterInstructionID(inGetterInstructionID), mLineNum(inLineNum) {};
+		: CValueNode(inTree), mSetterInstructionID(inSetterInstructionID), mGetterInstructionID(inGetterInstructionID), mParams(GetNodeArena()), mLineNum(inLineNum) {};
 	virtual ~CGlobalPropertyNode() {};
 	
 	virtual size_t			GetParamCount()									{ return mParams.size(); };
@@ -35,14 +35,15 @@ public:
 	
 	virtual void			DebugPrint( std::ostream& destStream, size_t indentLevel );
 
-	virtual void			Simplify();
+	virtual CValueNode*		Simplify();
 	virtual void			GenerateCode( CCodeBlock* inCodeBlock );
 	virtual void			GenerateSetterCode( CCodeBlock* inCodeBlock, CValueNode* newValueNode );
+	virtual void			WriteToArchive( CParseTreeWriter& ioWriter );
 
 protected:
 	LEOInstructionID			mSetterInstructionID;
 	LEOInstructionID			mGetterInstructionID;
-	std::vector<CValueNode*>	mParams;
+	CValueNodeList				mParams;
 	size_t						mLineNum;
 };
 
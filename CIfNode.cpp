@@ -9,6 +9,8 @@
 
 #include "CIfNode.h"
 #include "CCodeBlock.h"
+#include "CParseTreeArchive.h"
+#include <stdexcept>
 
 
 namespace Carlson
@@ -52,11 +54,18 @@ void	CIfNode::GenerateCode( CCodeBlock* inBlock )
 }
 
 
-void	CIfNode::Simplify()
+CNode*	CIfNode::Simplify()
 {
-	mCondition->Simplify();
+	mCondition = mCondition->Simplify();
 	CCodeBlockNode::Simplify();
-	mElseBlock->Simplify();
+	if( mElseBlock )
+	{
+		mElseBlock = dynamic_cast<CCodeBlockNode*>( mElseBlock->Simplify() );
+		if( !mElseBlock )
+			throw std::logic_error( "An else block may only be simplified into another code block." );
+	}
+	
+	return this;
 }
 
 
@@ -76,6 +85,21 @@ void	CIfNode::DebugPrint( std::ostream& destStream, size_t indentLevel )
 }
 
 
+void	CIfNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	ioWriter.WriteNumber( ENodeKindIf );
+	ioWriter.WriteNodeReference( mOwningBlock );
+	ioWriter.WriteNumber( mLineNum );
+	ioWriter.WriteNode( mCondition );
+	WriteCommandsToArchive( ioWriter );
+	ioWriter.WriteBool( mElseBlock != NULL );
+	if( mElseBlock )
+	{
+		ioWriter.WriteNumber( mElseBlock->GetLineNum() );
+		ioWriter.RegisterNode( mElseBlock );	// Variables in it refer to it.
+		mElseBlock->WriteCommandsToArchive( ioWriter );
+	}
+}
 
 
 }
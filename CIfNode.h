@@ -16,15 +16,15 @@ class CIfNode : public CCodeBlockNode
 {
 public:
 	CIfNode( CParseTree* inTree, size_t inLineNum, CCodeBlockNodeBase* owningBlock ) : CCodeBlockNode( inTree, inLineNum, owningBlock ), mCondition(NULL), mElseBlock(NULL) {};
-	~CIfNode() { delete mCondition; mCondition = NULL; if( mElseBlock ) { delete mElseBlock; mElseBlock = NULL; } };
 
-	virtual void			SetCondition( CValueNode* inCond )	{ if( mCondition ) delete mCondition; mCondition = inCond; };	// inCond is now owned by the CIfNode.
-	virtual CCodeBlockNode*	CreateElseBlock( size_t inLineNum )	{ mElseBlock = new CCodeBlockNode( mParseTree, inLineNum, mOwningBlock ); return mElseBlock; };
+	virtual void			SetCondition( CValueNode* inCond )	{ mCondition = inCond; };
+	virtual CCodeBlockNode*	CreateElseBlock( size_t inLineNum )	{ mElseBlock = new( mParseTree ) CCodeBlockNode( mParseTree, inLineNum, mOwningBlock ); return mElseBlock; };
 	virtual CCodeBlockNode*	GetElseBlock()						{ return mElseBlock; };	// May return NULL!
 	
 	virtual void			DebugPrint( std::ostream& destStream, size_t indentLevel );
 	virtual void			GenerateCode( CCodeBlock* inBlock );
-	virtual void			Simplify();
+	virtual CNode*			Simplify();
+	virtual void			WriteToArchive( CParseTreeWriter& ioWriter );
 	
 protected:
 	CCodeBlockNode*	mElseBlock;
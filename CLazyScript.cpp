@@ -0,0 +1,254 @@
+/*
+ *  CLazyScript.cpp
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#include "CLazyScript.h"
+#include "CCodeBlock.h"
+#include "CFunctionDefinitionNode.h"
+#include <stdexcept>
+#include <stdio.h>
+
+extern "C" {
+#include "ForgeInstructions.h"
+#include "LEOScript.h"
+#include "LEOContextGroup.h"
+}
+
+
+using namespace Carlson;
+
+
+static void	CompileHandlerLazilyInstruction( LEOContext* inContext );
+
+
+extern "C" {
+
+LEOInstructionFuncPtr	gForgeInstructions[LEO_NUMBER_OF_FORGE_INSTRUCTIONS] =
+{
+	CompileHandlerLazilyInstruction
+};
+
+const char*				gForgeInstructionNames[LEO_NUMBER_OF_FORGE_INSTRUCTIONS] =
+{
+	"CompileHandlerLazily"
+};
+
+size_t					kFirstForgeInstruction = 0;
+
+}
+
+
+/*!
+	Replace the stub handler we're running in with its compiled code and
+	continue at the start of that. Nothing has been pushed for this handler
+	yet, so the parameters the caller pushed are exactly where the compiled
+	code expects them.
+	
+	(COMPILE_HANDLER_LAZILY_INSTR)
+	
+	param2	-	The stub's number, as handed out by CLazyScript::AddHandlers().
+*/
+
+static void	CompileHandlerLazilyInstruction( LEOContext* inContext )
+{
+	try
+	{
+		LEOHandler*	theHandler = CLazyScript::CompileStub( inContext->currentInstruction->param2 );
+		inContext->currentInstruction = theHandler->instructions;
+	}
+	catch( std::exception& err )
+	{
+		snprintf( inContext->errMsg, sizeof(inContext->errMsg), "%s", err.what() );
+		inContext->keepRunning = false;
+	}
+	catch( ... )
+	{
+		snprintf( inContext->errMsg, sizeof(inContext->errMsg), "Unknown error compiling handler." );
+		inContext->keepRunning = false;
+	}
+}
+
+
+namespace Carlson
+{
+
+std::vector< std::pair<CLazyScript*,size_t> >	CLazyScript::sStubs;
+pthread_mutex_t									CLazyScript::sStubsLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+CLazyScript::CLazyScript( CCompilerContext& inContext, LEOContextGroup* inGroup, LEOScript* inScript, const char* inCode, size_t inCodeLength, const char* inFileName )
+	: mCode( inCode, inCodeLength ), mFileName( inFileName ), mContext( &inContext ), mGroup( NULL ), mScript( inScript ), mBusyCount( 0 ), mForgotten( false )
+{
+	mGroup = LEOContextGroupRetain( inGroup );
+	pthread_mutex_init( &mCompileLock, NULL );
+	
+	CTokenizer	tokenizer( mCode.data(), mCode.length() );
+	mTokens = CTokenList( &tokenizer, &mParseTree.GetSymbols(), 0 );
+	mTokens.TokenizeInParallel();	// Big scripts get tokenized on all cores.
+	if( !mTokens.IsComplete() )		// Too small for that, tokenize it here.
+		mTokens = CToken::TokenListFromText( mCode.data(), mCode.length(), &mParseTree.GetSymbols() );
+}
+
+
+CLazyScript::~CLazyScript()
+{
+	pthread_mutex_destroy( &mCompileLock );
+	LEOContextGroupRelease( mGroup );
+}
+
+
+void	CLazyScript::AddHandlers( CCompilerContext& inContext, LEOContextGroup* inGroup, LEOScript* inScript, const char* inCode, size_t inCodeLength, const char* inFileName )
+{
+	if( kFirstForgeInstruction == 0 )
+		throw std::logic_error( "Add gForgeInstructions to the instruction array before compiling handlers lazily." );
+	
+	CLazyScript*	lazyScript = new CLazyScript( inContext, inGroup, inScript, inCode, inCodeLength, inFileName );
+	
+	try
+	{
+		if( !CParser::FindHandlers( lazyScript->mTokens, lazyScript->mHandlers ) )	// Something we can't skip over? Compile it all now, so errors get reported.
+		{
+			CParser		parser( &inContext );
+			parser.Parse( inFileName, lazyScript->mTokens, lazyScript->mParseTree );
+			lazyScript->mParseTree.Simplify();
+			
+			CCodeBlock	block( inGroup, inScript );
+			lazyScript->mParseTree.GenerateCode( &block );
+			
+			delete lazyScript;
+			return;
+		}
+		
+		std::vector<CParsedHandler>::iterator	itty;
+		for( itty = lazyScript->mHandlers.begin(); itty != lazyScript->mHandlers.end(); itty++ )
+		{
+			itty->mIsFunction = lazyScript->mTokens.GetToken( itty->mStartIndex ).IsIdentifier( EFunctionIdentifier );
+			itty->mHandlerName = lazyScript->mTokens.GetToken( itty->mStartIndex +1 ).GetIdentifierText();
+			
+			LEOHandlerID	handlerID = LEOContextGroupHandlerIDForHandlerName( inGroup, itty->mHandlerName.c_str() );
+			LEOHandler*		existingHandler = itty->mIsFunction ? LEOScriptFindFunctionHandlerWithID( inScript, handlerID ) : LEOScriptFindCommandHandlerWithID( inScript, handlerID );
+			if( existingHandler )	// Only the first one with a name would ever get called.
+				continue;
+			
+			LEOHandler*		stub = itty->mIsFunction ? LEOScriptAddFunctionHandlerWithID( inScript, handlerID ) : LEOScriptAddCommandHandlerWithID( inScript, handlerID );
+			pthread_mutex_lock( &sStubsLock );
+			uint32_t		stubNumber = (uint32_t) sStubs.size();
+			sStubs.push_back( std::make_pair( lazyScript, (size_t)(itty -lazyScript->mHandlers.begin()) ) );
+			pthread_mutex_unlock( &sStubsLock );
+			LEOHandlerAddInstruction( stub, kFirstForgeInstruction +COMPILE_HANDLER_LAZILY_INSTR, 0, stubNumber );
+		}
+	}
+	catch( ... )
+	{
+		pthread_mutex_lock( &sStubsLock );
+		std::vector< std::pair<CLazyScript*,size_t> >::iterator	stubItty;
+		for( stubItty = sStubs.begin(); stubItty != sStubs.end(); stubItty++ )
+		{
+			if( stubItty->first == lazyScript )	// Stubs we already added just report an error when called.
+				stubItty->first = NULL;
+		}
+		pthread_mutex_unlock( &sStubsLock );
+		delete lazyScript;
+		throw;
+	}
+}
+
+
+void	CLazyScript::ForgetHandlers( LEOScript* inScript )
+{
+	std::vector<CLazyScript*>								scripts;
+	std::vector< std::pair<CLazyScript*,size_t> >::iterator	itty;
+	pthread_mutex_lock( &sStubsLock );
+	for( itty = sStubs.begin(); itty != sStubs.end(); itty++ )
+	{
+		if( itty->first == NULL || itty->first->mScript != inScript )
+			continue;
+		if( !itty->first->mForgotten )
+		{
+			itty->first->mForgotten = true;
+			if( itty->first->mBusyCount == 0 )	// Otherwise the last one compiling deletes it.
+				scripts.push_back( itty->first );
+		}
+		itty->first = NULL;	// Numbers aren't re-used, stubs still around elsewhere would run the wrong handler.
+	}
+	pthread_mutex_unlock( &sStubsLock );
+	
+	std::vector<CLazyScript*>::iterator	scriptItty;
+	for( scriptItty = scripts.begin(); scriptItty != scripts.end(); scriptItty++ )
+		delete *scriptItty;
+}
+
+
+LEOHandler*	CLazyScript::CompileStub( size_t inStubNumber )
+{
+	pthread_mutex_lock( &sStubsLock );
+	std::pair<CLazyScript*,size_t>	stub( (CLazyScript*) NULL, 0 );
+	if( inStubNumber < sStubs.size() )
+		stub = sStubs[inStubNumber];
+	if( stub.first )
+		stub.first->mBusyCount++;	// Keeps ForgetHandlers() from deleting it under us.
+	pthread_mutex_unlock( &sStubsLock );
+	
+	if( stub.first == NULL )
+		throw std::runtime_error( "Can't compile a handler whose script has been unloaded." );
+	
+	LEOHandler*	theHandler = NULL;
+	pthread_mutex_lock( &stub.first->mCompileLock );
+	try
+	{
+		theHandler = stub.first->CompileHandler( stub.second );
+	}
+	catch( ... )
+	{
+		pthread_mutex_unlock( &stub.first->mCompileLock );
+		DoneCompiling( stub.first );
+		throw;
+	}
+	pthread_mutex_unlock( &stub.first->mCompileLock );
+	DoneCompiling( stub.first );
+	
+	return theHandler;
+}
+
+
+void	CLazyScript::DoneCompiling( CLazyScript* inScript )
+{
+	pthread_mutex_lock( &sStubsLock );
+	bool	deleteScript = (--inScript->mBusyCount == 0) && inScript->mForgotten;
+	pthread_mutex_unlock( &sStubsLock );
+	
+	if( deleteScript )
+		delete inScript;
+}
+
+
+LEOHandler*	CLazyScript::CompileHandler( size_t inHandlerIndex )
+{
+	CParsedHandler&	handler = mHandlers[inHandlerIndex];
+	LEOHandlerID	handlerID = LEOContextGroupHandlerIDForHandlerName( mGroup, handler.mHandlerName.c_str() );
+	LEOHandler*		stub = handler.mIsFunction ? LEOScriptFindFunctionHandlerWithID( mScript, handlerID ) : LEOScriptFindCommandHandlerWithID( mScript, handlerID );	// Adding handlers may have moved it since we created it.
+	if( !stub )
+		throw std::logic_error( "Couldn't find the stub of a handler to compile." );
+	if( handler.mNode )	// Already compiled, e.g. someone kept a copy of the stub's instruction.
+		return stub;
+	
+	CParser						parser( mContext );
+	CFunctionDefinitionNode*	theNode = parser.ParseHandlerAt( mFileName.c_str(), mTokens, handler.mStartIndex, mParseTree );	// Throws on syntax errors.
+	if( !theNode )
+		throw std::logic_error( "Couldn't find the handler to compile." );
+	theNode->Simplify();
+	
+	CCodeBlock	block( mGroup, mScript );
+	block.SetHandlerToReplace( stub );
+	theNode->GenerateCode( &block );
+	handler.mNode = theNode;
+	
+	return stub;
+}
+
+}
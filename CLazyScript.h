@@ -0,0 +1,75 @@
+/*
+ *  CLazyScript.h
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#pragma once
+
+#include "CParser.h"
+#include "CParseTree.h"
+#include "CToken.h"
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+extern "C" {
+#include "LEOInterpreter.h"
+}
+
+struct LEOScript;
+struct LEOHandler;
+struct LEOContextGroup;
+
+
+namespace Carlson
+{
+
+// Handlers that only get parsed and compiled when they are first called:
+//	AddHandlers() tokenizes the script, finds where its handlers are, and adds
+//	a stub handler for each to the LEOScript. A stub's only instruction
+//	compiles the real handler over the stub and continues at its start.
+//	The stubs refer to us by number in a table all threads share, which is
+//	locked while it is looked at or changed. Numbers are never handed out
+//	twice, so a stub of a forgotten script that someone still holds on to
+//	can't compile another script's handler. We're only deleted once nobody
+//	is compiling one of our handlers anymore.
+class CLazyScript
+{
+public:
+	static void			AddHandlers( CCompilerContext& inContext, LEOContextGroup* inGroup, LEOScript* inScript, const char* inCode, size_t inCodeLength, const char* inFileName );	// Copies inCode. Compiles it all right away if it can't find the handlers without parsing. inContext must stay around until you call ForgetHandlers().
+	static void			ForgetHandlers( LEOScript* inScript );	// Call before releasing inScript. Stubs that haven't been called yet stop working.
+	
+	static LEOHandler*	CompileStub( size_t inStubNumber );	// Compiles the handler over its stub, if that hasn't happened yet, and returns it.
+	
+protected:
+	CLazyScript( CCompilerContext& inContext, LEOContextGroup* inGroup, LEOScript* inScript, const char* inCode, size_t inCodeLength, const char* inFileName );
+	~CLazyScript();
+	
+	LEOHandler*			CompileHandler( size_t inHandlerIndex );	// Call with mCompileLock held.
+	static void			DoneCompiling( CLazyScript* inScript );	// Balances the mBusyCount increment in CompileStub(), deletes inScript if it was forgotten meanwhile.
+	
+	CLazyScript( const CLazyScript& inOriginal );				// Not copyable, the stubs point at us.
+	CLazyScript&	operator =( const CLazyScript& inOriginal );
+	
+protected:
+	std::string						mCode;		// Our tokens point into this.
+	std::string						mFileName;
+	CCompilerContext*				mContext;	// Host entries to parse our handlers with. We don't own this.
+	LEOContextGroup*				mGroup;		// Retained, it knows the handler IDs.
+	LEOScript*						mScript;	// Not retained, it owns the stubs, which point at us.
+	CParseTree						mParseTree;	// Owns the symbols of our tokens, and the handlers compiled so far.
+	CTokenList						mTokens;
+	std::vector<CParsedHandler>		mHandlers;	// mNode is set once a handler has been compiled.
+	pthread_mutex_t					mCompileLock;	// Held while a handler is compiled, so two threads can't parse into mParseTree at once.
+	size_t							mBusyCount;	// Number of threads compiling one of our handlers. Guarded by sStubsLock.
+	bool							mForgotten;	// ForgetHandlers() was called while we were busy, delete us once we aren't. Guarded by sStubsLock.
+	
+	static std::vector< std::pair<CLazyScript*,size_t> >	sStubs;	// Script and index in its mHandlers for each stub number. NULL script once forgotten, the number isn't re-used.
+	static pthread_mutex_t									sStubsLock;	// Held while anyone touches sStubs.
+};
+
+}
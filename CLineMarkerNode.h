@@ -21,6 +21,7 @@ public:
 	virtual void	DebugPrint( std::ostream& destStream, size_t indentLevel );
 
 	virtual void	GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void	WriteToArchive( CParseTreeWriter& ioWriter )		{ WriteCommandToArchive( ioWriter, ENodeKindLineMarker ); };
 };
 
 } // namespace Carlson
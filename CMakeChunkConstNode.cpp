@@ -8,6 +8,7 @@
 
 #include "CMakeChunkConstNode.h"
 #include "CCodeBlock.h"
+#include "CParseTreeArchive.h"
 
 
 namespace Carlson
@@ -16,9 +17,9 @@ namespace Carlson
 		
 CValueNode*	CMakeChunkConstNode::Copy()
 {
-	CMakeChunkConstNode	*	nodeCopy = new CMakeChunkConstNode( mParseTree, mLineNum );
+	CMakeChunkConstNode	*	nodeCopy = new( mParseTree ) CMakeChunkConstNode( mParseTree, mLineNum );
 	
-	std::vector<CValueNode*>::const_iterator	itty;
+	CValueNodeList::const_iterator	itty;
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
 	{
 		nodeCopy->AddParam( (*itty)->Copy() );
@@ -30,7 +31,7 @@ CValueNode*	CMakeChunkConstNode::Copy()
 
 void	CMakeChunkConstNode::GenerateCode( CCodeBlock* inCodeBlock )
 {
-	std::vector<CValueNode*>::const_iterator	itty = mParams.begin();
+	CValueNodeList::const_iterator	itty = mParams.begin();
 	
 	(*itty)->GenerateCode( inCodeBlock );
 	
@@ -55,4 +56,10 @@ void	CMakeChunkConstNode::GenerateCode( CCodeBlock* inCodeBlock )
 	#endif
 }
 
+
+void	CMakeChunkConstNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	WriteCallToArchive( ioWriter, ENodeKindMakeChunkConst );
+}
+
 } // namespace Carlson
@@ -8,6 +8,7 @@
 
 #include "CMakeChunkRefNode.h"
 #include "CCodeBlock.h"
+#include "CParseTreeArchive.h"
 
 
 namespace Carlson
@@ -16,9 +17,9 @@ namespace Carlson
 		
 CValueNode*	CMakeChunkRefNode::Copy()
 {
-	CMakeChunkRefNode	*	nodeCopy = new CMakeChunkRefNode( mParseTree, mLineNum );
+	CMakeChunkRefNode	*	nodeCopy = new( mParseTree ) CMakeChunkRefNode( mParseTree, mLineNum );
 	
-	std::vector<CValueNode*>::const_iterator	itty;
+	CValueNodeList::const_iterator	itty;
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
 	{
 		nodeCopy->AddParam( (*itty)->Copy() );
@@ -30,7 +31,7 @@ CValueNode*	CMakeChunkRefNode::Copy()
 
 void	CMakeChunkRefNode::GenerateCode( CCodeBlock* inCodeBlock )
 {
-	std::vector<CValueNode*>::const_iterator	itty = mParams.begin();
+	CValueNodeList::const_iterator	itty = mParams.begin();
 	
 	CLocalVariableRefValueNode * theVar = dynamic_cast<CLocalVariableRefValueNode*>(*itty);
 	
@@ -53,4 +54,10 @@ void	CMakeChunkRefNode::GenerateCode( CCodeBlock* inCodeBlock )
 	inCodeBlock->GeneratePushChunkRefInstruction( bpRelativeOffset, chunkType );
 }
 
+
+void	CMakeChunkRefNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	WriteCallToArchive( ioWriter, ENodeKindMakeChunkRef );
+}
+
 } // namespace Carlson
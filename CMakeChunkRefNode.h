@@ -21,6 +21,7 @@ public:
 	virtual CValueNode*	Copy();
 
 	virtual void		GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void		WriteToArchive( CParseTreeWriter& ioWriter );
 };
 
 
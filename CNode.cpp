@@ -8,4 +8,37 @@
  */
 
 #include "CNode.h"
+#include "CParseTree.h"
+#include <stdexcept>
+
+
+namespace Carlson
+{
+
+CNode::CNode( CParseTree* inTree )
+	: mParseTree(inTree), mNodeArena(&inTree->GetNodeArena())
+{
+	mNodeArena->NodeWasConstructed( this );
+}
+
+
+CNode::~CNode()
+{
+	if( !mNodeArena->IsReleasing() )	// A subclass's constructor threw.
+		mNodeArena->NodeWasDestructed( this );
+}
+
+
+void*	CNode::operator new( size_t inSize, CParseTree* inTree )
+{
+	return inTree->GetNodeArena().Allocate( inSize );
+}
+
+
+void	CNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	throw std::logic_error( "Can't archive this kind of node." );
+}
+
+} // namespace Carlson
 
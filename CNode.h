@@ -13,7 +13,10 @@
 //	Headers:
 // -----------------------------------------------------------------------------
 
+#include "CNodeArena.h"
+#include "CSymbolTable.h"
 #include <ostream>
+#include <vector>
 
 
 #if 1
@@ -32,28 +35,50 @@ namespace Carlson
 
 class CCodeBlock;
 class CParseTree;
+class CValueNode;
+class CParseTreeWriter;
 
 // Abstract root class for things in a parse tree:
 //	These are stupid, and can simply be debug-printed or turned into code, and
 //	that is it.
+//	Nodes live in their parse tree's CNodeArena, so you create them with
+//	new( &parseTree ) CSomeNode( &parseTree, ... ) and never delete them. The
+//	tree destructs all of them when it goes away.
 
 class CNode
 {
 public:
-	explicit CNode( CParseTree* inTree ) : mParseTree(inTree)					{};
-	virtual ~CNode() {};
+	explicit CNode( CParseTree* inTree );
+	virtual ~CNode();
 	
-	virtual void	Simplify()													{};	// For optimizing our parse tree before we actually generate code.
+	static void*	operator new( size_t inSize, CParseTree* inTree );
+	static void		operator delete( void* inMemory, CParseTree* inTree )		{};	// Only called if a constructor throws. The arena frees the memory.
+	
+	CNodeArena&		GetNodeArena()												{ return *mNodeArena; };	// The arena we live in, even after MoveToTree().
+	
+	virtual CNode*	Simplify()													{ return this; };	// For optimizing our parse tree before we actually generate code. Returns the node to use in our place, which may be a new one.
 	
 	virtual void	GenerateCode( CCodeBlock* inCodeBlock )						{};	// Generate the actual bytecode.
 	
 	virtual void	DebugPrint( std::ostream& destStream, size_t indentLevel ) = 0;
 	
+	virtual void	MoveToTree( CParseTree* inTree, const std::vector<CSymbolID>& inSymbolMap )	{ mParseTree = inTree; };	// Used when merging trees parsed on several threads. inSymbolMap maps each symbol of our old tree to inTree's. We stay in the old tree's arena, see CParseTree::AdoptSubTree().
+	
+	virtual void	WriteToArchive( CParseTreeWriter& ioWriter );	// Write our kind and fields for CParseTreeReader::ReadNode(). Throws std::logic_error for nodes that can't be archived.
+	
+protected:
+	static void		operator delete( void* inMemory )							{};	// Protected so nobody deletes a node, the arena frees the memory.
+
 protected:
 	CParseTree*		mParseTree;
+	CNodeArena*		mNodeArena;	// Arena of the tree we were created in, which frees our memory.
 };
 
 
+typedef std::vector<CNode*,CNodeArenaAllocator<CNode*> >				CNodeList;		// List of child nodes that lives in the parse tree's arena.
+typedef std::vector<CValueNode*,CNodeArenaAllocator<CValueNode*> >		CValueNodeList;	// List of child values that lives in the parse tree's arena.
+
+
 } // namespace Carlson
 
 // -----------------------------------------------------------------------------
@@ -0,0 +1,78 @@
+/*
+ *  CNodeArena.cpp
+ *  HyperCompiler
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#include "CNodeArena.h"
+#include "CNode.h"
+
+
+namespace Carlson
+{
+
+void*	CNodeArena::Allocate( size_t inSize )
+{
+	inSize = (inSize +NODE_ARENA_ALIGNMENT -1) & ~((size_t) NODE_ARENA_ALIGNMENT -1);
+
+	if( inSize > (size_t)(mCurrBlockEnd -mCurrBlockPos) )
+	{
+		bool	isBigAllocation = inSize > (NODE_ARENA_BLOCK_SIZE / 4);	// Give these their own block, so we don't waste most of the current one.
+		size_t	blockSize = isBigAllocation ? inSize : NODE_ARENA_BLOCK_SIZE;
+
+		mBlocks.reserve( mBlocks.size() +1 );	// So push_back() below can't throw and leak the block.
+		char*	newBlock = (char*) ::operator new( blockSize );	// Aligned suitably for any type, which covers NODE_ARENA_ALIGNMENT.
+		mBlocks.push_back( newBlock );
+
+		if( isBigAllocation )
+			return newBlock;
+
+		mCurrBlockPos = newBlock;
+		mCurrBlockEnd = newBlock +blockSize;
+	}
+
+	void*	theMemory = mCurrBlockPos;
+	mCurrBlockPos += inSize;
+
+	return theMemory;
+}
+
+
+void	CNodeArena::NodeWasDestructed( CNode* inNode )
+{
+	std::vector<CNode*>::reverse_iterator	itty;
+
+	for( itty = mNodes.rbegin(); itty != mNodes.rend(); itty++ )	// Usually the most recent one.
+	{
+		if( *itty == inNode )
+		{
+			mNodes.erase( (++itty).base() );
+			break;
+		}
+	}
+}
+
+
+void	CNodeArena::ReleaseAll()
+{
+	mReleasing = true;
+
+	std::vector<CNode*>::reverse_iterator	nodeItty;
+	for( nodeItty = mNodes.rbegin(); nodeItty != mNodes.rend(); nodeItty++ )
+		(*nodeItty)->~CNode();
+	mNodes.clear();
+
+	std::vector<char*>::iterator	blockItty;
+	for( blockItty = mBlocks.begin(); blockItty != mBlocks.end(); blockItty++ )
+		::operator delete( *blockItty );
+	mBlocks.clear();
+
+	mCurrBlockPos = NULL;
+	mCurrBlockEnd = NULL;
+	mReleasing = false;
+}
+
+}
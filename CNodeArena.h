@@ -0,0 +1,104 @@
+/*
+ *  CNodeArena.h
+ *  HyperCompiler
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <new>
+
+
+namespace Carlson
+{
+
+class CNode;
+
+
+#define NODE_ARENA_BLOCK_SIZE		(64 * 1024)	// Size of the chunks the arena gets from the system.
+#define NODE_ARENA_ALIGNMENT		16			// Every allocation starts at a multiple of this. Must be a power of two.
+
+
+// Bump allocator for the nodes of one parse tree and the arrays of their
+//	child nodes: Allocating just moves a pointer along a big block, and
+//	nothing is ever freed individually. When the arena goes away, it calls
+//	the destructors of all nodes constructed in it and frees its blocks in
+//	one go. So nodes don't delete each other, and nodes of a half-parsed
+//	script don't leak when the parser throws.
+class CNodeArena
+{
+public:
+	CNodeArena() : mCurrBlockPos(NULL), mCurrBlockEnd(NULL), mReleasing(false) {}
+	~CNodeArena()	{ ReleaseAll(); }
+
+	void*		Allocate( size_t inSize );
+
+	void		NodeWasConstructed( CNode* inNode )	{ mNodes.push_back( inNode ); }	// CNode's constructor calls this, so we can destruct it later.
+	void		NodeWasDestructed( CNode* inNode );	// CNode's destructor calls this when a subclass's constructor threw.
+	bool		IsReleasing() const					{ return mReleasing; }
+	size_t		GetNodeCount() const				{ return mNodes.size(); }
+	CNode*		GetNode( size_t inIndex ) const		{ return mNodes[inIndex]; }	// In order of construction.
+
+	void		ReleaseAll();	// Destructs all nodes and frees all memory.
+
+protected:
+	CNodeArena( const CNodeArena& inOriginal );				// Not copyable, the nodes point at us.
+	CNodeArena&	operator =( const CNodeArena& inOriginal );
+
+protected:
+	char*				mCurrBlockPos;	// Where the next allocation goes.
+	char*				mCurrBlockEnd;	// End of the block mCurrBlockPos points into.
+	std::vector<char*>	mBlocks;		// All blocks we allocated.
+	std::vector<CNode*>	mNodes;			// All nodes constructed in our blocks, in order of construction.
+	bool				mReleasing;		// TRUE while ReleaseAll() is destructing nodes.
+};
+
+
+// STL allocator that gets its memory from a CNodeArena. Used for the lists of
+//	child nodes, so they go away with the nodes without needing any deletes.
+template<class T>
+class CNodeArenaAllocator
+{
+public:
+	typedef T			value_type;
+	typedef T*			pointer;
+	typedef const T*	const_pointer;
+	typedef T&			reference;
+	typedef const T&	const_reference;
+	typedef size_t		size_type;
+	typedef ptrdiff_t	difference_type;
+
+	template<class U> struct rebind	{ typedef CNodeArenaAllocator<U> other; };
+
+	CNodeArenaAllocator( CNodeArena& inArena ) : mArena(&inArena) {}	// Not explicit, so you can initialize a list with just the arena.
+	template<class U> CNodeArenaAllocator( const CNodeArenaAllocator<U>& inOriginal ) : mArena(inOriginal.GetArena()) {}
+
+	pointer			address( reference inValue ) const				{ return &inValue; }
+	const_pointer	address( const_reference inValue ) const		{ return &inValue; }
+
+	pointer			allocate( size_type inCount, const void* = NULL )	{ return (pointer) mArena->Allocate( inCount * sizeof(T) ); }
+	void			deallocate( pointer, size_type )				{}	// Freed along with the arena.
+	size_type		max_size() const								{ return ((size_type) -1) / sizeof(T); }
+
+	void			construct( pointer inPtr, const T& inValue )	{ new( (void*) inPtr ) T( inValue ); }
+	void			destroy( pointer inPtr )						{ inPtr->~T(); }
+
+	CNodeArena*		GetArena() const								{ return mArena; }
+
+protected:
+	CNodeArena*		mArena;
+};
+
+
+template<class T, class U>
+inline bool	operator ==( const CNodeArenaAllocator<T>& a, const CNodeArenaAllocator<U>& b )	{ return a.GetArena() == b.GetArena(); }
+
+template<class T, class U>
+inline bool	operator !=( const CNodeArenaAllocator<T>& a, const CNodeArenaAllocator<U>& b )	{ return a.GetArena() != b.GetArena(); }
+
+}
@@ -10,6 +10,7 @@
 #include "CObjectPropertyNode.h"
 #include "CParseTree.h"
 #include "CCodeBlock.h"
+#include "CParseTreeArchive.h"
 
 
 namespace Carlson
@@ -17,9 +18,9 @@ namespace Carlson
 
 CValueNode*	CObjectPropertyNode::Copy()
 {
-	CObjectPropertyNode	*	nodeCopy = new CObjectPropertyNode( mParseTree, mSymbolName, mLineNum );
+	CObjectPropertyNode	*	nodeCopy = new( mParseTree ) CObjectPropertyNode( mParseTree, mSymbolName, mLineNum );
 	
-	std::vector<CValueNode*>::const_iterator	itty;
+	CValueNodeList::const_iterator	itty;
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
 	{
 		nodeCopy->AddParam( (*itty)->Copy() );
@@ -36,7 +37,7 @@ void	CObjectPropertyNode::DebugPrint( std::ostream& destStream, size_t indentLev
 	destStream << indentChars << "Property \"" << mSymbolName << "\"" << std::endl
 				<< indentChars << "{" << std::endl;
 	
-	std::vector<CValueNode*>::iterator itty;
+	CValueNodeList::iterator itty;
 	
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
 	{
@@ -54,18 +55,20 @@ void	CObjectPropertyNode::AddParam( CValueNode* val )
 }
 
 
-void	CObjectPropertyNode::Simplify()
+CValueNode*	CObjectPropertyNode::Simplify()
 {
-	std::vector<CValueNode*>::iterator itty;
+	CValueNodeList::iterator itty;
 	
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
-		(*itty)->Simplify();
+		(*itty) = (*itty)->Simplify();
+	
+	return this;
 }
 
 
 void	CObjectPropertyNode::GenerateCode( CCodeBlock* inCodeBlock )
 {
-	std::vector<CValueNode*>::reverse_iterator itty;
+	CValueNodeList::reverse_iterator itty;
 	
 	// Push all params on stack (in reverse order!):
 	inCodeBlock->GeneratePushStringInstruction( mSymbolName );
@@ -75,4 +78,13 @@ void	CObjectPropertyNode::GenerateCode( CCodeBlock* inCodeBlock )
 	inCodeBlock->GeneratePushPropertyOfObjectInstruction();
 }
 
+
+void	CObjectPropertyNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	ioWriter.WriteNumber( ENodeKindObjectProperty );
+	ioWriter.WriteString( mSymbolName );
+	ioWriter.WriteNumber( mLineNum );
+	ioWriter.WriteNodes( mParams );
+}
+
 } // namespace Carlson
@@ -23,7 +23,7 @@ class CObjectPropertyNode : public CValueNode
 {
 public:
 	CObjectPropertyNode( CParseTree* inTree, const std::string& inSymbolName, size_t inLineNum )
-		: CValueNode(inTree), mSymbolName(inSymbolName), mLineNum(inLineNum) {};
+		: CValueNode(inTree), mSymbolName(inSymbolName), mParams(GetNodeArena()), mLineNum(inLineNum) {};
 	virtual ~CObjectPropertyNode() {};
 	
 	virtual void		GetSymbolName( std::string& outSymbolName )		{ outSymbolName = mSymbolName; };
@@ -36,12 +36,13 @@ public:
 	
 	virtual void		DebugPrint( std::ostream& destStream, size_t indentLevel );
 
-	virtual void		Simplify();
+	virtual CValueNode*	Simplify();
 	virtual void		GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void		WriteToArchive( CParseTreeWriter& ioWriter );
 
 protected:
 	std::string					mSymbolName;
-	std::vector<CValueNode*>	mParams;
+	CValueNodeList				mParams;
 	size_t						mLineNum;
 };
 
@@ -11,6 +11,11 @@
 #include "CParseTree.h"
 #include "CCodeBlock.h"
 #include "LEOInstructions.h"
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <strings.h>
+#include "CParseTreeArchive.h"
 
 
 namespace Carlson
@@ -23,7 +28,7 @@ void	COperatorNode::DebugPrint( std::ostream& destStream, size_t indentLevel )
 	destStream << indentChars << "Operator Call \"" << gInstructionNames[mInstructionID] << "\"" << std::endl
 				<< indentChars << "{" << std::endl;
 	
-	std::vector<CValueNode*>::iterator itty;
+	CValueNodeList::iterator itty;
 	
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
 	{
@@ -41,29 +46,332 @@ void	COperatorNode::AddParam( CValueNode* val )
 }
 
 
-void	COperatorNode::Simplify()
+CValueNode*	COperatorNode::Simplify()
 {
-	std::vector<CValueNode*>::iterator itty;
+	CValueNodeList::iterator itty;
 	
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
-		(*itty)->Simplify();
+		(*itty) = (*itty)->Simplify();
+	
+	CValueNode*	foldedValue = FoldConstants();
+	return foldedValue ? foldedValue : this;
+}
+
+
+// -----------------------------------------------------------------------------
+//	Constant folding:
+//		What an operator does is up to Leonie, so we only fold where any way
+//		it could convert the operands gives the same result: Integers stay
+//		integers as long as a float holds them exactly, strings only count as
+//		numbers if they're plain integers, and we leave floats that would have
+//		to be turned into strings alone. Errors like division by zero aren't
+//		folded either, so they're still reported when the script runs.
+// -----------------------------------------------------------------------------
+
+#define MAX_EXACT_FLOAT_INTEGER		16777216L	// 2^24, the largest integer a float can hold exactly.
+
+enum
+{
+	EConstantKindInteger,	// Int, or a string that is a plain integer.
+	EConstantKindFloat,
+	EConstantKindBool,
+	EConstantKindString		// A string that is definitely not a number.
+};
+
+struct CConstantOperand
+{
+	int				mKind;
+	long			mInteger;
+	float			mFloat;
+	bool			mBool;
+	std::string		mString;	// What it looks like as a string, unused for floats.
+};
+
+
+static bool	StringIsInteger( const std::string& inString, long& outNumber )
+{
+	size_t		x = (inString.length() > 1 && inString[0] == '-') ? 1 : 0;
+	long		number = 0;
+	if( x >= inString.length() )
+		return false;
+	for( ; x < inString.length(); x++ )
+	{
+		if( inString[x] < '0' || inString[x] > '9' )
+			return false;
+		number = number * 10 +(inString[x] -'0');
+		if( number > MAX_EXACT_FLOAT_INTEGER )
+			return false;
+	}
+	outNumber = (inString[0] == '-') ? -number : number;
+	return true;
+}
+
+
+static bool	StringIsNotANumber( const std::string& inString )
+{
+	std::string		lowercased;
+	for( size_t x = 0; x < inString.length(); x++ )
+	{
+		if( inString[x] >= '0' && inString[x] <= '9' )
+			return false;
+		lowercased.push_back( (char) tolower( inString[x] ) );
+	}
+	return inString.length() > 0 && lowercased.find("inf") == std::string::npos && lowercased.find("nan") == std::string::npos;	// strtod() would take those.
+}
+
+
+static bool	GetConstantOperand( CValueNode* inValue, CConstantOperand& outOperand )
+{
+	if( !inValue->IsConstant() )
+		return false;
+	
+	CIntValueNode*		intValue = dynamic_cast<CIntValueNode*>( inValue );
+	CFloatValueNode*	floatValue = dynamic_cast<CFloatValueNode*>( inValue );
+	CBoolValueNode*		boolValue = dynamic_cast<CBoolValueNode*>( inValue );
+	CStringValueNode*	stringValue = dynamic_cast<CStringValueNode*>( inValue );
+	if( intValue && labs( intValue->GetAsLong() ) <= MAX_EXACT_FLOAT_INTEGER )
+	{
+		outOperand.mKind = EConstantKindInteger;
+		outOperand.mInteger = intValue->GetAsLong();
+		outOperand.mString = intValue->GetAsString();
+	}
+	else if( floatValue )
+	{
+		outOperand.mKind = EConstantKindFloat;
+		outOperand.mFloat = floatValue->GetAsFloat();
+	}
+	else if( boolValue )
+	{
+		outOperand.mKind = EConstantKindBool;
+		outOperand.mBool = boolValue->GetAsBool();
+		outOperand.mString = boolValue->GetAsString();
+	}
+	else if( stringValue )
+	{
+		outOperand.mString = stringValue->GetAsString();
+		if( StringIsInteger( outOperand.mString, outOperand.mInteger ) )
+			outOperand.mKind = EConstantKindInteger;
+		else if( StringIsNotANumber( outOperand.mString ) )
+			outOperand.mKind = EConstantKindString;
+		else
+			return false;	// "1.5", " 2" etc. depend on how Leonie parses numbers.
+	}
+	else
+		return false;
+	
+	return true;
+}
+
+
+static bool	GetConstantBool( const CConstantOperand& inOperand, bool& outBool )
+{
+	if( inOperand.mKind == EConstantKindBool )
+		outBool = inOperand.mBool;
+	else if( inOperand.mKind == EConstantKindString && (inOperand.mString.compare("true") == 0 || inOperand.mString.compare("false") == 0) )
+		outBool = (inOperand.mString.compare("true") == 0);
+	else
+		return false;
+	return true;
+}
+
+
+static bool	IsNumber( const CConstantOperand& inOperand )
+{
+	return inOperand.mKind == EConstantKindInteger || inOperand.mKind == EConstantKindFloat;
+}
+
+
+static double	GetAsDouble( const CConstantOperand& inOperand )
+{
+	return (inOperand.mKind == EConstantKindInteger) ? (double) inOperand.mInteger : (double) inOperand.mFloat;
+}
+
+
+static bool	StringsAreEqualIgnoringCase( const std::string& inFirst, const std::string& inSecond, bool& outEqual )
+{
+	if( inFirst == inSecond )
+	{
+		outEqual = true;
+		return true;
+	}
+	if( inFirst.length() != inSecond.length() )
+	{
+		outEqual = false;	// Case-folding ASCII doesn't change the length.
+		for( size_t x = 0; x < inFirst.length(); x++ )
+			if( inFirst[x] & 0x80 )
+				return false;
+		for( size_t x = 0; x < inSecond.length(); x++ )
+			if( inSecond[x] & 0x80 )
+				return false;
+		return true;
+	}
+	for( size_t x = 0; x < inFirst.length(); x++ )
+	{
+		if( (inFirst[x] & 0x80) || (inSecond[x] & 0x80) )
+			return false;	// Unicode case rules are Leonie's business.
+	}
+	outEqual = strcasecmp( inFirst.c_str(), inSecond.c_str() ) == 0;
+	return true;
+}
+
+
+CValueNode*	COperatorNode::FoldConstants()
+{
+	CConstantOperand	a, b;
+	bool				boolA = false, boolB = false;
+	
+	if( mParams.size() == 1 )
+	{
+		if( !GetConstantOperand( mParams[0], a ) )
+			return NULL;
+		
+		switch( mInstructionID )
+		{
+			case NEGATE_BOOL_INSTR:
+				if( !GetConstantBool( a, boolA ) )
+					return NULL;
+				return new( mParseTree ) CBoolValueNode( mParseTree, !boolA );
+			
+			case NEGATE_NUMBER_INSTR:
+				if( a.mKind == EConstantKindInteger )
+					return new( mParseTree ) CIntValueNode( mParseTree, -a.mInteger );
+				else if( a.mKind == EConstantKindFloat )
+					return new( mParseTree ) CFloatValueNode( mParseTree, -a.mFloat );
+				return NULL;
+		}
+		return NULL;
+	}
+	
+	if( mParams.size() != 2 || !GetConstantOperand( mParams[0], a ) || !GetConstantOperand( mParams[1], b ) )
+		return NULL;
 	
 	switch( mInstructionID )
 	{
-		case CONCATENATE_VALUES_INSTR:
+		case ADD_OPERATOR_INSTR:
+		case SUBTRACT_OPERATOR_INSTR:
+		case MULTIPLY_OPERATOR_INSTR:
+		case DIVIDE_OPERATOR_INSTR:
+		case MODULO_OPERATOR_INSTR:
+		case POWER_OPERATOR_INSTR:
+		{
+			if( !IsNumber(a) || !IsNumber(b) )
+				return NULL;
+			
+			if( a.mKind == EConstantKindInteger && b.mKind == EConstantKindInteger && mInstructionID != DIVIDE_OPERATOR_INSTR )
+			{
+				int64_t		result = 0;
+				if( mInstructionID == ADD_OPERATOR_INSTR )
+					result = (int64_t) a.mInteger +b.mInteger;
+				else if( mInstructionID == SUBTRACT_OPERATOR_INSTR )
+					result = (int64_t) a.mInteger -b.mInteger;
+				else if( mInstructionID == MULTIPLY_OPERATOR_INSTR )
+					result = (int64_t) a.mInteger * b.mInteger;	// Both are at most 2^24, so this can't overflow.
+				else if( mInstructionID == MODULO_OPERATOR_INSTR )
+				{
+					if( b.mInteger == 0 )
+						return NULL;
+					result = a.mInteger % b.mInteger;	// Same as fmod() for integers.
+				}
+				else	// POWER_OPERATOR_INSTR
+				{
+					if( b.mInteger < 0 )
+						return NULL;
+					result = 1;
+					for( long x = 0; x < b.mInteger && result <= MAX_EXACT_FLOAT_INTEGER && result >= -MAX_EXACT_FLOAT_INTEGER; x++ )
+					{
+						result *= a.mInteger;
+						if( result == 0 || result == 1 )
+							break;	// 0 and 1 stay what they are, no need to loop through a huge exponent.
+						if( result == -1 )
+						{
+							result = ((b.mInteger -x -1) % 2 == 0) ? -1 : 1;
+							break;
+						}
+					}
+				}
+				if( result > MAX_EXACT_FLOAT_INTEGER || result < -MAX_EXACT_FLOAT_INTEGER )
+					return NULL;
+				return new( mParseTree ) CIntValueNode( mParseTree, (long) result );
+			}
 			
-			break;
+			if( mInstructionID == MODULO_OPERATOR_INSTR || mInstructionID == POWER_OPERATOR_INSTR )
+				return NULL;	// Whether Leonie truncates or uses the C library, it may round differently than we do.
+			
+			float	numA = (float) GetAsDouble(a), numB = (float) GetAsDouble(b);
+			double	result = 0;	// Rounding a double result to float gives the same as calculating in float for these.
+			if( mInstructionID == ADD_OPERATOR_INSTR )
+				result = (double) numA +(double) numB;
+			else if( mInstructionID == SUBTRACT_OPERATOR_INSTR )
+				result = (double) numA -(double) numB;
+			else if( mInstructionID == MULTIPLY_OPERATOR_INSTR )
+				result = (double) numA * (double) numB;
+			else
+			{
+				if( numB == 0 )
+					return NULL;
+				result = (double) numA / (double) numB;
+			}
+			float	floatResult = (float) result;
+			if( isinf( floatResult ) || isnan( floatResult ) )
+				return NULL;
+			return new( mParseTree ) CFloatValueNode( mParseTree, floatResult );
+		}
+		
+		case LESS_THAN_OPERATOR_INSTR:
+		case LESS_THAN_EQUAL_OPERATOR_INSTR:
+		case GREATER_THAN_OPERATOR_INSTR:
+		case GREATER_THAN_EQUAL_OPERATOR_INSTR:
+		{
+			if( !IsNumber(a) || !IsNumber(b) )
+				return NULL;	// Sort order of strings is Leonie's business.
+			double	numA = GetAsDouble(a), numB = GetAsDouble(b);
+			bool	result = false;
+			if( mInstructionID == LESS_THAN_OPERATOR_INSTR )
+				result = numA < numB;
+			else if( mInstructionID == LESS_THAN_EQUAL_OPERATOR_INSTR )
+				result = numA <= numB;
+			else if( mInstructionID == GREATER_THAN_OPERATOR_INSTR )
+				result = numA > numB;
+			else
+				result = numA >= numB;
+			return new( mParseTree ) CBoolValueNode( mParseTree, result );
+		}
 		
+		case EQUAL_OPERATOR_INSTR:
+		case NOT_EQUAL_OPERATOR_INSTR:
+		{
+			bool	isEqual = false;
+			if( IsNumber(a) && IsNumber(b) )
+				isEqual = GetAsDouble(a) == GetAsDouble(b);
+			else if( a.mKind == EConstantKindBool && b.mKind == EConstantKindBool )
+				isEqual = a.mBool == b.mBool;
+			else if( a.mKind == EConstantKindFloat || b.mKind == EConstantKindFloat )
+				return NULL;	// Would be compared as strings, and we don't know how Leonie formats floats.
+			else if( !StringsAreEqualIgnoringCase( a.mString, b.mString, isEqual ) )
+				return NULL;
+			return new( mParseTree ) CBoolValueNode( mParseTree, (mInstructionID == EQUAL_OPERATOR_INSTR) ? isEqual : !isEqual );
+		}
+		
+		case AND_INSTR:
+		case OR_INSTR:
+			if( !GetConstantBool( a, boolA ) || !GetConstantBool( b, boolB ) )
+				return NULL;
+			return new( mParseTree ) CBoolValueNode( mParseTree, (mInstructionID == AND_INSTR) ? (boolA && boolB) : (boolA || boolB) );
+		
+		case CONCATENATE_VALUES_INSTR:
 		case CONCATENATE_VALUES_WITH_SPACE_INSTR:
-			
-			break;
+			if( a.mKind == EConstantKindFloat || b.mKind == EConstantKindFloat )
+				return NULL;
+			return new( mParseTree ) CStringValueNode( mParseTree, a.mString +((mInstructionID == CONCATENATE_VALUES_WITH_SPACE_INSTR) ? " " : "") +b.mString );
 	}
+	
+	return NULL;
 }
 
 
 void	COperatorNode::GenerateCode( CCodeBlock* inCodeBlock )
 {
-	std::vector<CValueNode*>::iterator itty;
+	CValueNodeList::iterator itty;
 	
 	// Push all params on stack:
 	for( itty = mParams.begin(); itty != mParams.end(); itty++ )
@@ -72,4 +380,13 @@ void	COperatorNode::GenerateCode( CCodeBlock* inCodeBlock )
 	inCodeBlock->GenerateOperatorInstruction( mInstructionID );
 }
 
+
+void	COperatorNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	ioWriter.WriteNumber( ENodeKindOperator );
+	ioWriter.WriteInstructionID( mInstructionID );
+	ioWriter.WriteNumber( mLineNum );
+	ioWriter.WriteNodes( mParams );
+}
+
 } // namespace Carlson
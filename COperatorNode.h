@@ -25,7 +25,7 @@ class COperatorNode : public CValueNode
 {
 public:
 	COperatorNode( CParseTree* inTree, LEOInstructionID inInstructionID, size_t inLineNum )
-		: CValueNode(inTree), mInstructionID(inInstructionID), mLineNum(inLineNum) {};
+		: CValueNode(inTree), mInstructionID(inInstructionID), mParams(GetNodeArena()), mLineNum(inLineNum) {};
 	virtual ~COperatorNode() {};
 	
 	virtual size_t		GetParamCount()									{ return mParams.size(); };
@@ -34,15 +34,19 @@ public:
 	virtual void		AddParam( CValueNode* val );
 	
 	virtual void		DebugPrint( std::ostream& destStream, size_t indentLevel );
-
-	virtual void		Simplify();
+	
+	virtual CValueNode*	Simplify();
 	virtual void		GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void		WriteToArchive( CParseTreeWriter& ioWriter );
 	
 	virtual void		SetInstructionID( LEOInstructionID inID )		{ mInstructionID = inID; };
 
+protected:
+	CValueNode*			FoldConstants();	// Returns the constant this operation will always give, or NULL.
+
 protected:
 	LEOInstructionID			mInstructionID;
-	std::vector<CValueNode*>	mParams;
+	CValueNodeList				mParams;
 	size_t						mLineNum;
 };
 
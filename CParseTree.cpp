@@ -14,13 +14,11 @@ namespace Carlson
 
 CParseTree::~CParseTree()
 {
-	std::deque<CNode*>::iterator itty;
+	mNodeArena.ReleaseAll();	// Before our other members go away, in case a node's destructor needs them.
 	
-	for( itty = mNodes.begin(); itty != mNodes.end(); itty++ )
-	{
-		delete *itty;
-		*itty = NULL;
-	}
+	std::vector<CParseTree*>::iterator	itty;
+	for( itty = mSubTrees.begin(); itty != mSubTrees.end(); itty++ )
+		delete *itty;	// Destructs the nodes they gave us, which still point at us.
 }
 
 
@@ -30,7 +28,7 @@ void	CParseTree::Simplify()
 	
 	for( itty = mNodes.begin(); itty != mNodes.end(); itty++ )
 	{
-		(*itty)->Simplify();
+		(*itty) = (*itty)->Simplify();
 	}
 }
 
@@ -11,9 +11,11 @@
 
 #include "CNode.h"
 #include "CVariableEntry.h"
+#include "CSymbolTable.h"
 #include <deque>
 #include <map>
 #include <string>
+#include <vector>
 
 
 namespace Carlson
@@ -27,9 +29,16 @@ public:
 	virtual ~CParseTree();
 	
 	virtual void		AddNode( CNode* inNode )			{ mNodes.push_back( inNode ); };
+	size_t				GetNodeCount()						{ return mNodes.size(); };
+	CNode*				GetNodeAtIndex( size_t inIndex )	{ return mNodes[inIndex]; };
 	void				NodeWasAdded( CNode* inNode )		{ };
 	
-	std::map<std::string,CVariableEntry>&	GetGlobals()	{ return mGlobals; };
+	CNodeArena&			GetNodeArena()					{ return mNodeArena; };	// Where all nodes of this tree and their child lists are allocated.
+	
+	std::map<CSymbolID,CVariableEntry>&	GetGlobals()	{ return mGlobals; };
+	CSymbolTable&						GetSymbols()	{ return mSymbols; };	// Tokenize into this so identifiers' symbols are valid for this tree.
+	
+	void				AdoptSubTree( CParseTree* inTree )	{ mSubTrees.push_back( inTree ); };	// We delete inTree after our own nodes. Nodes moved to us from it with CNode::MoveToTree() still live in its arena.
 	
 	virtual void		Simplify();
 	virtual void		GenerateCode( CCodeBlock* inCodeBlock );
@@ -37,8 +46,11 @@ public:
 	virtual void		DebugPrint( std::ostream& destStream, size_t indentLevel );
 
 protected:
-	std::deque<CNode*>						mNodes;	// The tree owns any nodes you add and will delete them when it goes out of scope.
-	std::map<std::string,CVariableEntry>	mGlobals;
+	CNodeArena								mNodeArena;	// Owns all nodes of this tree.
+	std::deque<CNode*>						mNodes;		// Top-level nodes, e.g. handlers.
+	std::map<CSymbolID,CVariableEntry>		mGlobals;
+	CSymbolTable							mSymbols;	// Names of all identifiers and variables in this tree.
+	std::vector<CParseTree*>				mSubTrees;	// Trees some of our nodes were parsed into on other threads.
 };
 
 }
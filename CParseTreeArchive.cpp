@@ -0,0 +1,786 @@
+/*
+ *  CParseTreeArchive.cpp
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#include "CParseTreeArchive.h"
+#include "CParseTree.h"
+#include "CBytecodeArchive.h"
+#include "CValueNode.h"
+#include "CCodeBlockNode.h"
+#include "CFunctionDefinitionNode.h"
+#include "CIfNode.h"
+#include "CWhileLoopNode.h"
+#include "CCommandNode.h"
+#include "CAddCommandNode.h"
+#include "CAssignChunkArrayNode.h"
+#include "CAssignCommandNode.h"
+#include "CGetArrayItemCountNode.h"
+#include "CGetArrayItemNode.h"
+#include "CGetParamCommandNode.h"
+#include "CLineMarkerNode.h"
+#include "CPrintCommandNode.h"
+#include "CPushValueCommandNode.h"
+#include "CPutCommandNode.h"
+#include "CReturnCommandNode.h"
+#include "COperatorNode.h"
+#include "CGlobalPropertyNode.h"
+#include "CObjectPropertyNode.h"
+#include "CFunctionCallNode.h"
+#include "CMakeChunkConstNode.h"
+#include "CMakeChunkRefNode.h"
+#include <stdexcept>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+extern "C" {
+#include "LEOInterpreter.h"
+#include "LEOInstructions.h"
+}
+
+
+namespace Carlson
+{
+
+static void	AppendNumber( std::string& ioData, uint64_t inNumber )
+{
+	while( inNumber >= 0x80 )
+	{
+		ioData.push_back( (char)((inNumber & 0x7F) | 0x80) );
+		inNumber >>= 7;
+	}
+	ioData.push_back( (char) inNumber );
+}
+
+
+#pragma mark [Writing]
+
+/*static*/ void	CParseTreeWriter::WriteTree( CParseTree& inTree, std::string& ioData )
+{
+	CParseTreeWriter	writer;
+	writer.mTree = &inTree;
+	
+	writer.WriteVariables( inTree.GetGlobals() );
+	std::string		globalsData;
+	globalsData.swap( writer.mData );
+	
+	// Each handler is written on its own, with its own node numbers:
+	std::string		handlerTable,
+					handlerRecords;
+	for( size_t x = 0; x < inTree.GetNodeCount(); x++ )
+	{
+		CNode*						node = inTree.GetNodeAtIndex( x );
+		CFunctionDefinitionNode*	handler = dynamic_cast<CFunctionDefinitionNode*>( node );
+		writer.mData.clear();
+		writer.mNodeIndexes.clear();
+		writer.mHandlerSymbols.clear();
+		writer.WriteNode( node );
+		
+		size_t		recordOffset = handlerRecords.length();
+		AppendNumber( handlerRecords, writer.mHandlerSymbols.size() );
+		for( std::map<CSymbolID,bool>::iterator currSymbol = writer.mHandlerSymbols.begin(); currSymbol != writer.mHandlerSymbols.end(); currSymbol++ )
+			AppendNumber( handlerRecords, currSymbol->first );
+		handlerRecords.append( writer.mData );
+		
+		writer.mData.clear();
+		writer.WriteString( handler ? handler->GetName() : std::string() );
+		writer.WriteNumber( (handler && handler->GetIsCommand()) ? CParseTreeReader::kParseTreeHandlerIsCommand : 0 );
+		writer.WriteNumber( handler ? handler->GetLineNum() : 0 );
+		writer.WriteNumber( recordOffset );
+		writer.WriteNumber( handlerRecords.length() -recordOffset );
+		handlerTable.append( writer.mData );
+	}
+	
+	// Everything that adds strings is done, so we can look up the last ones and write the tables:
+	std::vector<uint32_t>	symbolTextIndexes;
+	for( std::map<CSymbolID,bool>::iterator currSymbol = writer.mSymbols.begin(); currSymbol != writer.mSymbols.end(); currSymbol++ )
+		symbolTextIndexes.push_back( writer.IndexForString( inTree.GetSymbols().TextForSymbol( currSymbol->first ) ) );
+	std::vector<uint32_t>	instructionNameIndexes;
+	for( size_t x = 0; x < writer.mInstructions.size(); x++ )
+	{
+		uint16_t	instructionID = writer.mInstructions[x];
+		bool		hasUniqueName = instructionID < gNumInstructions && gInstructionNames[instructionID]
+									&& CBytecodeArchive::InstructionIDForName( gInstructionNames[instructionID] ) == instructionID;
+		instructionNameIndexes.push_back( hasUniqueName ? writer.IndexForString( gInstructionNames[instructionID] ) +1 : 0 );	// Without a name, the reader has to trust the ID.
+	}
+	
+	ioData.append( PARSE_TREE_ARCHIVE_MAGIC, 4 );
+	AppendNumber( ioData, PARSE_TREE_ARCHIVE_VERSION );
+	AppendNumber( ioData, writer.mStrings.size() );
+	for( size_t x = 0; x < writer.mStrings.size(); x++ )
+	{
+		AppendNumber( ioData, writer.mStrings[x]->length() );
+		ioData.append( *writer.mStrings[x] );
+	}
+	AppendNumber( ioData, writer.mSymbols.size() );
+	size_t			symbolIndex = 0;
+	for( std::map<CSymbolID,bool>::iterator currSymbol = writer.mSymbols.begin(); currSymbol != writer.mSymbols.end(); currSymbol++ )
+	{
+		AppendNumber( ioData, currSymbol->first );
+		AppendNumber( ioData, symbolTextIndexes[symbolIndex++] );
+	}
+	AppendNumber( ioData, writer.mInstructions.size() );
+	for( size_t x = 0; x < writer.mInstructions.size(); x++ )
+	{
+		AppendNumber( ioData, writer.mInstructions[x] );
+		AppendNumber( ioData, instructionNameIndexes[x] );
+	}
+	ioData.append( globalsData );
+	AppendNumber( ioData, inTree.GetNodeCount() );
+	ioData.append( handlerTable );
+	ioData.append( handlerRecords );
+}
+
+
+/*static*/ void	CParseTreeWriter::WriteTreeToFile( CParseTree& inTree, const char* inFilePath )
+{
+	std::string		data;
+	WriteTree( inTree, data );
+	
+	FILE*	theFile = fopen( inFilePath, "wb" );
+	if( !theFile )
+		throw std::runtime_error( std::string("Couldn't create file \"") +inFilePath +"\"." );
+	bool	success = fwrite( data.data(), 1, data.length(), theFile ) == data.length();
+	success = (fclose( theFile ) == 0) && success;
+	if( !success )
+	{
+		unlink( inFilePath );
+		throw std::runtime_error( std::string("Couldn't write file \"") +inFilePath +"\"." );
+	}
+}
+
+
+void	CParseTreeWriter::WriteNumber( uint64_t inNumber )
+{
+	AppendNumber( mData, inNumber );
+}
+
+
+void	CParseTreeWriter::WriteSignedNumber( int64_t inNumber )
+{
+	WriteNumber( ((uint64_t) inNumber << 1) ^ (uint64_t)(inNumber >> 63) );	// Zig-zag, so small negative numbers stay short.
+}
+
+
+void	CParseTreeWriter::WriteFloat( float inNumber )
+{
+	uint32_t	bits = 0;
+	memcpy( &bits, &inNumber, sizeof(bits) );
+	for( int x = 0; x < 4; x++ )
+		mData.push_back( (char)((bits >> (x * 8)) & 0xFF) );
+}
+
+
+uint32_t	CParseTreeWriter::IndexForString( const std::string& inString )
+{
+	std::map<std::string,uint32_t>::iterator	foundString = mStringIndexes.find( inString );
+	if( foundString == mStringIndexes.end() )
+	{
+		foundString = mStringIndexes.insert( std::make_pair( inString, (uint32_t) mStrings.size() ) ).first;
+		mStrings.push_back( &foundString->first );
+	}
+	return foundString->second;
+}
+
+
+void	CParseTreeWriter::WriteString( const std::string& inString )
+{
+	WriteNumber( IndexForString( inString ) );
+}
+
+
+void	CParseTreeWriter::WriteSymbol( CSymbolID inSymbol )
+{
+	if( inSymbol >= mTree->GetSymbols().size() )
+		throw std::logic_error( "Can't archive a node whose symbol isn't in its parse tree." );
+	mSymbols[inSymbol] = true;
+	mHandlerSymbols[inSymbol] = true;
+	WriteNumber( inSymbol );
+}
+
+
+void	CParseTreeWriter::WriteInstructionID( uint16_t inInstructionID )
+{
+	std::map<uint16_t,uint32_t>::iterator	foundInstruction = mInstructionIndexes.find( inInstructionID );
+	if( foundInstruction == mInstructionIndexes.end() )
+	{
+		foundInstruction = mInstructionIndexes.insert( std::make_pair( inInstructionID, (uint32_t) mInstructions.size() ) ).first;
+		mInstructions.push_back( inInstructionID );
+	}
+	WriteNumber( foundInstruction->second );
+}
+
+
+void	CParseTreeWriter::RegisterNode( CNode* inNode )
+{
+	uint32_t	nodeIndex = (uint32_t) mNodeIndexes.size();
+	mNodeIndexes[inNode] = nodeIndex;
+}
+
+
+void	CParseTreeWriter::WriteNode( CNode* inNode )
+{
+	if( !inNode )
+		throw std::logic_error( "Can't archive a parse tree with a missing node." );
+	if( ++mDepth > PARSE_TREE_ARCHIVE_MAX_DEPTH )
+		throw std::logic_error( "Parse tree is nested too deeply to archive." );
+	RegisterNode( inNode );	// Before its children, like the reader does.
+	inNode->WriteToArchive( *this );
+	mDepth--;
+}
+
+
+void	CParseTreeWriter::WriteNodeReference( CNode* inNode )
+{
+	std::map<CNode*,uint32_t>::iterator	foundNode = mNodeIndexes.find( inNode );
+	if( foundNode == mNodeIndexes.end() )
+		throw std::logic_error( "Can't archive a node that refers to a node that comes after it or is in another handler." );
+	WriteNumber( foundNode->second );
+}
+
+
+void	CParseTreeWriter::WriteVariables( std::map<CSymbolID,CVariableEntry>& inVariables )
+{
+	WriteNumber( inVariables.size() );
+	for( std::map<CSymbolID,CVariableEntry>::iterator itty = inVariables.begin(); itty != inVariables.end(); itty++ )
+	{
+		CVariableEntry&	var = itty->second;
+		WriteSymbol( itty->first );
+		WriteNumber( (var.mInitWithName ? 1 : 0) | (var.mIsParameter ? 2 : 0) | (var.mIsGlobal ? 4 : 0) | (var.mDontDispose ? 8 : 0) );
+		WriteString( var.mRealName );
+		WriteNumber( (uint32_t) var.mVariableType );
+		WriteBool( var.mBPRelativeOffset != LONG_MAX );
+		if( var.mBPRelativeOffset != LONG_MAX )
+			WriteSignedNumber( var.mBPRelativeOffset );
+	}
+}
+
+
+#pragma mark -
+#pragma mark [Reading]
+
+CParseTreeReader::CParseTreeReader( const char* inData, size_t inDataLength )
+	: mData((const uint8_t*) inData), mDataLength(inDataLength), mOffset(0), mEnd(inDataLength), mIsMapped(false), mTree(NULL), mDepth(0)
+{
+	ReadTables();
+}
+
+
+CParseTreeReader::CParseTreeReader( const char* inFilePath )
+	: mData(NULL), mDataLength(0), mOffset(0), mEnd(0), mIsMapped(false), mTree(NULL), mDepth(0)
+{
+	int		fd = open( inFilePath, O_RDONLY );
+	if( fd < 0 )
+		throw std::runtime_error( std::string("Couldn't open file \"") +inFilePath +"\"." );
+	
+	struct stat		fileInfo;
+	void*			fileContents = MAP_FAILED;
+	if( fstat( fd, &fileInfo ) == 0 && fileInfo.st_size > 0 )
+		fileContents = mmap( NULL, (size_t) fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );	// The mapping stays valid without the descriptor.
+	if( fileContents == MAP_FAILED )
+		throw std::runtime_error( std::string("Couldn't read file \"") +inFilePath +"\"." );
+	mData = (const uint8_t*) fileContents;
+	mDataLength = mEnd = (size_t) fileInfo.st_size;
+	mIsMapped = true;
+	
+	try
+	{
+		ReadTables();
+	}
+	catch( ... )
+	{
+		munmap( (void*) mData, mDataLength );
+		throw;
+	}
+}
+
+
+CParseTreeReader::~CParseTreeReader()
+{
+	if( mIsMapped )
+		munmap( (void*) mData, mDataLength );
+}
+
+
+void	CParseTreeReader::ReadTables()
+{
+	if( mDataLength < 4 || memcmp( mData, PARSE_TREE_ARCHIVE_MAGIC, 4 ) != 0 )
+		throw std::runtime_error( "Not a parse tree archive." );
+	mOffset = 4;
+	if( ReadNumber() != PARSE_TREE_ARCHIVE_VERSION )
+		throw std::runtime_error( "Parse tree archive was written by a different version of Forge." );
+	
+	mStrings.resize( ReadCount() );
+	for( size_t x = 0; x < mStrings.size(); x++ )
+	{
+		size_t	len = ReadCount();
+		if( len > mEnd -mOffset )
+			throw std::runtime_error( "Parse tree archive is damaged." );
+		mStrings[x].assign( (const char*) mData +mOffset, len );
+		mOffset += len;
+	}
+	
+	size_t		numSymbols = ReadCount();
+	for( size_t x = 0; x < numSymbols; x++ )
+	{
+		uint64_t	symbol = ReadNumber();
+		uint64_t	textIndex = ReadNumber();
+		if( symbol >= kNoSymbol || textIndex >= mStrings.size() )
+			throw std::runtime_error( "Parse tree archive is damaged." );
+		mSymbolTexts[(CSymbolID)symbol] = (uint32_t) textIndex;
+	}
+	
+	size_t		numInstructions = ReadCount();
+	for( size_t x = 0; x < numInstructions; x++ )
+	{
+		uint64_t	instructionID = ReadNumber();
+		uint64_t	nameIndex = ReadNumber();
+		if( instructionID > 0xFFFF || nameIndex > mStrings.size() )
+			throw std::runtime_error( "Parse tree archive is damaged." );
+		if( nameIndex == 0 )
+			mInstructionIDs[x] = (uint16_t) instructionID;
+		else
+		{
+			size_t	hostInstructionID = CBytecodeArchive::InstructionIDForName( mStrings[nameIndex -1].c_str() );
+			if( hostInstructionID < gNumInstructions )
+				mInstructionIDs[x] = (uint16_t) hostInstructionID;
+			else
+				mMissingInstructions[x] = (uint32_t) nameIndex -1;	// Only an error if a handler we load uses it.
+		}
+	}
+	
+	mGlobalsOffset = mOffset;
+	size_t		numGlobals = ReadCount();
+	for( size_t x = 0; x < numGlobals; x++ )
+	{
+		ReadNumber();	// Symbol.
+		ReadNumber();	// Flags.
+		ReadNumber();	// Real name.
+		ReadNumber();	// Type.
+		if( ReadBool() )
+			ReadNumber();	// Slot.
+	}
+	
+	mHandlers.resize( ReadCount() );
+	for( size_t x = 0; x < mHandlers.size(); x++ )
+	{
+		uint64_t	nameIndex = ReadNumber();
+		if( nameIndex >= mStrings.size() )
+			throw std::runtime_error( "Parse tree archive is damaged." );
+		mHandlers[x].mNameIndex = (uint32_t) nameIndex;
+		mHandlers[x].mFlags = (uint32_t) ReadNumber();
+		mHandlers[x].mLineNum = (size_t) ReadNumber();
+		mHandlers[x].mOffset = (size_t) ReadNumber();
+		mHandlers[x].mLength = (size_t) ReadNumber();
+	}
+	size_t		recordsStart = mOffset;
+	for( size_t x = 0; x < mHandlers.size(); x++ )
+	{
+		if( mHandlers[x].mOffset > mDataLength -recordsStart || mHandlers[x].mLength > mDataLength -recordsStart -mHandlers[x].mOffset )
+			throw std::runtime_error( "Parse tree archive is damaged." );
+		mHandlers[x].mOffset += recordsStart;
+	}
+}
+
+
+uint64_t	CParseTreeReader::ReadNumber()
+{
+	uint64_t	number = 0;
+	for( int shift = 0; shift < 64; shift += 7 )
+	{
+		if( mOffset >= mEnd )
+			throw std::runtime_error( "Parse tree archive is damaged." );
+		uint8_t		currByte = mData[mOffset++];
+		number |= (uint64_t)(currByte & 0x7F) << shift;
+		if( (currByte & 0x80) == 0 )
+			return number;
+	}
+	throw std::runtime_error( "Parse tree archive is damaged." );
+}
+
+
+int64_t	CParseTreeReader::ReadSignedNumber()
+{
+	uint64_t	number = ReadNumber();
+	return (int64_t)(number >> 1) ^ -(int64_t)(number & 1);
+}
+
+
+float	CParseTreeReader::ReadFloat()
+{
+	if( mEnd -mOffset < 4 )
+		throw std::runtime_error( "Parse tree archive is damaged." );
+	uint32_t	bits = (uint32_t)mData[mOffset] | ((uint32_t)mData[mOffset +1] << 8) | ((uint32_t)mData[mOffset +2] << 16) | ((uint32_t)mData[mOffset +3] << 24);
+	mOffset += 4;
+	float		number = 0;
+	memcpy( &number, &bits, sizeof(number) );
+	return number;
+}
+
+
+size_t	CParseTreeReader::ReadCount()
+{
+	uint64_t	count = ReadNumber();
+	if( count > mEnd -mOffset )
+		throw std::runtime_error( "Parse tree archive is damaged." );
+	return (size_t) count;
+}
+
+
+const std::string&	CParseTreeReader::ReadString()
+{
+	uint64_t	stringIndex = ReadNumber();
+	if( stringIndex >= mStrings.size() )
+		throw std::runtime_error( "Parse tree archive is damaged." );
+	return mStrings[stringIndex];
+}
+
+
+// Interns the symbol in the tree we're reading into the first time we see it:
+CSymbolID	CParseTreeReader::SymbolInTree( CSymbolID inWrittenSymbol )
+{
+	std::map<CSymbolID,CSymbolID>::iterator	foundSymbol = mSymbolMap.find( inWrittenSymbol );
+	if( foundSymbol != mSymbolMap.end() )
+		return foundSymbol->second;
+	
+	std::map<CSymbolID,uint32_t>::iterator	foundText = mSymbolTexts.find( inWrittenSymbol );
+	if( foundText == mSymbolTexts.end() )
+		throw std::runtime_error( "Parse tree archive is damaged." );
+	CSymbolID	symbol = mTree->GetSymbols().SymbolForString( mStrings[foundText->second] );
+	mSymbolMap[inWrittenSymbol] = symbol;
+	return symbol;
+}
+
+
+CSymbolID	CParseTreeReader::ReadSymbol()
+{
+	uint64_t	symbol = ReadNumber();
+	if( symbol >= kNoSymbol )
+		throw std::runtime_error( "Parse tree archive is damaged." );
+	return SymbolInTree( (CSymbolID) symbol );
+}
+
+
+uint16_t	CParseTreeReader::ReadInstructionID()
+{
+	uint64_t	instructionIndex = ReadNumber();
+	std::map<uint64_t,uint16_t>::iterator	foundInstruction = mInstructionIDs.find( instructionIndex );
+	if( foundInstruction != mInstructionIDs.end() )
+		return foundInstruction->second;
+	
+	std::map<uint64_t,uint32_t>::iterator	missingInstruction = mMissingInstructions.find( instructionIndex );
+	if( missingInstruction != mMissingInstructions.end() )
+		throw std::runtime_error( std::string("Parse tree needs the instruction \"") +mStrings[missingInstruction->second] +"\", which hasn't been registered." );
+	throw std::runtime_error( "Parse tree archive is damaged." );
+}
+
+
+void	CParseTreeReader::ReadVariables( std::map<CSymbolID,CVariableEntry>& outVariables )
+{
+	size_t		numVariables = ReadCount();
+	for( size_t x = 0; x < numVariables; x++ )
+	{
+		CSymbolID			symbol = ReadSymbol();
+		uint64_t			flags = ReadNumber();
+		const std::string&	realName = ReadString();
+		TVariantType		type = (TVariantType) ReadNumber();
+		CVariableEntry		var( realName, type, (flags & 1) != 0, (flags & 2) != 0, (flags & 4) != 0, (flags & 8) != 0 );
+		if( ReadBool() )
+			var.mBPRelativeOffset = (long) ReadSignedNumber();
+		outVariables[symbol] = var;
+	}
+}
+
+
+CCodeBlockNodeBase*	CParseTreeReader::ReadBlockReference()
+{
+	uint64_t	nodeIndex = ReadNumber();
+	if( nodeIndex >= mBlocks.size() || mBlocks[nodeIndex] == NULL )
+		throw std::runtime_error( "Parse tree archive is damaged." );
+	return mBlocks[nodeIndex];
+}
+
+
+void	CParseTreeReader::RegisterNode( CCodeBlockNodeBase* inBlock )
+{
+	mBlocks.push_back( inBlock );
+}
+
+
+void	CParseTreeReader::ReadBlockContents( CCodeBlockNodeBase* inBlock )
+{
+	size_t		numCommands = ReadCount();
+	for( size_t x = 0; x < numCommands; x++ )
+		inBlock->AddCommand( ReadNode( ENodeKindIntValue, ENodeKind_Sentinel ) );
+}
+
+
+void	CParseTreeReader::ReadParams( CNode* inNode, int inKind )
+{
+	size_t		numParams = ReadCount();
+	for( size_t x = 0; x < numParams; x++ )
+	{
+		CValueNode*	param = ReadValueNode();
+		if( inKind == ENodeKindOperator )
+			((COperatorNode*)inNode)->AddParam( param );
+		else if( inKind == ENodeKindGlobalProperty )
+			((CGlobalPropertyNode*)inNode)->AddParam( param );
+		else if( inKind == ENodeKindObjectProperty )
+			((CObjectPropertyNode*)inNode)->AddParam( param );
+		else if( inKind >= ENodeKindFunctionCall && inKind <= ENodeKindMakeChunkRef )
+			((CFunctionCallNode*)inNode)->AddParam( param );
+		else
+			((CCommandNode*)inNode)->AddParam( param );
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//	ReadNode:
+//		Creates each node from the fields its WriteToArchive() wrote. Nodes
+//		are numbered before their children are read, like the writer does.
+// -----------------------------------------------------------------------------
+
+CNode*	CParseTreeReader::ReadNode( int inFirstKind, int inEndKind )
+{
+	uint64_t	kind = ReadNumber();
+	if( kind < (uint64_t) inFirstKind || kind >= (uint64_t) inEndKind || ++mDepth > PARSE_TREE_ARCHIVE_MAX_DEPTH )
+		throw std::runtime_error( "Parse tree archive is damaged." );
+	
+	CNode*		node = NULL;
+	switch( kind )
+	{
+		case ENodeKindIntValue:
+			node = new( mTree ) CIntValueNode( mTree, (long) ReadSignedNumber() );
+			RegisterNode();
+			break;
+		
+		case ENodeKindFloatValue:
+			node = new( mTree ) CFloatValueNode( mTree, ReadFloat() );
+			RegisterNode();
+			break;
+		
+		case ENodeKindBoolValue:
+			node = new( mTree ) CBoolValueNode( mTree, ReadBool() );
+			RegisterNode();
+			break;
+		
+		case ENodeKindStringValue:
+			node = new( mTree ) CStringValueNode( mTree, ReadString() );
+			RegisterNode();
+			break;
+		
+		case ENodeKindLocalVariableRef:
+		{
+			CCodeBlockNodeBase*	block = ReadBlockReference();
+			CSymbolID			varName = ReadSymbol();
+			node = new( mTree ) CLocalVariableRefValueNode( mTree, block, varName, ReadString() );
+			RegisterNode();
+			break;
+		}
+		
+		case ENodeKindOperator:
+		{
+			uint16_t	instructionID = ReadInstructionID();
+			node = new( mTree ) COperatorNode( mTree, instructionID, (size_t) ReadNumber() );
+			RegisterNode();
+			ReadParams( node, (int) kind );
+			break;
+		}
+		
+		case ENodeKindGlobalProperty:
+		{
+			uint16_t	setterID = ReadInstructionID();
+			uint16_t	getterID = ReadInstructionID();
+			node = new( mTree ) CGlobalPropertyNode( mTree, setterID, getterID, (size_t) ReadNumber() );
+			RegisterNode();
+			ReadParams( node, (int) kind );
+			break;
+		}
+		
+		case ENodeKindObjectProperty:
+		{
+			const std::string&	symbolName = ReadString();
+			node = new( mTree ) CObjectPropertyNode( mTree, symbolName, (size_t) ReadNumber() );
+			RegisterNode();
+			ReadParams( node, (int) kind );
+			break;
+		}
+		
+		case ENodeKindFunctionCall:
+		case ENodeKindMakeChunkConst:
+		case ENodeKindMakeChunkRef:
+		{
+			bool				isCommand = ReadBool();
+			const std::string&	symbolName = ReadString();
+			size_t				lineNum = (size_t) ReadNumber();
+			CFunctionCallNode*	callNode = NULL;
+			if( kind == ENodeKindMakeChunkConst )
+				callNode = new( mTree ) CMakeChunkConstNode( mTree, lineNum );
+			else if( kind == ENodeKindMakeChunkRef )
+				callNode = new( mTree ) CMakeChunkRefNode( mTree, lineNum );
+			else
+				callNode = new( mTree ) CFunctionCallNode( mTree, isCommand, symbolName, lineNum );
+			callNode->SetIsMessagePassing( ReadBool() );
+			node = callNode;
+			RegisterNode();
+			ReadParams( node, (int) kind );
+			break;
+		}
+		
+		case ENodeKindCommand:
+		case ENodeKindAddCommand:
+		case ENodeKindAssignChunkArray:
+		case ENodeKindAssignCommand:
+		case ENodeKindGetArrayItemCount:
+		case ENodeKindGetArrayItem:
+		case ENodeKindGetParamCommand:
+		case ENodeKindLineMarker:
+		case ENodeKindPrintCommand:
+		case ENodeKindPushValueCommand:
+		case ENodeKindPutCommand:
+		case ENodeKindReturnCommand:
+		{
+			const std::string&	symbolName = ReadString();
+			size_t				lineNum = (size_t) ReadNumber();
+			switch( kind )
+			{
+				case ENodeKindAddCommand:			node = new( mTree ) CAddCommandNode( mTree, lineNum );			break;
+				case ENodeKindAssignChunkArray:		node = new( mTree ) CAssignChunkArrayNode( mTree, lineNum );	break;
+				case ENodeKindAssignCommand:		node = new( mTree ) CAssignCommandNode( mTree, lineNum );		break;
+				case ENodeKindGetArrayItemCount:	node = new( mTree ) CGetArrayItemCountNode( mTree, lineNum );	break;
+				case ENodeKindGetArrayItem:			node = new( mTree ) CGetArrayItemNode( mTree, lineNum );		break;
+				case ENodeKindGetParamCommand:		node = new( mTree ) CGetParamCommandNode( mTree, lineNum );		break;
+				case ENodeKindLineMarker:			node = new( mTree ) CLineMarkerNode( mTree, lineNum );			break;
+				case ENodeKindPrintCommand:			node = new( mTree ) CPrintCommandNode( mTree, lineNum );		break;
+				case ENodeKindPushValueCommand:		node = new( mTree ) CPushValueCommandNode( mTree, lineNum );	break;
+				case ENodeKindPutCommand:			node = new( mTree ) CPutCommandNode( mTree, lineNum );			break;
+				case ENodeKindReturnCommand:		node = new( mTree ) CReturnCommandNode( mTree, lineNum );		break;
+				default:							node = new( mTree ) CCommandNode( mTree, symbolName, lineNum );	break;
+			}
+			RegisterNode();
+			ReadParams( node, (int) kind );
+			break;
+		}
+		
+		case ENodeKindCodeBlock:
+		{
+			CCodeBlockNodeBase*	owningBlock = ReadBlockReference();
+			CCodeBlockNode*		block = new( mTree ) CCodeBlockNode( mTree, (size_t) ReadNumber(), owningBlock );
+			node = block;
+			RegisterNode( block );
+			ReadBlockContents( block );
+			break;
+		}
+		
+		case ENodeKindIf:
+		{
+			CCodeBlockNodeBase*	owningBlock = ReadBlockReference();
+			CIfNode*			ifNode = new( mTree ) CIfNode( mTree, (size_t) ReadNumber(), owningBlock );
+			node = ifNode;
+			RegisterNode( ifNode );
+			ifNode->SetCondition( ReadValueNode() );
+			ReadBlockContents( ifNode );
+			if( ReadBool() )
+			{
+				CCodeBlockNode*	elseBlock = ifNode->CreateElseBlock( (size_t) ReadNumber() );
+				RegisterNode( elseBlock );
+				ReadBlockContents( elseBlock );
+			}
+			break;
+		}
+		
+		case ENodeKindWhileLoop:
+		{
+			CCodeBlockNodeBase*	owningBlock = ReadBlockReference();
+			CWhileLoopNode*		loopNode = new( mTree ) CWhileLoopNode( mTree, (size_t) ReadNumber(), owningBlock );
+			node = loopNode;
+			RegisterNode( loopNode );
+			loopNode->SetCondition( ReadValueNode() );
+			ReadBlockContents( loopNode );
+			break;
+		}
+		
+		case ENodeKindFunctionDefinition:
+		{
+			bool						isCommand = ReadBool();
+			const std::string&			handlerName = ReadString();
+			size_t						lineNum = (size_t) ReadNumber();
+			CFunctionDefinitionNode*	handler = new( mTree ) CFunctionDefinitionNode( mTree, isCommand, handlerName, lineNum );
+			handler->SetEndLineNum( (size_t) ReadNumber() );
+			node = handler;
+			RegisterNode( handler );
+			ReadVariables( handler->GetLocals() );	// Before the body, whose variable references would add them with default settings.
+			ReadVariables( handler->GetGlobals() );
+			handler->GetLocalVariableCount() = (size_t) ReadNumber();
+			ReadBlockContents( handler );
+			break;
+		}
+	}
+	
+	mDepth--;
+	return node;
+}
+
+
+void	CParseTreeReader::StartReadingInto( CParseTree& ioTree )
+{
+	if( mTree != &ioTree )
+	{
+		mTree = &ioTree;
+		mSymbolMap.clear();
+	}
+}
+
+
+void	CParseTreeReader::ReadHandler( size_t inIndex, CParseTree& ioTree )
+{
+	StartReadingInto( ioTree );
+	
+	CHandlerEntry&	handler = mHandlers.at( inIndex );
+	mOffset = handler.mOffset;
+	mEnd = handler.mOffset +handler.mLength;
+	mBlocks.clear();
+	mDepth = 0;
+	
+	try
+	{
+		size_t		numSymbols = ReadCount();	// Intern in the order the parser did, so variables get the same slots.
+		for( size_t x = 0; x < numSymbols; x++ )
+			ReadSymbol();
+		
+		ioTree.AddNode( ReadNode( ENodeKindFunctionDefinition, ENodeKind_Sentinel ) );
+	}
+	catch( ... )
+	{
+		mEnd = mDataLength;
+		throw;	// The nodes we made so far are still in the tree's arena, which deletes them with the tree.
+	}
+	mEnd = mDataLength;
+}
+
+
+void	CParseTreeReader::ReadTree( CParseTree& ioTree )
+{
+	StartReadingInto( ioTree );
+	
+	for( std::map<CSymbolID,uint32_t>::iterator currSymbol = mSymbolTexts.begin(); currSymbol != mSymbolTexts.end(); currSymbol++ )
+		SymbolInTree( currSymbol->first );	// All of them, in the order the parser interned them.
+	
+	mOffset = mGlobalsOffset;
+	ReadVariables( ioTree.GetGlobals() );
+	
+	for( size_t x = 0; x < mHandlers.size(); x++ )
+		ReadHandler( x, ioTree );
+}
+
+}
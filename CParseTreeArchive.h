@@ -0,0 +1,221 @@
+/*
+ *  CParseTreeArchive.h
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#pragma once
+
+#include "CSymbolTable.h"
+#include "CVariableEntry.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+
+namespace Carlson
+{
+
+class CNode;
+class CValueNode;
+class CCodeBlockNodeBase;
+class CParseTree;
+
+
+#define PARSE_TREE_ARCHIVE_MAGIC		"FGPT"
+#define PARSE_TREE_ARCHIVE_VERSION		1		// Bump whenever the layout below or what a node writes changes.
+#define PARSE_TREE_ARCHIVE_MAX_DEPTH	4000	// Deeper trees aren't archived, so damaged files can't recurse us off the stack.
+
+
+// What kind of node follows in an archive. Values go first, then commands,
+//	then code blocks, so the reader can check what it gets with a range:
+enum
+{
+	ENodeKindNone = 0,			// Never written, so zeroed data isn't mistaken for a node.
+	ENodeKindIntValue,
+	ENodeKindFloatValue,
+	ENodeKindBoolValue,
+	ENodeKindStringValue,
+	ENodeKindLocalVariableRef,
+	ENodeKindOperator,
+	ENodeKindGlobalProperty,
+	ENodeKindObjectProperty,
+	ENodeKindFunctionCall,
+	ENodeKindMakeChunkConst,
+	ENodeKindMakeChunkRef,
+	ENodeKindCommand,			// First command.
+	ENodeKindAddCommand,
+	ENodeKindAssignChunkArray,
+	ENodeKindAssignCommand,
+	ENodeKindGetArrayItemCount,
+	ENodeKindGetArrayItem,
+	ENodeKindGetParamCommand,
+	ENodeKindLineMarker,
+	ENodeKindPrintCommand,
+	ENodeKindPushValueCommand,
+	ENodeKindPutCommand,
+	ENodeKindReturnCommand,
+	ENodeKindCodeBlock,			// First code block.
+	ENodeKindIf,
+	ENodeKindWhileLoop,
+	ENodeKindFunctionDefinition,
+	ENodeKind_Sentinel
+};
+
+
+// Flattens a CParseTree into bytes, so tools can keep trees around without
+//	tokenizing and parsing the script again. Each node writes its own fields
+//	in WriteToArchive(), CParseTreeReader::ReadNode() must read them in the
+//	same order.
+//	Numbers are variable-length: 7 bits per byte, low bits first, high bit
+//	set on all but the last byte. Signed numbers are zig-zag encoded first.
+//	Strings, symbols and instructions are written as indexes into tables at
+//	the start of the file, and nodes that refer to other nodes (variables to
+//	their code block) use the index of that node in its handler. Each handler
+//	is a separate record the table of contents points to, so one of them can
+//	be read without reading the others.
+//
+//	Layout:
+//		char[4]		PARSE_TREE_ARCHIVE_MAGIC
+//		number		PARSE_TREE_ARCHIVE_VERSION
+//		number		number of strings, then for each its length and UTF8 bytes
+//		number		number of symbols, then for each (ascending by symbol ID):
+//			number		symbol ID when written
+//			number		string index of its text
+//		number		number of instructions, then for each:
+//			number		instruction ID when written
+//			number		string index of its name +1, 0 if it had no unique name
+//		variables	the tree's globals
+//		number		number of handlers, then for each:
+//			number		string index of the name
+//			number		flags (kParseTreeHandlerIsCommand)
+//			number		line number
+//			number		offset of its record from the end of this table
+//			number		length of its record
+//		handler records, each:
+//			number		number of symbols it uses, then each symbol ID
+//						ascending, so loading one handler can intern them
+//						in the same order the parser did
+//			node		the CFunctionDefinitionNode
+//	where variables are a count, then for each: symbol, flags, real name,
+//	type, whether it has a slot and the slot as a signed number. A node is
+//	its kind and then whatever it writes.
+class CParseTreeWriter
+{
+public:
+	CParseTreeWriter() : mTree(NULL), mDepth(0) {};
+	
+	static void	WriteTree( CParseTree& inTree, std::string& ioData );	// Throws std::logic_error if a node can't be archived.
+	static void	WriteTreeToFile( CParseTree& inTree, const char* inFilePath );
+	
+	// For the nodes' WriteToArchive():
+	void		WriteNumber( uint64_t inNumber );
+	void		WriteSignedNumber( int64_t inNumber );
+	void		WriteFloat( float inNumber );
+	void		WriteBool( bool inState )				{ WriteNumber( inState ? 1 : 0 ); };
+	void		WriteString( const std::string& inString );
+	void		WriteSymbol( CSymbolID inSymbol );
+	void		WriteInstructionID( uint16_t inInstructionID );
+	void		WriteNode( CNode* inNode );				// Writes its kind and contents. Parse trees have no NULL nodes, so neither may archives.
+	void		WriteNodeReference( CNode* inNode );	// inNode must have been written (or registered) already.
+	void		RegisterNode( CNode* inNode );			// For nodes whose owner writes them itself instead of calling WriteNode(), so they can be referenced.
+	template<class L>
+	void		WriteNodes( L& inNodes )
+	{
+		WriteNumber( inNodes.size() );
+		for( typename L::iterator itty = inNodes.begin(); itty != inNodes.end(); itty++ )
+			WriteNode( *itty );
+	}
+	void		WriteVariables( std::map<CSymbolID,CVariableEntry>& inVariables );
+
+protected:
+	uint32_t	IndexForString( const std::string& inString );
+
+protected:
+	CParseTree*							mTree;
+	std::string							mData;			// Contents of the current handler record.
+	std::map<std::string,uint32_t>		mStringIndexes;
+	std::vector<const std::string*>		mStrings;		// In order of their indexes. Point into mStringIndexes' keys.
+	std::map<CSymbolID,bool>			mSymbols;		// All symbols we wrote.
+	std::map<CSymbolID,bool>			mHandlerSymbols;	// Symbols the current handler uses.
+	std::map<uint16_t,uint32_t>			mInstructionIndexes;
+	std::vector<uint16_t>				mInstructions;
+	std::map<CNode*,uint32_t>			mNodeIndexes;	// Nodes of the current handler.
+	size_t								mDepth;
+};
+
+
+// Reads trees written by CParseTreeWriter, either all of them or just the
+//	handlers you ask for. Only the tables at the start are read up front:
+class CParseTreeReader
+{
+public:
+	CParseTreeReader( const char* inData, size_t inDataLength );	// Data must stay valid as long as the reader. Throws std::runtime_error if it's not a parse tree archive.
+	explicit CParseTreeReader( const char* inFilePath );	// Maps the file.
+	~CParseTreeReader();
+	
+	size_t				GetNumHandlers() const							{ return mHandlers.size(); };
+	const std::string&	GetHandlerName( size_t inIndex ) const			{ return mStrings[mHandlers[inIndex].mNameIndex]; };
+	bool				GetHandlerIsCommand( size_t inIndex ) const		{ return (mHandlers[inIndex].mFlags & kParseTreeHandlerIsCommand) != 0; };
+	size_t				GetHandlerLineNum( size_t inIndex ) const		{ return mHandlers[inIndex].mLineNum; };
+	
+	void				ReadHandler( size_t inIndex, CParseTree& ioTree );	// Adds the handler to ioTree.
+	void				ReadTree( CParseTree& ioTree );	// Adds the globals and all handlers to ioTree.
+	
+	enum
+	{
+		kParseTreeHandlerIsCommand	= (1 << 0)
+	};
+
+protected:
+	struct CHandlerEntry
+	{
+		uint32_t	mNameIndex;
+		uint32_t	mFlags;
+		size_t		mLineNum;
+		size_t		mOffset;
+		size_t		mLength;
+	};
+	
+	void				ReadTables();
+	void				StartReadingInto( CParseTree& ioTree );
+	uint64_t			ReadNumber();
+	int64_t				ReadSignedNumber();
+	float				ReadFloat();
+	bool				ReadBool()			{ return ReadNumber() != 0; };
+	size_t				ReadCount();		// A number no bigger than the bytes left, so damaged counts can't make us allocate gigabytes.
+	const std::string&	ReadString();
+	CSymbolID			ReadSymbol();
+	uint16_t			ReadInstructionID();
+	CNode*				ReadNode( int inFirstKind, int inEndKind );	// Throws if the node's kind isn't in this range.
+	CValueNode*			ReadValueNode()		{ return (CValueNode*) ReadNode( ENodeKindIntValue, ENodeKindCommand ); };
+	CCodeBlockNodeBase*	ReadBlockReference();
+	void				ReadBlockContents( CCodeBlockNodeBase* inBlock );
+	void				ReadParams( CNode* inNode, int inKind );
+	void				ReadVariables( std::map<CSymbolID,CVariableEntry>& outVariables );
+	CSymbolID			SymbolInTree( CSymbolID inWrittenSymbol );
+	void				RegisterNode( CCodeBlockNodeBase* inBlock = NULL );	// Numbers the next node, pass it if it's a code block.
+
+protected:
+	const uint8_t*						mData;
+	size_t								mDataLength;
+	size_t								mOffset;
+	size_t								mEnd;				// Don't read past this, the end of the current handler record.
+	bool								mIsMapped;
+	std::vector<std::string>			mStrings;
+	std::map<CSymbolID,uint32_t>		mSymbolTexts;		// Symbol ID when written -> string index.
+	std::map<uint64_t,uint16_t>			mInstructionIDs;	// Index in the instruction table -> ID in this host.
+	std::map<uint64_t,uint32_t>			mMissingInstructions;	// Index -> string index of the name of an instruction this host doesn't have.
+	size_t								mGlobalsOffset;
+	std::vector<CHandlerEntry>			mHandlers;
+	CParseTree*							mTree;				// Tree we're reading into.
+	std::map<CSymbolID,CSymbolID>		mSymbolMap;			// Symbol ID when written -> symbol in mTree.
+	std::vector<CCodeBlockNodeBase*>	mBlocks;			// Nodes of the current handler by index, NULL for nodes that aren't code blocks.
+	size_t								mDepth;
+};
+
+}
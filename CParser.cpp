@@ -47,6 +47,10 @@ extern "C" {
 #include <string>
 #include <fstream>
 #include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <pthread.h>
+#include <unistd.h>
 
 
 using namespace Carlson;
@@ -63,7 +67,6 @@ namespace Carlson
 {
 
 // Static ivars:
-int										CVariableEntry::mTempCounterSeed = 0;	// Counter we use for generating unique temp variable names.
 std::map<std::string,CObjCMethodEntry>	CParser::sObjCMethodTable;				// Table of ObjC method signature -> types mappings for calling Cocoa.
 std::map<std::string,CObjCMethodEntry>	CParser::sCFunctionTable;				// Table of C function name -> types mappings for calling native system calls.
 std::map<std::string,CObjCMethodEntry>	CParser::sCFunctionPointerTable;		// Table of C function pointer type name -> types mappings for generating callback trampolines.
@@ -76,7 +79,7 @@ std::map<std::string,int>				CParser::sConstantToValueTable;			// Table of C sys
 // Operator token(s), precedence and instruction function name:
 static TOperatorEntry	sOperators[] =
 {
-	{ EAndIdentifier, ELastIdentifier_Sentinel, 100, AND_INSTR, EAndIdentifier },
+	{ EAndIdentifier, ELastIdentifier_Sentinel, 150, AND_INSTR, EAndIdentifier },
 	{ EOrIdentifier, ELastIdentifier_Sentinel, 100, OR_INSTR, EOrIdentifier },
 	{ ELessThanOperator, EGreaterThanOperator, 200, NOT_EQUAL_OPERATOR_INSTR, ENotEqualPseudoOperator },
 	{ ELessThanOperator, EEqualsOperator, 200, LESS_THAN_EQUAL_OPERATOR_INSTR, ELessThanEqualPseudoOperator },
@@ -114,11 +117,315 @@ static TGlobalPropertyEntry	sDefaultGlobalProperties[] =
 	{ ELastIdentifier_Sentinel, INVALID_INSTR }
 };
 
-static TGlobalPropertyEntry*	sGlobalProperties = NULL;
 
-static THostCommandEntry*		sHostCommands = NULL;
+#pragma mark [Host registries]
+// Helpers for the registries of global properties, host commands and host
+//	functions in CCompilerContext, which are indexed by the identifier that
+//	introduces each entry.
+
+static void	OffsetInstructions( TGlobalPropertyEntry& ioEntry, size_t firstInstruction )
+{
+	ioEntry.mSetterInstructionID += firstInstruction;
+	ioEntry.mGetterInstructionID += firstInstruction;
+}
+
+
+static void	OffsetInstructions( THostCommandEntry& ioEntry, size_t firstInstruction )
+{
+	ioEntry.mInstructionID += firstInstruction;
+	for( size_t y = 0; ioEntry.mParam[y].mType != EHostParam_Sentinel; y++ )
+	{
+		if( ioEntry.mParam[y].mInstructionID == INVALID_INSTR2 )
+			ioEntry.mParam[y].mInstructionID = INVALID_INSTR;
+		else
+			ioEntry.mParam[y].mInstructionID += firstInstruction;
+	}
+}
+
+
+// Add a sentinel-terminated list of entries to one of the registries above.
+//	If inReplaceExisting is TRUE, any entries that were registered for the
+//	same identifiers before are removed first:
+template<class TEntry>
+static void	AddEntriesToRegistry( std::vector<TEntry>* ioRegistry, const TEntry* inEntries, size_t firstInstruction, bool inReplaceExisting )
+{
+	for( size_t x = 0; inEntries[x].mType != ELastIdentifier_Sentinel; x++ )
+	{
+		if( inEntries[x].mType > ELastIdentifier_Sentinel )
+			throw std::logic_error( "Host entries must be introduced by a built-in identifier." );
+	}
+	
+	if( inReplaceExisting )
+	{
+		for( size_t x = 0; inEntries[x].mType != ELastIdentifier_Sentinel; x++ )
+			ioRegistry[inEntries[x].mType].clear();
+	}
+	
+	for( size_t x = 0; inEntries[x].mType != ELastIdentifier_Sentinel; x++ )
+	{
+		TEntry		newEntry = inEntries[x];
+		OffsetInstructions( newEntry, firstInstruction );
+		ioRegistry[newEntry.mType].push_back( newEntry );
+	}
+}
+
+
+#pragma mark -
+#pragma mark [Compiler context]
+
+// -----------------------------------------------------------------------------
+//	* CONSTRUCTOR:
+// -----------------------------------------------------------------------------
+
+CCompilerContext::CCompilerContext()
+	: mGeneration(0)
+{
+	for( size_t x = 0; sDefaultGlobalProperties[x].mType != ELastIdentifier_Sentinel; x++ )
+		mGlobalProperties[sDefaultGlobalProperties[x].mType].push_back( sDefaultGlobalProperties[x] );
+	for( size_t x = 0; x <= ELastIdentifier_Sentinel; x++ )
+		mStatementParsers[x] = NULL;
+	mLastErrorMessage[0] = 0;
+}
+
+
+// -----------------------------------------------------------------------------
+//	GetDefault:
+//		The context of parsers nobody gave one. Function-local, so hosts can
+//		register their entries from static initializers.
+// -----------------------------------------------------------------------------
+
+/*static*/ CCompilerContext&	CCompilerContext::GetDefault()
+{
+	static CCompilerContext		sDefaultContext;
+	
+	return sDefaultContext;
+}
+
+static CCompilerContext&	sDefaultContextAtStartup = CCompilerContext::GetDefault();	// So threads never race to construct it.
+
+
+const TGlobalPropertyEntry*	CCompilerContext::GlobalPropertyForType( TIdentifierSubtype inType ) const
+{
+	const TGlobalPropertyList&	candidates = mGlobalProperties[inType];
+	
+	return candidates.empty() ? NULL : &candidates.front();
+}
+
+
+void	CCompilerContext::SetLastErrorMessage( const char* inMessage )
+{
+	strncpy( mLastErrorMessage, inMessage, sizeof(mLastErrorMessage) -1 );
+	mLastErrorMessage[sizeof(mLastErrorMessage) -1] = 0;
+}
+
+
+// -----------------------------------------------------------------------------
+//	SetStatementParser:
+//		Make parsers using this context call inParser for lines that start
+//		with the given identifier (or one of its synonyms), instead of the
+//		built-in parser or treating it as a host command. Pass NULL to go back
+//		to the default.
+// -----------------------------------------------------------------------------
+
+void	CCompilerContext::SetStatementParser( TIdentifierSubtype inType, TStatementParserProc inParser )
+{
+	if( inType >= ELastIdentifier_Sentinel )
+		throw std::logic_error( "Can only register statement parsers for built-in identifiers." );
+	
+	mStatementParsers[inType] = inParser;
+	mGeneration++;
+}
+
+
+// -----------------------------------------------------------------------------
+//	AddGlobalProperties:
+//		Add additional global properties to the ones the parser understands.
+// -----------------------------------------------------------------------------
+
+void	CCompilerContext::AddGlobalPropertiesAndOffsetInstructions( const TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction )
+{
+	AddEntriesToRegistry( mGlobalProperties, inEntries, firstGlobalPropertyInstruction, false );
+	mGeneration++;
+}
+
+
+// -----------------------------------------------------------------------------
+//	ReplaceGlobalProperties:
+//		Like AddGlobalProperties, but first removes any global properties
+//		already registered for the identifiers in inEntries.
+// -----------------------------------------------------------------------------
+
+void	CCompilerContext::ReplaceGlobalPropertiesAndOffsetInstructions( const TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction )
+{
+	AddEntriesToRegistry( mGlobalProperties, inEntries, firstGlobalPropertyInstruction, true );
+	mGeneration++;
+}
+
+
+// -----------------------------------------------------------------------------
+//	RemoveGlobalProperty:
+//		Remove all global properties registered for the given identifier.
+// -----------------------------------------------------------------------------
+
+void	CCompilerContext::RemoveGlobalProperty( TIdentifierSubtype inType )
+{
+	if( inType < ELastIdentifier_Sentinel )
+		mGlobalProperties[inType].clear();
+	mGeneration++;
+}
+
+
+// -----------------------------------------------------------------------------
+//	AddHostCommands:
+//		Add additional commands to the ones the parser understands.
+// -----------------------------------------------------------------------------
+
+void	CCompilerContext::AddHostCommandsAndOffsetInstructions( const THostCommandEntry* inEntries, size_t firstHostCommandInstruction )
+{
+	AddEntriesToRegistry( mHostCommands, inEntries, firstHostCommandInstruction, false );
+	mGeneration++;
+}
+
+
+// -----------------------------------------------------------------------------
+//	ReplaceHostCommands:
+//		Like AddHostCommands, but first removes any commands already
+//		registered for the identifiers in inEntries.
+// -----------------------------------------------------------------------------
+
+void	CCompilerContext::ReplaceHostCommandsAndOffsetInstructions( const THostCommandEntry* inEntries, size_t firstHostCommandInstruction )
+{
+	AddEntriesToRegistry( mHostCommands, inEntries, firstHostCommandInstruction, true );
+	mGeneration++;
+}
+
+
+// -----------------------------------------------------------------------------
+//	RemoveHostCommand:
+//		Remove all commands registered for the given identifier.
+// -----------------------------------------------------------------------------
+
+void	CCompilerContext::RemoveHostCommand( TIdentifierSubtype inType )
+{
+	if( inType < ELastIdentifier_Sentinel )
+		mHostCommands[inType].clear();
+	mGeneration++;
+}
+
+
+// -----------------------------------------------------------------------------
+//	AddHostFunctions:
+//		Add additional functions to the ones the parser understands.
+// -----------------------------------------------------------------------------
+
+void	CCompilerContext::AddHostFunctionsAndOffsetInstructions( const THostCommandEntry* inEntries, size_t firstHostCommandInstruction )
+{
+	AddEntriesToRegistry( mHostFunctions, inEntries, firstHostCommandInstruction, false );
+	mGeneration++;
+}
+
+
+// -----------------------------------------------------------------------------
+//	ReplaceHostFunctions:
+//		Like AddHostFunctions, but first removes any functions already
+//		registered for the identifiers in inEntries.
+// -----------------------------------------------------------------------------
+
+void	CCompilerContext::ReplaceHostFunctionsAndOffsetInstructions( const THostCommandEntry* inEntries, size_t firstHostCommandInstruction )
+{
+	AddEntriesToRegistry( mHostFunctions, inEntries, firstHostCommandInstruction, true );
+	mGeneration++;
+}
 
-static THostCommandEntry*		sHostFunctions = NULL;
+
+// -----------------------------------------------------------------------------
+//	RemoveHostFunction:
+//		Remove all functions registered for the given identifier.
+// -----------------------------------------------------------------------------
+
+void	CCompilerContext::RemoveHostFunction( TIdentifierSubtype inType )
+{
+	if( inType < ELastIdentifier_Sentinel )
+		mHostFunctions[inType].clear();
+	mGeneration++;
+}
+
+
+#pragma mark -
+#pragma mark [Statement lookup table]
+// First identifier of a line -> member function that parses the statement it starts:
+static TBuiltInStatementEntry	sBuiltInStatements[] =
+{
+	{ EPutIdentifier, &CParser::ParsePutStatement },
+	{ EDeleteIdentifier, &CParser::ParseDeleteStatement },
+	{ EReturnIdentifier, &CParser::ParseReturnStatement },
+	{ EPassIdentifier, &CParser::ParsePassStatement },
+	{ EExitIdentifier, &CParser::ParseExitStatement },
+	{ ENextIdentifier, &CParser::ParseNextStatement },
+	{ ERepeatIdentifier, &CParser::ParseRepeatStatement },
+	{ EIfIdentifier, &CParser::ParseIfStatement },
+	{ EAddIdentifier, &CParser::ParseAddStatement },
+	{ ESubtractIdentifier, &CParser::ParseSubtractStatement },
+	{ EMultiplyIdentifier, &CParser::ParseMultiplyStatement },
+	{ EDivideIdentifier, &CParser::ParseDivideStatement },
+	{ EGetIdentifier, &CParser::ParseGetStatement },
+	{ ESetIdentifier, &CParser::ParseSetStatement },
+	{ EGlobalIdentifier, &CParser::ParseGlobalStatement },
+	{ ELastIdentifier_Sentinel, NULL }
+};
+
+// sBuiltInStatements, indexed by the (synonym-resolved) TIdentifierSubtype,
+//	so ParseOneLine() can find the parser for a line with one look-up. Parsers
+//	in the CCompilerContext come first, anything without an entry in either is
+//	parsed as a host command.
+static TStatementParserEntry	sStatementParsers[ELastIdentifier_Sentinel +1];
+
+// sOperators, indexed by the (synonym-resolved) TIdentifierSubtype of the
+//	operator's first token:
+static TOperatorLookupEntry		sOperatorLookup[ELastIdentifier_Sentinel +1];
+
+static bool						sLookupTablesBuilt = false;
+
+
+static bool	BuildLookupTables()
+{
+	if( sLookupTablesBuilt )
+		return true;
+	
+	for( size_t x = 0; sBuiltInStatements[x].mType != ELastIdentifier_Sentinel; x++ )
+		sStatementParsers[sBuiltInStatements[x].mType].mParser = sBuiltInStatements[x].mParser;
+	
+	for( size_t x = 0; x <= ELastIdentifier_Sentinel; x++ )
+	{
+		for( size_t y = 0; y < MAX_OPERATOR_FOLLOWERS; y++ )
+			sOperatorLookup[x].mFollowers[y].mSecondType = ELastIdentifier_Sentinel;
+	}
+	for( size_t x = 0; sOperators[x].mType != ELastIdentifier_Sentinel; x++ )
+	{
+		TOperatorLookupEntry&	entry = sOperatorLookup[sOperators[x].mType];
+		if( sOperators[x].mSecondType == ELastIdentifier_Sentinel )
+		{
+			entry.mPrecedence = sOperators[x].mPrecedence;
+			entry.mInstructionID = sOperators[x].mInstructionID;
+			continue;
+		}
+		
+		size_t		y = 0;
+		while( y < MAX_OPERATOR_FOLLOWERS && entry.mFollowers[y].mSecondType != ELastIdentifier_Sentinel )
+			y++;
+		if( y >= MAX_OPERATOR_FOLLOWERS )
+			throw std::logic_error( "Too many two-token operators start with the same identifier. Increase MAX_OPERATOR_FOLLOWERS." );
+		entry.mFollowers[y].mSecondType = sOperators[x].mSecondType;
+		entry.mFollowers[y].mPrecedence = sOperators[x].mPrecedence;
+		entry.mFollowers[y].mInstructionID = sOperators[x].mInstructionID;
+	}
+	
+	sLookupTablesBuilt = true;
+	
+	return true;
+}
+
+static bool	sLookupTablesBuiltAtStartup = BuildLookupTables();	// So parsers on several threads never race to build them.
 
 
 #pragma mark [Chunk type lookup table]
@@ -138,48 +445,48 @@ static TChunkTypeEntry	sChunkTypes[] =
 // Constant identifier and actual code to generate the value:
 struct TConstantEntry	sConstants[] =
 {
-	{ { ETrueIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, new CBoolValueNode( NULL, true ) },
-	{ { EFalseIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, new CBoolValueNode( NULL, false ) },
-	{ { EEmptyIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("") ) },
-	{ { ECommaIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string(",") ) },
-	{ { EColonIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string(":") ) },
-	{ { ECrIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("\r") ) },
-	{ { ELineFeedIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("\n") ) },
-	{ { ENullIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("\0") ) },
-	{ { EQuoteIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("\"") ) },
-	{ { EReturnIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("\r") ) },
-	{ { ENewlineIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("\n") ) },
-	{ { ESpaceIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string(" ") ) },
-	{ { ETabIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("\t") ) },
-	{ { EPiIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, new CFloatValueNode( NULL, (float) M_PI ) },
-	{ { EBarnIdentifier, EDoorIdentifier, EOpenIdentifier }, new CStringValueNode( NULL, std::string("barn door open") ) },
-	{ { EBarnIdentifier, EDoorIdentifier, ECloseIdentifier }, new CStringValueNode( NULL, std::string("barn door close") ) },
-	{ { EIrisIdentifier, EOpenIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("iris open") ) },
-	{ { EIrisIdentifier, ECloseIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("iris close") ) },
-	{ { EPushIdentifier, EUpIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("push up") ) },
-	{ { EPushIdentifier, EDownIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("push down") ) },
-	{ { EPushIdentifier, ELeftIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("push left") ) },
-	{ { EPushIdentifier, ERightIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("push right") ) },
-	{ { EScrollIdentifier, EUpIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("scroll up") ) },
-	{ { EScrollIdentifier, EDownIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("scroll down") ) },
-	{ { EScrollIdentifier, ELeftIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("scroll left") ) },
-	{ { EScrollIdentifier, ERightIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("scroll right") ) },
-	{ { EShrinkIdentifier, EToIdentifier, ETopIdentifier }, new CStringValueNode( NULL, std::string("shrink to top") ) },
-	{ { EShrinkIdentifier, EToIdentifier, ECenterIdentifier }, new CStringValueNode( NULL, std::string("shrink to center") ) },
-	{ { EShrinkIdentifier, EToIdentifier, EBottomIdentifier }, new CStringValueNode( NULL, std::string("shrink to bottom") ) },
-	{ { EStretchIdentifier, EFromIdentifier, ETopIdentifier }, new CStringValueNode( NULL, std::string("stretch from top") ) },
-	{ { EStretchIdentifier, EFromIdentifier, ECenterIdentifier }, new CStringValueNode( NULL, std::string("stretch from center") ) },
-	{ { EStretchIdentifier, EFromIdentifier, EBottomIdentifier }, new CStringValueNode( NULL, std::string("stretch from bottom") ) },
-	{ { EVenetianIdentifier, EBlindsIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("venetian blinds") ) },
-	{ { EWipeIdentifier, EUpIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("wipe up") ) },
-	{ { EWipeIdentifier, EDownIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("wipe down") ) },
-	{ { EWipeIdentifier, ELeftIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("wipe left") ) },
-	{ { EWipeIdentifier, ERightIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("wipe right") ) },
-	{ { EZoomIdentifier, ECloseIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("zoom close") ) },
-	{ { EZoomIdentifier, EInIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("zoom in") ) },
-	{ { EZoomIdentifier, EOpenIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("zoom open") ) },
-	{ { EZoomIdentifier, EOutIdentifier, ELastIdentifier_Sentinel }, new CStringValueNode( NULL, std::string("zoom out") ) },
-	{ { ELastIdentifier_Sentinel, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, NULL }
+	{ { ETrueIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, TVariantTypeBool, NULL, 1 },
+	{ { EFalseIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, TVariantTypeBool, NULL, 0 },
+	{ { EEmptyIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, TVariantTypeString, "", 0 },
+	{ { ECommaIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, TVariantTypeString, ",", 0 },
+	{ { EColonIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, TVariantTypeString, ":", 0 },
+	{ { ECrIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, TVariantTypeString, "\r", 0 },
+	{ { ELineFeedIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, TVariantTypeString, "\n", 0 },
+	{ { ENullIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, TVariantTypeString, "\0", 0 },
+	{ { EQuoteIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, TVariantTypeString, "\"", 0 },
+	{ { EReturnIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, TVariantTypeString, "\r", 0 },
+	{ { ENewlineIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, TVariantTypeString, "\n", 0 },
+	{ { ESpaceIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, TVariantTypeString, " ", 0 },
+	{ { ETabIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, TVariantTypeString, "\t", 0 },
+	{ { EPiIdentifier, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, TVariantTypeFloat, NULL, (float) M_PI },
+	{ { EBarnIdentifier, EDoorIdentifier, EOpenIdentifier }, TVariantTypeString, "barn door open", 0 },
+	{ { EBarnIdentifier, EDoorIdentifier, ECloseIdentifier }, TVariantTypeString, "barn door close", 0 },
+	{ { EIrisIdentifier, EOpenIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "iris open", 0 },
+	{ { EIrisIdentifier, ECloseIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "iris close", 0 },
+	{ { EPushIdentifier, EUpIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "push up", 0 },
+	{ { EPushIdentifier, EDownIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "push down", 0 },
+	{ { EPushIdentifier, ELeftIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "push left", 0 },
+	{ { EPushIdentifier, ERightIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "push right", 0 },
+	{ { EScrollIdentifier, EUpIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "scroll up", 0 },
+	{ { EScrollIdentifier, EDownIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "scroll down", 0 },
+	{ { EScrollIdentifier, ELeftIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "scroll left", 0 },
+	{ { EScrollIdentifier, ERightIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "scroll right", 0 },
+	{ { EShrinkIdentifier, EToIdentifier, ETopIdentifier }, TVariantTypeString, "shrink to top", 0 },
+	{ { EShrinkIdentifier, EToIdentifier, ECenterIdentifier }, TVariantTypeString, "shrink to center", 0 },
+	{ { EShrinkIdentifier, EToIdentifier, EBottomIdentifier }, TVariantTypeString, "shrink to bottom", 0 },
+	{ { EStretchIdentifier, EFromIdentifier, ETopIdentifier }, TVariantTypeString, "stretch from top", 0 },
+	{ { EStretchIdentifier, EFromIdentifier, ECenterIdentifier }, TVariantTypeString, "stretch from center", 0 },
+	{ { EStretchIdentifier, EFromIdentifier, EBottomIdentifier }, TVariantTypeString, "stretch from bottom", 0 },
+	{ { EVenetianIdentifier, EBlindsIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "venetian blinds", 0 },
+	{ { EWipeIdentifier, EUpIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "wipe up", 0 },
+	{ { EWipeIdentifier, EDownIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "wipe down", 0 },
+	{ { EWipeIdentifier, ELeftIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "wipe left", 0 },
+	{ { EWipeIdentifier, ERightIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "wipe right", 0 },
+	{ { EZoomIdentifier, ECloseIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "zoom close", 0 },
+	{ { EZoomIdentifier, EInIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "zoom in", 0 },
+	{ { EZoomIdentifier, EOpenIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "zoom open", 0 },
+	{ { EZoomIdentifier, EOutIdentifier, ELastIdentifier_Sentinel }, TVariantTypeString, "zoom out", 0 },
+	{ { ELastIdentifier_Sentinel, ELastIdentifier_Sentinel, ELastIdentifier_Sentinel }, TVariantTypeNotSet, NULL, 0 }
 };
 
 #pragma mark [ObjC -> Variant mapping table]
@@ -275,13 +582,15 @@ void	PrintStringStream( std::stringstream& sstr )
 
 // -----------------------------------------------------------------------------
 //	GetNewTempName:
-//		Generate a unique name for a temp variable.
+//		Generate a name for a temp variable that is unique in the current
+//		handler. Numbering starts over for each handler, so a handler comes
+//		out the same no matter what was parsed before it, or on which thread.
 // -----------------------------------------------------------------------------
 
-const std::string CVariableEntry::GetNewTempName()
+std::string	CParser::GetNewTempName()
 {
 	char tempName[40];
-	snprintf( tempName, 40, "temp%d", mTempCounterSeed++ );
+	snprintf( tempName, 40, "temp%d", mTempCounter++ );
 	
 	return std::string( tempName );
 }
@@ -291,191 +600,490 @@ const std::string CVariableEntry::GetNewTempName()
 //	* CONSTRUCTOR:
 // -----------------------------------------------------------------------------
 
-CParser::CParser()
-	: mUsesObjCCall(false)
+CParser::CParser( CCompilerContext* inContext )
+	: mUsesObjCCall(false), mThrowOnError(true), mTempCounter(0), mContext(inContext)
 {
-	if( !sGlobalProperties )
-		sGlobalProperties = sDefaultGlobalProperties;
+	if( !mContext )
+		mContext = &CCompilerContext::GetDefault();
+	if( !sLookupTablesBuilt )	// Called from another static initializer?
+		BuildLookupTables();
 }
 
 
 // -----------------------------------------------------------------------------
-//	AddGlobalProperties:
-//		Add additional global properties to the ones the parser understands.
+//	ReportError:
+//		All syntax errors go through here. Either throws them, or remembers
+//		the first one so the caller can return and let the parse unwind.
+//		Parse functions must check HadError() after anything that can fail.
 // -----------------------------------------------------------------------------
 
-/*static*/ void	CParser::AddGlobalPropertiesAndOffsetInstructions( TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction )
+void	CParser::ReportError( const CParseError& inError )
 {
-	if( !sGlobalProperties )
-		sGlobalProperties = sDefaultGlobalProperties;
-	
-	size_t		numOldEntries = 0,
-				numNewEntries = 0;
-	
-	for( size_t x = 0; sGlobalProperties[x].mType != ELastIdentifier_Sentinel; x++ )
-		numOldEntries++;
-	for( size_t x = 0; inEntries[x].mType != ELastIdentifier_Sentinel; x++ )
-		numNewEntries++;
-	
-	TGlobalPropertyEntry*	newTable = NULL;
-	if( sGlobalProperties == sDefaultGlobalProperties )
+	if( mThrowOnError )
 	{
-		newTable = (TGlobalPropertyEntry*) calloc( numOldEntries +numNewEntries +1, sizeof(TGlobalPropertyEntry) );
-		if( !newTable )
-			throw std::runtime_error( "Couldn't resize list of global properties." );
-		memmove( newTable, sGlobalProperties, numOldEntries *sizeof(TGlobalPropertyEntry) );
-		memmove( newTable +numOldEntries, inEntries, (numNewEntries +1) *sizeof(TGlobalPropertyEntry) );
-	}
-	else
-	{
-		newTable = (TGlobalPropertyEntry*) realloc( sGlobalProperties, (numOldEntries +numNewEntries +1) * sizeof(TGlobalPropertyEntry) );
-		if( !newTable )
-			throw std::runtime_error( "Couldn't resize list of global properties." );
-		memmove( newTable +numOldEntries, inEntries, (numNewEntries +1) *sizeof(TGlobalPropertyEntry) );
+		std::string		errMsg( inError.GetMessage() );
+		mMessages.push_back( CMessageEntry( errMsg, mFileName, inError.GetLineNum() ) );
+		throw std::runtime_error( errMsg );
 	}
 	
-	// Fix up instruction IDs to account for the ones that were already there:
-	for( size_t x = numOldEntries; newTable[x].mType != ELastIdentifier_Sentinel; x++ )
+	if( !mError.IsSet() )	// Later errors are usually fallout from the first one.
+		mError = inError;
+}
+
+
+bool	CParser::GoNextToken( CTokenCursor& tokenItty, CTokenList& tokens )
+{
+	if( tokenItty == tokens.end() )
 	{
-		newTable[x].mSetterInstructionID += firstGlobalPropertyInstruction;
-		newTable[x].mGetterInstructionID += firstGlobalPropertyInstruction;
+		ReportError( CParseError( mFileName, tokenItty->mLineNum, "Premature end of file.", *tokenItty ) );
+		return false;
 	}
 	
-	sGlobalProperties = newTable;
+	++tokenItty;
+	
+	return true;
 }
 
 
-// -----------------------------------------------------------------------------
-//	AddHostCommands:
-//		Add additional commands to the ones the parser understands.
-// -----------------------------------------------------------------------------
+bool	CParser::ExpectIdentifier( CTokenCursor& tokenItty, TIdentifierSubtype subType, TIdentifierSubtype precedingIdent )
+{
+	if( tokenItty->IsIdentifier( subType ) )
+		return true;
+	
+	std::string		precedingText;
+	if( precedingIdent != ELastIdentifier_Sentinel )
+		precedingText.append( gIdentifierStrings[precedingIdent] ).append( 1, ' ' );
+	ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"%s%i\" here, found \"%s%t\".", *tokenItty, subType, precedingText ) );
+	
+	return false;
+}
 
-/*static*/ void	CParser::AddHostCommandsAndOffsetInstructions( THostCommandEntry* inEntries, size_t firstHostCommandInstruction )
+
+bool	CParser::ExpectIdentifierToken( CTokenCursor& tokenItty )
 {
-	size_t		numOldEntries = 0,
-				numNewEntries = 0;
+	if( tokenItty->mType == EIdentifierToken )
+		return true;
 	
-	if( sHostCommands )
-	{
-		for( size_t x = 0; sHostCommands[x].mType != ELastIdentifier_Sentinel; x++ )
-			numOldEntries++;
-	}
-	for( size_t x = 0; inEntries[x].mType != ELastIdentifier_Sentinel; x++ )
-	{
-		numNewEntries++;
-	}
+	ReportError( CParseError( NULL, tokenItty->mLineNum, "Expected identifier here.", *tokenItty ) );
 	
-	THostCommandEntry*	newTable = NULL;
-	if( sHostCommands == NULL )
-	{
-		newTable = (THostCommandEntry*) calloc( numOldEntries +numNewEntries +1, sizeof(THostCommandEntry) );
-		if( !newTable )
-			throw std::runtime_error( "Couldn't resize list of host commands." );
-		memmove( newTable, inEntries, (numNewEntries +1) *sizeof(THostCommandEntry) );
-	}
-	else
+	return false;
+}
+
+
+std::string	CParseError::GetMessage() const
+{
+	std::string		msg;
+	
+	if( mFileName )
 	{
-		newTable = (THostCommandEntry*) realloc( sHostCommands, (numOldEntries +numNewEntries +1) * sizeof(THostCommandEntry) );
-		if( !newTable )
-			throw std::runtime_error( "Couldn't resize list of host commands." );
-		memmove( newTable +numOldEntries, inEntries, (numNewEntries +1) *sizeof(THostCommandEntry) );
+		char		lineNumStr[32];
+		sprintf( lineNumStr, ":%lu: error: ", (unsigned long) mLineNum );
+		msg.append( mFileName ).append( lineNumStr );
 	}
 	
-	// Fix up instruction IDs to account for the ones that were already there:
-	for( size_t x = numOldEntries; newTable[x].mType != ELastIdentifier_Sentinel; x++ )
+	for( const char* currCh = mFormat; currCh && *currCh != 0; currCh++ )
 	{
-		newTable[x].mInstructionID += firstHostCommandInstruction;
-		for( size_t y = 0; newTable[x].mParam[y].mType != EHostParam_Sentinel; y++ )
+		if( currCh[0] == '%' && currCh[1] == 't' )
+			msg.append( mFoundToken.GetShortDescription() );
+		else if( currCh[0] == '%' && currCh[1] == 'i' )
+			msg.append( gIdentifierStrings[mIdentifier] );
+		else if( currCh[0] == '%' && currCh[1] == 's' )
+			msg.append( mDetail );
+		else
 		{
-			if( newTable[x].mParam[y].mInstructionID == INVALID_INSTR2 )
-				newTable[x].mParam[y].mInstructionID = INVALID_INSTR;
-			else
-				newTable[x].mParam[y].mInstructionID += firstHostCommandInstruction;
+			msg.append( 1, *currCh );
+			continue;
 		}
+		currCh++;	// Skip the letter after the '%'.
 	}
 	
-	sHostCommands = newTable;
+	return msg;
 }
 
 
 // -----------------------------------------------------------------------------
-//	AddHostCommands:
-//		Add additional commands to the ones the parser understands.
+//	Static registration functions:
+//		For hosts that only compile on one thread. These change the default
+//		CCompilerContext, see there.
 // -----------------------------------------------------------------------------
 
+/*static*/ void	CParser::SetStatementParser( TIdentifierSubtype inType, TStatementParserProc inParser )
+{
+	CCompilerContext::GetDefault().SetStatementParser( inType, inParser );
+}
+
+
+/*static*/ void	CParser::AddGlobalPropertiesAndOffsetInstructions( TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction )
+{
+	CCompilerContext::GetDefault().AddGlobalPropertiesAndOffsetInstructions( inEntries, firstGlobalPropertyInstruction );
+}
+
+
+/*static*/ void	CParser::ReplaceGlobalPropertiesAndOffsetInstructions( TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction )
+{
+	CCompilerContext::GetDefault().ReplaceGlobalPropertiesAndOffsetInstructions( inEntries, firstGlobalPropertyInstruction );
+}
+
+
+/*static*/ void	CParser::RemoveGlobalProperty( TIdentifierSubtype inType )
+{
+	CCompilerContext::GetDefault().RemoveGlobalProperty( inType );
+}
+
+
+/*static*/ void	CParser::AddHostCommandsAndOffsetInstructions( THostCommandEntry* inEntries, size_t firstHostCommandInstruction )
+{
+	CCompilerContext::GetDefault().AddHostCommandsAndOffsetInstructions( inEntries, firstHostCommandInstruction );
+}
+
+
+/*static*/ void	CParser::ReplaceHostCommandsAndOffsetInstructions( THostCommandEntry* inEntries, size_t firstHostCommandInstruction )
+{
+	CCompilerContext::GetDefault().ReplaceHostCommandsAndOffsetInstructions( inEntries, firstHostCommandInstruction );
+}
+
+
+/*static*/ void	CParser::RemoveHostCommand( TIdentifierSubtype inType )
+{
+	CCompilerContext::GetDefault().RemoveHostCommand( inType );
+}
+
+
 /*static*/ void	CParser::AddHostFunctionsAndOffsetInstructions( THostCommandEntry* inEntries, size_t firstHostCommandInstruction )
 {
-	size_t		numOldEntries = 0,
-				numNewEntries = 0;
+	CCompilerContext::GetDefault().AddHostFunctionsAndOffsetInstructions( inEntries, firstHostCommandInstruction );
+}
+
+
+/*static*/ void	CParser::ReplaceHostFunctionsAndOffsetInstructions( THostCommandEntry* inEntries, size_t firstHostCommandInstruction )
+{
+	CCompilerContext::GetDefault().ReplaceHostFunctionsAndOffsetInstructions( inEntries, firstHostCommandInstruction );
+}
+
+
+/*static*/ void	CParser::RemoveHostFunction( TIdentifierSubtype inType )
+{
+	CCompilerContext::GetDefault().RemoveHostFunction( inType );
+}
+
+
+// -----------------------------------------------------------------------------
+//	Parse:
+//		Main entrypoint. This takes a script that's been tokenised and generates
+//		the proper parse tree.
+// -----------------------------------------------------------------------------
+
+void	CParser::Parse( const char* fname, CTokenList& tokens, CParseTree& parseTree )
+{
+	if( tokens.GetSymbols() != &parseTree.GetSymbols() )
+		throw std::logic_error( "Tokens need to be interned into the parse tree's symbol table." );
+	
+	// -------------------------------------------------------------------------
+	// First recursively parse our script for top-level constructs:
+	//	(functions, commands, CompileIt-style globals, whatever...)
+	CTokenCursor	tokenItty = tokens.begin();
+	
+	mFileName = fname;
 	
-	if( sHostFunctions )
+	while( tokenItty != tokens.end() && !HadError() )
 	{
-		for( size_t x = 0; sHostFunctions[x].mType != ELastIdentifier_Sentinel; x++ )
-			numOldEntries++;
+		ParseTopLevelConstruct( tokenItty, tokens, parseTree );
 	}
-	for( size_t x = 0; inEntries[x].mType != ELastIdentifier_Sentinel; x++ )
+}
+
+
+// -----------------------------------------------------------------------------
+//	ParseInParallel:
+//		Handlers only share globals, so we can give each thread a run of them
+//		to parse into a tree of its own. The main thread then walks the
+//		script like Parse() would, and wherever a thread already parsed the
+//		handler that starts there, moves its nodes over instead of parsing
+//		it again. Any handler a thread couldn't parse (usually a syntax
+//		error) is simply parsed here, so errors come out the same, too.
+// -----------------------------------------------------------------------------
+
+struct CParseHandlersChunk	// One thread's share of ParseInParallel()'s work.
+{
+	CParser					mParser;
+	CTokenList*				mTokens;
+	CParseTree*				mParseTree;		// Owned by the main parse tree, see CParseTree::AdoptSubTree().
+	CParsedHandler*			mHandlers;
+	size_t					mNumHandlers;
+	std::vector<CSymbolID>	mSymbolMap;		// The main tree's symbol for each symbol in mParseTree, as far as we know it yet.
+	
+	CParseHandlersChunk() : mTokens(NULL), mParseTree(NULL), mHandlers(NULL), mNumHandlers(0) {};
+};
+
+
+void	CParser::ParseInParallel( const char* fname, CTokenList& tokens, CParseTree& parseTree, size_t inMaxThreads )
+{
+	if( tokens.GetSymbols() != &parseTree.GetSymbols() )
+		throw std::logic_error( "Tokens need to be interned into the parse tree's symbol table." );
+	
+	if( !tokens.IsComplete() )	// Threads can't share a list that tokenizes as they go.
 	{
-		numNewEntries++;
+		Parse( fname, tokens, parseTree );
+		return;
 	}
 	
-	THostCommandEntry*	newTable = NULL;
-	if( sHostFunctions == NULL )
+	std::vector<CParsedHandler>	handlers;
+	FindHandlers( tokens, handlers );
+	
+	if( inMaxThreads == 0 )
 	{
-		newTable = (THostCommandEntry*) calloc( numOldEntries +numNewEntries +1, sizeof(THostCommandEntry) );
-		if( !newTable )
-			throw std::runtime_error( "Couldn't resize list of host commands." );
-		memmove( newTable, inEntries, (numNewEntries +1) *sizeof(THostCommandEntry) );
+		long	numCPUs = sysconf( _SC_NPROCESSORS_ONLN );
+		inMaxThreads = (numCPUs > 0) ? numCPUs : 1;
 	}
-	else
+	size_t		numChunks = std::min( inMaxThreads, handlers.size() / PARALLEL_PARSE_MIN_HANDLERS_PER_THREAD );
+	if( handlers.size() < PARALLEL_PARSE_MIN_HANDLERS || numChunks < 2 )
 	{
-		newTable = (THostCommandEntry*) realloc( sHostFunctions, (numOldEntries +numNewEntries +1) * sizeof(THostCommandEntry) );
-		if( !newTable )
-			throw std::runtime_error( "Couldn't resize list of host commands." );
-		memmove( newTable +numOldEntries, inEntries, (numNewEntries +1) *sizeof(THostCommandEntry) );
+		Parse( fname, tokens, parseTree );
+		return;
 	}
 	
-	// Fix up instruction IDs to account for the ones that were already there:
-	for( size_t x = numOldEntries; newTable[x].mType != ELastIdentifier_Sentinel; x++ )
+	mFileName = fname;
+	
+	// Split the handlers into runs with roughly equal numbers of tokens:
+	size_t		numHandlerTokens = 0;
+	for( size_t x = 0; x < handlers.size(); x++ )
+		numHandlerTokens += handlers[x].mEndIndex -handlers[x].mStartIndex;
+	
+	std::vector<CParseHandlersChunk>	chunks( numChunks );
+	size_t								firstHandler = 0,
+										tokensSoFar = 0;
+	for( size_t x = 0; x < numChunks; x++ )
 	{
-		newTable[x].mInstructionID += firstHostCommandInstruction;
-		for( size_t y = 0; newTable[x].mParam[y].mType != EHostParam_Sentinel; y++ )
+		size_t		endHandler = firstHandler;
+		while( endHandler < handlers.size() && (x == (numChunks -1) || tokensSoFar < (numHandlerTokens / numChunks) * (x +1)) )
 		{
-			if( newTable[x].mParam[y].mInstructionID == INVALID_INSTR2 )
-				newTable[x].mParam[y].mInstructionID = INVALID_INSTR;
-			else
-				newTable[x].mParam[y].mInstructionID += firstHostCommandInstruction;
+			tokensSoFar += handlers[endHandler].mEndIndex -handlers[endHandler].mStartIndex;
+			endHandler++;
+		}
+		
+		CParseHandlersChunk&	chunk = chunks[x];
+		chunk.mParser.mFileName = fname;
+		chunk.mParser.mContext = mContext;	// Only read while parsing, so the threads can share it.
+		chunk.mParser.SetThrowOnError( false );
+		chunk.mTokens = &tokens;
+		chunk.mParseTree = new CParseTree;
+		parseTree.AdoptSubTree( chunk.mParseTree );
+		chunk.mParseTree->GetSymbols() = parseTree.GetSymbols();	// So the tokens' symbols are valid for it.
+		chunk.mHandlers = (firstHandler < handlers.size()) ? &handlers[firstHandler] : NULL;
+		chunk.mNumHandlers = endHandler -firstHandler;
+		firstHandler = endHandler;
+	}
+	
+	// Parse the first run on this thread, all others on their own:
+	std::vector<pthread_t>	threads( numChunks );
+	std::vector<bool>		threadStarted( numChunks, false );
+	for( size_t x = 1; x < numChunks; x++ )
+		threadStarted[x] = (pthread_create( &threads[x], NULL, ParseHandlersThread, &chunks[x] ) == 0);
+	ParseHandlersThread( &chunks[0] );
+	for( size_t x = 1; x < numChunks; x++ )
+	{
+		if( threadStarted[x] )
+			pthread_join( threads[x], NULL );
+		else
+			ParseHandlersThread( &chunks[x] );
+	}
+	
+	for( size_t x = 0; x < numChunks; x++ )
+	{
+		CSymbolTable&	chunkSymbols = chunks[x].mParseTree->GetSymbols();
+		chunks[x].mSymbolMap.resize( chunkSymbols.size() );
+		for( size_t y = 0; y < chunkSymbols.size(); y++ )
+			chunks[x].mSymbolMap[y] = (CSymbolID) y;	// Symbols that were there before the threads started don't change.
+	}
+	
+	// Now go through the script in order, like Parse() does:
+	CSymbolTable&	symbols = parseTree.GetSymbols();
+	CTokenCursor	tokenItty = tokens.begin();
+	size_t			nextHandler = 0,
+					currChunk = 0,
+					chunkEndHandler = chunks[0].mNumHandlers;
+	while( tokenItty != tokens.end() && !HadError() )
+	{
+		if( nextHandler < handlers.size() && tokenItty.GetIndex() == handlers[nextHandler].mStartIndex
+			&& handlers[nextHandler].mNode != NULL )
+		{
+			while( nextHandler >= chunkEndHandler )
+				chunkEndHandler += chunks[++currChunk].mNumHandlers;
+			
+			CParsedHandler&			handler = handlers[nextHandler++];
+			CParseHandlersChunk&	chunk = chunks[currChunk];
+			CSymbolTable&			chunkSymbols = chunk.mParseTree->GetSymbols();
+			
+			// Intern new symbols in the order Parse() would have, so variables get the same slots:
+			std::vector<CSymbolID>::iterator	symItty;
+			for( symItty = handler.mNewSymbols.begin(); symItty != handler.mNewSymbols.end(); symItty++ )
+			{
+				const std::string&	symbolText = chunkSymbols.TextForSymbol( *symItty );
+				chunk.mSymbolMap[*symItty] = symbols.SymbolForText( symbolText.data(), symbolText.length(), false );	// Keywords are never new symbols.
+			}
+			
+			std::vector<CNode*>::iterator		nodeItty;
+			for( nodeItty = handler.mNodes.begin(); nodeItty != handler.mNodes.end(); nodeItty++ )
+				(*nodeItty)->MoveToTree( &parseTree, chunk.mSymbolMap );
+			parseTree.AddNode( handler.mNode );
+			
+			if( mFirstHandlerName.length() == 0 )
+			{
+				mFirstHandlerName = handler.mHandlerName;
+				mFirstHandlerIsFunction = handler.mIsFunction;
+			}
+			
+			tokenItty = CTokenCursor( &tokens, handler.mEndIndex );
+			continue;
 		}
+		
+		ParseTopLevelConstruct( tokenItty, tokens, parseTree );
+		
+		while( nextHandler < handlers.size() && handlers[nextHandler].mStartIndex < tokenItty.GetIndex() )
+			nextHandler++;	// We parsed it ourselves, or parsed past it because it didn't end where FindHandlers() thought.
 	}
 	
-	sHostFunctions = newTable;
+	for( size_t x = 0; x < numChunks; x++ )
+	{
+		std::map<CSymbolID,CVariableEntry>::iterator	globalItty;
+		for( globalItty = chunks[x].mParser.mGlobals.begin(); globalItty != chunks[x].mParser.mGlobals.end(); globalItty++ )
+		{
+			if( globalItty->first < chunks[x].mSymbolMap.size() )
+				mGlobals.insert( std::make_pair( chunks[x].mSymbolMap[globalItty->first], globalItty->second ) );	// First one in the script wins.
+		}
+		mUsesObjCCall = mUsesObjCCall || chunks[x].mParser.mUsesObjCCall;
+		
+		chunks[x].mParseTree->GetSymbols() = CSymbolTable();	// Only its arena is still needed.
+	}
 }
 
 
 // -----------------------------------------------------------------------------
-//	Parse:
-//		Main entrypoint. This takes a script that's been tokenised and generates
-//		the proper parse tree.
+//	FindHandlers:
+//		Quickly find where handlers start and end without parsing them, so
+//		ParseInParallel() can hand them to threads. Skips other lines the way
+//		ParseTopLevelConstruct() does, and just stops at anything odd. Parsing
+//		will notice if a handler ends somewhere else.
 // -----------------------------------------------------------------------------
 
-void	CParser::Parse( const char* fname, std::deque<CToken>& tokens, CParseTree& parseTree )
+bool	CParser::FindHandlers( CTokenList& tokens, std::vector<CParsedHandler>& outHandlers )
 {
-	// -------------------------------------------------------------------------
-	// First recursively parse our script for top-level constructs:
-	//	(functions, commands, CompileIt-style globals, whatever...)
-	std::deque<CToken>::iterator	tokenItty = tokens.begin();
+	size_t		numTokens = tokens.size();
+	size_t		x = 0;
 	
-	mFileName = fname;
+	while( x < numTokens )
+	{
+		CToken		currToken = tokens.GetToken( x );
+		if( currToken.IsIdentifier( ENewlineOperator ) )
+			x++;
+		else if( currToken.IsIdentifier( EOnIdentifier ) || currToken.IsIdentifier( EFunctionIdentifier ) || currToken.IsIdentifier( EToIdentifier ) )
+		{
+			CToken		nameToken = tokens.GetToken( x +1 );
+			if( nameToken.mType != EIdentifierToken )
+				return false;
+			
+			// Find an "end <name>" at the start of a line:
+			size_t		endIndex = x +2;
+			bool		atLineStart = false;
+			for( ; endIndex < numTokens; endIndex++ )
+			{
+				CToken		lineToken = tokens.GetToken( endIndex );
+				if( atLineStart && lineToken.IsIdentifier( EEndIdentifier )
+					&& tokens.GetToken( endIndex +1 ).mSymbolID == nameToken.mSymbolID )
+					break;
+				atLineStart = lineToken.IsIdentifier( ENewlineOperator );
+			}
+			if( endIndex >= numTokens )
+				return false;
+			
+			outHandlers.push_back( CParsedHandler( x, endIndex +2 ) );
+			x = endIndex +2;
+		}
+		else
+		{
+			while( x < numTokens && !tokens.GetToken( x ).IsIdentifier( ENewlineOperator ) )
+				x++;
+		}
+	}
 	
-	while( tokenItty != tokens.end() )
+	return true;
+}
+
+
+void*	CParser::ParseHandlersThread( void* inChunk )
+{
+	CParseHandlersChunk*	chunk = (CParseHandlersChunk*) inChunk;
+	chunk->mParser.ParseHandlers( *chunk->mTokens, *chunk->mParseTree, chunk->mHandlers, chunk->mNumHandlers );
+	return NULL;
+}
+
+
+void	CParser::ParseHandlers( CTokenList& tokens, CParseTree& parseTree, CParsedHandler* ioHandlers, size_t inNumHandlers )
+{
+	CSymbolTable&	symbols = parseTree.GetSymbols();
+	CNodeArena&		arena = parseTree.GetNodeArena();
+	
+	for( size_t x = 0; x < inNumHandlers; x++ )
 	{
-		ParseTopLevelConstruct( tokenItty, tokens, parseTree );
+		CParsedHandler&	handler = ioHandlers[x];
+		size_t			firstNode = arena.GetNodeCount();
+		
+		mError = CParseError();
+		mFirstHandlerName.clear();
+		
+		try
+		{
+			CTokenCursor	tokenItty( &tokens, handler.mStartIndex );
+			symbols.StartUsageLog( &handler.mNewSymbols );
+			ParseTopLevelConstruct( tokenItty, tokens, parseTree );
+			symbols.StopUsageLog();
+			
+			if( HadError() || tokenItty.GetIndex() != handler.mEndIndex || arena.GetNodeCount() <= firstNode
+				|| dynamic_cast<CFunctionDefinitionNode*>( arena.GetNode( firstNode ) ) == NULL )	// ParseFunctionDefinition() creates the handler's node first.
+				continue;	// Leave it to the main thread, which will report the error.
+			
+			for( size_t y = firstNode; y < arena.GetNodeCount(); y++ )
+				handler.mNodes.push_back( arena.GetNode( y ) );
+			handler.mHandlerName = mFirstHandlerName;
+			handler.mIsFunction = mFirstHandlerIsFunction;
+			handler.mNode = handler.mNodes[0];
+		}
+		catch( ... )	// Exceptions can't leave a thread. Leave it to the main thread, which will throw again if it wasn't just us.
+		{
+			symbols.StopUsageLog();
+			handler.mNodes.clear();
+			handler.mNode = NULL;
+		}
 	}
 }
 
 
-void	CParser::ParseCommandOrExpression( const char* fname, std::deque<CToken>& tokens, CParseTree& parseTree )
+CFunctionDefinitionNode*	CParser::ParseHandlerAt( const char* fname, CTokenList& tokens, size_t inStartIndex, CParseTree& parseTree )
+{
+	if( tokens.GetSymbols() != &parseTree.GetSymbols() )
+		throw std::logic_error( "Tokens need to be interned into the parse tree's symbol table." );
+	
+	CTokenCursor	tokenItty( &tokens, inStartIndex );
+	if( tokenItty == tokens.end() || !(tokenItty->IsIdentifier( EOnIdentifier ) || tokenItty->IsIdentifier( EFunctionIdentifier ) || tokenItty->IsIdentifier( EToIdentifier )) )
+		return NULL;
+	
+	mFileName = fname;
+	
+	CNodeArena&		arena = parseTree.GetNodeArena();
+	size_t			firstNode = arena.GetNodeCount();
+	ParseTopLevelConstruct( tokenItty, tokens, parseTree );
+	if( HadError() || arena.GetNodeCount() <= firstNode )
+		return NULL;
+	
+	return dynamic_cast<CFunctionDefinitionNode*>( arena.GetNode( firstNode ) );	// ParseFunctionDefinition() creates the handler's node first.
+}
+
+
+void	CParser::ParseCommandOrExpression( const char* fname, CTokenList& tokens, CParseTree& parseTree )
 {
-	std::deque<CToken>::iterator	tokenItty = tokens.begin();
+	if( tokens.GetSymbols() != &parseTree.GetSymbols() )
+		throw std::logic_error( "Tokens need to be interned into the parse tree's symbol table." );
+	
+	CTokenCursor	tokenItty = tokens.begin();
 	std::string						handlerName( ":run" );
 	mFileName = fname;
 	
@@ -484,41 +1092,42 @@ void	CParser::ParseCommandOrExpression( const char* fname, std::deque<CToken>& t
 		mFirstHandlerName = handlerName;
 		mFirstHandlerIsFunction = false;
 	}
+	mTempCounter = 0;
 
 	CFunctionDefinitionNode*		currFunctionNode = NULL;
-	currFunctionNode = new CFunctionDefinitionNode( &parseTree, true, handlerName, 1 );
+	currFunctionNode = new( &parseTree ) CFunctionDefinitionNode( &parseTree, true, handlerName, 1 );
 	parseTree.AddNode( currFunctionNode );
 	
 	// Make built-in system variables so they get declared below like other local vars:
-	currFunctionNode->AddLocalVar( "result", "result", TVariantTypeEmptyString, false, false, false, false );
+	currFunctionNode->AddLocalVar( parseTree.GetSymbols().SymbolForString( "result" ), "result", TVariantTypeEmptyString, false, false, false, false );
 
 	size_t		endLineNum = 1;
-	ParseFunctionBody( handlerName, parseTree, currFunctionNode, tokenItty, tokens, NULL, ENewlineOperator );
+	ParseFunctionBody( parseTree.GetSymbols().SymbolForString( handlerName ), parseTree, currFunctionNode, tokenItty, tokens, NULL, ENewlineOperator );
 	currFunctionNode->SetEndLineNum( endLineNum );
 }
 
 
-void	CParser::ParseTopLevelConstruct( std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens, CParseTree& parseTree )
+void	CParser::ParseTopLevelConstruct( CTokenCursor& tokenItty, CTokenList& tokens, CParseTree& parseTree )
 {
 	if( tokenItty == tokens.end() )
 		;
 	else if( tokenItty->IsIdentifier( ENewlineOperator ) )
 	{
-		CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip the newline.
+		GoNextToken( tokenItty, tokens );	// Skip the newline.
 	}
 	else if( tokenItty->IsIdentifier( EFunctionIdentifier ) )
 	{
-		CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "function" 
+		GoNextToken( tokenItty, tokens );	// Skip "function" 
 		ParseFunctionDefinition( false, tokenItty, tokens, parseTree );
 	}
 	else if( tokenItty->IsIdentifier( EOnIdentifier ) )
 	{
-		CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "on" 
+		GoNextToken( tokenItty, tokens );	// Skip "on" 
 		ParseFunctionDefinition( true, tokenItty, tokens, parseTree );
 	}
 	else if( tokenItty->IsIdentifier( EToIdentifier ) )
 	{
-		CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "to" 
+		GoNextToken( tokenItty, tokens );	// Skip "to" 
 		ParseFunctionDefinition( true, tokenItty, tokens, parseTree );
 	}
 	else
@@ -526,11 +1135,12 @@ void	CParser::ParseTopLevelConstruct( std::deque<CToken>::iterator& tokenItty, s
 		std::stringstream errMsg;
 		errMsg << mFileName << ":" << tokenItty->mLineNum << ": warning: Skipping " << tokenItty->GetShortDescription();
 		
-		CToken::GoNextToken( mFileName, tokenItty, tokens );	// Just skip it, whatever it may be.
+		GoNextToken( tokenItty, tokens );	// Just skip it, whatever it may be.
 		while( !tokenItty->IsIdentifier( ENewlineOperator ) )	// Now skip until the end of the line.
 		{
 			errMsg << " " << tokenItty->GetShortDescription();
-			CToken::GoNextToken( mFileName, tokenItty, tokens );
+			if( !GoNextToken( tokenItty, tokens ) )
+				return;
 		}
 		errMsg << "." << std::endl;
 		
@@ -539,61 +1149,63 @@ void	CParser::ParseTopLevelConstruct( std::deque<CToken>::iterator& tokenItty, s
 }
 
 
-void	CParser::ParseFunctionDefinition( bool isCommand, std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens, CParseTree& parseTree )
+void	CParser::ParseFunctionDefinition( bool isCommand, CTokenCursor& tokenItty, CTokenList& tokens, CParseTree& parseTree )
 {
+	if( !ExpectIdentifierToken( tokenItty ) )
+		return;
+	
 	std::string								handlerName( tokenItty->GetIdentifierText() );
-	std::string								userHandlerName( tokenItty->GetIdentifierText() );
+	CSymbolID								userHandlerName = tokenItty->GetIdentifierSymbol();
 	std::stringstream						fcnHeader;
 	std::stringstream						fcnSignature;
 	size_t									fcnLineNum = 0;
 	
 	fcnLineNum = tokenItty->mLineNum;
 	
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	GoNextToken( tokenItty, tokens );
 
 	if( mFirstHandlerName.length() == 0 )
 	{
 		mFirstHandlerName = handlerName;
 		mFirstHandlerIsFunction = !isCommand;
 	}
+	mTempCounter = 0;
 	
 	CFunctionDefinitionNode*		currFunctionNode = NULL;
-	currFunctionNode = new CFunctionDefinitionNode( &parseTree, isCommand, handlerName, fcnLineNum );
+	currFunctionNode = new( &parseTree ) CFunctionDefinitionNode( &parseTree, isCommand, handlerName, fcnLineNum );
 	parseTree.AddNode( currFunctionNode );
 	
 	// Make built-in system variables so they get declared below like other local vars:
-	currFunctionNode->AddLocalVar( "result", "result", TVariantTypeEmptyString, false, false, false, false );
+	currFunctionNode->AddLocalVar( parseTree.GetSymbols().SymbolForString( "result" ), "result", TVariantTypeEmptyString, false, false, false, false );
 
 	int		currParamIdx = 0;
 	
 	while( !tokenItty->IsIdentifier( ENewlineOperator ) )
 	{
+		if( !ExpectIdentifierToken( tokenItty ) )
+			return;
+		
 		std::string	realVarName( tokenItty->GetIdentifierText() );
-		std::string	varName("var_");
-		varName.append( realVarName );
-		CCommandNode*		theVarCopyCommand = new CGetParamCommandNode( &parseTree, tokenItty->mLineNum );
-		theVarCopyCommand->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunctionNode, varName, realVarName) );
-		theVarCopyCommand->AddParam( new CIntValueNode( &parseTree, currParamIdx++ ) );
+		CSymbolID	varName = parseTree.GetSymbols().VariableSymbolForSymbol( tokenItty->GetIdentifierSymbol() );
+		CCommandNode*		theVarCopyCommand = new( &parseTree ) CGetParamCommandNode( &parseTree, tokenItty->mLineNum );
+		theVarCopyCommand->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunctionNode, varName, realVarName) );
+		theVarCopyCommand->AddParam( new( &parseTree ) CIntValueNode( &parseTree, currParamIdx++ ) );
 		currFunctionNode->AddCommand( theVarCopyCommand );
 		
 		currFunctionNode->AddLocalVar( varName, realVarName, TVariantTypeEmptyString, false, true, false );	// Create param var and mark as parameter in variable list.
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		GoNextToken( tokenItty, tokens );
 		if( !tokenItty->IsIdentifier( ECommaOperator ) )
 		{
 			if( tokenItty->IsIdentifier( ENewlineOperator ) )
 				break;
-			std::stringstream		errMsg;
-			errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected comma or end of line here, found "
-									<< tokenItty->GetShortDescription() << ".";
-			
-			mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-			throw std::runtime_error( errMsg.str() );
+			ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected comma or end of line here, found %t.", *tokenItty ) );
+			return;
 		}
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		GoNextToken( tokenItty, tokens );
 	}
 	
 	while( tokenItty->IsIdentifier( ENewlineOperator ) )
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		GoNextToken( tokenItty, tokens );
 
 	size_t		endLineNum = fcnLineNum;
 	ParseFunctionBody( userHandlerName, parseTree, currFunctionNode, tokenItty, tokens, &endLineNum );
@@ -601,29 +1213,35 @@ void	CParser::ParseFunctionDefinition( bool isCommand, std::deque<CToken>::itera
 }
 
 
-CValueNode	*	CParser::ParseFunctionCall( CParseTree& parseTree, CCodeBlockNodeBase* currFunction, bool isMessagePassing, std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+CValueNode	*	CParser::ParseFunctionCall( CParseTree& parseTree, CCodeBlockNodeBase* currFunction, bool isMessagePassing, CTokenCursor& tokenItty, CTokenList& tokens )
 {
+	if( !ExpectIdentifierToken( tokenItty ) )
+		return NULL;
+	
 	CValueNode*	theTerm = NULL;
 	std::string	handlerName( tokenItty->GetIdentifierText() );
 	std::string	realHandlerName( tokenItty->GetOriginalIdentifierText() );
 	size_t		callLineNum = tokenItty->mLineNum;
 	
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	GoNextToken( tokenItty, tokens );
 	
 	if( tokenItty->IsIdentifier(EOpenBracketOperator) )	// Yes! Function call!
 	{
-		CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip opening bracket.
+		GoNextToken( tokenItty, tokens );	// Skip opening bracket.
 		
 		std::map<std::string,CObjCMethodEntry>::iterator funcItty = sCFunctionTable.find( realHandlerName );
 		if( funcItty == sCFunctionTable.end() )	// No native function of that name? Call function handler:
 		{
-			CFunctionCallNode*	fcall = new CFunctionCallNode( &parseTree, false, handlerName, callLineNum );
+			CFunctionCallNode*	fcall = new( &parseTree ) CFunctionCallNode( &parseTree, false, handlerName, callLineNum );
 			if( isMessagePassing )
 				fcall->SetIsMessagePassing(true);
 			theTerm = fcall;
 			ParseParamList( ECloseBracketOperator, parseTree, currFunction, tokenItty, tokens, fcall );
+			if( HadError() )
+				return NULL;
 			
-			CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip closing bracket.
+			if( !GoNextToken( tokenItty, tokens ) )	// Skip closing bracket.
+				return NULL;
 		}
 		else if( !isMessagePassing )	// Native call!
 			theTerm = ParseNativeFunctionCallStartingAtParams( realHandlerName, funcItty->second, parseTree, currFunction, tokenItty, tokens );
@@ -634,26 +1252,26 @@ CValueNode	*	CParser::ParseFunctionCall( CParseTree& parseTree, CCodeBlockNodeBa
 	return theTerm;
 }
 
-void	CParser::ParsePassStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-									std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+void	CParser::ParsePassStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+									CTokenCursor& tokenItty, CTokenList& tokens )
 {
-	CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "pass".
+	GoNextToken( tokenItty, tokens );	// Skip "pass".
 	
 	CFunctionDefinitionNode* theFunction = dynamic_cast<CFunctionDefinitionNode*>( currFunction->GetContainingFunction() );
 	if( !theFunction )
 	{
-		std::stringstream		errMsg;
-		errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Can only pass messages in command or function handlers.";
-		mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-		throw std::runtime_error( errMsg.str() );
+		ReportError( CParseError( mFileName, tokenItty->mLineNum, "Can only pass messages in command or function handlers.", *tokenItty ) );
+		return;
 	}
 	
 	if( theFunction->GetIsCommand() )
 		ParseHandlerCall( parseTree, currFunction, true, tokenItty, tokens );
 	else
 	{
-		CCommandNode*	theReturnCommand = new CReturnCommandNode( &parseTree, tokenItty->mLineNum );
+		CCommandNode*	theReturnCommand = new( &parseTree ) CReturnCommandNode( &parseTree, tokenItty->mLineNum );
 		CValueNode*		theWhatNode = ParseFunctionCall( parseTree, currFunction, true, tokenItty, tokens );
+		if( HadError() )
+			return;
 		theReturnCommand->AddParam( theWhatNode );
 		
 		currFunction->AddCommand( theReturnCommand );
@@ -661,371 +1279,338 @@ void	CParser::ParsePassStatement( CParseTree& parseTree, CCodeBlockNodeBase* cur
 }
 
 
-void	CParser::ParseHandlerCall( CParseTree& parseTree, CCodeBlockNodeBase* currFunction, bool isMessagePassing, std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+void	CParser::ParseHandlerCall( CParseTree& parseTree, CCodeBlockNodeBase* currFunction, bool isMessagePassing, CTokenCursor& tokenItty, CTokenList& tokens )
 {
 	std::string	handlerName;
 	size_t		currLineNum = tokenItty->mLineNum;
 	
+	if( !ExpectIdentifierToken( tokenItty ) )
+		return;
 	handlerName.append( tokenItty->GetIdentifierText() );
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	GoNextToken( tokenItty, tokens );
 
-	CFunctionCallNode*	currFunctionCall = new CFunctionCallNode( &parseTree, true, handlerName, currLineNum );
+	CFunctionCallNode*	currFunctionCall = new( &parseTree ) CFunctionCallNode( &parseTree, true, handlerName, currLineNum );
 	ParseParamList( ENewlineOperator, parseTree, currFunction, tokenItty, tokens, currFunctionCall );
+	if( HadError() )
+		return;
 	
 	CCommandNode*			theVarAssignCommand = NULL;
 	if( isMessagePassing )
 	{
 		currFunctionCall->SetIsMessagePassing( true );
-		theVarAssignCommand = new CReturnCommandNode( &parseTree, tokenItty->mLineNum );
+		theVarAssignCommand = new( &parseTree ) CReturnCommandNode( &parseTree, tokenItty->mLineNum );
 		theVarAssignCommand->AddParam( currFunctionCall );
 	}
 	else
 	{
-		theVarAssignCommand = new CAssignCommandNode( &parseTree, currLineNum );
-		theVarAssignCommand->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, "result", "result") );
+		theVarAssignCommand = new( &parseTree ) CAssignCommandNode( &parseTree, currLineNum );
+		theVarAssignCommand->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, parseTree.GetSymbols().SymbolForString( "result" ), "result") );
 		theVarAssignCommand->AddParam( currFunctionCall );
 	}
 	currFunction->AddCommand( theVarAssignCommand );
 }
 
 
-void	CParser::ParsePutStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-								std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+void	CParser::ParsePutStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+								CTokenCursor& tokenItty, CTokenList& tokens )
 {
 	// Put:
 	CCommandNode*			thePutCommand = NULL;
 	size_t					startLine = tokenItty->mLineNum;
 	
-	try {
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
-		
-		// What:
-		CValueNode*	whatExpression = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+	if( !GoNextToken( tokenItty, tokens ) )
+		return;
+	
+	// What:
+	CValueNode*	whatExpression = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
+	
+	// [into|after|before]
+	if( tokenItty->IsIdentifier( EIntoIdentifier ) )
+	{
+		thePutCommand = new( &parseTree ) CPutCommandNode( &parseTree, startLine );
+		thePutCommand->AddParam( whatExpression );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
 		
-		// [into|after|before]
-		if( tokenItty->IsIdentifier( EIntoIdentifier ) )
-		{
-			thePutCommand = new CPutCommandNode( &parseTree, startLine );
-			thePutCommand->AddParam( whatExpression );
-			CToken::GoNextToken( mFileName, tokenItty, tokens );
-			
-			// container:
-			CValueNode*	destContainer = ParseContainer( false, false, parseTree, currFunction, tokenItty, tokens );
-			thePutCommand->AddParam( destContainer );
-		}
-		else if( tokenItty->IsIdentifier( EAfterIdentifier ) )
-		{
-			CToken::GoNextToken( mFileName, tokenItty, tokens );
-
-			CValueNode*	destContainer = ParseContainer( false, false, parseTree, currFunction, tokenItty, tokens );
-			
-			thePutCommand = new CPutCommandNode( &parseTree, startLine );
-			COperatorNode	*	concatOperation = new COperatorNode( &parseTree, CONCATENATE_VALUES_INSTR, startLine );
-			concatOperation->AddParam( destContainer->Copy() );
-			concatOperation->AddParam( whatExpression );
-			thePutCommand->AddParam( concatOperation );
-			thePutCommand->AddParam( destContainer );
-		}
-		else if( tokenItty->IsIdentifier( EBeforeIdentifier ) )
-		{
-			CToken::GoNextToken( mFileName, tokenItty, tokens );
+		// container:
+		CValueNode*	destContainer = ParseContainer( false, false, parseTree, currFunction, tokenItty, tokens );
+		if( HadError() )
+			return;
+		thePutCommand->AddParam( destContainer );
+	}
+	else if( tokenItty->IsIdentifier( EAfterIdentifier ) )
+	{
+		GoNextToken( tokenItty, tokens );
 
-			CValueNode*	destContainer = ParseContainer( false, false, parseTree, currFunction, tokenItty, tokens );
-			
-			thePutCommand = new CPutCommandNode( &parseTree, startLine );
-			COperatorNode	*	concatOperation = new COperatorNode( &parseTree, CONCATENATE_VALUES_INSTR, startLine );
-			concatOperation->AddParam( whatExpression );
-			concatOperation->AddParam( destContainer->Copy() );
-			thePutCommand->AddParam( concatOperation );
-			thePutCommand->AddParam( destContainer );
-		}
-		else
-		{
-			thePutCommand = new CPrintCommandNode( &parseTree, startLine );
-			thePutCommand->AddParam( whatExpression );
-		}
+		CValueNode*	destContainer = ParseContainer( false, false, parseTree, currFunction, tokenItty, tokens );
+		if( HadError() )
+			return;
 		
-		currFunction->AddCommand( thePutCommand );
+		thePutCommand = new( &parseTree ) CPutCommandNode( &parseTree, startLine );
+		COperatorNode	*	concatOperation = new( &parseTree ) COperatorNode( &parseTree, CONCATENATE_VALUES_INSTR, startLine );
+		concatOperation->AddParam( destContainer->Copy() );
+		concatOperation->AddParam( whatExpression );
+		thePutCommand->AddParam( concatOperation );
+		thePutCommand->AddParam( destContainer );
 	}
-	catch( ... )
+	else if( tokenItty->IsIdentifier( EBeforeIdentifier ) )
 	{
-		if( thePutCommand )
-			delete thePutCommand;
+		GoNextToken( tokenItty, tokens );
+
+		CValueNode*	destContainer = ParseContainer( false, false, parseTree, currFunction, tokenItty, tokens );
+		if( HadError() )
+			return;
 		
-		throw;
+		thePutCommand = new( &parseTree ) CPutCommandNode( &parseTree, startLine );
+		COperatorNode	*	concatOperation = new( &parseTree ) COperatorNode( &parseTree, CONCATENATE_VALUES_INSTR, startLine );
+		concatOperation->AddParam( whatExpression );
+		concatOperation->AddParam( destContainer->Copy() );
+		thePutCommand->AddParam( concatOperation );
+		thePutCommand->AddParam( destContainer );
 	}
+	else
+	{
+		thePutCommand = new( &parseTree ) CPrintCommandNode( &parseTree, startLine );
+		thePutCommand->AddParam( whatExpression );
+	}
+	
+	currFunction->AddCommand( thePutCommand );
 }
 
 
-void	CParser::ParseSetStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-									std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+void	CParser::ParseSetStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+									CTokenCursor& tokenItty, CTokenList& tokens )
 {
 	// Set:
 	CCommandNode*	thePutCommand = NULL;
 	size_t			startLine = tokenItty->mLineNum;
 	
-	try {
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
-		
-		// container:
-		CValueNode*	destContainer = ParseContainer( false, false, parseTree, currFunction, tokenItty, tokens );
-		
-		// to:
-		if( !tokenItty->IsIdentifier( EToIdentifier ) )
-		{
-			std::stringstream		errMsg;
-			errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: expected \"to\" here, found "
-									<< tokenItty->GetShortDescription() << ".";
-			mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-			throw std::runtime_error( errMsg.str() );
-		}
-		CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "to".
-
-		// what:
-		CValueNode*	whatExpression = ParseExpression( parseTree, currFunction, tokenItty, tokens );
-		
-		// Just build a put command:
-		thePutCommand = new CPutCommandNode( &parseTree, startLine );
-		thePutCommand->AddParam( whatExpression );
-		thePutCommand->AddParam( destContainer );
-		
-		currFunction->AddCommand( thePutCommand );
-	}
-	catch( ... )
+	if( !GoNextToken( tokenItty, tokens ) )
+		return;
+	
+	// container:
+	CValueNode*	destContainer = ParseContainer( false, false, parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
+	
+	// to:
+	if( !tokenItty->IsIdentifier( EToIdentifier ) )
 	{
-		if( thePutCommand )
-			delete thePutCommand;
-		
-		// TODO: Don't leak destContainer and whatExpression if error before they're added to command.
-		
-		throw;
+		ReportError( CParseError( mFileName, tokenItty->mLineNum, "expected \"to\" here, found %t.", *tokenItty ) );
+		return;
 	}
+	GoNextToken( tokenItty, tokens );	// Skip "to".
+
+	// what:
+	CValueNode*	whatExpression = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
+	
+	// Just build a put command:
+	thePutCommand = new( &parseTree ) CPutCommandNode( &parseTree, startLine );
+	thePutCommand->AddParam( whatExpression );
+	thePutCommand->AddParam( destContainer );
+	
+	currFunction->AddCommand( thePutCommand );
 }
 
 
 CValueNode*	CParser::ParseHostFunction( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-									std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+									CTokenCursor& tokenItty, CTokenList& tokens )
 {
-	return ParseHostEntityWithTable( parseTree, currFunction, tokenItty, tokens, sHostFunctions );
+	return ParseHostEntityWithTable( parseTree, currFunction, tokenItty, tokens, mContext->HostFunctionsByType() );
 }
 
 
 void	CParser::ParseHostCommand( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-									std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+									CTokenCursor& tokenItty, CTokenList& tokens )
 {
 	CNode*	theNode = ParseHostEntityWithTable( parseTree, currFunction,
-												tokenItty, tokens, sHostCommands );
-	if( theNode )
+												tokenItty, tokens, mContext->HostCommandsByType() );
+	if( HadError() )
+		return;
+	else if( theNode )
 		currFunction->AddCommand( theNode );
 	else if( tokenItty != tokens.end() && tokenItty->IsIdentifier(EEndIdentifier) )
-	{
-		std::stringstream		errMsg;
-		errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected handler call here, found \""
-							<< tokenItty->GetShortDescription() << "\".";
-		mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-		throw std::runtime_error( errMsg.str() );
-	}
+		ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected handler call here, found \"%t\".", *tokenItty ) );
 	else
 		ParseHandlerCall( parseTree, currFunction, false, tokenItty, tokens );
 }
 
 
 CValueNode*	CParser::ParseHostEntityWithTable( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-									std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens,
-									THostCommandEntry* inHostTable )
+									CTokenCursor& tokenItty, CTokenList& tokens,
+									const THostCommandList* inHostTable )
 {
+	if( !ExpectIdentifierToken( tokenItty ) )
+		return NULL;
+	
 	CValueNode			*theNode = NULL;
 	TIdentifierSubtype	firstIdentifier = tokenItty->GetIdentifierSubType();
 	
-	if( inHostTable != NULL )
+	const THostCommandList&	candidates = inHostTable[firstIdentifier];
+	if( !candidates.empty() )	// First one registered for this identifier wins.
 	{
-		for( size_t commandIdx = 0; inHostTable[commandIdx].mType != ELastIdentifier_Sentinel; commandIdx++ )
+		GoNextToken( tokenItty, tokens );
+		
+		const THostCommandEntry*	cmd = &candidates.front();
+		const THostParameterEntry*	par = cmd->mParam;
+		COperatorNode*				hostCommand = new( &parseTree ) COperatorNode( &parseTree, cmd->mInstructionID, tokenItty->mLineNum );
+		theNode = hostCommand;
+		
+		while( par->mType != EHostParam_Sentinel )
 		{
-			if( inHostTable[commandIdx].mType == firstIdentifier )
+			switch( par->mType )
 			{
-				CToken::GoNextToken( mFileName, tokenItty, tokens );
-				
-				THostCommandEntry*		cmd = inHostTable + commandIdx;
-				THostParameterEntry*	par = cmd->mParam;
-				COperatorNode*			hostCommand = new COperatorNode( &parseTree, cmd->mInstructionID, tokenItty->mLineNum );
-				theNode = hostCommand;
-				
-				while( par->mType != EHostParam_Sentinel )
+				case EHostParamImmediateValue:
 				{
-					switch( par->mType )
+					CValueNode	*	term = ParseTerm( parseTree, currFunction, tokenItty, tokens );
+					if( HadError() )
+						return NULL;
+					else if( !term && par->mIsOptional )
 					{
-						case EHostParamImmediateValue:
+						if( par->mInstructionID == INVALID_INSTR )
+							hostCommand->AddParam( new( &parseTree ) CStringValueNode( &parseTree, "" ) );
+					}
+					else if( !term )
+					{
+						if( tokenItty != tokens.end() )
+							ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected term here, found \"%t\".", *tokenItty ) );
+						else
 						{
-							CValueNode	*	term = ParseTerm( parseTree, currFunction, tokenItty, tokens );
-							if( !term && par->mIsOptional )
-							{
-								if( par->mInstructionID == INVALID_INSTR )
-									hostCommand->AddParam( new CStringValueNode( &parseTree, "" ) );
-							}
-							else if( !term )
-							{
-								delete hostCommand;
-								std::stringstream		errMsg;
-								if( tokenItty != tokens.end() )
-								{
-									errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected term here, found \""
-															<< tokenItty->GetShortDescription() << "\".";
-								}
-								else
-								{
-									--tokenItty;
-									errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected term here.";
-								}
-								mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-								throw std::runtime_error( errMsg.str() );
-							}
-							else
-							{
-								hostCommand->AddParam( term );
-								if( par->mInstructionID != INVALID_INSTR )
-									hostCommand->SetInstructionID( par->mInstructionID );
-							}
-							break;
+							--tokenItty;
+							ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected term here.", *tokenItty ) );
+						}
+						return NULL;
+					}
+					else
+					{
+						hostCommand->AddParam( term );
+						if( par->mInstructionID != INVALID_INSTR )
+							hostCommand->SetInstructionID( par->mInstructionID );
+					}
+					break;
+				}
+
+				case EHostParamExpression:
+				{
+					CValueNode	*	term = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+					if( HadError() )
+						return NULL;
+					else if( !term && par->mIsOptional )
+					{
+						if( par->mInstructionID == INVALID_INSTR )
+							hostCommand->AddParam( new( &parseTree ) CStringValueNode( &parseTree, "" ) );
+					}
+					else if( !term )
+					{
+						if( tokenItty != tokens.end() )
+							ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected expression here, found \"%t\".", *tokenItty ) );
+						else
+						{
+							--tokenItty;
+							ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected expression here.", *tokenItty ) );
+						}
+						return NULL;
+					}
+					else
+					{
+						hostCommand->AddParam( term );
+						if( par->mInstructionID != INVALID_INSTR )
+							hostCommand->SetInstructionID( par->mInstructionID );
+					}
+					break;
+				}
+
+				case EHostParamIdentifier:
+				{
+					if( tokenItty->IsIdentifier(par->mIdentifierType) )
+					{
+						if( par->mInstructionID == INVALID_INSTR )
+							hostCommand->AddParam( new( &parseTree ) CStringValueNode( &parseTree, tokenItty->GetShortDescription() ) );
+						else
+							hostCommand->SetInstructionID( par->mInstructionID );
+						if( !GoNextToken( tokenItty, tokens ) )
+							return NULL;
+					}
+					else if( par->mIsOptional )
+					{
+						if( par->mInstructionID == INVALID_INSTR )
+							hostCommand->AddParam( new( &parseTree ) CStringValueNode( &parseTree, "" ) );
+					}
+					else
+					{
+						if( tokenItty != tokens.end() )
+							ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"%i\" here, found \"%t\".", *tokenItty, par->mIdentifierType ) );
+						else
+						{
+							--tokenItty;
+							ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"%i\" here.", *tokenItty, par->mIdentifierType ) );
 						}
+						return NULL;
+					}
+					break;
+				}
 
-						case EHostParamExpression:
+				case EHostParamLabeledValue:
+				case EHostParamLabeledExpression:
+				{
+					if( tokenItty->IsIdentifier(par->mIdentifierType) )
+					{
+						GoNextToken( tokenItty, tokens );
+						
+						CValueNode	*	term = NULL;
+						const char	*	valType = "term";
+						if( par->mType == EHostParamLabeledExpression )
 						{
-							CValueNode	*	term = ParseExpression( parseTree, currFunction, tokenItty, tokens );
-							if( !term && par->mIsOptional )
-							{
-								if( par->mInstructionID == INVALID_INSTR )
-									hostCommand->AddParam( new CStringValueNode( &parseTree, "" ) );
-							}
-							else if( !term )
-							{
-								delete hostCommand;
-								std::stringstream		errMsg;
-								if( tokenItty != tokens.end() )
-								{
-									errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected expression here, found \""
-															<< tokenItty->GetShortDescription() << "\".";
-								}
-								else
-								{
-									--tokenItty;
-									errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected expression here.";
-								}
-								mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-								throw std::runtime_error( errMsg.str() );
-							}
-							else
-							{
-								hostCommand->AddParam( term );
-								if( par->mInstructionID != INVALID_INSTR )
-									hostCommand->SetInstructionID( par->mInstructionID );
-							}
-							break;
+							term = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+							valType = "expression";
 						}
-
-						case EHostParamIdentifier:
+						else
+							term = ParseTerm( parseTree, currFunction, tokenItty, tokens );
+						if( HadError() )
+							return NULL;
+						else if( !term )
 						{
-							if( tokenItty->IsIdentifier(par->mIdentifierType) )
-							{
-								if( par->mInstructionID == INVALID_INSTR )
-									hostCommand->AddParam( new CStringValueNode( &parseTree, tokenItty->GetShortDescription() ) );
-								else
-									hostCommand->SetInstructionID( par->mInstructionID );
-								CToken::GoNextToken( mFileName, tokenItty, tokens );
-							}
-							else if( par->mIsOptional )
-							{
-								if( par->mInstructionID == INVALID_INSTR )
-									hostCommand->AddParam( new CStringValueNode( &parseTree, "" ) );
-							}
+							if( tokenItty != tokens.end() )
+								ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected %s after \"%i\", found \"%t\".", *tokenItty, par->mIdentifierType, valType ) );
 							else
 							{
-								delete hostCommand;
-								std::stringstream		errMsg;
-								if( tokenItty != tokens.end() )
-									errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"" << gIdentifierStrings[par->mIdentifierType] << "\" here, found \""
-														<< tokenItty->GetShortDescription() << "\".";
-								else
-								{
-									--tokenItty;
-									errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"" << gIdentifierStrings[par->mIdentifierType] << "\" here.";
-								}
-								mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-								throw std::runtime_error( errMsg.str() );
+								--tokenItty;
+								ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected %s after \"%i\".", *tokenItty, par->mIdentifierType, valType ) );
 							}
-							break;
+							return NULL;
 						}
-
-						case EHostParamLabeledValue:
-						case EHostParamLabeledExpression:
+						else
 						{
-							if( tokenItty->IsIdentifier(par->mIdentifierType) )
-							{
-								CToken::GoNextToken( mFileName, tokenItty, tokens );
-								
-								CValueNode	*	term = NULL;
-								const char	*	valType = "term";
-								if( par->mType == EHostParamLabeledExpression )
-								{
-									term = ParseExpression( parseTree, currFunction, tokenItty, tokens );
-									valType = "expression";
-								}
-								else
-									term = ParseTerm( parseTree, currFunction, tokenItty, tokens );
-								if( !term )
-								{
-									delete hostCommand;
-									std::stringstream		errMsg;
-									if( tokenItty != tokens.end() )
-									{
-										errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected " << valType << " after \"" << gIdentifierStrings[par->mIdentifierType] << "\", found \""
-															<< tokenItty->GetShortDescription() << "\".";
-									}
-									else
-									{
-										--tokenItty;
-										errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected " << valType << " after \"" << gIdentifierStrings[par->mIdentifierType] << "\".";
-									}
-									mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-									throw std::runtime_error( errMsg.str() );
-								}
-								else
-								{
-									hostCommand->AddParam( term );
-									if( par->mInstructionID != INVALID_INSTR )
-										hostCommand->SetInstructionID( par->mInstructionID );
-								}
-							}
-							else if( par->mIsOptional )
-								hostCommand->AddParam( new CStringValueNode( &parseTree, "" ) );
-							else
-							{
-								delete hostCommand;
-								std::stringstream		errMsg;
-								if( tokenItty != tokens.end() )
-								{
-									errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"" << gIdentifierStrings[par->mIdentifierType] << "\" here, found \""
-														<< tokenItty->GetShortDescription() << "\".";
-								}
-								else
-								{
-									--tokenItty;
-									errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"" << gIdentifierStrings[par->mIdentifierType] << "\" here.";
-								}
-								mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-								throw std::runtime_error( errMsg.str() );
-							}
-							break;
+							hostCommand->AddParam( term );
+							if( par->mInstructionID != INVALID_INSTR )
+								hostCommand->SetInstructionID( par->mInstructionID );
 						}
-						
-						case EHostParam_Sentinel:
-							break;
 					}
-					
-					par++;
+					else if( par->mIsOptional )
+						hostCommand->AddParam( new( &parseTree ) CStringValueNode( &parseTree, "" ) );
+					else
+					{
+						if( tokenItty != tokens.end() )
+							ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"%i\" here, found \"%t\".", *tokenItty, par->mIdentifierType ) );
+						else
+						{
+							--tokenItty;
+							ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"%i\" here.", *tokenItty, par->mIdentifierType ) );
+						}
+						return NULL;
+					}
+					break;
 				}
 				
-				break;	// Found a command that matches, stop looping.
+				case EHostParam_Sentinel:
+					break;
 			}
+			
+			par++;
 		}
 	}
 	
@@ -1033,81 +1618,88 @@ CValueNode*	CParser::ParseHostEntityWithTable( CParseTree& parseTree, CCodeBlock
 }
 
 
-void	CParser::ParseGlobalStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+void	CParser::ParseGlobalStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens )
 {
-	CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "global".
+	GoNextToken( tokenItty, tokens );	// Skip "global".
 	
-	std::string		globalName( "var_" );
-	globalName.append( tokenItty->GetIdentifierText() );
+	if( !ExpectIdentifierToken( tokenItty ) )
+		return;
+	CSymbolID		globalName = parseTree.GetSymbols().VariableSymbolForSymbol( tokenItty->GetIdentifierSymbol() );
 	
 	currFunction->AddLocalVar( globalName, tokenItty->GetIdentifierText(), TVariantType_INVALID, false, false, true );
 	
-	CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip global name.
+	if( !GoNextToken( tokenItty, tokens ) )	// Skip global name.
+		return;
 }
 
 
-void	CParser::ParseGetStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-									std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+void	CParser::ParseGetStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+									CTokenCursor& tokenItty, CTokenList& tokens )
 {
-	CCommandNode*	thePutCommand = new CPutCommandNode( &parseTree, tokenItty->mLineNum );
+	CCommandNode*	thePutCommand = new( &parseTree ) CPutCommandNode( &parseTree, tokenItty->mLineNum );
 	
 	// We map "get" to "put <what> into it":
-	CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "get".
+	GoNextToken( tokenItty, tokens );	// Skip "get".
 	
 	// What:
 	CValueNode*	theWhatNode = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
 	thePutCommand->AddParam( theWhatNode );
 		
 	// Make sure we have an "it":
-	CreateVariable( "var_it", "it", false, currFunction );
-	thePutCommand->AddParam( new CLocalVariableRefValueNode( &parseTree, currFunction, "var_it", "it" ) );
+	CSymbolID	itVarName = parseTree.GetSymbols().SymbolForString( "var_it" );
+	CreateVariable( itVarName, "it", false, currFunction );
+	thePutCommand->AddParam( new( &parseTree ) CLocalVariableRefValueNode( &parseTree, currFunction, itVarName, "it" ) );
 	
 	currFunction->AddCommand( thePutCommand );
 }
 
 
-void	CParser::ParseReturnStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+void	CParser::ParseReturnStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens )
 {
-	CCommandNode*	theReturnCommand = new CReturnCommandNode( &parseTree, tokenItty->mLineNum );
+	CCommandNode*	theReturnCommand = new( &parseTree ) CReturnCommandNode( &parseTree, tokenItty->mLineNum );
 	
 	// Return:
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	GoNextToken( tokenItty, tokens );
 	
 	// What:
 	CValueNode*	theWhatNode = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
 	theReturnCommand->AddParam( theWhatNode );
 	
 	currFunction->AddCommand( theReturnCommand );
 }
 
 
-void	CParser::ParseAddStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+void	CParser::ParseAddStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens )
 {
-	CCommandNode*	theAddCommand = new CAddCommandNode( &parseTree, tokenItty->mLineNum );
+	CCommandNode*	theAddCommand = new( &parseTree ) CAddCommandNode( &parseTree, tokenItty->mLineNum );
 	
 	// Add:
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	GoNextToken( tokenItty, tokens );
 	
 	// What:
 	CValueNode*	theWhatNode = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
 	
 	// To:
 	if( !tokenItty->IsIdentifier( EToIdentifier ) )
 	{
-		delete theWhatNode;
-		std::stringstream		errMsg;
-		errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"to\" here, found "
-								<< tokenItty->GetShortDescription() << ".";
-		mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-		throw std::runtime_error( errMsg.str() );
+		ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"to\" here, found %t.", *tokenItty ) );
+		return;
 	}
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	GoNextToken( tokenItty, tokens );
 	
 	// Dest:
 	CValueNode*	theContainerNode = ParseContainer( false, false, parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
 	theAddCommand->AddParam( theContainerNode );
 	theAddCommand->AddParam( theWhatNode );
 	
@@ -1115,93 +1707,96 @@ void	CParser::ParseAddStatement( CParseTree& parseTree, CCodeBlockNodeBase* curr
 }
 
 
-void	CParser::ParseSubtractStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+void	CParser::ParseSubtractStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens )
 {
-	CCommandNode*	theAddCommand = new CCommandNode( &parseTree, "SubtractFrom", tokenItty->mLineNum );
+	CCommandNode*	theAddCommand = new( &parseTree ) CCommandNode( &parseTree, "SubtractFrom", tokenItty->mLineNum );
 	
 	// Add:
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	GoNextToken( tokenItty, tokens );
 	
 	// What:
 	CValueNode*	theWhatNode = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
 	theAddCommand->AddParam( theWhatNode );
 	
 	// From:
 	if( !tokenItty->IsIdentifier( EFromIdentifier ) )
 	{
-		std::stringstream		errMsg;
-		errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"from\" here, found "
-								<< tokenItty->GetShortDescription() << ".";
-		mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-		throw std::runtime_error( errMsg.str() );
+		ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"from\" here, found %t.", *tokenItty ) );
+		return;
 	}
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	GoNextToken( tokenItty, tokens );
 	
 	// Dest:
 	CValueNode*	theContainerNode = ParseContainer( false, false, parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
 	theAddCommand->AddParam( theContainerNode );
 	
 	currFunction->AddCommand( theAddCommand );
 }
 
 
-void	CParser::ParseMultiplyStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+void	CParser::ParseMultiplyStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens )
 {
-	CCommandNode*	theAddCommand = new CCommandNode( &parseTree, "MultiplyWith", tokenItty->mLineNum );
+	CCommandNode*	theAddCommand = new( &parseTree ) CCommandNode( &parseTree, "MultiplyWith", tokenItty->mLineNum );
 	
 	// Multiply:
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	GoNextToken( tokenItty, tokens );
 	
 	// Dest:
 	CValueNode*	theContainerNode = ParseContainer( false, false, parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
 	theAddCommand->AddParam( theContainerNode );
 	
 	// With:
 	if( !tokenItty->IsIdentifier( EWithIdentifier ) )
 	{
-		std::stringstream		errMsg;
-		errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"with\" here, found "
-								<< tokenItty->GetShortDescription() << ".";
-		mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-		throw std::runtime_error( errMsg.str() );
+		ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"with\" here, found %t.", *tokenItty ) );
+		return;
 	}
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	GoNextToken( tokenItty, tokens );
 	
 	// What:
 	CValueNode*	theWhatNode = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
 	theAddCommand->AddParam( theWhatNode );
 	
 	currFunction->AddCommand( theAddCommand );
 }
 
 
-void	CParser::ParseDivideStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+void	CParser::ParseDivideStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens )
 {
-	CCommandNode*	theAddCommand = new CCommandNode( &parseTree, "DivideBy", tokenItty->mLineNum );
+	CCommandNode*	theAddCommand = new( &parseTree ) CCommandNode( &parseTree, "DivideBy", tokenItty->mLineNum );
 	
 	// Divide:
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	GoNextToken( tokenItty, tokens );
 	
 	// Dest:
 	CValueNode*	theContainerNode = ParseContainer( false, false, parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
 	theAddCommand->AddParam( theContainerNode );
 	
 	// By:
 	if( !tokenItty->IsIdentifier( EByIdentifier ) )
 	{
-		std::stringstream		errMsg;
-		errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"by\" here, found "
-								<< tokenItty->GetShortDescription() << ".";
-		mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-		throw std::runtime_error( errMsg.str() );
+		ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"by\" here, found %t.", *tokenItty ) );
+		return;
 	}
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	GoNextToken( tokenItty, tokens );
 	
 	// What:
 	CValueNode*	theWhatNode = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
 	theAddCommand->AddParam( theWhatNode );
 	
 	currFunction->AddCommand( theAddCommand );
@@ -1209,131 +1804,140 @@ void	CParser::ParseDivideStatement( CParseTree& parseTree, CCodeBlockNodeBase* c
 
 
 // When you enter this, "repeat for each" has already been parsed, and you should be at the chunk type token:
-void	CParser::ParseRepeatForEachStatement( std::string& userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+void	CParser::ParseRepeatForEachStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens )
 {
 	// chunk type:
+	if( !ExpectIdentifierToken( tokenItty ) )
+		return;
 	TChunkType	chunkTypeConstant = GetChunkTypeNameFromIdentifierSubtype( tokenItty->GetIdentifierSubType() );
 	if( chunkTypeConstant == TChunkTypeInvalid )
 	{
-		std::stringstream		errMsg;
-		errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected chunk type identifier here, found "
-								<< tokenItty->GetShortDescription() << ".";
-		mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-		throw std::runtime_error( errMsg.str() );
+		ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected chunk type identifier here, found %t.", *tokenItty ) );
+		return;
 	}
-	CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip chunk type.
+	GoNextToken( tokenItty, tokens );	// Skip chunk type.
 	
 	// <varName>:
-	std::string	counterVarName("var_");
-	counterVarName.append( tokenItty->GetIdentifierText() );
+	if( !ExpectIdentifierToken( tokenItty ) )
+		return;
+	std::string	realCounterVarName( tokenItty->GetIdentifierText() );
+	CSymbolID	counterVarName = parseTree.GetSymbols().VariableSymbolForSymbol( tokenItty->GetIdentifierSymbol() );
 	
-	CreateVariable( counterVarName, tokenItty->GetIdentifierText(), false, currFunction );
+	CreateVariable( counterVarName, realCounterVarName, false, currFunction );
 	
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	if( !GoNextToken( tokenItty, tokens ) )
+		return;
 	
 	// of:
 	if( !tokenItty->IsIdentifier( EOfIdentifier ) && !tokenItty->IsIdentifier( EInIdentifier ) )
 	{
-		std::stringstream		errMsg;
-		errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"of\" here, found "
-								<< tokenItty->GetShortDescription() << ".";
-		mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-		throw std::runtime_error( errMsg.str() );
+		ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"of\" here, found %t.", *tokenItty ) );
+		return;
 	}
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	if( !GoNextToken( tokenItty, tokens ) )
+		return;
 	
 	// <expression>
 	size_t			currLineNum = tokenItty->mLineNum;
 	CValueNode* theExpressionNode = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
 	
 	// AssignChunkArray( tempName, chunkType, <expression> );
-	std::string		tempName = CVariableEntry::GetNewTempName();
-	std::string		tempCounterName = CVariableEntry::GetNewTempName();
-	std::string		tempMaxCountName = CVariableEntry::GetNewTempName();
-	
-	CCommandNode*			theVarChunkListCommand = new CAssignChunkArrayNode( &parseTree, currLineNum );
-	theVarChunkListCommand->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempName, tempName) );
-	theVarChunkListCommand->AddParam( new CIntValueNode(&parseTree, chunkTypeConstant) );
+	std::string		tempName = GetNewTempName();
+	CSymbolID		tempSymbol = parseTree.GetSymbols().SymbolForString( tempName );
+	std::string		tempCounterName = GetNewTempName();
+	CSymbolID		tempCounterSymbol = parseTree.GetSymbols().SymbolForString( tempCounterName );
+	std::string		tempMaxCountName = GetNewTempName();
+	CSymbolID		tempMaxCountSymbol = parseTree.GetSymbols().SymbolForString( tempMaxCountName );
+	
+	CCommandNode*			theVarChunkListCommand = new( &parseTree ) CAssignChunkArrayNode( &parseTree, currLineNum );
+	theVarChunkListCommand->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempSymbol, tempName) );
+	theVarChunkListCommand->AddParam( new( &parseTree ) CIntValueNode(&parseTree, chunkTypeConstant) );
 	theVarChunkListCommand->AddParam( theExpressionNode );
 	currFunction->AddCommand( theVarChunkListCommand );
 	
 	// tempCounterName = 1;
-	CCommandNode*			theVarAssignCommand = new CAssignCommandNode( &parseTree, currLineNum );
-	theVarAssignCommand->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempCounterName, tempCounterName) );
-	theVarAssignCommand->AddParam( new CIntValueNode(&parseTree, 1) );
+	CCommandNode*			theVarAssignCommand = new( &parseTree ) CAssignCommandNode( &parseTree, currLineNum );
+	theVarAssignCommand->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempCounterSymbol, tempCounterName) );
+	theVarAssignCommand->AddParam( new( &parseTree ) CIntValueNode(&parseTree, 1) );
 	currFunction->AddCommand( theVarAssignCommand );
 	
 	// tempMaxCountName = GetArrayItemCount( tempName );
-	CGetArrayItemCountNode*	currFunctionCall = new CGetArrayItemCountNode( &parseTree, currLineNum);
-	currFunctionCall->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempMaxCountName, tempMaxCountName) );
-	currFunctionCall->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempName, tempName) );
+	CGetArrayItemCountNode*	currFunctionCall = new( &parseTree ) CGetArrayItemCountNode( &parseTree, currLineNum);
+	currFunctionCall->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempMaxCountSymbol, tempMaxCountName) );
+	currFunctionCall->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempSymbol, tempName) );
 	currFunction->AddCommand( currFunctionCall );
 	
 	// while( tempCounterName <= tempMaxCountName )
-	CWhileLoopNode*		whileLoop = new CWhileLoopNode( &parseTree, currLineNum, currFunction );
+	CWhileLoopNode*		whileLoop = new( &parseTree ) CWhileLoopNode( &parseTree, currLineNum, currFunction );
 	currFunction->AddCommand( whileLoop );
-	COperatorNode	*	opNode = new COperatorNode( &parseTree, LESS_THAN_EQUAL_OPERATOR_INSTR, currLineNum );
+	COperatorNode	*	opNode = new( &parseTree ) COperatorNode( &parseTree, LESS_THAN_EQUAL_OPERATOR_INSTR, currLineNum );
 	whileLoop->SetCondition( opNode );
-	opNode->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempCounterName, tempCounterName) );
-	opNode->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempMaxCountName, tempMaxCountName) );
+	opNode->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempCounterSymbol, tempCounterName) );
+	opNode->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempMaxCountSymbol, tempMaxCountName) );
 	
 	// counterVarName = GetArrayItem( tempName, tempCounterName );
-	CGetArrayItemNode*	getItemNode = new CGetArrayItemNode( &parseTree, currLineNum );
-	getItemNode->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, counterVarName, counterVarName) );
-	getItemNode->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempCounterName, tempCounterName) );
-	getItemNode->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempName, tempName) );
+	CGetArrayItemNode*	getItemNode = new( &parseTree ) CGetArrayItemNode( &parseTree, currLineNum );
+	getItemNode->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, counterVarName, realCounterVarName) );
+	getItemNode->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempCounterSymbol, tempCounterName) );
+	getItemNode->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempSymbol, tempName) );
 	whileLoop->AddCommand( getItemNode );
 	
 	while( !tokenItty->IsIdentifier( EEndIdentifier ) )
 	{
 		ParseOneLine( userHandlerName, parseTree, whileLoop, tokenItty, tokens );
+		if( HadError() )
+			return;
 	}
 	
 	// tempCounterName += 1;	-- increment loop counter.
-	CAddCommandNode	*	theIncrementOperation = new CAddCommandNode( &parseTree, tokenItty->mLineNum );
-	theIncrementOperation->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempCounterName, tempCounterName) );
-	theIncrementOperation->AddParam( new CIntValueNode(&parseTree, 1) );
-	whileLoop->AddCommand( theIncrementOperation );	// TODO: Need to dispose this on exceptions above.
+	CAddCommandNode	*	theIncrementOperation = new( &parseTree ) CAddCommandNode( &parseTree, tokenItty->mLineNum );
+	theIncrementOperation->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempCounterSymbol, tempCounterName) );
+	theIncrementOperation->AddParam( new( &parseTree ) CIntValueNode(&parseTree, 1) );
+	whileLoop->AddCommand( theIncrementOperation );
 	
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	if( !GoNextToken( tokenItty, tokens ) )
+		return;
 	if( !tokenItty->IsIdentifier(ERepeatIdentifier) )	// end repeat
 	{
-		std::stringstream		errMsg;
-		errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"end repeat\" here, found "
-								<< tokenItty->GetShortDescription() << ".";
-		mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-		throw std::runtime_error( errMsg.str() );
+		ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"end repeat\" here, found %t.", *tokenItty ) );
+		return;
 	}
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	if( !GoNextToken( tokenItty, tokens ) )
+		return;
 }
 
 
-void	CParser::ParseRepeatStatement( std::string& userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+void	CParser::ParseRepeatStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens )
 {
 	size_t		conditionLineNum = tokenItty->mLineNum;
 	
 	// Repeat:
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	GoNextToken( tokenItty, tokens );
 	
 	if( tokenItty->IsIdentifier( EWhileIdentifier ) || tokenItty->IsIdentifier( EUntilIdentifier ) )	// While:
 	{
 		bool			doUntil = (tokenItty->mSubType == EUntilIdentifier);
 		
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
 		
-		CWhileLoopNode*		whileLoop = new CWhileLoopNode( &parseTree, conditionLineNum, currFunction );
+		CWhileLoopNode*		whileLoop = new( &parseTree ) CWhileLoopNode( &parseTree, conditionLineNum, currFunction );
 		CValueNode*			conditionNode = NULL;
 		
 		currFunction->AddCommand( whileLoop );
 		
 		// Condition:
 		conditionNode = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+		if( HadError() )
+			return;
 
 		if( doUntil )
 		{
-			COperatorNode	*funcNode = new COperatorNode( &parseTree, NEGATE_BOOL_INSTR, conditionLineNum );
+			COperatorNode	*funcNode = new( &parseTree ) COperatorNode( &parseTree, NEGATE_BOOL_INSTR, conditionLineNum );
 			funcNode->AddParam( conditionNode );
 			conditionNode = funcNode;
 		}
@@ -1344,38 +1948,46 @@ void	CParser::ParseRepeatStatement( std::string& userHandlerName, CParseTree& pa
 		while( !tokenItty->IsIdentifier( EEndIdentifier ) )
 		{
 			ParseOneLine( userHandlerName, parseTree, whileLoop, tokenItty, tokens );
+			if( HadError() )
+				return;
 		}
 
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
-		tokenItty->ExpectIdentifier( mFileName, ERepeatIdentifier, EEndIdentifier );
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
+		if( !ExpectIdentifier( tokenItty, ERepeatIdentifier, EEndIdentifier ) )
+			return;
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
 	}
 	else if( tokenItty->IsIdentifier( EWithIdentifier ) )	// With:
 	{
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		GoNextToken( tokenItty, tokens );
 		
-		std::string	counterVarName("var_");
-		counterVarName.append( tokenItty->GetIdentifierText() );
+		if( !ExpectIdentifierToken( tokenItty ) )
+			return;
+		std::string	realCounterVarName( tokenItty->GetIdentifierText() );
+		CSymbolID	counterVarName = parseTree.GetSymbols().VariableSymbolForSymbol( tokenItty->GetIdentifierSymbol() );
 		
-		CreateVariable( counterVarName, tokenItty->GetIdentifierText(), false, currFunction );
+		CreateVariable( counterVarName, realCounterVarName, false, currFunction );
 		
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
 		
 		// From:
 		if( !tokenItty->IsIdentifier( EFromIdentifier ) && !tokenItty->IsIdentifier( EEqualsOperator )
 			 && !tokenItty->IsIdentifier( EIsIdentifier ) )
 		{
-			std::stringstream		errMsg;
-			errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"from\" or \"=\" here, found "
-								<< tokenItty->GetShortDescription() << ".";
-			mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-			throw std::runtime_error( errMsg.str() );
+			ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"from\" or \"=\" here, found %t.", *tokenItty ) );
+			return;
 		}
 		
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
 		
 		// startNum:
 		CValueNode*			startNumExpr = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+		if( HadError() )
+			return;
 		
 		LEOInteger			stepSize = 1;
 		LEOInstructionID	compareOp = LESS_THAN_EQUAL_OPERATOR_INSTR;
@@ -1386,43 +1998,45 @@ void	CParser::ParseRepeatStatement( std::string& userHandlerName, CParseTree& pa
 			stepSize = -1;
 			compareOp = GREATER_THAN_EQUAL_OPERATOR_INSTR;
 			
-			CToken::GoNextToken( mFileName, tokenItty, tokens );
+			if( !GoNextToken( tokenItty, tokens ) )
+				return;
 		}
 		
 		// To:
 		if( !tokenItty->IsIdentifier( EToIdentifier ) && !tokenItty->IsIdentifier( EThroughIdentifier ) )
 		{
-			std::stringstream		errMsg;
-			errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"to\" or \"through\" here, found "
-								<< tokenItty->GetShortDescription() << ".";
-			mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-			throw std::runtime_error( errMsg.str() );
+			ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"to\" or \"through\" here, found %t.", *tokenItty ) );
+			return;
 		}
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
 		
 		// endNum:
 		CValueNode*		endNumExpr = ParseExpression( parseTree, currFunction, tokenItty, tokens );
-		std::string		tempName = CVariableEntry::GetNewTempName();
-		currFunction->AddLocalVar( tempName, tempName, TVariantTypeInt );
+		if( HadError() )
+			return;
+		std::string		tempName = GetNewTempName();
+		CSymbolID		tempSymbol = parseTree.GetSymbols().SymbolForString( tempName );
+		currFunction->AddLocalVar( tempSymbol, tempName, TVariantTypeInt );
 		
-		CWhileLoopNode*		whileLoop = new CWhileLoopNode( &parseTree, conditionLineNum, currFunction );
+		CWhileLoopNode*		whileLoop = new( &parseTree ) CWhileLoopNode( &parseTree, conditionLineNum, currFunction );
 		
 		// tempName = startNum;
-		CCommandNode*	theAssignCommand = new CAssignCommandNode( &parseTree, conditionLineNum );
-		theAssignCommand->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempName, tempName) );
+		CCommandNode*	theAssignCommand = new( &parseTree ) CAssignCommandNode( &parseTree, conditionLineNum );
+		theAssignCommand->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempSymbol, tempName) );
 		theAssignCommand->AddParam( startNumExpr );
 		currFunction->AddCommand( theAssignCommand );
 		
 		// while( tempName <= endNum )
-		COperatorNode*	theComparison = new COperatorNode( &parseTree, compareOp, conditionLineNum );
-		theComparison->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempName, tempName) );
+		COperatorNode*	theComparison = new( &parseTree ) COperatorNode( &parseTree, compareOp, conditionLineNum );
+		theComparison->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempSymbol, tempName) );
 		theComparison->AddParam( endNumExpr );
 		whileLoop->SetCondition( theComparison );
 		
 		// counterVarName = tempName;
-		theAssignCommand = new CPutCommandNode( &parseTree, conditionLineNum );
-		theAssignCommand->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempName, tempName) );
-		theAssignCommand->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, counterVarName, counterVarName) );
+		theAssignCommand = new( &parseTree ) CPutCommandNode( &parseTree, conditionLineNum );
+		theAssignCommand->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempSymbol, tempName) );
+		theAssignCommand->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, counterVarName, realCounterVarName) );
 		whileLoop->AddCommand( theAssignCommand );
 		
 		do
@@ -1432,36 +2046,41 @@ void	CParser::ParseRepeatStatement( std::string& userHandlerName, CParseTree& pa
 			//	make sure we eliminate that case beforehand.
 			
 			while( tokenItty != tokens.end() && tokenItty->IsIdentifier( ENewlineOperator) )
-				CToken::GoNextToken( mFileName, tokenItty, tokens );
+				GoNextToken( tokenItty, tokens );
 			
 			if( tokenItty == tokens.end() || tokenItty->IsIdentifier( EEndIdentifier ) )
 				break;
 			
 			ParseOneLine( userHandlerName, parseTree, whileLoop, tokenItty, tokens );
+			if( HadError() )
+				return;
 		}
 		while( true );
 		
 		// tempName += 1;
-		CAddCommandNode	*	theIncrementOperation = new CAddCommandNode( &parseTree, tokenItty->mLineNum );
-		theIncrementOperation->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempName, tempName) );
-		theIncrementOperation->AddParam( new CIntValueNode(&parseTree, stepSize) );
-		whileLoop->AddCommand( theIncrementOperation );	// TODO: Need to dispose this on exceptions above.
+		CAddCommandNode	*	theIncrementOperation = new( &parseTree ) CAddCommandNode( &parseTree, tokenItty->mLineNum );
+		theIncrementOperation->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempSymbol, tempName) );
+		theIncrementOperation->AddParam( new( &parseTree ) CIntValueNode(&parseTree, stepSize) );
+		whileLoop->AddCommand( theIncrementOperation );
 		
 		currFunction->AddCommand( whileLoop );
 		
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
-		tokenItty->ExpectIdentifier( mFileName, ERepeatIdentifier, EEndIdentifier );
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
+		if( !ExpectIdentifier( tokenItty, ERepeatIdentifier, EEndIdentifier ) )
+			return;
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
 	}
 	else
 	{
 		// [for] ?
 		if( tokenItty->IsIdentifier( EForIdentifier ) )
 		{
-			CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "for".
+			GoNextToken( tokenItty, tokens );	// Skip "for".
 			if( tokenItty->IsIdentifier( EEachIdentifier ) )
 			{
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "each".
+				GoNextToken( tokenItty, tokens );	// Skip "each".
 				ParseRepeatForEachStatement( userHandlerName, parseTree,
 											currFunction, tokenItty, tokens );
 				return;
@@ -1469,99 +2088,118 @@ void	CParser::ParseRepeatStatement( std::string& userHandlerName, CParseTree& pa
 		}
 		
 		// tempName = 0;
-		std::string			tempName = CVariableEntry::GetNewTempName();
-		CCommandNode*		theAssignCommand = new CAssignCommandNode( &parseTree, conditionLineNum );
-		theAssignCommand->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempName, tempName) );
-		theAssignCommand->AddParam( new CIntValueNode(&parseTree, 0) );
+		std::string			tempName = GetNewTempName();
+		CSymbolID			tempSymbol = parseTree.GetSymbols().SymbolForString( tempName );
+		CCommandNode*		theAssignCommand = new( &parseTree ) CAssignCommandNode( &parseTree, conditionLineNum );
+		theAssignCommand->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempSymbol, tempName) );
+		theAssignCommand->AddParam( new( &parseTree ) CIntValueNode(&parseTree, 0) );
 		currFunction->AddCommand( theAssignCommand );
 		
 		// countNum:
 		CValueNode*		countExpression = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+		if( HadError() )
+			return;
 		
 		// [times] ?
 		if( tokenItty->IsIdentifier( ETimesIdentifier ) )
-			CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "times".
+			GoNextToken( tokenItty, tokens );	// Skip "times".
 		
-		CWhileLoopNode*		whileLoop = new CWhileLoopNode( &parseTree, conditionLineNum, currFunction );
+		CWhileLoopNode*		whileLoop = new( &parseTree ) CWhileLoopNode( &parseTree, conditionLineNum, currFunction );
 		currFunction->AddCommand( whileLoop );
 		
 		// while( tempName < countExpression )
-		COperatorNode*	theComparison = new COperatorNode( &parseTree, LESS_THAN_OPERATOR_INSTR, conditionLineNum );
-		theComparison->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempName, tempName) );
+		COperatorNode*	theComparison = new( &parseTree ) COperatorNode( &parseTree, LESS_THAN_OPERATOR_INSTR, conditionLineNum );
+		theComparison->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempSymbol, tempName) );
 		theComparison->AddParam( countExpression );
 		whileLoop->SetCondition( theComparison );
 
 		while( !tokenItty->IsIdentifier( EEndIdentifier ) )
 		{
 			ParseOneLine( userHandlerName, parseTree, whileLoop, tokenItty, tokens );
+			if( HadError() )
+				return;
 		}
 		
 		// tempName += 1;
-		CAddCommandNode	*	theIncrementOperation = new CAddCommandNode( &parseTree, tokenItty->mLineNum );
-		theIncrementOperation->AddParam( new CLocalVariableRefValueNode(&parseTree, currFunction, tempName, tempName) );
-		theIncrementOperation->AddParam( new CIntValueNode(&parseTree, 1) );
+		CAddCommandNode	*	theIncrementOperation = new( &parseTree ) CAddCommandNode( &parseTree, tokenItty->mLineNum );
+		theIncrementOperation->AddParam( new( &parseTree ) CLocalVariableRefValueNode(&parseTree, currFunction, tempSymbol, tempName) );
+		theIncrementOperation->AddParam( new( &parseTree ) CIntValueNode(&parseTree, 1) );
 		whileLoop->AddCommand( theIncrementOperation );
 		
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
-		tokenItty->ExpectIdentifier( mFileName, ERepeatIdentifier, EEndIdentifier );
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
+		if( !ExpectIdentifier( tokenItty, ERepeatIdentifier, EEndIdentifier ) )
+			return;
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
 	}
 }
 
 
-void	CParser::ParseIfStatement( std::string& userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+void	CParser::ParseIfStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens )
 {
 	size_t			conditionLineNum = tokenItty->mLineNum;
-	CIfNode*		ifNode = new CIfNode( &parseTree, conditionLineNum, currFunction );
+	CIfNode*		ifNode = new( &parseTree ) CIfNode( &parseTree, conditionLineNum, currFunction );
 	
 	// If:
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	GoNextToken( tokenItty, tokens );
 	
 	// Condition:
 	CValueNode*			condition = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
 	ifNode->SetCondition( condition );
 	
 	while( tokenItty->IsIdentifier(ENewlineOperator) )
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		GoNextToken( tokenItty, tokens );
 	
 	// Then:
-	tokenItty->ExpectIdentifier( mFileName, EThenIdentifier );
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	if( !ExpectIdentifier( tokenItty, EThenIdentifier ) )
+		return;
+	if( !GoNextToken( tokenItty, tokens ) )
+		return;
 	
 	bool	needEndIf = true;
 	
 	if( tokenItty->IsIdentifier( ENewlineOperator ) )
 	{
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		GoNextToken( tokenItty, tokens );
 		// Commands:
 		while( !tokenItty->IsIdentifier( EEndIdentifier ) && !tokenItty->IsIdentifier( EElseIdentifier ) )
 		{
 			ParseOneLine( userHandlerName, parseTree, ifNode, tokenItty, tokens );
+			if( HadError() )
+				return;
 		}
 	}
 	else
 	{
 		ParseOneLine( userHandlerName, parseTree, ifNode, tokenItty, tokens, true );
+		if( HadError() )
+			return;
 		needEndIf = false;
 	}
 	
 	while( tokenItty->IsIdentifier(ENewlineOperator) )
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		GoNextToken( tokenItty, tokens );
 	
 	// Else:
 	if( tokenItty->IsIdentifier( EElseIdentifier ) )	// It's an "else"! Parse another block!
 	{
 		CCodeBlockNode*		elseNode = ifNode->CreateElseBlock( tokenItty->mLineNum );
 		
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
 		
 		if( tokenItty->IsIdentifier(ENewlineOperator) )	// Followed by a newline! Multi-line if!
 		{
-			CToken::GoNextToken( mFileName, tokenItty, tokens );
+			GoNextToken( tokenItty, tokens );
 			while( !tokenItty->IsIdentifier( EEndIdentifier ) )
 			{
 				ParseOneLine( userHandlerName, parseTree, elseNode, tokenItty, tokens );
+				if( HadError() )
+					return;
 			}
 			needEndIf = true;
 		}
@@ -1569,53 +2207,59 @@ void	CParser::ParseIfStatement( std::string& userHandlerName, CParseTree& parseT
 		{
 			ParseOneLine( userHandlerName, parseTree, elseNode, tokenItty, tokens, true );	// Don't swallow return.
 			needEndIf = false;
+			if( HadError() )
+				return;
 		}
 	}
 	
 	// End If:
 	if( needEndIf && tokenItty->IsIdentifier( EEndIdentifier ) )
 	{
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		GoNextToken( tokenItty, tokens );
 		if( !tokenItty->IsIdentifier(EIfIdentifier) )
 		{
-			std::stringstream		errMsg;
-			errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"end if\" here, found "
-									<< tokenItty->GetShortDescription() << ".";
-			mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-			throw std::runtime_error( errMsg.str() );
+			ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"end if\" here, found %t.", *tokenItty ) );
+			return;
 		}
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		GoNextToken( tokenItty, tokens );
 	}
 	
-	currFunction->AddCommand( ifNode );	// TODO: delete ifNode on exceptions above, and condition before it's added to ifNode etc.
+	currFunction->AddCommand( ifNode );
 }
 
 
 CValueNode*	CParser::ParseArrayItem( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-								std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+								CTokenCursor& tokenItty, CTokenList& tokens )
 {
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	if( !GoNextToken( tokenItty, tokens ) )
+		return NULL;
 	
 	// itemNumber:
 	CValueNode*	theIndex = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return NULL;
 	
 	// of:
-	tokenItty->ExpectIdentifier( mFileName, EOfIdentifier );
-	CToken::GoNextToken( mFileName, tokenItty, tokens );
+	if( !ExpectIdentifier( tokenItty, EOfIdentifier ) )
+		return NULL;
+	if( !GoNextToken( tokenItty, tokens ) )
+		return NULL;
 	
 	// container:
 	size_t				containerLineNum = tokenItty->mLineNum;
 	CValueNode*			theTarget = ParseContainer( false, true, parseTree, currFunction, tokenItty, tokens );
-	CFunctionCallNode*	fcall = new CFunctionCallNode( &parseTree, true, "GetItemOfListWithKey", containerLineNum );
+	if( HadError() )
+		return NULL;
+	CFunctionCallNode*	fcall = new( &parseTree ) CFunctionCallNode( &parseTree, true, "GetItemOfListWithKey", containerLineNum );
 	fcall->AddParam( theTarget );
 	fcall->AddParam( theIndex );
 	
-	return fcall;	// TODO: delete stuff on exceptions before this.
+	return fcall;
 }
 
 
 CValueNode*	CParser::ParseContainer( bool asPointer, bool initWithName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-								std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+								CTokenCursor& tokenItty, CTokenList& tokens )
 {
 	// Try to find chunk type that matches:
 	CValueNode*	container = NULL;
@@ -1629,9 +2273,10 @@ CValueNode*	CParser::ParseContainer( bool asPointer, bool initWithName, CParseTr
 	// Try if it is a "my <property>"-style property expression:
 	if( tokenItty->IsIdentifier( EMyIdentifier ) )
 	{
-		COperatorNode*		meContainer = new COperatorNode( &parseTree, kFirstPropertyInstruction +PUSH_ME_INSTR, tokenItty->mLineNum );
+		COperatorNode*		meContainer = new( &parseTree ) COperatorNode( &parseTree, kFirstPropertyInstruction +PUSH_ME_INSTR, tokenItty->mLineNum );
 		
-		CToken::GoNextToken( mFileName, tokenItty, tokens );	// skip "my".
+		if( !GoNextToken( tokenItty, tokens ) )	// skip "my".
+			return NULL;
 		
 		// Look for long/abbreviated/short style qualifier:
 		std::string		propName;
@@ -1641,72 +2286,87 @@ CValueNode*	CParser::ParseContainer( bool asPointer, bool initWithName, CParseTr
 			propName = tokenItty->GetIdentifierText();
 			propName.append( 1, ' ' );
 			
-			CToken::GoNextToken( mFileName, tokenItty, tokens );	// Advance past style qualifier.
+			if( !GoNextToken( tokenItty, tokens ) )	// Advance past style qualifier.
+				return NULL;
 		}
 		
 		// Look for actual property name:
+		if( !ExpectIdentifierToken( tokenItty ) )
+			return NULL;
 		propName.append( tokenItty->GetIdentifierText() );
-		CObjectPropertyNode	*	propExpr = new CObjectPropertyNode( &parseTree, propName, tokenItty->mLineNum );
+		CObjectPropertyNode	*	propExpr = new( &parseTree ) CObjectPropertyNode( &parseTree, propName, tokenItty->mLineNum );
 		propExpr->AddParam( meContainer );
 
-		CToken::GoNextToken( mFileName, tokenItty, tokens );	// skip property name.
+		if( !GoNextToken( tokenItty, tokens ) )	// skip property name.
+			return NULL;
 		
 		return propExpr;
 	}
 	else if( tokenItty->IsIdentifier( EMeIdentifier ) )	// A reference to the object owning this script?
 	{
-		COperatorNode*		hostCommand = new COperatorNode( &parseTree, kFirstPropertyInstruction +PUSH_ME_INSTR, tokenItty->mLineNum );
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		COperatorNode*		hostCommand = new( &parseTree ) COperatorNode( &parseTree, kFirstPropertyInstruction +PUSH_ME_INSTR, tokenItty->mLineNum );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return NULL;
 		return hostCommand;
 	}
 	
 	// If we know we have a variable of that name, choose that:
+	if( !ExpectIdentifierToken( tokenItty ) )
+		return NULL;
 	std::string		realVarName( tokenItty->GetIdentifierText() );
-	std::string		varName( "var_" );
-	varName.append( realVarName );
+	CSymbolID		varName = parseTree.GetSymbols().VariableSymbolForSymbol( tokenItty->GetIdentifierSymbol() );
 	if( !container && currFunction->LocalVariableExists( varName ) )
 	{
 		CreateVariable( varName, realVarName, initWithName, currFunction );
-		container = new CLocalVariableRefValueNode( &parseTree, currFunction, varName, realVarName );
+		container = new( &parseTree ) CLocalVariableRefValueNode( &parseTree, currFunction, varName, realVarName );
 		
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return NULL;
 		
 		return container;
 	}
 	
 	// Try to parse a host-specific function (e.g. object descriptor):
 	container = ParseHostFunction( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return NULL;
 	if( container )
 		return container;
 
 	// Otherwise try to parse a built-in variable:
 	if( tokenItty->IsIdentifier( ETheIdentifier ) )
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		GoNextToken( tokenItty, tokens );
 	
 	if( tokenItty->IsIdentifier( EResultIdentifier ) )
 	{
 		std::string		realVarName( "result" );
-		std::string		varName( "result" );
+		CSymbolID		varName = parseTree.GetSymbols().SymbolForString( realVarName );
 		CreateVariable( varName, realVarName, initWithName, currFunction );
-		container = new CLocalVariableRefValueNode( &parseTree, currFunction, varName, realVarName );
+		container = new( &parseTree ) CLocalVariableRefValueNode( &parseTree, currFunction, varName, realVarName );
 		
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return NULL;
 	}
 	
 	// Check if it could be an object property expression:
 	if( !container )
 	{
+		if( !ExpectIdentifierToken( tokenItty ) )
+			return NULL;
 		size_t				lineNum = tokenItty->mLineNum;
 		std::string			propName = tokenItty->GetIdentifierText();
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return NULL;
 		if( tokenItty->IsIdentifier( EOfIdentifier ) )
 		{
-			CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "of".
+			GoNextToken( tokenItty, tokens );	// Skip "of".
 			CValueNode	*	targetObj = ParseTerm( parseTree, currFunction, tokenItty, tokens );
+			if( HadError() )
+				return NULL;
 			
 			if( targetObj )
 			{
-				CObjectPropertyNode	*	propExpr = new CObjectPropertyNode( &parseTree, propName, lineNum );
+				CObjectPropertyNode	*	propExpr = new( &parseTree ) CObjectPropertyNode( &parseTree, propName, lineNum );
 				propExpr->AddParam( targetObj );
 				container = propExpr;
 			}
@@ -1719,17 +2379,12 @@ CValueNode*	CParser::ParseContainer( bool asPointer, bool initWithName, CParseTr
 	// Check if it could be a global property expression:
 	if( !container )
 	{
-		// Find it in our list of global properties:
-		int				x = 0;
-		
-		for( x = 0; sGlobalProperties[x].mType != ELastIdentifier_Sentinel; x++ )
+		const TGlobalPropertyEntry*	globalProperty = mContext->GlobalPropertyForType( tokenItty->GetIdentifierSubType() );
+		if( globalProperty )
 		{
-			if( sGlobalProperties[x].mType == tokenItty->GetIdentifierSubType() )
-			{
-				container = new CGlobalPropertyNode( &parseTree, sGlobalProperties[x].mSetterInstructionID, sGlobalProperties[x].mGetterInstructionID, tokenItty->mLineNum );
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip the property name.
-				break;
-			}
+			container = new( &parseTree ) CGlobalPropertyNode( &parseTree, globalProperty->mSetterInstructionID, globalProperty->mGetterInstructionID, tokenItty->mLineNum );
+			if( !GoNextToken( tokenItty, tokens ) )	// Skip the property name.
+				return NULL;
 		}
 	}
 	
@@ -1737,20 +2392,21 @@ CValueNode*	CParser::ParseContainer( bool asPointer, bool initWithName, CParseTr
 	if( !container )
 	{
 		CreateVariable( varName, realVarName, initWithName, currFunction );
-		container = new CLocalVariableRefValueNode( &parseTree, currFunction, varName, realVarName );
+		container = new( &parseTree ) CLocalVariableRefValueNode( &parseTree, currFunction, varName, realVarName );
 		
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return NULL;
 	}
 	
 	return container;
 }
 
 
-void	CParser::CreateVariable( const std::string& varName, const std::string& realVarName, bool initWithName,
+void	CParser::CreateVariable( CSymbolID varName, const std::string& realVarName, bool initWithName,
 									CCodeBlockNodeBase* currFunction, bool isGlobal )
 {
-	std::map<std::string,CVariableEntry>::iterator	theContainerItty;
-	std::map<std::string,CVariableEntry>*			varMap;
+	std::map<CSymbolID,CVariableEntry>::iterator	theContainerItty;
+	std::map<CSymbolID,CVariableEntry>*			varMap;
 	
 	if( isGlobal )
 		varMap = &currFunction->GetGlobals();
@@ -1764,141 +2420,141 @@ void	CParser::CreateVariable( const std::string& varName, const std::string& rea
 }
 
 
-void	CParser::ParseOneLine( std::string& userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-								std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens,
+void	CParser::ParseDeleteStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens )
+{
+	GoNextToken( tokenItty, tokens );	// Skip "delete".
+	
+	CValueNode*	theContainer = ParseContainer( false, false, parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
+	CFunctionCallNode*	theFCall = new( &parseTree ) CFunctionCallNode( &parseTree, true, "Delete", tokenItty->mLineNum );
+	theFCall->AddParam( theContainer );
+	currFunction->AddCommand( theFCall );
+}
+
+
+void	CParser::ParseExitStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens )
+{
+	GoNextToken( tokenItty, tokens );	// Skip "exit".
+	if( tokenItty->IsIdentifier(ERepeatIdentifier) )
+	{
+		CCommandNode*	theExitRepeatCommand = new( &parseTree ) CCommandNode( &parseTree, "ExitRepeat", tokenItty->mLineNum );
+		currFunction->AddCommand( theExitRepeatCommand );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
+	}
+	else if( tokenItty->mType == EIdentifierToken && tokenItty->GetIdentifierSymbol() == userHandlerName )
+	{
+		CCommandNode*	theReturnCommand = new( &parseTree ) CReturnCommandNode( &parseTree, tokenItty->mLineNum );
+		currFunction->AddCommand( theReturnCommand );
+		theReturnCommand->AddParam( new( &parseTree ) CStringValueNode(&parseTree, "") );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
+	}
+	else
+	{
+		ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"exit repeat\" or \"exit %s\", found %t.", *tokenItty, ELastIdentifier_Sentinel, parseTree.GetSymbols().TextForSymbol( userHandlerName ) ) );
+		return;
+	}
+}
+
+
+void	CParser::ParseNextStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens )
+{
+	GoNextToken( tokenItty, tokens );	// Skip "next".
+	if( tokenItty->IsIdentifier(ERepeatIdentifier) )
+	{
+		CCommandNode*	theNextRepeatCommand = new( &parseTree ) CCommandNode( &parseTree, "NextRepeat", tokenItty->mLineNum );
+		currFunction->AddCommand( theNextRepeatCommand );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
+	}
+	else
+	{
+		ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"next repeat\", found %t.", *tokenItty ) );
+		return;
+	}
+}
+
+
+void	CParser::ParseOneLine( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+								CTokenCursor& tokenItty, CTokenList& tokens,
 								bool dontSwallowReturn )
 {
 	while( tokenItty->IsIdentifier(ENewlineOperator) )
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		GoNextToken( tokenItty, tokens );
 	
-	CLineMarkerNode*	lineMarker = new CLineMarkerNode( &parseTree, tokenItty->mLineNum );
+	CLineMarkerNode*	lineMarker = new( &parseTree ) CLineMarkerNode( &parseTree, tokenItty->mLineNum );
 	currFunction->AddCommand( lineMarker );
 	
 	if( tokenItty->mType == EIdentifierToken && tokenItty->mSubType == ELastIdentifier_Sentinel )	// Unknown identifier.
 		ParseHandlerCall( parseTree, currFunction, false, tokenItty, tokens );
-	else if( tokenItty->IsIdentifier(EPutIdentifier) )		// put command.
-		ParsePutStatement( parseTree, currFunction, tokenItty, tokens );
-	else if( tokenItty->IsIdentifier(EDeleteIdentifier) )	// delete command.
-	{
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
-		
-		CValueNode*	theContainer = ParseContainer( false, false, parseTree, currFunction, tokenItty, tokens );
-		CFunctionCallNode*	theFCall = new CFunctionCallNode( &parseTree, true, "Delete", tokenItty->mLineNum );
-		theFCall->AddParam( theContainer );
-		currFunction->AddCommand( theFCall );
-	}
-	else if( tokenItty->IsIdentifier(EReturnIdentifier) )
-		ParseReturnStatement( parseTree, currFunction, tokenItty, tokens );
-	else if( tokenItty->IsIdentifier(EPassIdentifier) )
-		ParsePassStatement( parseTree, currFunction, tokenItty, tokens );
-	else if( tokenItty->IsIdentifier(EExitIdentifier) )
-	{
-		CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "exit".
-		if( tokenItty->IsIdentifier(ERepeatIdentifier) )
-		{
-			CCommandNode*	theExitRepeatCommand = new CCommandNode( &parseTree, "ExitRepeat", tokenItty->mLineNum );
-			currFunction->AddCommand( theExitRepeatCommand );
-			CToken::GoNextToken( mFileName, tokenItty, tokens );
-		}
-		else if( tokenItty->GetIdentifierText().compare(userHandlerName) == 0 )
-		{
-			CCommandNode*	theReturnCommand = new CReturnCommandNode( &parseTree, tokenItty->mLineNum );
-			currFunction->AddCommand( theReturnCommand );
-			theReturnCommand->AddParam( new CStringValueNode(&parseTree, "") );
-			CToken::GoNextToken( mFileName, tokenItty, tokens );
-		}
-		else
-		{
-			std::stringstream errMsg;
-			errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"exit repeat\" or \"exit " << userHandlerName << "\", found "
-					<< tokenItty->GetShortDescription() << ".";
-			mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-			throw std::runtime_error( errMsg.str() );
-		}
-	}
-	else if( tokenItty->IsIdentifier(ENextIdentifier) )
+	else
 	{
-		CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "next".
-		if( tokenItty->IsIdentifier(ERepeatIdentifier) )
+		TStatementParserProc	hostParser = NULL;
+		TStatementParser		builtInParser = NULL;
+		if( tokenItty->mType == EIdentifierToken )
 		{
-			CCommandNode*	theNextRepeatCommand = new CCommandNode( &parseTree, "NextRepeat", tokenItty->mLineNum );
-			currFunction->AddCommand( theNextRepeatCommand );
-			CToken::GoNextToken( mFileName, tokenItty, tokens );
+			hostParser = mContext->StatementParserForType( tokenItty->GetIdentifierSubType() );
+			builtInParser = sStatementParsers[tokenItty->GetIdentifierSubType()].mParser;
 		}
+		
+		if( hostParser )
+			hostParser( *this, userHandlerName, parseTree, currFunction, tokenItty, tokens );
+		else if( builtInParser )
+			(this->*builtInParser)( userHandlerName, parseTree, currFunction, tokenItty, tokens );
 		else
-		{
-			std::stringstream errMsg;
-			errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"next repeat\", found "
-					<< tokenItty->GetShortDescription() << ".";
-			mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-			throw std::runtime_error( errMsg.str() );
-		}
+			ParseHostCommand( parseTree, currFunction, tokenItty, tokens );
 	}
-	else if( tokenItty->IsIdentifier(ERepeatIdentifier) )
-		ParseRepeatStatement( userHandlerName, parseTree, currFunction, tokenItty, tokens );
-	else if( tokenItty->IsIdentifier(EIfIdentifier) )
-		ParseIfStatement( userHandlerName, parseTree, currFunction, tokenItty, tokens );
-	else if( tokenItty->IsIdentifier(EAddIdentifier) )
-		ParseAddStatement( parseTree, currFunction, tokenItty, tokens );
-	else if( tokenItty->IsIdentifier(ESubtractIdentifier) )
-		ParseSubtractStatement( parseTree, currFunction, tokenItty, tokens );
-	else if( tokenItty->IsIdentifier(EMultiplyIdentifier) )
-		ParseMultiplyStatement( parseTree, currFunction, tokenItty, tokens );
-	else if( tokenItty->IsIdentifier(EDivideIdentifier) )
-		ParseDivideStatement( parseTree, currFunction, tokenItty, tokens );
-	else if( tokenItty->IsIdentifier(EGetIdentifier) )
-		ParseGetStatement( parseTree, currFunction, tokenItty, tokens );
-	else if( tokenItty->IsIdentifier(ESetIdentifier) )
-		ParseSetStatement( parseTree, currFunction, tokenItty, tokens );
-	else if( tokenItty->IsIdentifier(EGlobalIdentifier) )
-		ParseGlobalStatement( parseTree, currFunction, tokenItty, tokens );
-	else
-		ParseHostCommand( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return;
 	
 	// End this line:
 	if( !dontSwallowReturn && tokenItty != tokens.end() )
 	{
 		if( !tokenItty->IsIdentifier(ENewlineOperator) )
 		{
-			std::stringstream errMsg;
-			errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected end of line, found "
-					<< tokenItty->GetShortDescription() << ".";
-			mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-			throw std::runtime_error( errMsg.str() );
+			ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected end of line, found %t.", *tokenItty ) );
+			return;
 		}
 			
 		while( tokenItty->IsIdentifier(ENewlineOperator) )
-			CToken::GoNextToken( mFileName, tokenItty, tokens );
+			GoNextToken( tokenItty, tokens );
 	}
 }
 
 
-void	CParser::ParseFunctionBody( std::string& userHandlerName,
+void	CParser::ParseFunctionBody( CSymbolID userHandlerName,
 									CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-									std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens,
+									CTokenCursor& tokenItty, CTokenList& tokens,
 								    size_t *outEndLineNum, TIdentifierSubtype endIdentifier )
 {
 	while( tokenItty != tokens.end()
 			&& !tokenItty->IsIdentifier( endIdentifier ) )	// Sub-constructs will swallow their own "end XXX" instructions, so we can exit the loop. Either it's our "end", or it's unbalanced.
 	{
 		ParseOneLine( userHandlerName, parseTree, currFunction, tokenItty, tokens );
+		if( HadError() )
+			return;
 	}
 	
 	if( tokenItty != tokens.end() )
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		GoNextToken( tokenItty, tokens );
 	
 	if( endIdentifier == EEndIdentifier && tokenItty != tokens.end() )
 	{
-		if( tokenItty->GetIdentifierText().compare(userHandlerName) != 0 )
+		if( !ExpectIdentifierToken( tokenItty ) )
+			return;
+		if( tokenItty->GetIdentifierSymbol() != userHandlerName )
 		{
-			std::stringstream		errMsg;
-			errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"end " << userHandlerName << "\" here, found "
-									<< tokenItty->GetShortDescription() << ".";
-			mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-			throw std::runtime_error( errMsg.str() );
+			ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"end %s\" here, found %t.", *tokenItty, ELastIdentifier_Sentinel, parseTree.GetSymbols().TextForSymbol( userHandlerName ) ) );
+			return;
 		}
 		if( outEndLineNum ) *outEndLineNum = tokenItty->mLineNum;
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
 	}
 }
 
@@ -1906,7 +2562,7 @@ void	CParser::ParseFunctionBody( std::string& userHandlerName,
 // Parse a list of expressions separated by commas for passing to a handler as a parameter list:
 void	CParser::ParseParamList( TIdentifierSubtype identifierToEndOn,
 								CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-								std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens,
+								CTokenCursor& tokenItty, CTokenList& tokens,
 								CFunctionCallNode* inFCallToAddTo )
 {
 	if( tokenItty == tokens.end() )
@@ -1914,6 +2570,8 @@ void	CParser::ParseParamList( TIdentifierSubtype identifierToEndOn,
 	while( !tokenItty->IsIdentifier( identifierToEndOn ) )
 	{
 		CValueNode*		paramExpression = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+		if( HadError() )
+			return;
 		if( !paramExpression )
 			return;
 		inFCallToAddTo->AddParam( paramExpression );
@@ -1925,148 +2583,113 @@ void	CParser::ParseParamList( TIdentifierSubtype identifierToEndOn,
 		{
 			if( tokenItty->IsIdentifier( identifierToEndOn ) )
 				break;	// Exit loop.
-			std::stringstream		errMsg;
-			errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected comma here, found \""
-									<< tokenItty->GetShortDescription() << "\".";
-			mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-			throw std::runtime_error( errMsg.str() );
+			ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected comma here, found \"%t\".", *tokenItty ) );
+			return;
 		}
-		CToken::GoNextToken( mFileName, tokenItty, tokens );
+		if( !GoNextToken( tokenItty, tokens ) )
+			return;
 	}
 }
 
 
-TIdentifierSubtype	CParser::ParseOperator( std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens, int *outPrecedence, LEOInstructionID *outOpName )
+// -----------------------------------------------------------------------------
+//	PeekOperator ():
+//		If the token(s) at tokenItty form a binary operator, return how many
+//		tokens it consists of, and its precedence and instruction. Returns 0
+//		if there's no operator here. Doesn't move tokenItty, so the caller can
+//		decide whether it wants this operator before consuming it.
+// -----------------------------------------------------------------------------
+
+size_t	CParser::PeekOperator( CTokenCursor& tokenItty, int *outPrecedence, LEOInstructionID *outOpName )
 {
 	if( tokenItty->mType != EIdentifierToken )
-		return ELastIdentifier_Sentinel;
+		return 0;
 	
-	int		x = 0;
-	for( ; sOperators[x].mType != ELastIdentifier_Sentinel; x++ )
+	const TOperatorLookupEntry&	entry = sOperatorLookup[tokenItty->GetIdentifierSubType()];
+	if( entry.mFollowers[0].mSecondType != ELastIdentifier_Sentinel )	// Could be a two-token operator?
 	{
-		if( tokenItty->IsIdentifier( sOperators[x].mType ) )
+		CToken	nextToken = tokenItty.PeekToken( 1 );
+		for( size_t x = 0; x < MAX_OPERATOR_FOLLOWERS && entry.mFollowers[x].mSecondType != ELastIdentifier_Sentinel; x++ )
 		{
-			CToken::GoNextToken( mFileName, tokenItty, tokens );
-			
-			// Is single-token operator and matches?
-			if( sOperators[x].mSecondType == ELastIdentifier_Sentinel )
+			if( nextToken.IsIdentifier( entry.mFollowers[x].mSecondType ) )
 			{
-				*outPrecedence = sOperators[x].mPrecedence;
-				*outOpName = sOperators[x].mInstructionID;
-				
-				return sOperators[x].mTypeToReturn;
-			}
-			else if( tokenItty->IsIdentifier(sOperators[x].mSecondType) )
-			{
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Swallow second operator token, too.
-				*outPrecedence = sOperators[x].mPrecedence;
-				*outOpName = sOperators[x].mInstructionID;
-				
-				return sOperators[x].mTypeToReturn;
+				*outPrecedence = entry.mFollowers[x].mPrecedence;
+				*outOpName = entry.mFollowers[x].mInstructionID;
+				return 2;
 			}
-			else
-				CToken::GoPrevToken( mFileName, tokenItty, tokens );	// Backtrack so we don't accidentally swallow the token following this operator.
 		}
 	}
 	
-	return ELastIdentifier_Sentinel;
+	if( entry.mPrecedence == 0 )	// Not an operator on its own.
+		return 0;
+	
+	*outPrecedence = entry.mPrecedence;
+	*outOpName = entry.mInstructionID;
+	return 1;
 }
 
 
 // -----------------------------------------------------------------------------
-//	CollapseExpressionStack ():
-//		Take the passed lists of terms and operators and go over them from
-//		the right end, generating a function call for the rightmost operator/two
-//		terms combination and than pushing that call back on the tree for use
-//		as the rightmost argument of the next operator.
+//	ParseExpression ():
+//		Parse an expression from the given token stream, adding any variables
+//		and commands needed to the given function.
 // -----------------------------------------------------------------------------
 
-CValueNode*	CParser::CollapseExpressionStack( CParseTree& parseTree, std::deque<CValueNode*> &terms, std::deque<LEOInstructionID> &operators )
+CValueNode*	CParser::ParseExpression( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty,
+										CTokenList& tokens )
 {
-	CValueNode*			operandA = NULL;
-	LEOInstructionID	opName = NULL;
-
-	while( terms.size() > 1 )	// More than 1 operand? Process stuff on stack.
-	{
-		CValueNode*			operandB = NULL;
-		
-		opName = operators.back();
-		operators.pop_back();
-		
-		operandB = terms.back();
-		terms.pop_back();
-		
-		operandA = terms.back();
-		terms.pop_back();
-		
-		COperatorNode*	currOperation = new COperatorNode( &parseTree, opName, operandA->GetLineNum() );
-		currOperation->AddParam( operandA );
-		currOperation->AddParam( operandB );
-		
-		terms.push_back( currOperation );
-	}
-	
-	operandA = terms.back();
-	terms.pop_back();
+	if( tokenItty == tokens.end() )
+		return NULL;
 	
-	return operandA;
+	return ParseExpressionAbovePrecedence( 0, parseTree, currFunction, tokenItty, tokens );
 }
 
 
 // -----------------------------------------------------------------------------
-//	ParseExpression ():
-//		Parse an expression from the given token stream, adding any variables
-//		and commands needed to the given function. This uses a stack to collect
-//		all terms and operators, and collapses subexpressions whenever the
-//		operator precedence goes down.
+//	ParseExpressionAbovePrecedence ():
+//		Precedence climbing: Parse a term, then keep combining it with the
+//		operators that follow as long as they bind tighter than
+//		inMinPrecedence. The right-hand side of each operator is parsed by
+//		recursing with that operator's precedence, so it swallows only the
+//		operators that bind tighter than it, and operators of equal
+//		precedence associate to the left ("a - b - c" is "(a - b) - c"),
+//		except for "^", which associates to the right ("a ^ b ^ c" is
+//		"a ^ (b ^ c)").
 // -----------------------------------------------------------------------------
 
-CValueNode*	CParser::ParseExpression( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty,
-										std::deque<CToken>& tokens )
+CValueNode*	CParser::ParseExpressionAbovePrecedence( int inMinPrecedence, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens )
 {
-	if( tokenItty == tokens.end() )
+	CValueNode*			leftSide = ParseTerm( parseTree, currFunction, tokenItty, tokens );
+	if( !leftSide || HadError() )
 		return NULL;
 	
-	std::deque<CValueNode*>			terms;
-	std::deque<LEOInstructionID>	operators;
-	CValueNode*						currArg;
-	TIdentifierSubtype				currOpType = ELastIdentifier_Sentinel;
-	int								currPrecedence = 0,
-									prevPrecedence = 0;
-	LEOInstructionID				opName = INVALID_INSTR;
-	
-	currArg = ParseTerm( parseTree, currFunction, tokenItty, tokens );
-	if( !currArg )
-		return NULL;
-	terms.push_back( currArg );
-	currArg = NULL;
-	
-	while( (currOpType = ParseOperator( tokenItty, tokens, &currPrecedence, &opName )) != ELastIdentifier_Sentinel )
+	int					precedence = 0;
+	LEOInstructionID	opName = INVALID_INSTR;
+	size_t				numOperatorTokens = 0;
+	while( (numOperatorTokens = PeekOperator( tokenItty, &precedence, &opName )) != 0 && precedence > inMinPrecedence )
 	{
-		if( prevPrecedence > currPrecedence )
-		{
-			CValueNode*	collapsedOp = CollapseExpressionStack( parseTree, terms, operators );
-			terms.push_back( collapsedOp );
-		}
-
-		currArg = ParseTerm( parseTree, currFunction, tokenItty, tokens );
-		if( !currArg )
+		for( size_t x = 0; x < numOperatorTokens; x++ )
+			GoNextToken( tokenItty, tokens );
+		
+		int			rightPrecedence = (opName == POWER_OPERATOR_INSTR) ? (precedence -1) : precedence;	// Let the right side swallow another "^".
+		CValueNode*	rightSide = ParseExpressionAbovePrecedence( rightPrecedence, parseTree, currFunction, tokenItty, tokens );
+		if( HadError() )
+			return NULL;
+		if( !rightSide )
 		{
-			std::stringstream		errMsg;
-			errMsg << mFileName << ":0: error: Expected term here, found end of script.";
-			mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, 0 ) );
-			throw std::runtime_error( errMsg.str() );
+			ReportError( CParseError( mFileName, 0, "Expected term here, found end of script.", *tokenItty ) );
+			return NULL;
 		}
-		terms.push_back( currArg );
-		currArg = NULL;
-		
-		operators.push_back( opName );
 		
-		prevPrecedence = currPrecedence;
+		COperatorNode*	currOperation = new( &parseTree ) COperatorNode( &parseTree, opName, leftSide->GetLineNum() );
+		currOperation->AddParam( leftSide );
+		currOperation->AddParam( rightSide );
+		leftSide = currOperation;
 	}
 	
-	return CollapseExpressionStack( parseTree, terms, operators );
+	return leftSide;
 }
 
 
@@ -2227,9 +2850,10 @@ void	CParser::LoadNativeHeadersFromFile( const char* filepath )
 //	chunk expressions.
 
 CValueNode*	CParser::ParseChunkExpression( TChunkType typeConstant, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-											std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+											CTokenCursor& tokenItty, CTokenList& tokens )
 {
-	CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "char" or "item" or whatever chunk type token this was.
+	if( !GoNextToken( tokenItty, tokens ) )	// Skip "char" or "item" or whatever chunk type token this was.
+		return NULL;
 	
 	std::stringstream		valueStr;
 	std::stringstream		startOffs;
@@ -2238,6 +2862,8 @@ CValueNode*	CParser::ParseChunkExpression( TChunkType typeConstant, CParseTree&
 	
 	// Start offset:
 	CValueNode*	startOffsObj = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return NULL;
 	CValueNode*	endOffsObj = NULL;
 	
 	size_t		lineNum = tokenItty->mLineNum;
@@ -2246,31 +2872,36 @@ CValueNode*	CParser::ParseChunkExpression( TChunkType typeConstant, CParseTree&
 	if( tokenItty->IsIdentifier( EToIdentifier ) || tokenItty->IsIdentifier( EThroughIdentifier )
 		|| tokenItty->IsIdentifier( EThruIdentifier ) )
 	{
-		CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "to"/"through"/"thru".
+		if( !GoNextToken( tokenItty, tokens ) )	// Skip "to"/"through"/"thru".
+			return NULL;
 		
 		endOffsObj = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+		if( HadError() )
+			return NULL;
 		hadTo = true;
 	}
 	
 	// Target value:
 	if( !tokenItty->IsIdentifier( EOfIdentifier ) )
 	{
-		std::stringstream		errMsg;
-		errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected ";
-		if( !hadTo )
-			errMsg << "\"to\" or ";
-		errMsg << "\"of\" here, found " << tokenItty->GetShortDescription() << ".";
-		mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-		throw std::runtime_error( errMsg.str() );
+		ReportError( CParseError( mFileName, tokenItty->mLineNum, (hadTo ? "Expected \"of\" here, found %t." : "Expected \"to\" or \"of\" here, found %t."), *tokenItty ) );
+		return NULL;
 	}
-	CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "of".
+	GoNextToken( tokenItty, tokens );	// Skip "of".
 	
 	CValueNode*	targetValObj = ParseTerm( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return NULL;
+	if( !startOffsObj || !targetValObj )	// Ran off the end of the script.
+	{
+		ReportError( CParseError( mFileName, 0, "Expected term here, found end of script.", *tokenItty ) );
+		return NULL;
+	}
 	
 	// Now output code:
-	CMakeChunkRefNode*	currOperation = new CMakeChunkRefNode( &parseTree, lineNum );
+	CMakeChunkRefNode*	currOperation = new( &parseTree ) CMakeChunkRefNode( &parseTree, lineNum );
 	currOperation->AddParam( targetValObj );
-	currOperation->AddParam( new CIntValueNode( &parseTree, typeConstant ) );
+	currOperation->AddParam( new( &parseTree ) CIntValueNode( &parseTree, typeConstant ) );
 	currOperation->AddParam( startOffsObj );
 	currOperation->AddParam( hadTo ? endOffsObj : startOffsObj->Copy() );
 	
@@ -2282,45 +2913,53 @@ CValueNode*	CParser::ParseChunkExpression( TChunkType typeConstant, CParseTree&
 //	pretty much just fetches the chunk value right then and there.
 
 CValueNode*	CParser::ParseConstantChunkExpression( TChunkType typeConstant, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+										CTokenCursor& tokenItty, CTokenList& tokens )
 {
-	CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "char" or "item" or whatever chunk type token this was.
+	if( !GoNextToken( tokenItty, tokens ) )	// Skip "char" or "item" or whatever chunk type token this was.
+		return NULL;
 	
 	bool					hadTo = false;
 	CValueNode*				endOffsObj = NULL;
 	
 	// Start offset:
 	CValueNode*		startOffsObj = ParseTerm( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return NULL;
 	size_t			lineNum = tokenItty->mLineNum;
 	
 	// (Optional) end offset:
 	if( tokenItty->IsIdentifier( EToIdentifier ) || tokenItty->IsIdentifier( EThroughIdentifier )
 		|| tokenItty->IsIdentifier( EThruIdentifier ) )
 	{
-		CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "to"/"through"/"thru".
+		if( !GoNextToken( tokenItty, tokens ) )	// Skip "to"/"through"/"thru".
+			return NULL;
 		
 		endOffsObj = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+		if( HadError() )
+			return NULL;
 		hadTo = true;
 	}
 	
 	// Target value:
 	if( !tokenItty->IsIdentifier( EOfIdentifier ) )
 	{
-		std::stringstream		errMsg;
-		errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected ";
-		if( !hadTo )
-			errMsg << "\"to\" or ";
-		errMsg << "\"of\" here, found " << tokenItty->GetShortDescription() << ".";
-		mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-		throw std::runtime_error( errMsg.str() );
+		ReportError( CParseError( mFileName, tokenItty->mLineNum, (hadTo ? "Expected \"of\" here, found %t." : "Expected \"to\" or \"of\" here, found %t."), *tokenItty ) );
+		return NULL;
 	}
-	CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "of".
+	GoNextToken( tokenItty, tokens );	// Skip "of".
 	
 	CValueNode*	targetValObj = ParseTerm( parseTree, currFunction, tokenItty, tokens );
+	if( HadError() )
+		return NULL;
+	if( !startOffsObj || !targetValObj )	// Ran off the end of the script.
+	{
+		ReportError( CParseError( mFileName, 0, "Expected term here, found end of script.", *tokenItty ) );
+		return NULL;
+	}
 	
-	CMakeChunkConstNode*	currOperation = new CMakeChunkConstNode( &parseTree, lineNum );
+	CMakeChunkConstNode*	currOperation = new( &parseTree ) CMakeChunkConstNode( &parseTree, lineNum );
 	currOperation->AddParam( targetValObj );
-	currOperation->AddParam( new CIntValueNode( &parseTree, typeConstant ) );
+	currOperation->AddParam( new( &parseTree ) CIntValueNode( &parseTree, typeConstant ) );
 	currOperation->AddParam( startOffsObj );
 	currOperation->AddParam( hadTo ? endOffsObj : startOffsObj );
 
@@ -2329,7 +2968,7 @@ CValueNode*	CParser::ParseConstantChunkExpression( TChunkType typeConstant, CPar
 
 
 CValueNode*	CParser::ParseObjCMethodCall( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+										CTokenCursor& tokenItty, CTokenList& tokens )
 {
 	// We parse either a class name or an expression that evaluates to an object
 	// as type "native object", followed by parameters with labels. We build the
@@ -2352,7 +2991,7 @@ CValueNode*	CParser::ParseObjCMethodCall( CParseTree& parseTree, CCodeBlockNodeB
 //		std::string				className( tokenItty->GetOriginalIdentifierText() );
 //		std::string				varName( "var_" );
 //		varName.append( ToLowerString( className ) );
-//		std::map<std::string,CVariableEntry>::iterator	theContainerItty = theLocals.find( varName );
+//		std::map<CSymbolID,CVariableEntry>::iterator	theContainerItty = theLocals.find( varName );
 //
 //		if( theContainerItty == theLocals.end() )	// No variable of that name? Must be ObjC class name:
 //		{
@@ -2699,7 +3338,7 @@ TChunkType	CParser::GetChunkTypeNameFromIdentifierSubtype( TIdentifierSubtype id
 
 CValueNode*	CParser::ParseNativeFunctionCallStartingAtParams( std::string& methodName, CObjCMethodEntry& methodInfo,
 							CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-							std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+							CTokenCursor& tokenItty, CTokenList& tokens )
 {
 //	int						numParams = 0;
 //	std::stringstream		paramsCode;	// temp we compose our params in.
@@ -2780,7 +3419,7 @@ CValueNode*	CParser::ParseNativeFunctionCallStartingAtParams( std::string& metho
 
 
 CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-								std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+								CTokenCursor& tokenItty, CTokenList& tokens )
 {
 	CValueNode*	theTerm = NULL;
 	
@@ -2791,39 +3430,25 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 	{
 		case EStringToken:
 		{
-			theTerm = new CStringValueNode( &parseTree, tokenItty->mStringValue );
-			CToken::GoNextToken( mFileName, tokenItty, tokens );
+			theTerm = new( &parseTree ) CStringValueNode( &parseTree, tokenItty->GetStringValue() );
+			if( !GoNextToken( tokenItty, tokens ) )
+				return NULL;
 			break;
 		}
 
-		case ENumberToken:	// Any number (integer). We fake floats by parsing an integer/period-operator/integer sequence.
+		case ENumberToken:	// Any integer.
 		{
-			long					theNumber = tokenItty->mNumberValue;
-			
-			CToken::GoNextToken( mFileName, tokenItty, tokens );
-			
-			if( tokenItty != tokens.end() && tokenItty->IsIdentifier( EPeriodOperator ) )	// Integer followed by period? Could be a float!
-			{
-				CToken::GoNextToken( mFileName, tokenItty, tokens );
-				if( tokenItty != tokens.end() && tokenItty->mType == ENumberToken )	// Is a float!
-				{
-					std::stringstream	numStr;
-					numStr << theNumber << "." << tokenItty->mNumberValue;
-					char*				endPtr = NULL;
-					double				theNum = strtod( numStr.str().c_str(), &endPtr );
-					
-					theTerm = new CFloatValueNode( &parseTree, theNum );
-					
-					CToken::GoNextToken( mFileName, tokenItty, tokens );
-				}
-				else	// Backtrack, that period was something else:
-				{
-					CToken::GoPrevToken( mFileName, tokenItty, tokens );
-					theTerm = new CIntValueNode( &parseTree, theNumber );
-				}
-			}
-			else
-				theTerm = new CIntValueNode( &parseTree, theNumber );
+			theTerm = new( &parseTree ) CIntValueNode( &parseTree, tokenItty->mNumberValue );
+			if( !GoNextToken( tokenItty, tokens ) )
+				return NULL;
+			break;
+		}
+
+		case EFloatNumberToken:	// Decimal or scientific number, already parsed by the tokenizer.
+		{
+			theTerm = new( &parseTree ) CFloatValueNode( &parseTree, tokenItty->mFloatValue );
+			if( !GoNextToken( tokenItty, tokens ) )
+				return NULL;
 			break;
 		}
 
@@ -2831,6 +3456,8 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 			if( tokenItty->mSubType == ELastIdentifier_Sentinel )	// Any user-defined identifier.
 			{
 				theTerm = ParseFunctionCall( parseTree, currFunction, false, tokenItty, tokens );
+				if( HadError() )
+					return NULL;
 				if( !theTerm ) 
 				{
 					std::map<std::string,int>::iterator		sysConstItty = sConstantToValueTable.find( tokenItty->GetOriginalIdentifierText() );
@@ -2838,8 +3465,9 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 						theTerm = ParseContainer( false, true, parseTree, currFunction, tokenItty, tokens );
 					else
 					{
-						theTerm = new CIntValueNode( &parseTree, sysConstItty->second );
-						CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip the identifier for the constant we just parsed.
+						theTerm = new( &parseTree ) CIntValueNode( &parseTree, sysConstItty->second );
+						if( !GoNextToken( tokenItty, tokens ) )	// Skip the identifier for the constant we just parsed.
+							return NULL;
 					}
 				}
 				
@@ -2852,109 +3480,105 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 			else if( tokenItty->mSubType == EEntryIdentifier )
 			{	
 				theTerm = ParseArrayItem( parseTree, currFunction, tokenItty, tokens );
+				if( HadError() )
+					return NULL;
 				break;
 			}
 			else if( tokenItty->mSubType == EIdIdentifier )	// "id"?
 			{
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "id".
+				if( !GoNextToken( tokenItty, tokens ) )	// Skip "id".
+					return NULL;
 				
 				// OF:
 				if( !tokenItty->IsIdentifier(EOfIdentifier) )
 				{
-					std::stringstream		errMsg;
-					errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"of\" here, found "
-											<< tokenItty->GetShortDescription() << ".";
-					mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-					throw std::runtime_error( errMsg.str() );
+					ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"of\" here, found %t.", *tokenItty ) );
+					return NULL;
 				}
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "of".
+				GoNextToken( tokenItty, tokens );	// Skip "of".
 				
 				std::string		hdlName;
 				if( tokenItty->IsIdentifier(EFunctionIdentifier) )
 				{
 					hdlName.assign("fun_");
-					CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "function".
+					if( !GoNextToken( tokenItty, tokens ) )	// Skip "function".
+						return NULL;
 					if( tokenItty->IsIdentifier(EHandlerIdentifier) )
-						CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "handler".
+						GoNextToken( tokenItty, tokens );	// Skip "handler".
 				}
 				else if( tokenItty->IsIdentifier(EMessageIdentifier) )
 				{
 					hdlName.assign("hdl_");
-					CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "message".
+					if( !GoNextToken( tokenItty, tokens ) )	// Skip "message".
+						return NULL;
 					if( !tokenItty->IsIdentifier(EHandlerIdentifier) )
 					{
-						std::stringstream		errMsg;
-						errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"function handler\" or \"message handler\" here, found "
-												<< tokenItty->GetShortDescription() << ".";
-						mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-						throw std::runtime_error( errMsg.str() );
+						ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"function handler\" or \"message handler\" here, found %t.", *tokenItty ) );
+						return NULL;
 					}
-					CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "handler".
+					GoNextToken( tokenItty, tokens );	// Skip "handler".
 				}
 				else
 				{
 					hdlName.assign("hdl_");
 					if( !tokenItty->IsIdentifier(EHandlerIdentifier) )
 					{
-						std::stringstream		errMsg;
-						errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"function handler\" or \"message handler\" here, found "
-												<< tokenItty->GetShortDescription() << ".";
-						mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-						throw std::runtime_error( errMsg.str() );
+						ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"function handler\" or \"message handler\" here, found %t.", *tokenItty ) );
+						return NULL;
 					}
-					CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "handler".
+					GoNextToken( tokenItty, tokens );	// Skip "handler".
 				}
 				
+				if( !ExpectIdentifierToken( tokenItty ) )
+					return NULL;
 				hdlName.append( tokenItty->GetIdentifierText() );
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "handler".
+				if( !GoNextToken( tokenItty, tokens ) )	// Skip "handler".
+					return NULL;
 				
 				// Now that we know whether it's a function or a handler, store a pointer to it:
-				theTerm = new CFunctionCallNode( &parseTree, false, "vcy_fcn_addr", tokenItty->mLineNum );
+				theTerm = new( &parseTree ) CFunctionCallNode( &parseTree, false, "vcy_fcn_addr", tokenItty->mLineNum );
 				break;
 			}
 			else if( tokenItty->mSubType == ENumberIdentifier || tokenItty->mSubType == ENumIdentifier )		// The identifier "number", i.e. the actual word.
 			{
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "number".
+				if( !GoNextToken( tokenItty, tokens ) )	// Skip "number".
+					return NULL;
 				
 				// OF:
 				if( !tokenItty->IsIdentifier(EOfIdentifier) )
 				{
-					std::stringstream		errMsg;
-					errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"of\" here, found "
-											<< tokenItty->GetShortDescription() << ".";
-					mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-					throw std::runtime_error( errMsg.str() );
+					ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"of\" here, found %t.", *tokenItty ) );
+					return NULL;
 				}
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "of".
+				GoNextToken( tokenItty, tokens );	// Skip "of".
 				
 				// Chunk type:
+				if( !ExpectIdentifierToken( tokenItty ) )
+					return NULL;
 				TChunkType	typeConstant = GetChunkTypeNameFromIdentifierSubtype( tokenItty->GetIdentifierSubType() );
 				if( typeConstant == TChunkTypeInvalid )
 				{
-					std::stringstream		errMsg;
-					errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected a chunk type like \"character\", \"item\", \"word\" or \"line\" here, found "
-											<< tokenItty->GetShortDescription() << ".";
-					mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-					throw std::runtime_error( errMsg.str() );
+					ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected a chunk type like \"character\", \"item\", \"word\" or \"line\" here, found %t.", *tokenItty ) );
+					return NULL;
 				}
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "items" etc.
+				if( !GoNextToken( tokenItty, tokens ) )	// Skip "items" etc.
+					return NULL;
 				
 				// OF:
 				if( !tokenItty->IsIdentifier(EOfIdentifier) )
 				{
-					std::stringstream		errMsg;
-					errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected \"of\" here, found "
-											<< tokenItty->GetShortDescription() << ".";
-					mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-					throw std::runtime_error( errMsg.str() );
+					ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected \"of\" here, found %t.", *tokenItty ) );
+					return NULL;
 				}
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "of".
+				GoNextToken( tokenItty, tokens );	// Skip "of".
 				
 				// VALUE:
-				CFunctionCallNode*	fcall = new CFunctionCallNode( &parseTree, false, "vcy_chunk_count", tokenItty->mLineNum );
+				CFunctionCallNode*	fcall = new( &parseTree ) CFunctionCallNode( &parseTree, false, "vcy_chunk_count", tokenItty->mLineNum );
 				CValueNode*			valueObj = ParseTerm( parseTree, currFunction, tokenItty, tokens );
+				if( HadError() )
+					return NULL;
 				
-				fcall->AddParam( new CIntValueNode( &parseTree, typeConstant ) );
+				fcall->AddParam( new( &parseTree ) CIntValueNode( &parseTree, typeConstant ) );
 				fcall->AddParam( valueObj );
 				
 				theTerm = fcall;
@@ -2962,32 +3586,34 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 			}
 			else if( tokenItty->mSubType == EOpenBracketOperator )
 			{
-				CToken::GoNextToken( mFileName, tokenItty, tokens );
+				if( !GoNextToken( tokenItty, tokens ) )
+					return NULL;
 				
 				theTerm = ParseExpression( parseTree, currFunction, tokenItty, tokens );
+				if( HadError() )
+					return NULL;
 				
 				if( !tokenItty->IsIdentifier(ECloseBracketOperator) )
 				{
-					std::stringstream		errMsg;
-					errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected closing bracket here, found "
-											<< tokenItty->GetShortDescription() << ".";
-					mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-					throw std::runtime_error( errMsg.str() );
+					ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected closing bracket here, found %t.", *tokenItty ) );
+					return NULL;
 				}
-				CToken::GoNextToken( mFileName, tokenItty, tokens );
+				GoNextToken( tokenItty, tokens );
 				break;
 			}
 			else if( tokenItty->mSubType == ETheIdentifier )
 			{
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "the".
+				if( !GoNextToken( tokenItty, tokens ) )	// Skip "the".
+					return NULL;
 				if( tokenItty->IsIdentifier( EParamCountIdentifier ) )
 				{
-					CLocalVariableRefValueNode*	paramsNode = new CLocalVariableRefValueNode( &parseTree, currFunction, "paramList", "paramList" );
-					CFunctionCallNode*			countFunction = new CFunctionCallNode( &parseTree, false, "vcy_list_count", tokenItty->mLineNum );
+					CLocalVariableRefValueNode*	paramsNode = new( &parseTree ) CLocalVariableRefValueNode( &parseTree, currFunction, parseTree.GetSymbols().SymbolForString( "paramList" ), "paramList" );
+					CFunctionCallNode*			countFunction = new( &parseTree ) CFunctionCallNode( &parseTree, false, "vcy_list_count", tokenItty->mLineNum );
 					countFunction->AddParam( paramsNode );
 					theTerm = countFunction;
 					
-					CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "paramCount".
+					if( !GoNextToken( tokenItty, tokens ) )	// Skip "paramCount".
+						return NULL;
 				}
 				else
 				{
@@ -3001,19 +3627,25 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 						propName = tokenItty->GetIdentifierText();
 						propName.append( 1, ' ' );
 						
-						CToken::GoNextToken( mFileName, tokenItty, tokens );	// Advance past style qualifier.
+						if( !GoNextToken( tokenItty, tokens ) )	// Advance past style qualifier.
+							return NULL;
 						isStyleQualifiedProperty = true;
 					}
 					
+					if( !ExpectIdentifierToken( tokenItty ) )
+						return NULL;
 					size_t			lineNum = tokenItty->mLineNum;
 					propName.append( tokenItty->GetIdentifierText() );
-					CToken::GoNextToken( mFileName, tokenItty, tokens );
+					if( !GoNextToken( tokenItty, tokens ) )
+						return NULL;
 					if( tokenItty->IsIdentifier( EOfIdentifier ) )
 					{
-						CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "of".
+						GoNextToken( tokenItty, tokens );	// Skip "of".
 						CValueNode	*	targetObj = ParseTerm( parseTree, currFunction, tokenItty, tokens );
+						if( HadError() )
+							return NULL;
 						
-						CObjectPropertyNode	*	propExpr = new CObjectPropertyNode( &parseTree, propName, lineNum );
+						CObjectPropertyNode	*	propExpr = new( &parseTree ) CObjectPropertyNode( &parseTree, propName, lineNum );
 						propExpr->AddParam( targetObj );
 						theTerm = propExpr;
 					}
@@ -3026,19 +3658,12 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 					
 					if( !theTerm )
 					{
-						TIdentifierSubtype	subType = tokenItty->mSubType;
-			
-						// Find it in our list of global properties:
-						int				x = 0;
-						
-						for( x = 0; sGlobalProperties[x].mType != ELastIdentifier_Sentinel; x++ )
+						const TGlobalPropertyEntry*	globalProperty = mContext->GlobalPropertyForType( tokenItty->mSubType );
+						if( globalProperty )
 						{
-							if( sGlobalProperties[x].mType == subType )
-							{
-								theTerm = new COperatorNode( &parseTree, sGlobalProperties[x].mGetterInstructionID, tokenItty->mLineNum );
-								CToken::GoNextToken( mFileName, tokenItty, tokens );
-								break;
-							}
+							theTerm = new( &parseTree ) COperatorNode( &parseTree, globalProperty->mGetterInstructionID, tokenItty->mLineNum );
+							if( !GoNextToken( tokenItty, tokens ) )
+								return NULL;
 						}
 					}
 					
@@ -3046,6 +3671,8 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 					{
 						CToken::GoPrevToken( mFileName, tokenItty, tokens );	// Backtrack so ParseContainer sees "the", too.
 						theTerm = ParseContainer( false, true, parseTree, currFunction, tokenItty, tokens );
+						if( HadError() )
+							return NULL;
 					}
 				}
 				break;
@@ -3055,29 +3682,27 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 				bool		hadBrackets = false;
 				size_t		lineNum = tokenItty->mLineNum;
 				
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "paramCount".
+				if( !GoNextToken( tokenItty, tokens ) )	// Skip "paramCount".
+					return NULL;
 				
 				if( tokenItty->IsIdentifier( EOpenBracketOperator ) )
 				{
-					CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip opening bracket.
+					GoNextToken( tokenItty, tokens );	// Skip opening bracket.
 					if( tokenItty->IsIdentifier( ECloseBracketOperator ) )
 					{
-						CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip closing bracket.
+						GoNextToken( tokenItty, tokens );	// Skip closing bracket.
 						hadBrackets = true;
 					}
 				}
 					
 				if( !hadBrackets )
 				{
-					std::stringstream		errMsg;
-					errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: expected \"(\" and \")\" after function name, found "
-											<< tokenItty->GetShortDescription() << ".";
-					mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-					throw std::runtime_error( errMsg.str() );
+					ReportError( CParseError( mFileName, tokenItty->mLineNum, "expected \"(\" and \")\" after function name, found %t.", *tokenItty ) );
+					return NULL;
 				}
 				
-				CLocalVariableRefValueNode*	paramsNode = new CLocalVariableRefValueNode( &parseTree, currFunction, "paramList", "paramList" );
-				CFunctionCallNode*			countFunction = new CFunctionCallNode( &parseTree, false, "vcy_list_count", lineNum );
+				CLocalVariableRefValueNode*	paramsNode = new( &parseTree ) CLocalVariableRefValueNode( &parseTree, currFunction, parseTree.GetSymbols().SymbolForString( "paramList" ), "paramList" );
+				CFunctionCallNode*			countFunction = new( &parseTree ) CFunctionCallNode( &parseTree, false, "vcy_list_count", lineNum );
 				countFunction->AddParam( paramsNode );
 				theTerm = countFunction;
 				break;
@@ -3086,35 +3711,32 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 			{
 				size_t		lineNum = tokenItty->mLineNum;
 				
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "param".
+				if( !GoNextToken( tokenItty, tokens ) )	// Skip "param".
+					return NULL;
 				
 				if( !tokenItty->IsIdentifier( EOpenBracketOperator ) )	// Parse open bracket.
 				{
-					std::stringstream		errMsg;
-					errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: excpected \"(\" after function name, found "
-											<< tokenItty->GetShortDescription() << ".";
-					mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-					throw std::runtime_error( errMsg.str() );
+					ReportError( CParseError( mFileName, tokenItty->mLineNum, "excpected \"(\" after function name, found %t.", *tokenItty ) );
+					return NULL;
 				}
 				
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip opening bracket.
+				if( !GoNextToken( tokenItty, tokens ) )	// Skip opening bracket.
+					return NULL;
 				
-				CLocalVariableRefValueNode*	paramListVar = new CLocalVariableRefValueNode( &parseTree, currFunction, "paramList", "paramList" );
-				CFunctionCallNode*			fcall = new CFunctionCallNode( &parseTree, false, "vcy_list_get", lineNum );
+				CLocalVariableRefValueNode*	paramListVar = new( &parseTree ) CLocalVariableRefValueNode( &parseTree, currFunction, parseTree.GetSymbols().SymbolForString( "paramList" ), "paramList" );
+				CFunctionCallNode*			fcall = new( &parseTree ) CFunctionCallNode( &parseTree, false, "vcy_list_get", lineNum );
 				
 				fcall->AddParam( paramListVar );
 				fcall->AddParam( ParseExpression( parseTree, currFunction, tokenItty, tokens ) );
 				
 				if( !tokenItty->IsIdentifier( ECloseBracketOperator ) )	// Parse close bracket.
 				{
-					std::stringstream		errMsg;
-					errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: excpected \"(\" after function name, found "
-											<< tokenItty->GetShortDescription() << ".";
-					mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-					throw std::runtime_error( errMsg.str() );
+					ReportError( CParseError( mFileName, tokenItty->mLineNum, "excpected \"(\" after function name, found %t.", *tokenItty ) );
+					return NULL;
 				}
 				
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip closing bracket.
+				if( !GoNextToken( tokenItty, tokens ) )	// Skip closing bracket.
+					return NULL;
 				
 				theTerm = fcall;
 				break;
@@ -3123,10 +3745,11 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 			{
 				size_t		lineNum = tokenItty->mLineNum;
 				
-				CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip "parameter".
+				if( !GoNextToken( tokenItty, tokens ) )	// Skip "parameter".
+					return NULL;
 				
-				CLocalVariableRefValueNode*	paramListVar = new CLocalVariableRefValueNode( &parseTree, currFunction, "paramList", "paramList" );
-				CFunctionCallNode*			fcall = new CFunctionCallNode( &parseTree, false, "vcy_list_get", lineNum );
+				CLocalVariableRefValueNode*	paramListVar = new( &parseTree ) CLocalVariableRefValueNode( &parseTree, currFunction, parseTree.GetSymbols().SymbolForString( "paramList" ), "paramList" );
+				CFunctionCallNode*			fcall = new( &parseTree ) CFunctionCallNode( &parseTree, false, "vcy_list_get", lineNum );
 				
 				fcall->AddParam( paramListVar );
 				fcall->AddParam( ParseExpression( parseTree, currFunction, tokenItty, tokens ) );
@@ -3137,26 +3760,25 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 			else if( tokenItty->mSubType == EResultIdentifier || tokenItty->mSubType == ETheIdentifier )
 			{	
 				theTerm = ParseContainer( false, true, parseTree, currFunction, tokenItty, tokens );
+				if( HadError() )
+					return NULL;
 				break;
 			}
 			else if( tokenItty->mSubType == EOpenSquareBracketOperator )
 			{	
 				theTerm = ParseObjCMethodCall( parseTree, currFunction, tokenItty, tokens );
+				if( HadError() )
+					return NULL;
 				break;
 			}
 			else
 			{
-				TIdentifierSubtype	subType = tokenItty->mSubType;
-	
-				// Find it in our list of global properties:
-				for( int x = 0; sGlobalProperties[x].mType != ELastIdentifier_Sentinel; x++ )
+				const TGlobalPropertyEntry*	globalProperty = mContext->GlobalPropertyForType( tokenItty->mSubType );
+				if( globalProperty )
 				{
-					if( sGlobalProperties[x].mType == subType )
-					{
-						theTerm = new COperatorNode( &parseTree, sGlobalProperties[x].mGetterInstructionID, tokenItty->mLineNum );
-						CToken::GoNextToken( mFileName, tokenItty, tokens );
-						break;
-					}
+					theTerm = new( &parseTree ) COperatorNode( &parseTree, globalProperty->mGetterInstructionID, tokenItty->mLineNum );
+					if( !GoNextToken( tokenItty, tokens ) )
+						return NULL;
 				}
 				
 				if( theTerm )
@@ -3167,11 +3789,13 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 				if( typeConstant != TChunkTypeInvalid )
 				{
 					theTerm = ParseConstantChunkExpression( typeConstant, parseTree, currFunction, tokenItty, tokens );
+					if( HadError() )
+						return NULL;
 					break;
 				}
 
 				// Now try constant:
-				CValueNode		*	constantValue = NULL;
+				TConstantEntry	*	constantValue = NULL;
 				TConstantEntry	*	currConst = sConstants;
 				
 				while( currConst->mType[0] != ELastIdentifier_Sentinel )
@@ -3188,11 +3812,11 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 						
 						if( y == (MAX_CONSTANT_IDENTS -1) || currConst->mType[y+1] == ELastIdentifier_Sentinel )
 						{
-							constantValue = currConst->mValue;
+							constantValue = currConst;
 							break;
 						}
 						
-						CToken::GoNextToken( mFileName, tokenItty, tokens );
+						GoNextToken( tokenItty, tokens );
 					}
 					
 					if( constantValue )
@@ -3203,8 +3827,14 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 				
 				if( constantValue )	// Found constant of that name!
 				{
-					theTerm = constantValue->Copy();
-					CToken::GoNextToken( mFileName, tokenItty, tokens );
+					if( constantValue->mValueType == TVariantTypeBool )
+						theTerm = new( &parseTree ) CBoolValueNode( &parseTree, constantValue->mNumberValue != 0 );
+					else if( constantValue->mValueType == TVariantTypeFloat )
+						theTerm = new( &parseTree ) CFloatValueNode( &parseTree, constantValue->mNumberValue );
+					else
+						theTerm = new( &parseTree ) CStringValueNode( &parseTree, std::string( constantValue->mStringValue ) );
+					if( !GoNextToken( tokenItty, tokens ) )
+						return NULL;
 					break;
 				}
 
@@ -3220,10 +3850,14 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 				if( operatorCommandName != INVALID_INSTR )
 				{
 					size_t	lineNum = tokenItty->mLineNum;
-					CToken::GoNextToken( mFileName, tokenItty, tokens );	// Skip operator token.
+					if( !GoNextToken( tokenItty, tokens ) )	// Skip operator token.
+						return NULL;
 					
-					COperatorNode*	opFCall = new COperatorNode( &parseTree, operatorCommandName, lineNum );
-					opFCall->AddParam( ParseTerm( parseTree, currFunction, tokenItty, tokens ) );
+					COperatorNode*	opFCall = new( &parseTree ) COperatorNode( &parseTree, operatorCommandName, lineNum );
+					CValueNode*		operand = ParseTerm( parseTree, currFunction, tokenItty, tokens );
+					if( HadError() )
+						return NULL;
+					opFCall->AddParam( operand );
 					theTerm = opFCall;
 				}
 				else
@@ -3233,12 +3867,8 @@ CValueNode*	CParser::ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currF
 		
 		default:
 		{
-			std::stringstream		errMsg;
-			errMsg << mFileName << ":" << tokenItty->mLineNum << ": error: Expected a term here, found \""
-									<< tokenItty->GetShortDescription() << "\".";
-			mMessages.push_back( CMessageEntry( errMsg.str(), mFileName, tokenItty->mLineNum ) );
-			throw std::runtime_error( errMsg.str() );
-			break;
+			ReportError( CParseError( mFileName, tokenItty->mLineNum, "Expected a term here, found \"%t\".", *tokenItty ) );
+			return NULL;
 		}
 	}
 	
@@ -19,6 +19,8 @@
 
 #include "CParseTree.h"
 #include "CCodeBlockNode.h"
+#include "CSnippetCache.h"
+#include "CCompileCache.h"
 extern "C" {
 #include "LEOInterpreter.h"
 #include "ForgeTypes.h"
@@ -30,6 +32,7 @@ namespace Carlson
 	class CFunctionDefinitionNode;
 	class CCodeBlockNodeBase;
 	class CFunctionCallNode;
+	class CParser;
 	
 	// *** An entry in our operator look-up table:
 	struct TOperatorEntry
@@ -41,6 +44,23 @@ namespace Carlson
 		TIdentifierSubtype		mTypeToReturn;		// The identifier to return for this operator.
 	};
 	
+	// *** A two-token operator in TOperatorLookupEntry:
+	struct TOperatorFollower
+	{
+		TIdentifierSubtype		mSecondType;		// The second identifier, ELastIdentifier_Sentinel for unused entries.
+		int						mPrecedence;		// Precedence of the two-token operator.
+		LEOInstructionID		mInstructionID;		// Instruction that implements the two-token operator.
+	};
+	
+	// *** An entry in our operator look-up table, indexed by the operator's first identifier:
+	#define MAX_OPERATOR_FOLLOWERS		2
+	struct TOperatorLookupEntry
+	{
+		int						mPrecedence;		// Precedence if the identifier is an operator on its own, 0 if it's not.
+		LEOInstructionID		mInstructionID;		// Instruction that implements the single-token operator.
+		TOperatorFollower		mFollowers[MAX_OPERATOR_FOLLOWERS];	// Two-token operators starting with this identifier. Checked before the single-token one.
+	};
+	
 	// *** An entry in our unary operator look-up table:
 	struct TUnaryOperatorEntry
 	{
@@ -56,12 +76,39 @@ namespace Carlson
 		TChunkType				mChunkTypeConstant;			// Constant to pass to get a range of this chunk type.
 	};
 	
+	// *** All host entries registered for one identifier, in order of registration:
+	typedef std::vector<TGlobalPropertyEntry>	TGlobalPropertyList;
+	typedef std::vector<THostCommandEntry>		THostCommandList;
+	
+	// *** A member function that parses one kind of statement, e.g. "put", starting at its first token:
+	typedef void (CParser::*TStatementParser)( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+												CTokenCursor& tokenItty, CTokenList& tokens );
+	
+	// *** A function a host application registers to parse its own kind of statement:
+	typedef void (*TStatementParserProc)( CParser& inParser, CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+											CTokenCursor& tokenItty, CTokenList& tokens );
+	
+	// *** An entry in our table of built-in statements:
+	struct TBuiltInStatementEntry
+	{
+		TIdentifierSubtype		mType;			// The identifier that starts this statement.
+		TStatementParser		mParser;		// Member function that parses it.
+	};
+	
+	// *** An entry in our statement look-up table, indexed by the identifier that starts the statement:
+	struct TStatementParserEntry
+	{
+		TStatementParser		mParser;		// Built-in parser for this statement, or NULL. A parser the host registered in the CCompilerContext takes precedence.
+	};
+	
 	// *** An entry in our constant look-up table:
 	#define MAX_CONSTANT_IDENTS		3
 	struct TConstantEntry
 	{
 		TIdentifierSubtype		mType[MAX_CONSTANT_IDENTS];	// The identifier for this constant.
-		CValueNode*				mValue;	// TVariant holding this constant.
+		TVariantType			mValueType;		// TVariantTypeString, TVariantTypeBool or TVariantTypeFloat.
+		const char*				mStringValue;	// Value of string constants.
+		double					mNumberValue;	// Value of number constants, 0 or 1 for booleans.
 	};
 	
 	// *** an entry in our ObjC -> Variant or Variant -> ObjC type conversion mapping tables:
@@ -96,6 +143,98 @@ namespace Carlson
 		CMessageEntry( std::string inMessage, std::string inFileName, size_t inLineNum )	: mMessage(inMessage), mFileName(inFileName), mLineNum(inLineNum) {};
 	};
 	
+	// *** A syntax error. Only formatted into a message when someone asks for it:
+	class CParseError
+	{
+	public:
+		CParseError() : mFileName(NULL), mLineNum(0), mFormat(NULL), mFoundToken( EInvalidToken, ELastIdentifier_Sentinel, 0, 0, "", 0 ), mIdentifier(ELastIdentifier_Sentinel) {};
+		CParseError( const char* inFileName, size_t inLineNum, const char* inFormat, const CToken& inFoundToken,
+						TIdentifierSubtype inIdentifier = ELastIdentifier_Sentinel, const std::string& inDetail = std::string() )
+			: mFileName(inFileName), mLineNum(inLineNum), mFormat(inFormat), mFoundToken(inFoundToken), mIdentifier(inIdentifier), mDetail(inDetail) {};
+		
+		bool			IsSet() const		{ return mFormat != NULL; };
+		size_t			GetLineNum() const	{ return mLineNum; };
+		std::string		GetMessage() const;	// "file:line: error: " followed by mFormat, with %t replaced by the found token, %i by the identifier and %s by the detail text.
+		
+	protected:
+		const char*			mFileName;		// NULL for messages without a position.
+		size_t				mLineNum;
+		const char*			mFormat;		// A string constant, NULL if there was no error.
+		CToken				mFoundToken;	// Its text points into the script, so get the message before that goes away.
+		TIdentifierSubtype	mIdentifier;	// An identifier the message mentions, e.g. the one we expected.
+		std::string			mDetail;		// Any other text the message mentions, e.g. a handler name.
+	};
+	
+	// *** A handler ParseInParallel() found, and what a worker thread made of it:
+	struct CParsedHandler
+	{
+		size_t					mStartIndex;	// Index of its "on", "function" or "to" token.
+		size_t					mEndIndex;		// Index of the token after the handler name in its "end" line.
+		CNode*					mNode;			// Its CFunctionDefinitionNode, NULL if the worker couldn't parse it.
+		std::vector<CNode*>		mNodes;			// All nodes the worker created for it.
+		std::vector<CSymbolID>	mNewSymbols;	// Symbols it used that the worker's symbol table didn't start out with, in order of first use.
+		std::string				mHandlerName;
+		bool					mIsFunction;
+		
+		CParsedHandler( size_t inStartIndex, size_t inEndIndex ) : mStartIndex(inStartIndex), mEndIndex(inEndIndex), mNode(NULL), mIsFunction(false) {};
+	};
+	
+	#define PARALLEL_PARSE_MIN_HANDLERS				64	// Scripts with fewer handlers aren't worth starting threads for.
+	#define PARALLEL_PARSE_MIN_HANDLERS_PER_THREAD	16	// Don't give a thread fewer handlers than this.
+	
+	#define COMPILER_CONTEXT_ERROR_MESSAGE_SIZE		1024
+	
+	// -------------------------------------------------------------------------
+	//	Everything the parser looks up that a host can change: Global
+	//	properties, host commands and functions, and statement parsers, plus
+	//	the last error message for the C API and caches of compiled snippets
+	//	and scripts. Only one thread may use a context at a time, but threads
+	//	with their own contexts can compile at once.
+	//	Parsers use the default context unless you give them another one.
+	// -------------------------------------------------------------------------
+	
+	class CCompilerContext
+	{
+	public:
+		CCompilerContext();		// Starts out with only the built-in global properties. Copy one to get another with the same host entries and compile cache folder (but an empty snippet cache).
+		
+		static CCompilerContext&	GetDefault();	// The one CParser's static registration functions change.
+		
+		void	AddGlobalPropertiesAndOffsetInstructions( const TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction );
+		void	ReplaceGlobalPropertiesAndOffsetInstructions( const TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction );	// Like AddGlobalProperties..., but first removes existing properties with the same identifiers.
+		void	RemoveGlobalProperty( TIdentifierSubtype inType );
+		void	AddHostCommandsAndOffsetInstructions( const THostCommandEntry* inEntries, size_t firstHostCommandInstruction );
+		void	ReplaceHostCommandsAndOffsetInstructions( const THostCommandEntry* inEntries, size_t firstHostCommandInstruction );	// Like AddHostCommands..., but first removes existing commands with the same identifiers.
+		void	RemoveHostCommand( TIdentifierSubtype inType );
+		void	AddHostFunctionsAndOffsetInstructions( const THostCommandEntry* inEntries, size_t firstHostCommandInstruction );
+		void	ReplaceHostFunctionsAndOffsetInstructions( const THostCommandEntry* inEntries, size_t firstHostCommandInstruction );	// Like AddHostFunctions..., but first removes existing functions with the same identifiers.
+		void	RemoveHostFunction( TIdentifierSubtype inType );
+		void	SetStatementParser( TIdentifierSubtype inType, TStatementParserProc inParser );	// inType must be the main form of the identifier, not a synonym. NULL goes back to the default.
+		
+		const TGlobalPropertyEntry*	GlobalPropertyForType( TIdentifierSubtype inType ) const;	// NULL if there's none.
+		const TGlobalPropertyList*	GlobalPropertiesByType() const	{ return mGlobalProperties; };
+		const THostCommandList*		HostCommandsByType() const	{ return mHostCommands; };
+		const THostCommandList*		HostFunctionsByType() const	{ return mHostFunctions; };
+		TStatementParserProc		StatementParserForType( TIdentifierSubtype inType ) const	{ return mStatementParsers[inType]; };
+		
+		size_t			GetGeneration() const		{ return mGeneration; };	// Changes whenever host entries are added or removed.
+		CSnippetCache&	GetSnippetCache()			{ return mSnippetCache; };
+		CCompileCache&	GetCompileCache()			{ return mCompileCache; };
+		
+		void			SetLastErrorMessage( const char* inMessage );	// Truncates long messages. Pass "" to clear.
+		const char*		GetLastErrorMessage() const	{ return (mLastErrorMessage[0] == 0) ? NULL : mLastErrorMessage; };	// NULL if there was no error.
+		
+	protected:
+		TGlobalPropertyList		mGlobalProperties[ELastIdentifier_Sentinel +1];	// Indexed by the identifier that introduces them. If several are registered for the same identifier, the first one wins.
+		THostCommandList		mHostCommands[ELastIdentifier_Sentinel +1];
+		THostCommandList		mHostFunctions[ELastIdentifier_Sentinel +1];
+		TStatementParserProc	mStatementParsers[ELastIdentifier_Sentinel +1];
+		char					mLastErrorMessage[COMPILER_CONTEXT_ERROR_MESSAGE_SIZE];
+		size_t					mGeneration;
+		CSnippetCache			mSnippetCache;	// Compiled commands and expressions.
+		CCompileCache			mCompileCache;	// Compiled scripts on disk, off by default.
+	};
+	
 	// -------------------------------------------------------------------------
 	//	MAIN CLASS:
 	// -------------------------------------------------------------------------
@@ -103,13 +242,17 @@ namespace Carlson
 	class CParser
 	{
 	protected:
-		std::map<std::string,CVariableEntry>	mGlobals;	// List of globals so we can declare them.
+		std::map<CSymbolID,CVariableEntry>		mGlobals;	// List of globals so we can declare them.
 		std::string					mFirstHandlerName;			// Name of the function implementing the first handler we parse (can be used by templates as main entry point).
 		bool						mFirstHandlerIsFunction;	// TRUE if mFirstHandlerName is a function, FALSE if it's a message/command handler.
 		bool						mUsesObjCCall;				// Flag that gets set if we need to include the ObjC-support library.
 		const char*					mFileName;					// Name of file being parsed right now.
 		const char*					mSupportFolderPath;			// Path to folder with support files.
 		std::vector<CMessageEntry>	mMessages;					// Errors and warnings.
+		bool						mThrowOnError;				// Throw syntax errors as std::runtime_error? Otherwise they go into mError and the parser unwinds by returning.
+		CParseError					mError;						// First syntax error, if mThrowOnError is FALSE.
+		int							mTempCounter;				// Number of the next temp variable in the current handler.
+		CCompilerContext*			mContext;					// Host entries to parse with. We don't own this.
 		
 	protected:
 		static std::map<std::string,CObjCMethodEntry>	sObjCMethodTable;		// Populated from frameworkheaders.hhc file.
@@ -119,96 +262,121 @@ namespace Carlson
 		static std::map<std::string,int>				sConstantToValueTable;	// Populated from frameworkheaders.hhc file.
 		
 	public:
-		CParser();
-		
-		void	Parse( const char* fname, std::deque<CToken>& tokens, CParseTree& parseTree );
-		void	ParseCommandOrExpression( const char* fname, std::deque<CToken>& tokens, CParseTree& parseTree );	// Generates a handler named ":run"
-		
-		void	ParseTopLevelConstruct( std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens, CParseTree& parseTree );
-		void	ParseFunctionDefinition( bool isCommand, std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens, CParseTree& parseTree );
-		CValueNode	*	ParseFunctionCall( CParseTree& parseTree, CCodeBlockNodeBase* currFunction, bool isMessagePassing, std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
-		void	ParsePassStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction, std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
-		void	ParseHandlerCall( CParseTree& parseTree, CCodeBlockNodeBase* currFunction, bool isMessagePassing, std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
-		void	ParsePutStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-									std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
-		void	ParseGetStatement( CParseTree& parseTree,
+		explicit CParser( CCompilerContext* inContext = NULL );	// NULL uses CCompilerContext::GetDefault().
+		
+		void	Parse( const char* fname, CTokenList& tokens, CParseTree& parseTree );
+		void	ParseInParallel( const char* fname, CTokenList& tokens, CParseTree& parseTree, size_t inMaxThreads = 0 );	// Like Parse(), but if tokens are all there (e.g. after TokenizeInParallel()) and there are many handlers, parses them on inMaxThreads threads (0 for one per CPU). Gives the same tree as Parse().
+		void	ParseCommandOrExpression( const char* fname, CTokenList& tokens, CParseTree& parseTree );	// Generates a handler named ":run"
+		CFunctionDefinitionNode*	ParseHandlerAt( const char* fname, CTokenList& tokens, size_t inStartIndex, CParseTree& parseTree );	// Parses only the handler whose "on", "function" or "to" is at inStartIndex. Returns NULL if there's none.
+		
+		static bool		FindHandlers( CTokenList& tokens, std::vector<CParsedHandler>& outHandlers );	// Finds where handlers start and end without parsing them. Returns FALSE if it stopped at something it couldn't skip.
+		
+		void				SetThrowOnError( bool inThrow )	{ mThrowOnError = inThrow; };	// Defaults to TRUE. If FALSE, check HadError() after parsing.
+		bool				HadError() const				{ return mError.IsSet(); };
+		const CParseError&	GetError() const				{ return mError; };
+		
+		void	ReportError( const CParseError& inError );
+		std::string	GetNewTempName();
+		
+		static void*	ParseHandlersThread( void* inChunk );
+		void			ParseHandlers( CTokenList& tokens, CParseTree& parseTree, CParsedHandler* ioHandlers, size_t inNumHandlers );
+		
+		bool	GoNextToken( CTokenCursor& tokenItty, CTokenList& tokens );	// Returns FALSE after reporting an error if we're already at the end.
+		bool	ExpectIdentifier( CTokenCursor& tokenItty, TIdentifierSubtype subType, TIdentifierSubtype precedingIdent = ELastIdentifier_Sentinel );
+		bool	ExpectIdentifierToken( CTokenCursor& tokenItty );	// Reports an error unless it's safe to call GetIdentifierXXX() on the current token.
+		
+		void	ParseTopLevelConstruct( CTokenCursor& tokenItty, CTokenList& tokens, CParseTree& parseTree );
+		void	ParseFunctionDefinition( bool isCommand, CTokenCursor& tokenItty, CTokenList& tokens, CParseTree& parseTree );
+		CValueNode	*	ParseFunctionCall( CParseTree& parseTree, CCodeBlockNodeBase* currFunction, bool isMessagePassing, CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParsePassStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction, CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParseHandlerCall( CParseTree& parseTree, CCodeBlockNodeBase* currFunction, bool isMessagePassing, CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParsePutStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+									CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParseGetStatement( CSymbolID userHandlerName, CParseTree& parseTree,
 									CCodeBlockNodeBase* currFunction,
-									std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
-		void	ParseSetStatement( CParseTree& parseTree,
+									CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParseSetStatement( CSymbolID userHandlerName, CParseTree& parseTree,
 									CCodeBlockNodeBase* currFunction,
-									std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
+									CTokenCursor& tokenItty, CTokenList& tokens );
 		void	ParseHostCommand( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-									std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
+									CTokenCursor& tokenItty, CTokenList& tokens );
 		CValueNode*	ParseHostFunction( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
+										CTokenCursor& tokenItty, CTokenList& tokens );
 		CValueNode*	ParseHostEntityWithTable( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens,
-										THostCommandEntry* inHostTable );
-		void	ParseGlobalStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
-		void	ParseReturnStatement( CParseTree& parseTree,
+										CTokenCursor& tokenItty, CTokenList& tokens,
+										const THostCommandList* inHostTable );
+		void	ParseGlobalStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParseDeleteStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParseExitStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParseNextStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParseReturnStatement( CSymbolID userHandlerName, CParseTree& parseTree,
 										CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
-		void	ParseRepeatForEachStatement( std::string& userHandlerName, CParseTree& parseTree,
+										CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParseRepeatForEachStatement( CSymbolID userHandlerName, CParseTree& parseTree,
 										CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
-		void	ParseRepeatStatement( std::string& userHandlerName, CParseTree& parseTree,
+										CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParseRepeatStatement( CSymbolID userHandlerName, CParseTree& parseTree,
 										CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
-		void	ParseIfStatement( std::string& userHandlerName, CParseTree& parseTree,
+										CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParseIfStatement( CSymbolID userHandlerName, CParseTree& parseTree,
 										CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
+										CTokenCursor& tokenItty, CTokenList& tokens );
 		CValueNode*	ParseContainer( bool asPointer, bool initWithName, CParseTree& parseTree,
 										CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
+										CTokenCursor& tokenItty, CTokenList& tokens );
 		CValueNode*	ParseArrayItem( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-									std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
-		void	ParseOneLine( std::string& userHandlerName,
+									CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParseOneLine( CSymbolID userHandlerName,
 										CParseTree& parseTree,
 										CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens,
+										CTokenCursor& tokenItty, CTokenList& tokens,
 										bool dontSwallowReturn = false );
-		void	ParseFunctionBody( std::string& userHandlerName,
+		void	ParseFunctionBody( CSymbolID userHandlerName,
 									CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-									std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens,
+									CTokenCursor& tokenItty, CTokenList& tokens,
 									size_t *outEndLineNum = NULL, TIdentifierSubtype endIdentifier = EEndIdentifier );
 		void	ParseParamList( TIdentifierSubtype identifierToEndOn,
 								CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-								std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens,
+								CTokenCursor& tokenItty, CTokenList& tokens,
 								CFunctionCallNode* inFCallToAddTo );
 		CValueNode*	ParseObjCMethodCall( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
+										CTokenCursor& tokenItty, CTokenList& tokens );
 		CValueNode*	ParseNativeFunctionCallStartingAtParams( std::string& methodName, CObjCMethodEntry& methodInfo,
 										CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
+										CTokenCursor& tokenItty, CTokenList& tokens );
 		CValueNode*	ParseTerm( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
+										CTokenCursor& tokenItty, CTokenList& tokens );
 		void	OutputExpressionStack( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
 										std::deque<std::string>	&terms, std::deque<const char*>	&operators );
-		void	CreateVariable( const std::string& varName, const std::string& realVarName, bool initWithName,
+		void	CreateVariable( CSymbolID varName, const std::string& realVarName, bool initWithName,
 								CCodeBlockNodeBase* currFunction, bool isGlobal = false );
-		TIdentifierSubtype	ParseOperator( std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens, int *outPrecedence, LEOInstructionID *outOpName );
+		size_t	PeekOperator( CTokenCursor& tokenItty, int *outPrecedence, LEOInstructionID *outOpName );
 		CValueNode*	ParseChunkExpression( TChunkType typeConstant, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
+										CTokenCursor& tokenItty, CTokenList& tokens );
 		CValueNode*	ParseConstantChunkExpression( TChunkType typeConstant, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
+										CTokenCursor& tokenItty, CTokenList& tokens );
 		CValueNode*	ParseExpression( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
-		void	ParseAddStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
-		void	ParseSubtractStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
-		void	ParseMultiplyStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
-		void	ParseDivideStatement( CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
-										std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
+										CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParseAddStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParseSubtractStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParseMultiplyStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens );
+		void	ParseDivideStatement( CSymbolID userHandlerName, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens );
 		TChunkType	GetChunkTypeNameFromIdentifierSubtype( TIdentifierSubtype identifierToCheck );
 		void	FillArrayWithComponentsSeparatedBy( const char* typesStr, char delimiter, std::deque<std::string> &destTypesList );
 		void	CreateHandlerTrampolineForFunction( const std::string &handlerName, const std::string& procPtrName,
 														const char* typesStr,
 														std::stringstream& theCode, std::string &outTrampolineName );
 		
-		CValueNode*	CollapseExpressionStack( CParseTree& parseTree, std::deque<CValueNode*> &terms, std::deque<LEOInstructionID> &operators );
+		CValueNode*	ParseExpressionAbovePrecedence( int inMinPrecedence, CParseTree& parseTree, CCodeBlockNodeBase* currFunction,
+										CTokenCursor& tokenItty, CTokenList& tokens );
 		
 		bool		GetUsesObjCCall()									{ return mUsesObjCCall; };
 		std::string	GetFirstHandlerName()								{ return mFirstHandlerName; };
@@ -220,8 +388,18 @@ namespace Carlson
 		void		LoadNativeHeaders();
 		void		LoadNativeHeadersFromFile( const char* filepath );
 		
+		// These change CCompilerContext::GetDefault():
 		static void		AddGlobalPropertiesAndOffsetInstructions( TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction );
+		static void		ReplaceGlobalPropertiesAndOffsetInstructions( TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction );
+		static void		RemoveGlobalProperty( TIdentifierSubtype inType );
 		static void		AddHostCommandsAndOffsetInstructions( THostCommandEntry* inEntries, size_t firstHostCommandInstruction );
+		static void		ReplaceHostCommandsAndOffsetInstructions( THostCommandEntry* inEntries, size_t firstHostCommandInstruction );
+		static void		RemoveHostCommand( TIdentifierSubtype inType );
 		static void		AddHostFunctionsAndOffsetInstructions( THostCommandEntry* inEntries, size_t firstHostCommandInstruction );
+		static void		ReplaceHostFunctionsAndOffsetInstructions( THostCommandEntry* inEntries, size_t firstHostCommandInstruction );
+		static void		RemoveHostFunction( TIdentifierSubtype inType );
+		static void		SetStatementParser( TIdentifierSubtype inType, TStatementParserProc inParser );	// inType must be the main form of the identifier, not a synonym.
+		
+		CCompilerContext&	GetContext()						{ return *mContext; };	// Host entries this parser uses.
 	};
 }
@@ -19,6 +19,7 @@ public:
 		: CCommandNode( inTree, "PrintValue", inLineNum ) {};
 
 	virtual void	GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void	WriteToArchive( CParseTreeWriter& ioWriter )		{ WriteCommandToArchive( ioWriter, ENodeKindPrintCommand ); };
 };
 
 } // namespace Carlson
@@ -18,6 +18,7 @@ public:
 	CPushValueCommandNode( CParseTree* inTree, size_t inLineNum ) : CCommandNode( inTree, "PushValue", inLineNum ) {};
 
 	virtual void	GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void	WriteToArchive( CParseTreeWriter& ioWriter )		{ WriteCommandToArchive( ioWriter, ENodeKindPushValueCommand ); };
 };
 
 } // namespace Carlson
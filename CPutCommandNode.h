@@ -18,6 +18,7 @@ public:
 	CPutCommandNode( CParseTree* inTree, size_t inLineNum ) : CCommandNode( inTree, "Put", inLineNum ) {};
 
 	virtual void	GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void	WriteToArchive( CParseTreeWriter& ioWriter )		{ WriteCommandToArchive( ioWriter, ENodeKindPutCommand ); };
 };
 
 } // namespace Carlson
@@ -19,6 +19,7 @@ public:
 		: CCommandNode( inTree, "return", inLineNum ) {};
 
 	virtual void	GenerateCode( CCodeBlock* inCodeBlock );
+	virtual void	WriteToArchive( CParseTreeWriter& ioWriter )		{ WriteCommandToArchive( ioWriter, ENodeKindReturnCommand ); };
 };
 
 } // namespace Carlson
@@ -0,0 +1,531 @@
+/*
+ *  CScriptBundle.cpp
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#include "CScriptBundle.h"
+#include "CBytecodeArchive.h"
+#include <set>
+#include <algorithm>
+#include <stdexcept>
+#include <string.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+extern "C" {
+#include "LEOInstructions.h"
+#include "LEOContextGroup.h"
+#include "ForgeInstructions.h"
+}
+
+
+namespace Carlson
+{
+
+#define SCRIPT_BUNDLE_HEADER_SIZE			48
+#define SCRIPT_BUNDLE_SCRIPT_RECORD_SIZE	20
+#define SCRIPT_BUNDLE_HANDLER_RECORD_SIZE	24
+#define SCRIPT_BUNDLE_VAR_RECORD_SIZE		16
+
+
+// Can we use the instructions in the file as LEOInstructions?
+static bool	HostUsesBundleInstructionLayout()
+{
+	uint16_t	probe = 1;
+	return sizeof(LEOInstruction) == 8 && offsetof(LEOInstruction,param1) == 2 && offsetof(LEOInstruction,param2) == 4
+			&& *(uint8_t*)&probe == 1;
+}
+
+
+#pragma mark [Writing]
+
+// Strings are only added to the pool once, later ones get the first one's offset:
+class CBundleStringPool
+{
+public:
+	uint32_t	OffsetForString( const char* inString )
+	{
+		std::map<std::string,uint32_t>::iterator	foundString = mOffsets.find( inString );
+		if( foundString != mOffsets.end() )
+			return foundString->second;
+		uint32_t	offset = (uint32_t) mData.length();
+		mData.append( inString, strlen(inString) +1 );	// Including the zero byte.
+		mOffsets[inString] = offset;
+		return offset;
+	}
+	
+	const std::string&	GetData() const	{ return mData; };
+
+protected:
+	std::string						mData;
+	std::map<std::string,uint32_t>	mOffsets;
+};
+
+
+/*static*/ void	CScriptBundle::WriteBundle( const char* inFilePath, LEOScript** inScripts, const char** inFileNames, size_t inNumScripts, LEOContextGroup* inGroup )
+{
+	// Collect all handlers and the handler names and instructions they need:
+	std::vector<LEOHandler*>		handlers;
+	std::vector<uint32_t>			handlerFlags;
+	std::set<LEOHandlerID>			handlerIDs;
+	std::set<LEOInstructionID>		instructionIDs;
+	size_t							numStrings = 0,
+									numVarNames = 0;
+	for( size_t s = 0; s < inNumScripts; s++ )
+	{
+		LEOScript*	script = inScripts[s];
+		for( size_t x = 0; x < script->numCommands; x++ )
+		{
+			handlers.push_back( script->commands +x );
+			handlerFlags.push_back( 0 );
+		}
+		for( size_t x = 0; x < script->numFunctions; x++ )
+		{
+			handlers.push_back( script->functions +x );
+			handlerFlags.push_back( CBytecodeArchive::kBytecodeHandlerIsFunction );
+		}
+		numStrings += script->numStrings;
+	}
+	for( size_t x = 0; x < handlers.size(); x++ )
+	{
+		handlerIDs.insert( handlers[x]->handlerName );
+		numVarNames += handlers[x]->numVarNames;
+		for( size_t y = 0; y < handlers[x]->numInstructions; y++ )
+		{
+			LEOInstruction&	instr = handlers[x]->instructions[y];
+			if( kFirstForgeInstruction != 0 && instr.instructionID == kFirstForgeInstruction +COMPILE_HANDLER_LAZILY_INSTR )
+				throw std::logic_error( "Can't bundle handlers that haven't been compiled yet." );
+			if( instr.instructionID == CALL_HANDLER_INSTR )
+				handlerIDs.insert( instr.param2 );
+			if( instructionIDs.find( instr.instructionID ) == instructionIDs.end() )
+			{
+				if( instr.instructionID >= gNumInstructions || CBytecodeArchive::InstructionIDForName( gInstructionNames[instr.instructionID] ) != instr.instructionID )
+					throw std::logic_error( "Can only bundle scripts whose instructions have been registered under unique names." );
+				instructionIDs.insert( instr.instructionID );
+			}
+		}
+	}
+	
+	// Everything but the pool has a fixed size, so we can lay out the file before we write it:
+	uint32_t	handlerNamesOffset = SCRIPT_BUNDLE_HEADER_SIZE;
+	uint32_t	instructionNamesOffset = handlerNamesOffset +(uint32_t) handlerIDs.size() * 8;
+	uint32_t	scriptsOffset = instructionNamesOffset +(uint32_t) instructionIDs.size() * 8;
+	uint32_t	handlerRecordsOffset = scriptsOffset +(uint32_t) inNumScripts * SCRIPT_BUNDLE_SCRIPT_RECORD_SIZE;
+	uint32_t	stringListsOffset = handlerRecordsOffset +(uint32_t) handlers.size() * SCRIPT_BUNDLE_HANDLER_RECORD_SIZE;
+	uint32_t	varRecordsOffset = stringListsOffset +(uint32_t) numStrings * 4;
+	uint32_t	poolOffset = varRecordsOffset +(uint32_t) numVarNames * SCRIPT_BUNDLE_VAR_RECORD_SIZE;
+	
+	std::string			tables;
+	CBundleStringPool	pool;
+	std::map<LEOHandlerID,uint32_t>	nameIndexes;
+	for( std::set<LEOHandlerID>::iterator currID = handlerIDs.begin(); currID != handlerIDs.end(); currID++ )
+	{
+		const char*	handlerName = LEOContextGroupHandlerNameForHandlerID( inGroup, *currID );
+		if( !handlerName )
+			throw std::logic_error( "Script refers to a handler ID that isn't in its context group." );
+		uint32_t	nameIndex = (uint32_t) nameIndexes.size();
+		nameIndexes[*currID] = nameIndex;
+		CBytecodeArchive::AppendUInt32( tables, pool.OffsetForString( handlerName ) );
+		CBytecodeArchive::AppendUInt32( tables, (uint32_t) *currID );
+	}
+	for( std::set<LEOInstructionID>::iterator currID = instructionIDs.begin(); currID != instructionIDs.end(); currID++ )
+	{
+		CBytecodeArchive::AppendUInt32( tables, pool.OffsetForString( gInstructionNames[*currID] ) );
+		CBytecodeArchive::AppendUInt32( tables, *currID );
+	}
+	
+	uint32_t	stringListOffset = stringListsOffset;
+	uint32_t	handlerRecordOffset = handlerRecordsOffset;
+	for( size_t s = 0; s < inNumScripts; s++ )
+	{
+		LEOScript*	script = inScripts[s];
+		size_t		numHandlers = script->numCommands +script->numFunctions;
+		CBytecodeArchive::AppendUInt32( tables, pool.OffsetForString( (inFileNames && inFileNames[s]) ? inFileNames[s] : "" ) );
+		CBytecodeArchive::AppendUInt32( tables, (uint32_t) script->numStrings );
+		CBytecodeArchive::AppendUInt32( tables, stringListOffset );
+		CBytecodeArchive::AppendUInt32( tables, (uint32_t) numHandlers );
+		CBytecodeArchive::AppendUInt32( tables, handlerRecordOffset );
+		stringListOffset += (uint32_t) script->numStrings * 4;
+		handlerRecordOffset += (uint32_t) numHandlers * SCRIPT_BUNDLE_HANDLER_RECORD_SIZE;
+	}
+	
+	uint32_t	varRecordOffset = varRecordsOffset;
+	uint32_t	instructionOffset = 0;	// From the start of the instruction section, which we only know once the pool is done.
+	std::vector<size_t>	instructionOffsetPositions;	// Where in tables we need to add the section's offset.
+	for( size_t x = 0; x < handlers.size(); x++ )
+	{
+		LEOHandler*	handler = handlers[x];
+		CBytecodeArchive::AppendUInt32( tables, handlerFlags[x] );
+		CBytecodeArchive::AppendUInt32( tables, nameIndexes[handler->handlerName] );
+		instructionOffsetPositions.push_back( tables.length() );
+		CBytecodeArchive::AppendUInt32( tables, instructionOffset );
+		CBytecodeArchive::AppendUInt32( tables, (uint32_t) handler->numInstructions );
+		CBytecodeArchive::AppendUInt32( tables, varRecordOffset );
+		CBytecodeArchive::AppendUInt32( tables, (uint32_t) handler->numVarNames );
+		instructionOffset += (uint32_t) handler->numInstructions * 8;
+		varRecordOffset += (uint32_t) handler->numVarNames * SCRIPT_BUNDLE_VAR_RECORD_SIZE;
+	}
+	
+	for( size_t s = 0; s < inNumScripts; s++ )
+	{
+		for( size_t x = 0; x < inScripts[s]->numStrings; x++ )
+			CBytecodeArchive::AppendUInt32( tables, pool.OffsetForString( inScripts[s]->strings[x] ) );
+	}
+	
+	for( size_t x = 0; x < handlers.size(); x++ )
+	{
+		for( size_t y = 0; y < handlers[x]->numVarNames; y++ )
+		{
+			LEOVariableNameMapping&	mapping = handlers[x]->varNames[y];
+			CBytecodeArchive::AppendUInt32( tables, pool.OffsetForString( mapping.variableName ) );
+			CBytecodeArchive::AppendUInt32( tables, pool.OffsetForString( mapping.realVariableName ) );
+			CBytecodeArchive::AppendUInt64( tables, mapping.bpRelativeAddress );
+		}
+	}
+	
+	uint64_t	poolEnd = (uint64_t) poolOffset +pool.GetData().length();
+	uint64_t	instructionSectionOffset = (poolEnd +SCRIPT_BUNDLE_PAGE_SIZE -1) / SCRIPT_BUNDLE_PAGE_SIZE * SCRIPT_BUNDLE_PAGE_SIZE;
+	if( instructionSectionOffset +instructionOffset > 0xFFFFFFFFU )
+		throw std::runtime_error( "Too many scripts for one bundle." );
+	for( size_t x = 0; x < instructionOffsetPositions.size(); x++ )
+	{
+		CBytecodeReader	reader( tables.data(), tables.length(), instructionOffsetPositions[x] );
+		std::string		fixedOffset;
+		CBytecodeArchive::AppendUInt32( fixedOffset, reader.ReadUInt32() +(uint32_t) instructionSectionOffset );
+		tables.replace( instructionOffsetPositions[x], 4, fixedOffset );
+	}
+	
+	std::string		data;
+	data.reserve( (size_t) instructionSectionOffset +instructionOffset );
+	data.append( SCRIPT_BUNDLE_MAGIC, 4 );
+	CBytecodeArchive::AppendUInt32( data, SCRIPT_BUNDLE_VERSION );
+	CBytecodeArchive::AppendUInt32( data, poolOffset );
+	CBytecodeArchive::AppendUInt32( data, (uint32_t) pool.GetData().length() );
+	CBytecodeArchive::AppendUInt32( data, handlerNamesOffset );
+	CBytecodeArchive::AppendUInt32( data, (uint32_t) handlerIDs.size() );
+	CBytecodeArchive::AppendUInt32( data, instructionNamesOffset );
+	CBytecodeArchive::AppendUInt32( data, (uint32_t) instructionIDs.size() );
+	CBytecodeArchive::AppendUInt32( data, scriptsOffset );
+	CBytecodeArchive::AppendUInt32( data, (uint32_t) inNumScripts );
+	CBytecodeArchive::AppendUInt32( data, (uint32_t) instructionSectionOffset );
+	CBytecodeArchive::AppendUInt32( data, instructionOffset );
+	data.append( tables );
+	data.append( pool.GetData() );
+	data.append( (size_t) instructionSectionOffset -data.length(), '\0' );
+	for( size_t x = 0; x < handlers.size(); x++ )
+	{
+		for( size_t y = 0; y < handlers[x]->numInstructions; y++ )
+		{
+			LEOInstruction&	instr = handlers[x]->instructions[y];
+			CBytecodeArchive::AppendUInt16( data, instr.instructionID );
+			CBytecodeArchive::AppendUInt16( data, instr.param1 );
+			CBytecodeArchive::AppendUInt32( data, instr.param2 );
+		}
+	}
+	
+	// Workers may have the old bundle mapped, and would crash if we truncated
+	//	it under them, so write a new file and move it over the old one:
+	std::string		tempPath = std::string(inFilePath) +".XXXXXX";
+	int				fd = mkstemp( &tempPath[0] );
+	if( fd < 0 )
+		throw std::runtime_error( std::string("Couldn't create file \"") +inFilePath +"\"." );
+	bool			success = fchmod( fd, 0644 ) == 0;
+	for( size_t written = 0; success && written < data.length(); )
+	{
+		ssize_t	amount = write( fd, data.data() +written, data.length() -written );
+		success = amount > 0;
+		if( success )
+			written += (size_t) amount;
+	}
+	success = (close( fd ) == 0) && success;
+	if( !success || rename( tempPath.c_str(), inFilePath ) != 0 )
+	{
+		unlink( tempPath.c_str() );
+		throw std::runtime_error( std::string("Couldn't write file \"") +inFilePath +"\"." );
+	}
+}
+
+
+#pragma mark -
+#pragma mark [Reading]
+
+CScriptBundle::CScriptBundle( const char* inFilePath )
+	: mData(NULL), mDataLength(0), mInstructionIDsMatch(false), mGroup(NULL)
+{
+	int		fd = open( inFilePath, O_RDONLY );
+	if( fd < 0 )
+		throw std::runtime_error( std::string("Couldn't open file \"") +inFilePath +"\"." );
+	
+	struct stat		fileInfo;
+	void*			fileContents = MAP_FAILED;
+	if( fstat( fd, &fileInfo ) == 0 && fileInfo.st_size > 0 )
+		fileContents = mmap( NULL, (size_t) fileInfo.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+	close( fd );	// The mapping stays valid without the descriptor.
+	if( fileContents == MAP_FAILED )
+		throw std::runtime_error( std::string("Couldn't read file \"") +inFilePath +"\"." );
+	mData = (const char*) fileContents;
+	mDataLength = (size_t) fileInfo.st_size;
+	
+	try
+	{
+		CBytecodeReader		reader( mData, mDataLength );
+		if( memcmp( reader.ReadBytes( 4 ), SCRIPT_BUNDLE_MAGIC, 4 ) != 0 )
+			throw std::runtime_error( std::string("\"") +inFilePath +"\" is not a script bundle." );
+		if( reader.ReadUInt32() != SCRIPT_BUNDLE_VERSION )
+			throw std::runtime_error( std::string("\"") +inFilePath +"\" was written by a different version of Forge." );
+		mPoolOffset = reader.ReadUInt32();
+		mPoolSize = reader.ReadUInt32();
+		uint32_t	handlerNamesOffset = reader.ReadUInt32();
+		uint32_t	numHandlerNames = reader.ReadUInt32();
+		uint32_t	instructionNamesOffset = reader.ReadUInt32();
+		uint32_t	numInstructionNames = reader.ReadUInt32();
+		mScriptTableOffset = reader.ReadUInt32();
+		mNumScripts = reader.ReadUInt32();
+		mInstructionSectionOffset = reader.ReadUInt32();
+		mInstructionSectionSize = reader.ReadUInt32();
+		
+		// Every string ends in the pool, so a zero byte at its end is all we need to check:
+		if( mPoolSize == 0 || mPoolOffset > mDataLength || mPoolSize > mDataLength -mPoolOffset || mData[mPoolOffset +mPoolSize -1] != 0
+			|| (mInstructionSectionOffset % SCRIPT_BUNDLE_PAGE_SIZE) != 0 || mInstructionSectionOffset > mDataLength
+			|| mInstructionSectionSize > mDataLength -mInstructionSectionOffset
+			|| (uint64_t) mNumScripts * SCRIPT_BUNDLE_SCRIPT_RECORD_SIZE > mDataLength -std::min( (size_t) mScriptTableOffset, mDataLength ) )
+			throw std::runtime_error( "Script bundle is damaged." );
+		
+		mInstructionIDsMatch = HostUsesBundleInstructionLayout();
+		CBytecodeReader		instructionNameReader( mData, mDataLength, instructionNamesOffset );
+		for( size_t x = 0; x < numInstructionNames; x++ )
+		{
+			const char*	instructionName = StringAtPoolOffset( instructionNameReader.ReadUInt32() );
+			uint32_t	writtenID = instructionNameReader.ReadUInt32();
+			size_t		instructionID = CBytecodeArchive::InstructionIDForName( instructionName );
+			if( instructionID >= gNumInstructions )
+				throw std::runtime_error( std::string("Script bundle needs the instruction \"") +instructionName +"\", which hasn't been registered." );
+			if( writtenID > 0xFFFF )
+				throw std::runtime_error( "Script bundle is damaged." );
+			mInstructionIDs[(uint16_t)writtenID] = (LEOInstructionID) instructionID;
+			if( instructionID != writtenID )
+				mInstructionIDsMatch = false;
+		}
+		
+		CBytecodeReader		handlerNameReader( mData, mDataLength, handlerNamesOffset );
+		if( numHandlerNames > mDataLength / 8 )
+			throw std::runtime_error( "Script bundle is damaged." );
+		mHandlerNames.reserve( numHandlerNames );
+		mWrittenHandlerIDs.reserve( numHandlerNames );
+		for( size_t x = 0; x < numHandlerNames; x++ )
+		{
+			mHandlerNames.push_back( StringAtPoolOffset( handlerNameReader.ReadUInt32() ) );
+			mWrittenHandlerIDs.push_back( (LEOHandlerID) handlerNameReader.ReadUInt32() );
+		}
+	}
+	catch( ... )
+	{
+		munmap( (void*) mData, mDataLength );
+		throw;
+	}
+}
+
+
+CScriptBundle::~CScriptBundle()
+{
+	if( mGroup )
+		LEOContextGroupRelease( mGroup );
+	munmap( (void*) mData, mDataLength );
+}
+
+
+const char*	CScriptBundle::StringAtPoolOffset( uint32_t inOffset ) const
+{
+	if( inOffset >= mPoolSize )
+		throw std::runtime_error( "Script bundle is damaged." );
+	return mData +mPoolOffset +inOffset;
+}
+
+
+const char*	CScriptBundle::GetScriptFileName( size_t inIndex ) const
+{
+	if( inIndex >= mNumScripts )
+		throw std::out_of_range( "No script with that index in bundle." );
+	CBytecodeReader		reader( mData, mDataLength, mScriptTableOffset +inIndex * SCRIPT_BUNDLE_SCRIPT_RECORD_SIZE );
+	return StringAtPoolOffset( reader.ReadUInt32() );
+}
+
+
+// Registers all handler names with the group in the order of the IDs they
+//	had when the bundle was written, so a fresh group gives them the same IDs:
+void	CScriptBundle::LookUpHandlerIDs( LEOContextGroup* inGroup )
+{
+	if( inGroup == mGroup )
+		return;
+	
+	mHandlerIDs.resize( mHandlerNames.size() );
+	mHandlerIDsForWrittenIDs.clear();
+	for( size_t x = 0; x < mHandlerNames.size(); x++ )
+	{
+		mHandlerIDs[x] = LEOContextGroupHandlerIDForHandlerName( inGroup, mHandlerNames[x] );
+		mHandlerIDsForWrittenIDs[mWrittenHandlerIDs[x]] = mHandlerIDs[x];
+	}
+	
+	if( mGroup )
+		LEOContextGroupRelease( mGroup );
+	mGroup = LEOContextGroupRetain( inGroup );
+}
+
+
+// -----------------------------------------------------------------------------
+//	CreateScript:
+//		Checks each handler's instructions before adding it. Those whose IDs
+//		are all still right in this host, group and script are used right
+//		where they are in the mapped file, the others are copied and fixed.
+// -----------------------------------------------------------------------------
+
+LEOScript*	CScriptBundle::CreateScript( size_t inIndex, LEOContextGroup* inGroup, LEOObjectID inOwnerObject, LEOObjectSeed inOwnerSeed )
+{
+	if( inIndex >= mNumScripts )
+		throw std::out_of_range( "No script with that index in bundle." );
+	LookUpHandlerIDs( inGroup );
+	
+	CBytecodeReader		scriptReader( mData, mDataLength, mScriptTableOffset +inIndex * SCRIPT_BUNDLE_SCRIPT_RECORD_SIZE );
+	scriptReader.ReadUInt32();	// File name.
+	uint32_t			numStrings = scriptReader.ReadUInt32();
+	CBytecodeReader		stringReader( mData, mDataLength, scriptReader.ReadUInt32() );
+	uint32_t			numHandlers = scriptReader.ReadUInt32();
+	uint32_t			handlerRecordsOffset = scriptReader.ReadUInt32();
+	
+	LEOScript*	script = LEOScriptCreateForOwner( inOwnerObject, inOwnerSeed );
+	try
+	{
+		if( numStrings > mDataLength / 4 )
+			throw std::runtime_error( "Script bundle is damaged." );
+		std::vector<uint32_t>	stringIndexes( numStrings );
+		bool					stringIndexesMatch = true;
+		for( size_t x = 0; x < numStrings; x++ )
+		{
+			stringIndexes[x] = (uint32_t) LEOScriptAddString( script, StringAtPoolOffset( stringReader.ReadUInt32() ) );
+			if( stringIndexes[x] != x )
+				stringIndexesMatch = false;
+		}
+		
+		for( size_t x = 0; x < numHandlers; x++ )
+		{
+			CBytecodeReader		handlerReader( mData, mDataLength, handlerRecordsOffset +x * SCRIPT_BUNDLE_HANDLER_RECORD_SIZE );
+			uint32_t			flags = handlerReader.ReadUInt32();
+			uint32_t			nameIndex = handlerReader.ReadUInt32();
+			uint32_t			instructionsOffset = handlerReader.ReadUInt32();
+			uint32_t			numInstructions = handlerReader.ReadUInt32();
+			uint32_t			varRecordsOffset = handlerReader.ReadUInt32();
+			uint32_t			numVarNames = handlerReader.ReadUInt32();
+			if( nameIndex >= mHandlerIDs.size() || instructionsOffset < mInstructionSectionOffset || (instructionsOffset % 8) != 0
+				|| (uint64_t) numInstructions * 8 > (uint64_t) mInstructionSectionOffset +mInstructionSectionSize -instructionsOffset )
+				throw std::runtime_error( "Script bundle is damaged." );
+			
+			// Check the instructions, and whether we'd need to change any:
+			bool				canUseMappedInstructions = mInstructionIDsMatch;
+			CBytecodeReader		instructionReader( mData, mDataLength, instructionsOffset );
+			for( size_t y = 0; y < numInstructions; y++ )
+			{
+				std::map<uint16_t,LEOInstructionID>::iterator	foundID = mInstructionIDs.find( instructionReader.ReadUInt16() );
+				instructionReader.ReadUInt16();	// param1
+				uint32_t	param2 = instructionReader.ReadUInt32();
+				if( foundID == mInstructionIDs.end() )
+					throw std::runtime_error( "Script bundle is damaged." );
+				if( CBytecodeArchive::InstructionRefersToString( foundID->second ) )
+				{
+					if( param2 >= numStrings )
+						throw std::runtime_error( "Script bundle is damaged." );
+					canUseMappedInstructions = canUseMappedInstructions && stringIndexesMatch;
+				}
+				else if( foundID->second == CALL_HANDLER_INSTR )
+				{
+					std::map<LEOHandlerID,LEOHandlerID>::iterator	foundHandlerID = mHandlerIDsForWrittenIDs.find( param2 );
+					if( foundHandlerID == mHandlerIDsForWrittenIDs.end() )
+						throw std::runtime_error( "Script bundle is damaged." );
+					canUseMappedInstructions = canUseMappedInstructions && foundHandlerID->second == param2;
+				}
+			}
+			
+			LEOHandler*		handler = (flags & CBytecodeArchive::kBytecodeHandlerIsFunction) ? LEOScriptAddFunctionHandlerWithID( script, mHandlerIDs[nameIndex] ) : LEOScriptAddCommandHandlerWithID( script, mHandlerIDs[nameIndex] );
+			if( numInstructions > 0 && canUseMappedInstructions )
+			{
+				handler->instructions = (LEOInstruction*) (mData +instructionsOffset);	// Read-only, shared with everyone else who mapped the bundle.
+				handler->numInstructions = numInstructions;
+			}
+			else if( numInstructions > 0 )
+			{
+				LEOInstruction*	instructions = (LEOInstruction*) realloc( handler->instructions, numInstructions * sizeof(LEOInstruction) );
+				if( !instructions )
+					throw std::bad_alloc();
+				handler->instructions = instructions;
+				handler->numInstructions = numInstructions;
+				
+				instructionReader = CBytecodeReader( mData, mDataLength, instructionsOffset );
+				for( size_t y = 0; y < numInstructions; y++ )
+				{
+					LEOInstruction&	instr = handler->instructions[y];
+					instr.instructionID = mInstructionIDs[instructionReader.ReadUInt16()];
+					instr.param1 = instructionReader.ReadUInt16();
+					instr.param2 = instructionReader.ReadUInt32();
+					if( CBytecodeArchive::InstructionRefersToString( instr.instructionID ) )
+						instr.param2 = stringIndexes[instr.param2];
+					else if( instr.instructionID == CALL_HANDLER_INSTR )
+						instr.param2 = (uint32_t) mHandlerIDsForWrittenIDs[instr.param2];
+				}
+			}
+			
+			CBytecodeReader		varReader( mData, mDataLength, varRecordsOffset );
+			for( size_t y = 0; y < numVarNames; y++ )
+			{
+				const char*	varName = StringAtPoolOffset( varReader.ReadUInt32() );
+				const char*	realVarName = StringAtPoolOffset( varReader.ReadUInt32() );
+				LEOHandlerAddVariableNameMapping( handler, varName, realVarName, (size_t) varReader.ReadUInt64() );
+			}
+		}
+	}
+	catch( ... )
+	{
+		ForgetScript( script );
+		LEOScriptRelease( script );
+		throw;
+	}
+	
+	return script;
+}
+
+
+bool	CScriptBundle::HandlerUsesMappedInstructions( LEOHandler* inHandler ) const
+{
+	const char*	instructions = (const char*) inHandler->instructions;
+	return instructions >= mData && instructions < mData +mDataLength;
+}
+
+
+void	CScriptBundle::ForgetScript( LEOScript* inScript )
+{
+	for( size_t x = 0; x < inScript->numCommands; x++ )
+	{
+		if( HandlerUsesMappedInstructions( inScript->commands +x ) )
+		{
+			inScript->commands[x].instructions = NULL;
+			inScript->commands[x].numInstructions = 0;
+		}
+	}
+	for( size_t x = 0; x < inScript->numFunctions; x++ )
+	{
+		if( HandlerUsesMappedInstructions( inScript->functions +x ) )
+		{
+			inScript->functions[x].instructions = NULL;
+			inScript->functions[x].numInstructions = 0;
+		}
+	}
+}
+
+}
@@ -0,0 +1,106 @@
+/*
+ *  CScriptBundle.h
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+extern "C" {
+#include "LEOInterpreter.h"
+#include "LEOScript.h"
+}
+
+
+namespace Carlson
+{
+
+#define SCRIPT_BUNDLE_MAGIC				"FGSB"
+#define SCRIPT_BUNDLE_VERSION			1		// Bump whenever the layout below changes.
+#define SCRIPT_BUNDLE_PAGE_SIZE			16384	// Instructions start at a multiple of this, which is a multiple of the page size of every CPU we run on.
+#define SCRIPT_BUNDLE_FILE_SUFFIX		".fbundle"
+
+
+// Many compiled scripts in one file, meant to be mapped read-only by every
+//	worker process of a deployment, which then all share the same pages:
+//	The instructions of all handlers are kept in Leonie's own in-memory
+//	layout in a page-aligned section at the end of the file, and scripts
+//	loaded from the bundle point their handlers right at them instead of
+//	copying them. That only works as long as the IDs in them are right, so
+//	the bundle records the instruction and handler IDs it was written with,
+//	and a handler is only copied and fixed up if the host registered an
+//	instruction differently, the context group gave one of the handlers it
+//	calls a different ID, or the CPU has a different byte order. Loading a
+//	bundle into a fresh context group of the host that built it, before
+//	anything else, gives every handler the ID it had when it was written.
+//	Each string is only stored once, in a pool all scripts share.
+//
+//	Layout (little-endian uint32s unless noted, offsets from the file start):
+//		char[4]		SCRIPT_BUNDLE_MAGIC
+//		uint32		SCRIPT_BUNDLE_VERSION
+//		uint32		offset and size of the string pool
+//		uint32		offset and number of handler names, each:
+//			uint32		pool offset of the name, handler ID when written
+//		uint32		offset and number of instruction names, each:
+//			uint32		pool offset of the name, instruction ID when written
+//		uint32		offset and number of scripts, each:
+//			uint32		pool offset of the file name it was compiled from
+//			uint32		number of strings and offset of their pool offsets
+//			uint32		number of handlers and offset of their records, each:
+//				uint32		flags (CBytecodeArchive::kBytecodeHandlerIsFunction)
+//				uint32		index of its name in the handler name table
+//				uint32		offset and number of its instructions
+//				uint32		offset and number of variable name mappings, each:
+//					uint32		pool offsets of name and real name
+//					uint64		bp-relative address
+//		uint32		offset and size of the instruction section
+//	The pool is zero-terminated UTF8 strings. Instructions are LEOInstructions
+//	(uint16 ID, uint16 param1, uint32 param2) as the writing host had them,
+//	string instructions referring to their script's strings, handler calls to
+//	the written handler IDs.
+class CScriptBundle
+{
+public:
+	explicit CScriptBundle( const char* inFilePath );	// Maps the file. Throws std::runtime_error if it's not a bundle or needs instructions the host hasn't registered.
+	~CScriptBundle();	// Forget all scripts created from the bundle before you delete it.
+	
+	size_t		GetNumScripts() const		{ return mNumScripts; };
+	const char*	GetScriptFileName( size_t inIndex ) const;	// Points into the mapped file.
+	
+	LEOScript*	CreateScript( size_t inIndex, LEOContextGroup* inGroup, LEOObjectID inOwnerObject, LEOObjectSeed inOwnerSeed );	// Throws if the script's data is damaged. Call ForgetScript() before you release the script.
+	void		ForgetScript( LEOScript* inScript );	// Detaches the handlers from instructions in the mapped file, so releasing the script doesn't try to free() them.
+	bool		HandlerUsesMappedInstructions( LEOHandler* inHandler ) const;
+	
+	static void	WriteBundle( const char* inFilePath, LEOScript** inScripts, const char** inFileNames, size_t inNumScripts, LEOContextGroup* inGroup );	// Handler IDs must be from inGroup. inFileNames may be NULL. Replaces an existing file without disturbing processes that have it mapped.
+
+protected:
+	const char*	StringAtPoolOffset( uint32_t inOffset ) const;
+	void		LookUpHandlerIDs( LEOContextGroup* inGroup );
+
+protected:
+	const char*								mData;
+	size_t									mDataLength;
+	uint32_t								mPoolOffset;
+	uint32_t								mPoolSize;
+	uint32_t								mScriptTableOffset;
+	uint32_t								mNumScripts;
+	uint32_t								mInstructionSectionOffset;
+	uint32_t								mInstructionSectionSize;
+	std::map<uint16_t,LEOInstructionID>		mInstructionIDs;		// ID the instruction had when written -> ID in this host.
+	bool									mInstructionIDsMatch;	// Can instructions be used as they are in the file?
+	std::vector<const char*>				mHandlerNames;			// Index in the bundle's handler name table -> name.
+	std::vector<LEOHandlerID>				mWrittenHandlerIDs;		// Index -> ID the handler had when written.
+	LEOContextGroup*						mGroup;					// Group mHandlerIDs are for, retained.
+	std::vector<LEOHandlerID>				mHandlerIDs;			// Index -> ID in mGroup.
+	std::map<LEOHandlerID,LEOHandlerID>		mHandlerIDsForWrittenIDs;
+};
+
+}
@@ -0,0 +1,208 @@
+/*
+ *  CSnippetCache.cpp
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#include "CSnippetCache.h"
+#include "CParser.h"
+#include "CParseTree.h"
+#include "CCodeBlock.h"
+#include "CToken.h"
+#include <stdexcept>
+#include <stdint.h>
+
+extern "C" {
+#include "LEOScript.h"
+#include "LEOContextGroup.h"
+}
+
+
+namespace Carlson
+{
+
+// 64-bit FNV-1a constants. C++98 has no 64-bit literals, so they're put together from two halves:
+#define FNV1A_OFFSET_BASIS		((((uint64_t) 0xCBF29CE4) << 32) | 0x84222325)
+#define FNV1A_PRIME				((((uint64_t) 0x00000100) << 32) | 0x000001B3)
+
+
+// FNV-1a, good enough to tell apart the few hundred snippets we keep:
+static uint64_t	HashText( const char* inText, size_t inLength )
+{
+	uint64_t	hash = FNV1A_OFFSET_BASIS;
+	for( size_t x = 0; x < inLength; x++ )
+	{
+		hash ^= (uint8_t) inText[x];
+		hash *= FNV1A_PRIME;
+	}
+	
+	return hash;
+}
+
+
+bool	CSnippetCache::CSnippetKey::operator <( const CSnippetKey& inOther ) const
+{
+	if( mHash != inOther.mHash )
+		return mHash < inOther.mHash;
+	if( mGroup != inOther.mGroup )
+		return mGroup < inOther.mGroup;
+	if( mOwnerObject != inOther.mOwnerObject )
+		return mOwnerObject < inOther.mOwnerObject;
+	return mOwnerSeed < inOther.mOwnerSeed;
+}
+
+
+CSnippetCache::CSnippetCache()
+	: mMaxEntries(SNIPPET_CACHE_DEFAULT_MAX_ENTRIES), mMaxBytes(SNIPPET_CACHE_DEFAULT_MAX_BYTES), mNumBytes(0), mGeneration(0),
+		mNumHits(0), mNumMisses(0), mNumEvictions(0)
+{
+	
+}
+
+
+CSnippetCache::CSnippetCache( const CSnippetCache& inOriginal )
+	: mMaxEntries(inOriginal.mMaxEntries), mMaxBytes(inOriginal.mMaxBytes), mNumBytes(0), mGeneration(0),
+		mNumHits(0), mNumMisses(0), mNumEvictions(0)
+{
+	
+}
+
+
+CSnippetCache::~CSnippetCache()
+{
+	Flush();
+}
+
+
+// -----------------------------------------------------------------------------
+//	CompileCommandOrExpression:
+//		Hand out the script we compiled for the same text before, or compile
+//		it like LEOParseTreeCreateForCommandOrExpressionFromUTF8Characters()
+//		followed by LEOScriptCompileAndAddParseTree() would, and remember it.
+// -----------------------------------------------------------------------------
+
+LEOScript*	CSnippetCache::CompileCommandOrExpression( CCompilerContext& inContext, const char* inCode, size_t inCodeLength, const char* inFileName, LEOContextGroup* inGroup, LEOObjectID inOwnerObject, LEOObjectSeed inOwnerSeed )
+{
+	if( mGeneration != inContext.GetGeneration() )	// Host commands etc. changed, so the same text may compile differently now.
+	{
+		Flush();
+		mGeneration = inContext.GetGeneration();
+	}
+	
+	CSnippetKey		key;
+	key.mHash = HashText( inCode, inCodeLength );
+	key.mGroup = inGroup;
+	key.mOwnerObject = inOwnerObject;
+	key.mOwnerSeed = inOwnerSeed;
+	
+	std::map<CSnippetKey,CSnippetList::iterator>::iterator	foundEntry = mEntriesByKey.find( key );
+	if( foundEntry != mEntriesByKey.end() && foundEntry->second->mCode.compare( 0, std::string::npos, inCode, inCodeLength ) == 0 )
+	{
+		mNumHits++;
+		mEntries.splice( mEntries.begin(), mEntries, foundEntry->second );	// Most recently used goes first.
+		return LEOScriptRetain( foundEntry->second->mScript );
+	}
+	
+	mNumMisses++;
+	
+	CParseTree		parseTree;
+	CParser			parser( &inContext );
+	CTokenizer		tokenizer( inCode, inCodeLength );
+	CTokenList		tokens( &tokenizer, &parseTree.GetSymbols() );	// Tokenizes while parsing.
+	parser.SetThrowOnError( false );	// Typos in the message box are common, don't pay for unwinding on each one.
+	parser.ParseCommandOrExpression( inFileName, tokens, parseTree );
+	if( parser.HadError() )
+		throw std::runtime_error( parser.GetError().GetMessage() );
+	parseTree.Simplify();
+	
+	LEOScript*		script = LEOScriptCreateForOwner( inOwnerObject, inOwnerSeed );
+	try
+	{
+		CCodeBlock		block( inGroup, script );
+		parseTree.GenerateCode( &block );
+	}
+	catch( ... )
+	{
+		LEOScriptRelease( script );
+		throw;
+	}
+	
+	if( mMaxEntries == 0 )
+		return script;
+	
+	if( foundEntry != mEntriesByKey.end() )	// Different text with the same hash? Keep the newer one.
+	{
+		mNumBytes -= foundEntry->second->mNumBytes;
+		ReleaseEntry( *foundEntry->second );
+		mEntries.erase( foundEntry->second );
+		mEntriesByKey.erase( foundEntry );
+	}
+	
+	CSnippetEntry	newEntry;
+	newEntry.mKey = key;
+	newEntry.mCode.assign( inCode, inCodeLength );
+	newEntry.mScript = LEOScriptRetain( script );
+	newEntry.mNumBytes = inCodeLength;
+	LEOHandler*		runHandler = LEOScriptFindCommandHandlerWithID( script, LEOContextGroupHandlerIDForHandlerName( inGroup, ":run" ) );
+	if( runHandler )
+		newEntry.mNumBytes += runHandler->numInstructions * sizeof(LEOInstruction);
+	LEOContextGroupRetain( inGroup );
+	
+	mEntries.push_front( newEntry );
+	mEntriesByKey[key] = mEntries.begin();
+	mNumBytes += newEntry.mNumBytes;
+	
+	EvictDownTo( mMaxEntries, mMaxBytes );
+	
+	return script;
+}
+
+
+void	CSnippetCache::SetLimits( size_t inMaxEntries, size_t inMaxBytes )
+{
+	mMaxEntries = inMaxEntries;
+	mMaxBytes = inMaxBytes;
+	
+	EvictDownTo( mMaxEntries, mMaxBytes );
+}
+
+
+void	CSnippetCache::Flush()
+{
+	CSnippetList::iterator	itty;
+	for( itty = mEntries.begin(); itty != mEntries.end(); itty++ )
+		ReleaseEntry( *itty );
+	mEntries.clear();
+	mEntriesByKey.clear();
+	mNumBytes = 0;
+}
+
+
+// Drop the least recently used entries until we're within the given limits.
+//	The newest entry stays even if it is bigger than inMaxBytes on its own,
+//	unless inMaxEntries is 0:
+void	CSnippetCache::EvictDownTo( size_t inMaxEntries, size_t inMaxBytes )
+{
+	while( !mEntries.empty() && (mEntries.size() > inMaxEntries || (mNumBytes > inMaxBytes && mEntries.size() > 1)) )
+	{
+		CSnippetEntry&	oldestEntry = mEntries.back();
+		mEntriesByKey.erase( oldestEntry.mKey );
+		mNumBytes -= oldestEntry.mNumBytes;
+		ReleaseEntry( oldestEntry );
+		mEntries.pop_back();
+		mNumEvictions++;
+	}
+}
+
+
+void	CSnippetCache::ReleaseEntry( CSnippetEntry& inEntry )
+{
+	LEOScriptRelease( inEntry.mScript );
+	inEntry.mScript = NULL;
+	LEOContextGroupRelease( inEntry.mKey.mGroup );
+}
+
+}
@@ -0,0 +1,95 @@
+/*
+ *  CSnippetCache.h
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#pragma once
+
+#include <string>
+#include <list>
+#include <map>
+#include <stdint.h>
+
+extern "C" {
+#include "LEOValue.h"
+}
+
+struct LEOScript;
+struct LEOContextGroup;
+
+
+namespace Carlson
+{
+
+class CCompilerContext;
+
+
+#define SNIPPET_CACHE_DEFAULT_MAX_ENTRIES	256				// Scripts the cache keeps around before it starts dropping the least recently used.
+#define SNIPPET_CACHE_DEFAULT_MAX_BYTES		(1024 * 1024)	// Source text and instructions of all entries.
+
+
+// Compiled commands and expressions (what "do" and the message box run),
+//	so compiling the same text again is just a look-up. Each entry is a
+//	script with the ":run" handler, for one context group and owner. Belongs
+//	to a CCompilerContext, so it's only used by one thread at a time.
+class CSnippetCache
+{
+public:
+	CSnippetCache();
+	CSnippetCache( const CSnippetCache& inOriginal );	// Copies the limits, not the entries.
+	~CSnippetCache();
+	
+	LEOScript*	CompileCommandOrExpression( CCompilerContext& inContext, const char* inCode, size_t inCodeLength, const char* inFileName, LEOContextGroup* inGroup, LEOObjectID inOwnerObject, LEOObjectSeed inOwnerSeed );	// Returns a retained script with a ":run" handler, which the caller must release. Throws on syntax errors, which aren't cached.
+	
+	void		SetLimits( size_t inMaxEntries, size_t inMaxBytes );	// 0 entries turns off caching.
+	void		Flush();	// Releases all entries. Doesn't reset the counters.
+	
+	size_t		GetNumHits() const		{ return mNumHits; };
+	size_t		GetNumMisses() const	{ return mNumMisses; };
+	size_t		GetNumEvictions() const	{ return mNumEvictions; };
+	size_t		GetNumEntries() const	{ return mEntries.size(); };
+	size_t		GetNumBytes() const		{ return mNumBytes; };
+	
+protected:
+	struct CSnippetKey
+	{
+		uint64_t			mHash;		// Of the source text.
+		LEOContextGroup*	mGroup;		// Handler IDs in the script are only valid in this group.
+		LEOObjectID			mOwnerObject;
+		LEOObjectSeed		mOwnerSeed;
+		
+		bool	operator <( const CSnippetKey& inOther ) const;
+	};
+	
+	struct CSnippetEntry
+	{
+		CSnippetKey		mKey;
+		std::string		mCode;		// To tell apart texts with the same hash.
+		LEOScript*		mScript;	// Retained, and so is its mKey.mGroup.
+		size_t			mNumBytes;
+	};
+	
+	typedef std::list<CSnippetEntry>	CSnippetList;
+	
+	void		EvictDownTo( size_t inMaxEntries, size_t inMaxBytes );
+	void		ReleaseEntry( CSnippetEntry& inEntry );
+	
+	CSnippetCache&	operator =( const CSnippetCache& inOriginal );	// Not assignable, the entries are retained.
+	
+protected:
+	CSnippetList							mEntries;	// Most recently used first.
+	std::map<CSnippetKey,CSnippetList::iterator>	mEntriesByKey;
+	size_t		mMaxEntries;
+	size_t		mMaxBytes;
+	size_t		mNumBytes;
+	size_t		mGeneration;	// CCompilerContext's generation our entries were compiled with.
+	size_t		mNumHits;
+	size_t		mNumMisses;
+	size_t		mNumEvictions;
+};
+
+}
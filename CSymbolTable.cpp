@@ -0,0 +1,173 @@
+/*
+ *  CSymbolTable.cpp
+ *  HyperCompiler
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#include "CSymbolTable.h"
+#include "CToken.h"
+#include <stdexcept>
+
+
+namespace Carlson
+{
+
+#define SYMBOL_HASH_TABLE_INITIAL_SIZE		256	// Must be a power of two.
+
+
+static inline uint32_t	SymbolHashForText( const char* inStr, size_t inLen )
+{
+	uint32_t		hash = 2166136261U;	// FNV-1a.
+
+	for( size_t x = 0; x < inLen; x++ )
+	{
+		hash ^= (unsigned char) inStr[x];
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+
+CSymbolTable::CSymbolTable()
+	: mSlots( SYMBOL_HASH_TABLE_INITIAL_SIZE, kNoSymbol ), mUsageLog(NULL), mFirstLoggedSymbol(kNoSymbol), mUsageLogNumber(0)
+{
+	mKeywordTexts.reserve( ELastIdentifier_Sentinel );
+	for( size_t x = 0; x < (size_t) ELastIdentifier_Sentinel; x++ )
+		mKeywordTexts.push_back( std::string( gIdentifierStrings[x] ) );
+}
+
+
+CSymbolID	CSymbolTable::SymbolForText( const char* str, size_t len, bool mayBeKeyword )
+{
+	mLowercased.resize( len );
+	if( len > 0 )
+		mLowercased.resize( ToLowerUTF8( str, len, &mLowercased[0] ) );
+
+	if( mayBeKeyword )
+	{
+		TIdentifierSubtype	subType = CToken::IdentifierTypeFromText( mLowercased.c_str() );
+		if( subType != ELastIdentifier_Sentinel )
+			return subType;
+	}
+
+	return SymbolForLowercasedText( mLowercased.data(), mLowercased.length() );
+}
+
+
+CSymbolID	CSymbolTable::SymbolForLowercasedText( const char* str, size_t len )
+{
+	uint32_t	hash = SymbolHashForText( str, len );
+	size_t		mask = mSlots.size() -1;
+	size_t		slot = hash & mask;
+
+	while( mSlots[slot] != kNoSymbol )
+	{
+		size_t		index = mSlots[slot] -ELastIdentifier_Sentinel;
+		if( mHashes[index] == hash && mTexts[index].length() == len && mTexts[index].compare( 0, len, str, len ) == 0 )
+		{
+			if( mUsageLog )
+				LogUsage( mSlots[slot] );
+			return mSlots[slot];
+		}
+		slot = (slot +1) & mask;
+	}
+
+	if( (size() +1) >= kNoSymbol )
+		throw std::runtime_error( "Too many identifiers in script." );
+
+	CSymbolID	newSymbol = (CSymbolID) size();
+	mTexts.push_back( std::string( str, len ) );
+	mHashes.push_back( hash );
+	mSlots[slot] = newSymbol;
+
+	if( (mTexts.size() * 2) > mSlots.size() )	// Keep load factor below 50% so probe chains stay short.
+		GrowHashTable();
+
+	if( mUsageLog )
+		LogUsage( newSymbol );
+
+	return newSymbol;
+}
+
+
+void	CSymbolTable::GrowHashTable()
+{
+	std::vector<CSymbolID>	newSlots( mSlots.size() * 2, kNoSymbol );
+	size_t					mask = newSlots.size() -1;
+
+	for( size_t x = 0; x < mTexts.size(); x++ )
+	{
+		size_t		slot = mHashes[x] & mask;
+		while( newSlots[slot] != kNoSymbol )
+			slot = (slot +1) & mask;
+		newSlots[slot] = (CSymbolID)( x +ELastIdentifier_Sentinel );
+	}
+
+	mSlots.swap( newSlots );
+}
+
+
+const std::string&	CSymbolTable::TextForSymbol( CSymbolID inSymbol ) const
+{
+	if( inSymbol < (CSymbolID) ELastIdentifier_Sentinel )
+		return mKeywordTexts[inSymbol];
+	else if( inSymbol < size() )
+		return mTexts[inSymbol -ELastIdentifier_Sentinel];
+	else
+		throw std::logic_error( "Symbol doesn't belong to this symbol table." );
+}
+
+
+CSymbolID	CSymbolTable::VariableSymbolForSymbol( CSymbolID inSymbol )
+{
+	if( inSymbol >= size() )
+		throw std::logic_error( "Symbol doesn't belong to this symbol table." );
+	
+	if( inSymbol >= mVariableSymbols.size() )
+		mVariableSymbols.resize( size(), kNoSymbol );
+
+	if( mVariableSymbols[inSymbol] == kNoSymbol )
+	{
+		std::string		varName( "var_" );
+		varName.append( TextForSymbol( inSymbol ) );
+		mVariableSymbols[inSymbol] = SymbolForLowercasedText( varName.data(), varName.length() );	// "var_" + identifier is never a keyword.
+	}
+	else if( mUsageLog )	// Didn't go through SymbolForLowercasedText(), so log it ourselves.
+		LogUsage( mVariableSymbols[inSymbol] );
+
+	return mVariableSymbols[inSymbol];
+}
+
+
+
+void	CSymbolTable::StartUsageLog( std::vector<CSymbolID>* outUsedSymbols )
+{
+	if( mFirstLoggedSymbol == kNoSymbol )
+		mFirstLoggedSymbol = (CSymbolID) size();
+	
+	mUsageLogNumber++;
+	mUsageLog = outUsedSymbols;
+}
+
+
+void	CSymbolTable::LogUsage( CSymbolID inSymbol )
+{
+	if( inSymbol < mFirstLoggedSymbol )
+		return;
+	
+	size_t		index = inSymbol -mFirstLoggedSymbol;
+	if( index >= mUsageLogStamps.size() )
+		mUsageLogStamps.resize( size() -mFirstLoggedSymbol, 0 );
+	
+	if( mUsageLogStamps[index] != mUsageLogNumber )
+	{
+		mUsageLogStamps[index] = mUsageLogNumber;
+		mUsageLog->push_back( inSymbol );
+	}
+}
+
+}
@@ -0,0 +1,67 @@
+/*
+ *  CSymbolTable.h
+ *  HyperCompiler
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#pragma once
+
+#include "ForgeTypes.h"
+#include <string>
+#include <vector>
+
+
+namespace Carlson
+{
+
+typedef uint32_t	CSymbolID;
+
+#define kNoSymbol		0xFFFFFFFFU	// CSymbolID of tokens that aren't identifiers, or that were tokenized without a symbol table.
+
+
+// Interns the case-folded text of identifiers, so the parser can compare and
+//	look up names as integers. Symbols below ELastIdentifier_Sentinel are the
+//	built-in identifiers (the ID is the TIdentifierSubtype), all others are
+//	numbered in the order they were first seen.
+//	There is one of these per compilation (the CParseTree owns it), so there
+//	is no locking. Threads that parse parts of a script each get a copy, and
+//	log which new symbols they used, so the main thread can add them to the
+//	real table in the order a single thread would have.
+class CSymbolTable
+{
+public:
+	CSymbolTable();
+
+	CSymbolID			SymbolForText( const char* str, size_t len, bool mayBeKeyword = true );	// Case-insensitive. Pass false if you already know it's not in gIdentifierStrings.
+	CSymbolID			SymbolForString( const std::string& str )	{ return SymbolForText( str.data(), str.length() ); };
+	const std::string&	TextForSymbol( CSymbolID inSymbol ) const;	// Lowercased.
+
+	CSymbolID			VariableSymbolForSymbol( CSymbolID inSymbol );	// Symbol for the "var_"-prefixed internal name of a user variable.
+
+	size_t				size() const	{ return ELastIdentifier_Sentinel +mTexts.size(); };
+
+	void				StartUsageLog( std::vector<CSymbolID>* outUsedSymbols );	// Until StopUsageLog(), each lookup of a symbol that wasn't in the table when the first log started appends it to outUsedSymbols, once per log.
+	void				StopUsageLog()	{ mUsageLog = NULL; };
+
+protected:
+	CSymbolID			SymbolForLowercasedText( const char* str, size_t len );
+	void				GrowHashTable();
+	void				LogUsage( CSymbolID inSymbol );
+
+protected:
+	std::vector<std::string>	mTexts;				// Text of each symbol >= ELastIdentifier_Sentinel.
+	std::vector<uint32_t>		mHashes;			// Hash of each entry in mTexts, so growing doesn't need to re-hash strings.
+	std::vector<CSymbolID>		mSlots;				// Open-addressed hash table, kNoSymbol for empty slots. Size is a power of two.
+	std::vector<CSymbolID>		mVariableSymbols;	// Cache for VariableSymbolForSymbol(), indexed by symbol.
+	std::vector<std::string>	mKeywordTexts;		// gIdentifierStrings as std::strings, for TextForSymbol().
+	std::string					mLowercased;		// Scratch buffer, so we don't allocate for each lookup.
+	std::vector<CSymbolID>*		mUsageLog;			// Where LogUsage() appends symbols, or NULL.
+	CSymbolID					mFirstLoggedSymbol;	// size() when the first usage log was started, kNoSymbol before.
+	std::vector<uint32_t>		mUsageLogStamps;	// mUsageLogNumber for symbols already in the current log, indexed by symbol -mFirstLoggedSymbol.
+	uint32_t					mUsageLogNumber;	// Counts up for each log, so we don't need to clear mUsageLogStamps.
+};
+
+}
@@ -12,14 +12,27 @@
 #include <ios>
 #include <sstream>
 #include <string>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <clocale>
+#include <cstdlib>
 #include "UTF8UTF32Utilities.h"
+#include "UTF32CaseTables.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#if __SSE2__
+#include <emmintrin.h>
+#endif
 
 
 namespace Carlson
 {
 #pragma mark Constant tokens
 
-	const CToken&	CToken::KNewlineToken = CToken( EIdentifierToken, ENewlineOperator, 0, 0, std::string("") );	
+	const CToken&	CToken::KNewlineToken = CToken( EIdentifierToken, ENewlineOperator, 0, 0, "", 0 );	
 
 #pragma mark Token type strings
 
@@ -29,6 +42,7 @@ namespace Carlson
 		"EStringToken",
 		"EIdentifierToken",
 		"ENumberToken",
+		"EFloatNumberToken",
 		"***ECommentPseudoToken"
 	};
 
@@ -367,20 +381,91 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 
 #pragma mark -
 
+	static inline uint32_t	UTF32CharacterToLowerFromTable( uint32_t inChar )
+	{
+		if( inChar > 0xFFFF )
+			return inChar;
+		
+		return inChar +gUTF32CaseBlocks[ gUTF32CaseBlockIndex[inChar >> UTF32_CASE_BLOCK_SHIFT] ][ inChar & UTF32_CASE_BLOCK_MASK ];	// Wraps around correctly for negative deltas.
+	}
+	
+	
+	// Lowercase the plain ASCII bytes at the start of inStr into outBuf, without
+	//	branching on each character. Returns the number of bytes done, which is
+	//	less than inLen if it hit a non-ASCII byte.
+	static inline size_t	ToLowerASCIIPrefix( const char* inStr, size_t inLen, char* outBuf )
+	{
+		size_t		x = 0;
+		
+	#if __SSE2__
+		const __m128i	beforeA = _mm_set1_epi8( 'A' -1 ),
+						afterZ = _mm_set1_epi8( 'Z' +1 ),
+						caseBit = _mm_set1_epi8( 0x20 );
+		for( ; (x +16) <= inLen; x += 16 )
+		{
+			__m128i		block = _mm_loadu_si128( (const __m128i*)(inStr +x) );
+			if( _mm_movemask_epi8( block ) != 0 )	// Non-ASCII character somewhere in here.
+				break;
+			__m128i		isUpper = _mm_and_si128( _mm_cmpgt_epi8( block, beforeA ), _mm_cmplt_epi8( block, afterZ ) );
+			_mm_storeu_si128( (__m128i*)(outBuf +x), _mm_or_si128( block, _mm_and_si128( isUpper, caseBit ) ) );
+		}
+	#endif
+		
+		for( ; x < inLen && ((unsigned char)inStr[x]) < 0x80; x++ )
+		{
+			unsigned char	currCh = (unsigned char) inStr[x];
+			outBuf[x] = (char)( currCh | ((((unsigned)(currCh -'A')) < 26U) << 5) );
+		}
+		
+		return x;
+	}
+	
+	
+	size_t	ToLowerUTF8( const char* inStr, size_t inLen, char* outBuf )
+	{
+		size_t		x = 0,
+					outLen = 0;
+		
+		while( x < inLen )
+		{
+			size_t		numASCII = ToLowerASCIIPrefix( inStr +x, inLen -x, outBuf +outLen );
+			x += numASCII;
+			outLen += numASCII;
+			if( x >= inLen )
+				break;
+			
+			size_t		charStart = x;
+			uint32_t	currUTF32Char = UTF8StringParseUTF32CharacterAtOffset( inStr, inLen, &x );
+			uint32_t	lowerUTF32Char = UTF32CharacterToLowerFromTable( currUTF32Char );
+			if( x > inLen )	// Truncated character at the end.
+				x = inLen;
+			if( lowerUTF32Char == currUTF32Char )	// Copy the bytes as they are, so we never get longer.
+			{
+				memmove( outBuf +outLen, inStr +charStart, x -charStart );
+				outLen += x -charStart;
+			}
+			else
+			{
+				char		outUTF8Bytes[6];
+				size_t		bytesLength = 0;
+				UTF8BytesForUTF32Character( lowerUTF32Char, outUTF8Bytes, &bytesLength );
+				memcpy( outBuf +outLen, outUTF8Bytes, bytesLength );
+				outLen += bytesLength;
+			}
+		}
+		
+		return outLen;
+	}
+	
+	
 	std::string	ToLowerString( const std::string& inUTF8String )
 	{
-		std::string		outStr;
-		size_t			x = 0,
-						theLen = inUTF8String.length();
-		const char*		inUTF8Bytes = inUTF8String.c_str();
+		std::string		outStr( inUTF8String );
 		
-		while( x < theLen )
+		if( !outStr.empty() )
 		{
-			uint32_t	currUTF32Char = UTF8StringParseUTF32CharacterAtOffset( inUTF8Bytes, theLen, &x );
-			char		outUTF8Bytes[6];
-			size_t		bytesLength = 0;
-			UTF8BytesForUTF32Character( UTF32CharacterToLower( currUTF32Char ), outUTF8Bytes, &bytesLength );
-			outStr.append( outUTF8Bytes, bytesLength );
+			char*	outBytes = &outStr[0];
+			outStr.resize( ToLowerUTF8( outBytes, outStr.length(), outBytes ) );
 		}
 		
 		return outStr;
@@ -388,39 +473,449 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 
 #pragma mark -
 	
-	TIdentifierSubtype	CToken::IdentifierTypeFromText( const char* inLowercasedString )
+#pragma mark Identifier lookup table
+
+	// Open-addressed hash table mapping the (lowercased) text of an identifier to
+	//	its index in gIdentifierStrings. It is filled from gIdentifierStrings itself,
+	//	so adding an identifier to ForgeTypes.h and CToken.cpp is all that's needed.
+	#define IDENTIFIER_HASH_TABLE_SIZE		1024	// Must be a power of two, and should be a lot larger than ELastIdentifier_Sentinel to keep probe chains short.
+	
+	typedef char	TIdentifierHashTableSizeCheck[ (IDENTIFIER_HASH_TABLE_SIZE >= (4 * ELastIdentifier_Sentinel)) ? 1 : -1 ];	// Fails to compile if the table is too small for the identifier list.
+	
+	static TIdentifierSubtype	sIdentifierHashTable[IDENTIFIER_HASH_TABLE_SIZE];
+	static bool					sIdentifierHashTableBuilt = false;
+	
+	
+	static inline size_t	IdentifierHashForText( const char* inStr )
 	{
-		size_t		x = (size_t) ELastIdentifier_Sentinel;
+		uint32_t		hash = 2166136261U;	// FNV-1a.
 		
-		while( true )
+		for( const unsigned char* currCh = (const unsigned char*) inStr; *currCh != 0; currCh++ )
 		{
-			--x;
-			
-			if( strcmp( gIdentifierStrings[x], inLowercasedString ) == 0 )
-				return (TIdentifierSubtype) x;
+			hash ^= *currCh;
+			hash *= 16777619U;
+		}
+		
+		return hash & (IDENTIFIER_HASH_TABLE_SIZE -1);
+	}
+	
+	
+	static bool		BuildIdentifierHashTable()
+	{
+		if( sIdentifierHashTableBuilt )
+			return true;
+		
+		for( size_t x = 0; x < IDENTIFIER_HASH_TABLE_SIZE; x++ )
+			sIdentifierHashTable[x] = ELastIdentifier_Sentinel;
+		
+		for( size_t x = 0; x < (size_t) ELastIdentifier_Sentinel; x++ )
+		{
+			assert( gIdentifierStrings[x] != NULL );	// gIdentifierStrings has fewer entries than TIdentifierSubtype!
 			
-			if( x == 0 )
-				return ELastIdentifier_Sentinel;
+			size_t		slot = IdentifierHashForText( gIdentifierStrings[x] );
+			while( sIdentifierHashTable[slot] != ELastIdentifier_Sentinel
+					&& strcmp( gIdentifierStrings[sIdentifierHashTable[slot]], gIdentifierStrings[x] ) != 0 )
+				slot = (slot +1) & (IDENTIFIER_HASH_TABLE_SIZE -1);
+			sIdentifierHashTable[slot] = (TIdentifierSubtype) x;	// Duplicates: the last one wins, like the old backwards linear search.
+		}
+		
+		sIdentifierHashTableBuilt = true;
+		
+		return true;
+	}
+	
+	static bool		sIdentifierHashTableBuiltAtStartup = BuildIdentifierHashTable();	// Build it before anyone can be tokenizing on another thread.
+	
+	
+	TIdentifierSubtype	CToken::IdentifierTypeFromText( const char* inLowercasedString )
+	{
+		if( !sIdentifierHashTableBuilt )	// Called from another static initializer?
+			BuildIdentifierHashTable();
+		
+		size_t		slot = IdentifierHashForText( inLowercasedString );
+		while( sIdentifierHashTable[slot] != ELastIdentifier_Sentinel )
+		{
+			if( strcmp( gIdentifierStrings[sIdentifierHashTable[slot]], inLowercasedString ) == 0 )
+				return sIdentifierHashTable[slot];
+			slot = (slot +1) & (IDENTIFIER_HASH_TABLE_SIZE -1);
 		}
 		
 		return ELastIdentifier_Sentinel;
 	}
 	
-	std::deque<CToken>	CToken::TokenListFromText( const char* str, size_t len )
+	
+	TIdentifierSubtype	CToken::IdentifierTypeFromText( const char* str, size_t len )
+	{
+		char		lowercased[64];
+		if( len < sizeof(lowercased) )	// Lowercasing never makes text longer.
+		{
+			lowercased[ ToLowerUTF8( str, len, lowercased ) ] = 0;
+			return IdentifierTypeFromText( lowercased );
+		}
+		
+		return IdentifierTypeFromText( ToLowerString( std::string( str, len ) ).c_str() );
+	}
+	
+#pragma mark ASCII fast path
+
+	// Almost all script text is plain ASCII, so the tokenizer consumes runs of
+	//	whitespace, identifier characters, digits, comments and string contents
+	//	a block at a time and only decodes UTF-8 for the characters that end a run.
+	enum
+	{
+		kSpaceCharClass				= (1 << 0),	// Space or tab.
+		kLineBreakCharClass			= (1 << 1),	// \n or \r.
+		kDigitCharClass				= (1 << 2),
+		kLetterCharClass			= (1 << 3),
+		kOtherIdentifierCharClass	= (1 << 4),	// Not alphanumeric, but doesn't end an identifier either (e.g. "_").
+		kQuoteCharClass				= (1 << 5),
+		kIdentifierCharClass		= (kDigitCharClass | kLetterCharClass | kOtherIdentifierCharClass)
+	};
+	
+	static unsigned char	sASCIICharClassTable[256];	// Bytes >= 0x80 have no class, so runs stop there and the slow path decodes them.
+	static bool				sASCIICharClassTableBuilt = false;
+	
+	
+	static bool		BuildASCIICharClassTable()
+	{
+		if( sASCIICharClassTableBuilt )
+			return true;
+		
+		for( int x = 0; x < 0x80; x++ )
+		{
+			unsigned char	charClass = 0;
+			char			opstr[2] = { (char) x, 0 };
+			if( x == ' ' || x == '\t' )
+				charClass = kSpaceCharClass;
+			else if( x == '\n' || x == '\r' )
+				charClass = kLineBreakCharClass;
+			else if( x >= '0' && x <= '9' )
+				charClass = kDigitCharClass;
+			else if( (x >= 'a' && x <= 'z') || (x >= 'A' && x <= 'Z') )
+				charClass = kLetterCharClass;
+			else if( CToken::IdentifierTypeFromText( opstr ) == ELastIdentifier_Sentinel )	// Same test TokenListFromText uses to end an identifier.
+				charClass = kOtherIdentifierCharClass;
+			if( x == '\"' )
+				charClass |= kQuoteCharClass;
+			sASCIICharClassTable[x] = charClass;
+		}
+		
+		sASCIICharClassTableBuilt = true;
+		
+		return true;
+	}
+	
+	static bool		sASCIICharClassTableBuiltAtStartup = BuildASCIICharClassTable();
+	
+	
+#if __SSE2__
+	// Returns a 16-bit mask with a bit set for each byte in the block that is in
+	//	one of the given classes. kOtherIdentifierCharClass is not checked here,
+	//	callers must fall back to sASCIICharClassTable for that.
+	static inline int	CharClassMaskForBlock( __m128i inBlock, unsigned char inClasses )
 	{
-		size_t				x = 0,
-							currStartOffs = 0;
-		TTokenType			currType = EInvalidToken;	// We're in whitespace.
-		std::string			currText;
-		std::deque<CToken>	tokenList;
-		size_t				currLineNum = 1;
+		__m128i		matches = _mm_setzero_si128();
+		
+		if( inClasses & kSpaceCharClass )
+			matches = _mm_or_si128( matches, _mm_or_si128( _mm_cmpeq_epi8( inBlock, _mm_set1_epi8(' ') ), _mm_cmpeq_epi8( inBlock, _mm_set1_epi8('\t') ) ) );
+		if( inClasses & kLineBreakCharClass )
+			matches = _mm_or_si128( matches, _mm_or_si128( _mm_cmpeq_epi8( inBlock, _mm_set1_epi8('\n') ), _mm_cmpeq_epi8( inBlock, _mm_set1_epi8('\r') ) ) );
+		if( inClasses & kQuoteCharClass )
+			matches = _mm_or_si128( matches, _mm_cmpeq_epi8( inBlock, _mm_set1_epi8('\"') ) );
+		if( inClasses & kDigitCharClass )	// Signed compares, so bytes >= 0x80 never match a range.
+			matches = _mm_or_si128( matches, _mm_and_si128( _mm_cmpgt_epi8( inBlock, _mm_set1_epi8('0' -1) ), _mm_cmplt_epi8( inBlock, _mm_set1_epi8('9' +1) ) ) );
+		if( inClasses & kLetterCharClass )
+		{
+			__m128i		lowercased = _mm_or_si128( inBlock, _mm_set1_epi8(0x20) );
+			matches = _mm_or_si128( matches, _mm_and_si128( _mm_cmpgt_epi8( lowercased, _mm_set1_epi8('a' -1) ), _mm_cmplt_epi8( lowercased, _mm_set1_epi8('z' +1) ) ) );
+		}
 		
+		return _mm_movemask_epi8( matches );
+	}
+#endif
+	
+	
+	// Returns the offset of the first byte at or after inOffset that is not in
+	//	any of the given classes.
+	static inline size_t	EndOfCharClassRun( const char* str, size_t inOffset, size_t len, unsigned char inClasses )
+	{
+		size_t		x = inOffset;
 		while( x < len )
 		{
+#if __SSE2__
+			if( (x +16) <= len )
+			{
+				int		mask = CharClassMaskForBlock( _mm_loadu_si128( (const __m128i*)(str +x) ), inClasses );
+				if( mask == 0xFFFF )
+				{
+					x += 16;
+					continue;
+				}
+				x += __builtin_ctz( ~mask );
+			}
+#endif
+			if( (sASCIICharClassTable[(unsigned char)str[x]] & inClasses) == 0 )
+				break;
+			x++;
+		}
+		
+		return x;
+	}
+	
+	
+	// Returns the offset of the first byte at or after inOffset that is in one
+	//	of the given classes (or len). May not be used with kOtherIdentifierCharClass.
+	static inline size_t	StartOfCharClass( const char* str, size_t inOffset, size_t len, unsigned char inClasses )
+	{
+		size_t		x = inOffset;
+#if __SSE2__
+		while( (x +16) <= len )
+		{
+			int		mask = CharClassMaskForBlock( _mm_loadu_si128( (const __m128i*)(str +x) ), inClasses );
+			if( mask != 0 )
+				return x + __builtin_ctz( mask );
+			x += 16;
+		}
+#endif
+		while( x < len && (sASCIICharClassTable[(unsigned char)str[x]] & inClasses) == 0 )
+			x++;
+		
+		return x;
+	}
+	
+	
+	static inline size_t	NumLineBreaksInRange( const char* str, size_t inOffset, size_t inEndOffset )
+	{
+		size_t		numLineBreaks = 0,
+					x = inOffset;
+#if __SSE2__
+		for( ; (x +16) <= inEndOffset; x += 16 )
+			numLineBreaks += __builtin_popcount( CharClassMaskForBlock( _mm_loadu_si128( (const __m128i*)(str +x) ), kLineBreakCharClass ) );
+#endif
+		for( ; x < inEndOffset; x++ )
+		{
+			if( str[x] == '\n' || str[x] == '\r' )
+				numLineBreaks++;
+		}
+		
+		return numLineBreaks;
+	}
+	
+	
+	static inline uint32_t	NextCharacterAtOffset( const char* str, size_t len, size_t* ioOffset )
+	{
+		unsigned char	firstByte = (unsigned char) str[*ioOffset];
+		if( firstByte < 0x80 )
+		{
+			(*ioOffset)++;
+			return firstByte;
+		}
+		return UTF8StringParseUTF32CharacterAtOffset( str, len, ioOffset );
+	}
+	
+	
+	// Like strtol(), but doesn't need a terminating zero byte. Clips to LONG_MAX
+	//	like strtol() does on overflow.
+	static long	NumberFromDigits( const char* str, size_t len )
+	{
+		long		num = 0;
+		for( size_t x = 0; x < len && str[x] >= '0' && str[x] <= '9'; x++ )
+		{
+			int		digit = str[x] -'0';
+			if( num > (LONG_MAX -digit) / 10 )
+				return LONG_MAX;
+			num = num * 10 +digit;
+		}
+		
+		return num;
+	}
+	
+	
+	static inline bool	IsASCIIDigit( char ch )
+	{
+		return ch >= '0' && ch <= '9';
+	}
+	
+	
+	// If the digits that end right before inOffset continue as a decimal or
+	//	scientific number ("1.05", "1e6", "2.5E-3"), returns the offset right
+	//	after it. Otherwise returns inOffset. A period that isn't followed by a
+	//	digit is left alone, as is an "e" that isn't followed by an exponent.
+	static size_t	EndOfFloatLiteral( const char* str, size_t len, size_t inOffset )
+	{
+		size_t		x = inOffset;
+		if( (x +1) < len && str[x] == '.' && IsASCIIDigit( str[x +1] ) )
+			x = EndOfCharClassRun( str, x +1, len, kDigitCharClass );
+		if( x < len && (str[x] == 'e' || str[x] == 'E') )
+		{
+			size_t	digitsStart = x +1;
+			if( digitsStart < len && (str[digitsStart] == '+' || str[digitsStart] == '-') )
+				digitsStart++;
+			if( digitsStart < len && IsASCIIDigit( str[digitsStart] ) )
+				x = EndOfCharClassRun( str, digitsStart, len, kDigitCharClass );
+		}
+		
+		return x;
+	}
+	
+	
+	static const double	sPowersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+											1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	
+	
+	// Parses a literal found by EndOfFloatLiteral(). Doesn't need a terminating
+	//	zero byte and always uses a period as the decimal point, whatever the
+	//	current locale says. Literals whose digits fit in a double's mantissa
+	//	and that have a small exponent (i.e. nearly all of them) are converted
+	//	with a single multiplication or division, everything else goes to
+	//	strtod().
+	static double	FloatFromText( const char* str, size_t len )
+	{
+		uint64_t	mantissa = 0;
+		int			numDigits = 0;		// Significant digits in mantissa.
+		long		exponent = 0;
+		bool		truncated = false;	// Had more digits than fit in mantissa?
+		size_t		x = 0;
+		
+		for( ; x < len && IsASCIIDigit( str[x] ); x++ )
+		{
+			if( numDigits < 19 )
+			{
+				mantissa = mantissa * 10 +(str[x] -'0');
+				if( mantissa != 0 )
+					numDigits++;
+			}
+			else
+			{
+				exponent++;
+				truncated = truncated || (str[x] != '0');
+			}
+		}
+		if( x < len && str[x] == '.' )
+		{
+			for( x++; x < len && IsASCIIDigit( str[x] ); x++ )
+			{
+				if( numDigits < 19 )
+				{
+					mantissa = mantissa * 10 +(str[x] -'0');
+					if( mantissa != 0 )
+						numDigits++;
+					exponent--;
+				}
+				else
+					truncated = truncated || (str[x] != '0');
+			}
+		}
+		if( x < len && (str[x] == 'e' || str[x] == 'E') )
+		{
+			bool	negative = false;
+			long	explicitExponent = 0;
+			x++;
+			if( x < len && (str[x] == '+' || str[x] == '-') )
+				negative = (str[x++] == '-');
+			for( ; x < len && IsASCIIDigit( str[x] ); x++ )
+			{
+				if( explicitExponent < 100000 )	// Way out of range for a double anyway, but don't overflow.
+					explicitExponent = explicitExponent * 10 +(str[x] -'0');
+			}
+			exponent += negative ? -explicitExponent : explicitExponent;
+		}
+		
+		if( mantissa == 0 )
+			return 0.0;
+		if( !truncated && mantissa <= (((uint64_t) 1) << 53) && exponent >= -22 && exponent <= 22 )	// Both exactly representable, so one rounding step gives the correctly rounded result.
+		{
+			if( exponent < 0 )
+				return ((double) mantissa) / sPowersOfTen[-exponent];
+			else
+				return ((double) mantissa) * sPowersOfTen[exponent];
+		}
+		
+		// Rare case: Let the C library do the hard work, with the decimal point it expects:
+		std::string		numStr( str, len );
+		const char*		decimalPoint = localeconv()->decimal_point;
+		size_t			periodOffset = numStr.find( '.' );
+		if( periodOffset != std::string::npos && decimalPoint != NULL && strcmp( decimalPoint, "." ) != 0 )
+			numStr.replace( periodOffset, 1, decimalPoint );
+		return strtod( numStr.c_str(), NULL );
+	}
+	
+	
+#pragma mark -
+	
+	CTokenList	CToken::TokenListFromText( const char* str, size_t len, CSymbolTable* inSymbols )
+	{
+		CTokenizer		tokenizer( str, len );
+		CTokenList		tokenList( str, inSymbols );
+		
+		while( !tokenizer.IsAtEnd() )
+			tokenizer.ReadNextTokens( tokenList );
+		
+		return tokenList;
+	}
+	
+	
+#pragma mark -
+	
+	CTokenizer::CTokenizer( const char* str, size_t len, size_t inStartOffset, size_t inStartLineNum )
+		: mText(str), mTextLength(len), mOffset(inStartOffset), mCurrStartOffs(inStartOffset), mCurrType(EInvalidToken), mCurrLineNum(inStartLineNum), mAtEnd(false)
+	{
+		if( !sASCIICharClassTableBuilt )	// Called from another static initializer?
+			BuildASCIICharClassTable();
+	}
+	
+	
+	void	CTokenizer::ReadNextTokens( CTokenList& tokenList )
+	{
+		const char*			str = mText;
+		size_t				len = mTextLength,
+							x = mOffset,
+							currStartOffs = mCurrStartOffs;
+		TTokenType			currType = mCurrType;
+		size_t				currLineNum = mCurrLineNum;
+		size_t				numTokensBefore = tokenList.size();
+		
+		while( x < len && tokenList.size() == numTokensBefore )
+		{
+			// Swallow any run of ASCII characters that can't change our state in one go:
+			size_t			runEnd = x;
+			switch( currType )
+			{
+				case EInvalidToken:
+					runEnd = EndOfCharClassRun( str, x, len, kSpaceCharClass );
+					if( runEnd != x )
+						currStartOffs = runEnd -1;
+					break;
+				
+				case EIdentifierToken:
+					runEnd = EndOfCharClassRun( str, x, len, kIdentifierCharClass );
+					break;
+				
+				case ENumberToken:
+					runEnd = EndOfCharClassRun( str, x, len, kDigitCharClass );
+					break;
+				
+				case ECommentPseudoToken:
+					runEnd = StartOfCharClass( str, x, len, kLineBreakCharClass );
+					break;
+				
+				case EStringToken:
+					runEnd = StartOfCharClass( str, x, len, kQuoteCharClass );
+					currLineNum += NumLineBreaksInRange( str, x, runEnd );
+					break;
+				
+				case EFloatNumberToken:	// Floats are read in one go by the ENumberToken case below, so we're never in the middle of one.
+				case ELastToken_Sentinel:
+					break;
+			}
+			x = runEnd;
+			if( x >= len )
+				break;
+			
 			size_t			newX = x;
-			uint32_t		currCh = UTF8StringParseUTF32CharacterAtOffset( str, len, &newX );
+			uint32_t		currCh = NextCharacterAtOffset( str, len, &newX );
 			size_t			nextNewX = newX;
-			uint32_t		nextCh = (nextNewX < len) ? UTF8StringParseUTF32CharacterAtOffset( str, len, &nextNewX ) : '\0';
+			uint32_t		nextCh = (nextNewX < len) ? NextCharacterAtOffset( str, len, &nextNewX ) : '\0';
 			
 			switch( currType )
 			{
@@ -440,19 +935,20 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 					{
 						currType = ENumberToken;
 						currStartOffs = x;
-						currText.append( str +x, newX -x );
 					}
 					else if( currCh == '-' && nextCh == '-' )
+					{
 						currType = ECommentPseudoToken;
+						currStartOffs = x;
+					}
 					else
 					{
 						char		opstr[2] = { 0, 0 };
 						opstr[0] = currCh;
-						TIdentifierSubtype subtype = (isalnum(currCh)) ? ELastIdentifier_Sentinel : IdentifierTypeFromText(opstr);	// Don't interrupt a token on a short identifier like "a".
+						TIdentifierSubtype subtype = (isalnum(currCh)) ? ELastIdentifier_Sentinel : CToken::IdentifierTypeFromText(opstr);	// Don't interrupt a token on a short identifier like "a".
 						if( subtype != ELastIdentifier_Sentinel )
 						{
-							tokenList.push_back( CToken( EIdentifierToken, subtype, x, currLineNum, std::string(opstr) ) );
-							currText.clear();
+							tokenList.AddToken( CToken( EIdentifierToken, subtype, x, currLineNum, gIdentifierStrings[subtype], 1 ) );
 							currType = EInvalidToken;
 							currStartOffs = x;
 						}
@@ -460,7 +956,6 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 						{
 							currType = EIdentifierToken;
 							currStartOffs = x;
-							currText.append( str +x, newX -x );
 						}
 					}
 					break;
@@ -468,49 +963,54 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 				case ECommentPseudoToken:
 					if( currCh == '\n' || currCh == '\r' )
 					{
-						tokenList.push_back( CToken( EIdentifierToken, ENewlineOperator, x, currLineNum, std::string("\n") ) );
-						currText.clear();
+						tokenList.AddToken( CToken( EIdentifierToken, ENewlineOperator, x, currLineNum, gIdentifierStrings[ENewlineOperator], 1 ) );
 						currType = EInvalidToken;
 						currStartOffs = newX;
 					}
 					break;
 				
 				case ENumberToken:
-					if( isdigit(currCh) )
-						currText.append( str +x, newX -x );
-					else
+					if( !isdigit(currCh) )
 					{
-						char*	endPtr = NULL;
-						long	num = strtol( currText.c_str(), &endPtr, 10 );
-						tokenList.push_back( CToken( ENumberToken, ELastIdentifier_Sentinel, currStartOffs, currLineNum, currText, num ) );
-						currText.clear();
+						size_t	floatEnd = EndOfFloatLiteral( str, len, x );
+						if( floatEnd != x )	// Decimal or scientific number, tokenize it in one go:
+						{
+							CToken	floatToken( EFloatNumberToken, ELastIdentifier_Sentinel, currStartOffs, currLineNum, str +currStartOffs, floatEnd -currStartOffs );
+							floatToken.mFloatValue = FloatFromText( str +currStartOffs, floatEnd -currStartOffs );
+							tokenList.AddToken( floatToken );
+							currType = EInvalidToken;
+							currStartOffs = floatEnd;
+							x = floatEnd;
+							continue;
+						}
+						
+						long	num = NumberFromDigits( str +currStartOffs, x -currStartOffs );
+						tokenList.AddToken( CToken( ENumberToken, ELastIdentifier_Sentinel, currStartOffs, currLineNum, str +currStartOffs, x -currStartOffs, num ) );
 						currType = EInvalidToken;
 						
 						if( currCh == '\"' )
 						{
-							currText.clear();
 							currType = EStringToken;
 							currStartOffs = newX;
 						}
 						else if( currCh == '-' && nextCh == '-' )
 						{
 							currType = ECommentPseudoToken;
+							currStartOffs = x;
 						}
 						else if( currCh != ' ' && currCh != '\t' )
 						{
 							char		opstr[2] = { 0, 0 };
 							opstr[0] = currCh;
-							TIdentifierSubtype subtype = (isalnum(currCh)) ? ELastIdentifier_Sentinel : IdentifierTypeFromText(opstr);	// Don't interrupt a token on a short identifier like "a".
+							TIdentifierSubtype subtype = (isalnum(currCh)) ? ELastIdentifier_Sentinel : CToken::IdentifierTypeFromText(opstr);	// Don't interrupt a token on a short identifier like "a".
 							if( subtype != ELastIdentifier_Sentinel )
 							{
-								tokenList.push_back( CToken( EIdentifierToken, subtype, x, currLineNum, std::string(opstr) ) );
-								currText.clear();
+								tokenList.AddToken( CToken( EIdentifierToken, subtype, x, currLineNum, gIdentifierStrings[subtype], 1 ) );
 								currType = EInvalidToken;
 								currStartOffs = x;
 							}
 							else
 							{
-								currText.append( str +x, newX -x );
 								currType = EIdentifierToken;
 								currStartOffs = x;
 							}
@@ -523,36 +1023,34 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 					bool	endThisToken = (currCh == ' ' || currCh == '\t' || currCh == '\n' || currCh == '\r');
 					char	opstr[2] = { 0, 0 };
 					opstr[0] = currCh;
-					TIdentifierSubtype subtype = (isalnum(currCh)) ? ELastIdentifier_Sentinel : IdentifierTypeFromText(opstr);	// Don't interrupt a token on a short identifier like "a".
+					TIdentifierSubtype subtype = (isalnum(currCh)) ? ELastIdentifier_Sentinel : CToken::IdentifierTypeFromText(opstr);	// Don't interrupt a token on a short identifier like "a".
 					endThisToken = endThisToken || (subtype != ELastIdentifier_Sentinel) || (currCh == '-' && nextCh == '-');
 					if( endThisToken )
 					{
-						tokenList.push_back( CToken( EIdentifierToken, IdentifierTypeFromText( ToLowerString( currText ).c_str() ), currStartOffs, currLineNum, currText ) );
+						tokenList.AddToken( CToken( EIdentifierToken, CToken::IdentifierTypeFromText( str +currStartOffs, x -currStartOffs ), currStartOffs, currLineNum, str +currStartOffs, x -currStartOffs ) );
 						currType = EInvalidToken;
 						
 						if( currCh == '-' && nextCh == '-' )	// Comment!
 							currType = ECommentPseudoToken;
 						else if( subtype != ELastIdentifier_Sentinel )
-							tokenList.push_back( CToken( EIdentifierToken, subtype, x, currLineNum, std::string(opstr) ) );
+							tokenList.AddToken( CToken( EIdentifierToken, subtype, x, currLineNum, gIdentifierStrings[subtype], 1 ) );
 						
-						currText.clear();
 						currStartOffs = x;
 					}
-					else
-						currText.append( str +x, newX -x );
 					break;
 				}
 				
 				case EStringToken:
 					if( currCh == '\"' )
 					{
-						tokenList.push_back( CToken( EStringToken, ELastIdentifier_Sentinel, currStartOffs, currLineNum, currText ) );
-						currText.clear();
+						tokenList.AddToken( CToken( EStringToken, ELastIdentifier_Sentinel, currStartOffs, currLineNum, str +currStartOffs, x -currStartOffs ) );
 						currStartOffs = x;
 						currType = EInvalidToken;
 					}
-					else
-						currText.append( str +x, newX -x );
+					break;
+				
+				case EFloatNumberToken:
+					throw std::logic_error( "Tokenizer stopped in the middle of a float. Should never happen." );
 					break;
 				
 				case ELastToken_Sentinel:
@@ -566,16 +1064,23 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 			x = newX;
 		}
 		
-		if( currType != EInvalidToken )	// We have an unfinished token waiting to be ended!
+		if( x >= len && !mAtEnd )
 		{
-			long	num = 0;
-			char*	endPtr = NULL;
-			if( currType == ENumberToken )
-				num = strtol( currText.c_str(), &endPtr, 10 );
-			tokenList.push_back( CToken( currType, IdentifierTypeFromText( ToLowerString( currText ).c_str() ), currStartOffs, currLineNum, currText, num ) );
+			if( currType != EInvalidToken )	// We have an unfinished token waiting to be ended!
+			{
+				size_t	textLength = (currType == ECommentPseudoToken) ? 0 : (len -currStartOffs);	// Comments don't have any text.
+				long	num = 0;
+				if( currType == ENumberToken )
+					num = NumberFromDigits( str +currStartOffs, textLength );
+				tokenList.AddToken( CToken( currType, CToken::IdentifierTypeFromText( str +currStartOffs, textLength ), currStartOffs, currLineNum, str +currStartOffs, textLength, num ) );
+			}
+			mAtEnd = true;
 		}
 		
-		return tokenList;
+		mOffset = x;
+		mCurrStartOffs = currStartOffs;
+		mCurrType = currType;
+		mCurrLineNum = currLineNum;
 	}
 	
 	std::string	CToken::GetDescription() const
@@ -585,7 +1090,7 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 		if( mSubType == ELastIdentifier_Sentinel )
 		{
 			str.append( ", \"" );
-			str.append( mStringValue );
+			str.append( mText, mTextLength );
 			str.append( "\"" );
 		}
 		else
@@ -598,7 +1103,10 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 		str.append( numstr );
 		sprintf( numstr,", %lu", (unsigned long) mOffset );
 		str.append( numstr );
-		sprintf( numstr,", %ld", mNumberValue );
+		if( mType == EFloatNumberToken )
+			sprintf( numstr,", %g", mFloatValue );
+		else
+			sprintf( numstr,", %ld", mNumberValue );
 		str.append( numstr );
 		
 		return str;
@@ -612,16 +1120,18 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 			sprintf( numstr,"%ld", mNumberValue );
 			return std::string(numstr);
 		}
+		else if( mType == EFloatNumberToken )	// Show it the way the user wrote it.
+			return GetStringValue();
 		else if( mType == EStringToken )
 		{
 			std::string		str("\"");
-			str.append( mStringValue );
+			str.append( mText, mTextLength );
 			str.append( "\"" );
 			
 			return str;
 		}
 		else if( mSubType == ELastIdentifier_Sentinel )
-			return mStringValue;
+			return GetStringValue();
 		else
 			return std::string(gIdentifierStrings[mSubType]);
 	}
@@ -640,13 +1150,23 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 		return gIdentifierSynonyms[mSubType];
 	}
 	
+	CSymbolID	CToken::GetIdentifierSymbol() const
+	{
+		if( mType != EIdentifierToken )
+			throw std::runtime_error( "Expected identifier here." );
+		if( mSymbolID == kNoSymbol )
+			throw std::logic_error( "Identifier was tokenized without a symbol table." );
+		
+		return mSymbolID;
+	}
+	
 	const std::string	CToken::GetIdentifierText() const
 	{
 		if( mType != EIdentifierToken )
 			throw std::runtime_error( "Expected identifier here." );
 		
 		if( mSubType == ELastIdentifier_Sentinel )
-			return ToLowerString(mStringValue);
+			return ToLowerString( GetStringValue() );
 		else
 			return std::string(gIdentifierStrings[mSubType]);
 	}
@@ -656,7 +1176,7 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 		if( mType != EIdentifierToken )
 			throw std::runtime_error( "Expected identifier here." );
 		
-		return mStringValue;
+		return GetStringValue();
 	}
 	
 	// Operator overloads so we can use this in std::map & co.:
@@ -669,14 +1189,21 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 		
 		if( mType == EStringToken )
 		{
-			std::string	myStr( ToLowerString(mStringValue) );
-			std::string	otherStr( ToLowerString(other.mStringValue) );
+			std::string	myStr( ToLowerString( GetStringValue() ) );
+			std::string	otherStr( ToLowerString( other.GetStringValue() ) );
 			same = same && ( otherStr.compare(myStr) == 0 );
 		}
 		else if( mType == EIdentifierToken && mSubType == ELastIdentifier_Sentinel )
-			same = same && ( other.mStringValue.compare(mStringValue) == 0 );
+		{
+			if( mSymbolID != kNoSymbol && other.mSymbolID != kNoSymbol )	// Assumes both came from the same symbol table.
+				same = same && ( mSymbolID == other.mSymbolID );
+			else
+				same = same && ( other.GetStringValue().compare( GetStringValue() ) == 0 );
+		}
 		else if( mType == ENumberToken )
 			same = same && ( mNumberValue == other.mNumberValue );
+		else if( mType == EFloatNumberToken )
+			same = same && ( mFloatValue == other.mFloatValue );
 		
 		return( same );
 	}
@@ -695,14 +1222,16 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 		
 		if( mType == EStringToken )
 		{
-			std::string	myStr( ToLowerString(mStringValue) );
-			std::string	otherStr( ToLowerString(other.mStringValue) );
+			std::string	myStr( ToLowerString( GetStringValue() ) );
+			std::string	otherStr( ToLowerString( other.GetStringValue() ) );
 			same = same && ( otherStr.compare(myStr) == 1 );
 		}
 		else if( mType == EIdentifierToken && mSubType == ELastIdentifier_Sentinel )
-			same = same && ( other.mStringValue.compare(mStringValue) == 1 );
+			same = same && ( other.GetStringValue().compare( GetStringValue() ) == 1 );
 		else if( mType == ENumberToken )
 			same = same && ( mNumberValue > other.mNumberValue );
+		else if( mType == EFloatNumberToken )
+			same = same && ( mFloatValue > other.mFloatValue );
 		
 		return( same );
 	}
@@ -716,14 +1245,16 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 		
 		if( mType == EStringToken )
 		{
-			std::string	myStr( ToLowerString(mStringValue) );
-			std::string	otherStr( ToLowerString(other.mStringValue) );
+			std::string	myStr( ToLowerString( GetStringValue() ) );
+			std::string	otherStr( ToLowerString( other.GetStringValue() ) );
 			same = same && ( otherStr.compare(myStr) == -1 );
 		}
 		else if( mType == EIdentifierToken && mSubType == ELastIdentifier_Sentinel )
-			same = same && ( other.mStringValue.compare(mStringValue) == -1 );
+			same = same && ( other.GetStringValue().compare( GetStringValue() ) == -1 );
 		else if( mType == ENumberToken )
 			same = same && ( mNumberValue < other.mNumberValue );
+		else if( mType == EFloatNumberToken )
+			same = same && ( mFloatValue < other.mFloatValue );
 		
 		return( same );
 	}
@@ -737,14 +1268,16 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 		
 		if( mType == EStringToken )
 		{
-			std::string	myStr( ToLowerString(mStringValue) );
-			std::string	otherStr( ToLowerString(other.mStringValue) );
+			std::string	myStr( ToLowerString( GetStringValue() ) );
+			std::string	otherStr( ToLowerString( other.GetStringValue() ) );
 			same = same && ( otherStr.compare(myStr) >= 0 );
 		}
 		else if( mType == EIdentifierToken && mSubType == ELastIdentifier_Sentinel )
-			same = same && ( other.mStringValue.compare(mStringValue) >= 0 );
+			same = same && ( other.GetStringValue().compare( GetStringValue() ) >= 0 );
 		else if( mType == ENumberToken )
 			same = same && ( mNumberValue >= other.mNumberValue );
+		else if( mType == EFloatNumberToken )
+			same = same && ( mFloatValue >= other.mFloatValue );
 		
 		return( same );
 	}
@@ -758,20 +1291,22 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 		
 		if( mType == EStringToken )
 		{
-			std::string	myStr( ToLowerString(mStringValue) );
-			std::string	otherStr( ToLowerString(other.mStringValue) );
+			std::string	myStr( ToLowerString( GetStringValue() ) );
+			std::string	otherStr( ToLowerString( other.GetStringValue() ) );
 			same = same && ( otherStr.compare(myStr) <= 0 );
 		}
 		else if( mType == EIdentifierToken && mSubType == ELastIdentifier_Sentinel )
-			same = same && ( other.mStringValue.compare(mStringValue) <= 0 );
+			same = same && ( other.GetStringValue().compare( GetStringValue() ) <= 0 );
 		else if( mType == ENumberToken )
 			same = same && ( mNumberValue <= other.mNumberValue );
+		else if( mType == EFloatNumberToken )
+			same = same && ( mFloatValue <= other.mFloatValue );
 		
 		return( same );
 	}
 
 
-	void	CToken::GoNextToken( const char* fname, std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+	void	CToken::GoNextToken( const char* fname, CTokenCursor& tokenItty, CTokenList& tokens )
 	{
 		if( tokenItty == tokens.end() )
 		{
@@ -780,11 +1315,11 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 			throw std::runtime_error( errMsg.str() );
 		}
 		else
-			tokenItty++;
+			++tokenItty;
 	}
 	
 	
-	void	CToken::GoPrevToken( const char* fname, std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens )
+	void	CToken::GoPrevToken( const char* fname, CTokenCursor& tokenItty, CTokenList& tokens )
 	{
 		if( tokenItty == tokens.begin() )
 		{
@@ -793,10 +1328,10 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 			throw std::runtime_error( errMsg.str() );
 		}
 		else
-			tokenItty--;
+			--tokenItty;
 	}
 
-	void	CToken::ExpectIdentifier( const std::string& inFileName, TIdentifierSubtype subType, TIdentifierSubtype precedingIdent )
+	void	CToken::ExpectIdentifier( const std::string& inFileName, TIdentifierSubtype subType, TIdentifierSubtype precedingIdent ) const
 	{
 		if( !IsIdentifier( subType ) )
 		{
@@ -816,4 +1351,462 @@ TIdentifierSubtype	gIdentifierSynonyms[ELastIdentifier_Sentinel +1] =
 	}
 
 
+
+#pragma mark -
+	
+	#define kTextIsIdentifierString		0xFFFFFFFFU	// mTextLengths value for tokens whose text is gIdentifierStrings[subtype], like operators.
+	#define kNoLiteral					0xFFFFFFFFU	// mLiteralIndexes value for tokens that aren't numbers.
+	
+	typedef char	TSubtypeFitsInByteCheck[ (ELastIdentifier_Sentinel <= 0xFF) ? 1 : -1 ];	// Fails to compile once mSubTypes needs to be wider.
+	
+	
+	CTokenList::CTokenList( CTokenizer* inTokenizer, CSymbolTable* inSymbols, size_t inRingBufferSize )
+		: mText(inTokenizer->GetText()), mTokenizer(inTokenizer), mSymbols(inSymbols), mRingBufferSize(inRingBufferSize), mNumTokens(0), mLastLineNum(1)
+	{
+		if( mRingBufferSize > 0 )
+		{
+			mTypes.reserve( mRingBufferSize );
+			mSubTypes.reserve( mRingBufferSize );
+			mOffsets.reserve( mRingBufferSize );
+			mTextLengths.reserve( mRingBufferSize );
+			mLineNums.reserve( mRingBufferSize );
+			mSymbolIDs.reserve( mRingBufferSize );
+			mLiteralIndexes.reserve( mRingBufferSize );
+			mNumberLiterals.reserve( mRingBufferSize );
+		}
+	}
+	
+	
+	void	CTokenList::AddToken( const CToken& inToken )
+	{
+		uint32_t	textLength = (uint32_t) inToken.mTextLength;
+		if( inToken.mSubType != ELastIdentifier_Sentinel && inToken.mText == gIdentifierStrings[inToken.mSubType] )
+			textLength = kTextIsIdentifierString;
+		else if( inToken.mText != mText +inToken.mOffset )
+			throw std::logic_error( "Token text must be in the token list's text." );
+		if( inToken.mOffset > 0xFFFFFFFFU || inToken.mLineNum > 0xFFFFFFFFU || inToken.mTextLength >= 0xFFFFFFFFU )
+			throw std::runtime_error( "Script too large." );
+		
+		CSymbolID	symbol = kNoSymbol;
+		if( inToken.mType == EIdentifierToken )
+		{
+			if( inToken.mSubType != ELastIdentifier_Sentinel )	// Built-in identifiers are their own symbol.
+				symbol = inToken.mSubType;
+			else if( mSymbols != NULL )
+				symbol = mSymbols->SymbolForText( inToken.mText, inToken.mTextLength, false );
+		}
+		
+		size_t		slot = (mRingBufferSize > 0) ? (mNumTokens % mRingBufferSize) : mNumTokens;
+		if( slot == mTypes.size() )
+		{
+			mTypes.push_back( (uint8_t) inToken.mType );
+			mSubTypes.push_back( (uint8_t) inToken.mSubType );
+			mOffsets.push_back( (uint32_t) inToken.mOffset );
+			mTextLengths.push_back( textLength );
+			mLineNums.push_back( (uint32_t) inToken.mLineNum );
+			mSymbolIDs.push_back( symbol );
+			mLiteralIndexes.push_back( kNoLiteral );
+			if( mRingBufferSize > 0 )	// Ring buffer has one literal slot per token slot, so it doesn't grow.
+				mNumberLiterals.push_back( TNumberLiteral() );
+		}
+		else	// Ring buffer full, overwrite oldest token:
+		{
+			mTypes[slot] = (uint8_t) inToken.mType;
+			mSubTypes[slot] = (uint8_t) inToken.mSubType;
+			mOffsets[slot] = (uint32_t) inToken.mOffset;
+			mTextLengths[slot] = textLength;
+			mLineNums[slot] = (uint32_t) inToken.mLineNum;
+			mSymbolIDs[slot] = symbol;
+			mLiteralIndexes[slot] = kNoLiteral;
+		}
+		
+		if( inToken.mType == ENumberToken || inToken.mType == EFloatNumberToken )
+		{
+			TNumberLiteral	literal;
+			if( inToken.mType == EFloatNumberToken )
+				literal.mFloat = inToken.mFloatValue;
+			else
+				literal.mInteger = inToken.mNumberValue;
+			
+			if( mRingBufferSize > 0 )
+			{
+				mLiteralIndexes[slot] = (uint32_t) slot;
+				mNumberLiterals[slot] = literal;
+			}
+			else
+			{
+				mLiteralIndexes[slot] = (uint32_t) mNumberLiterals.size();
+				mNumberLiterals.push_back( literal );
+			}
+		}
+		
+		mLastLineNum = inToken.mLineNum;
+		mNumTokens++;
+	}
+	
+	
+	bool	CTokenList::HasTokenAtIndex( size_t inIndex )
+	{
+		while( inIndex >= mNumTokens && mTokenizer != NULL && !mTokenizer->IsAtEnd() )
+			mTokenizer->ReadNextTokens( *this );
+		
+		return( inIndex < mNumTokens );
+	}
+	
+	
+	CToken	CTokenList::GetToken( size_t inIndex )
+	{
+		if( !HasTokenAtIndex( inIndex ) )	// End of file. Give the caller something with a sensible line number for error messages.
+			return CToken( EInvalidToken, ELastIdentifier_Sentinel, 0, mLastLineNum, "", 0 );
+		
+		size_t				slot = inIndex;
+		if( mRingBufferSize > 0 )
+		{
+			if( (inIndex +mRingBufferSize) < mNumTokens )
+				throw std::logic_error( "Parser backtracked further than the token ring buffer holds." );
+			slot = inIndex % mRingBufferSize;
+		}
+		
+		TIdentifierSubtype	subType = (TIdentifierSubtype) mSubTypes[slot];
+		const char*			text = mText +mOffsets[slot];
+		size_t				textLength = mTextLengths[slot];
+		if( textLength == kTextIsIdentifierString )
+		{
+			text = gIdentifierStrings[subType];
+			textLength = strlen( text );
+		}
+		TTokenType			type = (TTokenType) mTypes[slot];
+		long				number = (mLiteralIndexes[slot] == kNoLiteral || type != ENumberToken) ? 0 : mNumberLiterals[mLiteralIndexes[slot]].mInteger;
+		
+		CToken				token( type, subType, mOffsets[slot], mLineNums[slot], text, textLength, number, mSymbolIDs[slot] );
+		if( type == EFloatNumberToken )
+			token.mFloatValue = mNumberLiterals[mLiteralIndexes[slot]].mFloat;
+		return token;
+	}
+	
+	
+	void	CTokenList::clear()
+	{
+		mTypes.clear();
+		mSubTypes.clear();
+		mOffsets.clear();
+		mTextLengths.clear();
+		mLineNums.clear();
+		mSymbolIDs.clear();
+		mLiteralIndexes.clear();
+		mNumberLiterals.clear();
+		mNumTokens = 0;
+		mLastLineNum = 1;
+	}
+	
+	
+	bool	CTokenList::IsLineBreakTokenAtSlot( size_t inSlot ) const
+	{
+		return( mTypes[inSlot] == EIdentifierToken && mSubTypes[inSlot] == ENewlineOperator );
+	}
+	
+	
+	// Replace the elements from inStart up to inEnd with the first inNewCount
+	//	elements of inNewElements. Usually an edit changes only a handful of
+	//	tokens, so this overwrites in place and only moves the rest of the
+	//	array if the number of tokens changed.
+	template<class T>
+	static void	ReplaceRange( std::vector<T>& ioElements, size_t inStart, size_t inEnd, const std::vector<T>& inNewElements, size_t inNewCount )
+	{
+		size_t		numOld = inEnd -inStart,
+					numOverwritten = std::min( numOld, inNewCount );
+		std::copy( inNewElements.begin(), inNewElements.begin() +numOverwritten, ioElements.begin() +inStart );
+		if( inNewCount > numOld )
+			ioElements.insert( ioElements.begin() +inEnd, inNewElements.begin() +numOld, inNewElements.begin() +inNewCount );
+		else if( numOld > inNewCount )
+			ioElements.erase( ioElements.begin() +inStart +inNewCount, ioElements.begin() +inEnd );
+	}
+	
+	
+	void	CTokenList::UpdateForEdit( const char* inNewText, size_t inNewTextLength, size_t inEditOffset, size_t inRemovedLength, size_t inInsertedLength )
+	{
+		if( mRingBufferSize > 0 || (mTokenizer != NULL && !mTokenizer->IsAtEnd()) )
+			throw std::logic_error( "UpdateForEdit needs a list with all tokens of the script." );
+		
+		// Right after a line break token, the tokenizer is always between tokens,
+		//	so we can restart there. Find the last one before the edit:
+		size_t		firstTokenAtEdit = std::lower_bound( mOffsets.begin(), mOffsets.end(), (uint32_t) inEditOffset ) -mOffsets.begin();
+		size_t		firstReplacedToken = firstTokenAtEdit;
+		while( firstReplacedToken > 0 && !IsLineBreakTokenAtSlot( firstReplacedToken -1 ) )
+			firstReplacedToken--;
+		size_t		restartOffset = (firstReplacedToken > 0) ? (mOffsets[firstReplacedToken -1] +1) : 0;
+		size_t		restartLineNum = (firstReplacedToken > 0) ? (mLineNums[firstReplacedToken -1] +1) : 1;
+		
+		// Re-tokenize until we get a line break after the edit that was also
+		//	in the old list. Everything after it is unchanged except for position:
+		long		offsetDelta = (long) inInsertedLength -(long) inRemovedLength;
+		long		lineNumDelta = 0;
+		size_t		firstKeptToken = mNumTokens;	// If we don't resynchronize, all tokens to the end get replaced.
+		CTokenizer	tokenizer( inNewText, inNewTextLength, restartOffset, restartLineNum );
+		CTokenList	newTokens( inNewText, mSymbols );
+		size_t		numNewTokens = 0;
+		bool		resynchronized = false;
+		
+		while( !resynchronized && !tokenizer.IsAtEnd() )
+		{
+			tokenizer.ReadNextTokens( newTokens );
+			
+			for( ; numNewTokens < newTokens.mNumTokens && !resynchronized; numNewTokens++ )
+			{
+				if( !newTokens.IsLineBreakTokenAtSlot( numNewTokens ) || newTokens.mOffsets[numNewTokens] < (inEditOffset +inInsertedLength) )
+					continue;
+				
+				uint32_t	oldOffset = (uint32_t)( newTokens.mOffsets[numNewTokens] -offsetDelta );
+				size_t		oldIndex = std::lower_bound( mOffsets.begin() +firstTokenAtEdit, mOffsets.end(), oldOffset ) -mOffsets.begin();
+				if( oldIndex < mNumTokens && mOffsets[oldIndex] == oldOffset && IsLineBreakTokenAtSlot( oldIndex ) )
+				{
+					lineNumDelta = (long) newTokens.mLineNums[numNewTokens] -(long) mLineNums[oldIndex];
+					firstKeptToken = oldIndex +1;
+					resynchronized = true;
+				}
+			}
+		}
+		
+		// Rebase the new tokens' number literals onto our literal pool:
+		for( size_t x = 0; x < numNewTokens; x++ )
+		{
+			if( newTokens.mLiteralIndexes[x] != kNoLiteral )
+				newTokens.mLiteralIndexes[x] += (uint32_t) mNumberLiterals.size();
+		}
+		mNumberLiterals.insert( mNumberLiterals.end(), newTokens.mNumberLiterals.begin(), newTokens.mNumberLiterals.end() );
+		
+		// Swap in the new tokens:
+		ReplaceRange( mTypes, firstReplacedToken, firstKeptToken, newTokens.mTypes, numNewTokens );
+		ReplaceRange( mSubTypes, firstReplacedToken, firstKeptToken, newTokens.mSubTypes, numNewTokens );
+		ReplaceRange( mOffsets, firstReplacedToken, firstKeptToken, newTokens.mOffsets, numNewTokens );
+		ReplaceRange( mTextLengths, firstReplacedToken, firstKeptToken, newTokens.mTextLengths, numNewTokens );
+		ReplaceRange( mLineNums, firstReplacedToken, firstKeptToken, newTokens.mLineNums, numNewTokens );
+		ReplaceRange( mSymbolIDs, firstReplacedToken, firstKeptToken, newTokens.mSymbolIDs, numNewTokens );
+		ReplaceRange( mLiteralIndexes, firstReplacedToken, firstKeptToken, newTokens.mLiteralIndexes, numNewTokens );
+		mNumTokens = mTypes.size();
+		
+		// Move the unchanged tokens after the edit to their new position:
+		if( offsetDelta != 0 || lineNumDelta != 0 )
+		{
+			for( size_t x = firstReplacedToken +numNewTokens; x < mNumTokens; x++ )
+			{
+				mOffsets[x] += (uint32_t) offsetDelta;	// Wraps around correctly for negative deltas.
+				mLineNums[x] += (uint32_t) lineNumDelta;
+			}
+		}
+		
+		mText = inNewText;
+		mLastLineNum = mLineNums.empty() ? 1 : mLineNums.back();
+		
+		if( mNumberLiterals.size() > (2 * mNumTokens +1024) )	// Lots of literals of replaced tokens piled up?
+			CompactNumberLiterals();
+	}
+	
+	
+	void	CTokenList::CompactNumberLiterals()
+	{
+		std::vector<TNumberLiteral>	usedLiterals;
+		for( size_t x = 0; x < mNumTokens; x++ )
+		{
+			if( mLiteralIndexes[x] != kNoLiteral )
+			{
+				usedLiterals.push_back( mNumberLiterals[mLiteralIndexes[x]] );
+				mLiteralIndexes[x] = (uint32_t) (usedLiterals.size() -1);
+			}
+		}
+		mNumberLiterals.swap( usedLiterals );
+	}
+	
+	
+	void	CTokenList::AppendTokens( const CTokenList& inTokens, size_t inLineNumDelta, CSymbolTable& inTokensSymbols )
+	{
+		std::vector<CSymbolID>	symbolMap;	// Symbol in inTokensSymbols -> symbol in mSymbols, so we intern each name only once.
+		size_t					firstNewToken = mNumTokens;
+		
+		mTypes.insert( mTypes.end(), inTokens.mTypes.begin(), inTokens.mTypes.end() );
+		mSubTypes.insert( mSubTypes.end(), inTokens.mSubTypes.begin(), inTokens.mSubTypes.end() );
+		mOffsets.insert( mOffsets.end(), inTokens.mOffsets.begin(), inTokens.mOffsets.end() );
+		mTextLengths.insert( mTextLengths.end(), inTokens.mTextLengths.begin(), inTokens.mTextLengths.end() );
+		mLineNums.insert( mLineNums.end(), inTokens.mLineNums.begin(), inTokens.mLineNums.end() );
+		mSymbolIDs.insert( mSymbolIDs.end(), inTokens.mSymbolIDs.begin(), inTokens.mSymbolIDs.end() );
+		mLiteralIndexes.insert( mLiteralIndexes.end(), inTokens.mLiteralIndexes.begin(), inTokens.mLiteralIndexes.end() );
+		mNumTokens = mTypes.size();
+		
+		for( size_t x = firstNewToken; x < mNumTokens; x++ )
+		{
+			mLineNums[x] += (uint32_t) inLineNumDelta;
+			if( mLiteralIndexes[x] != kNoLiteral )
+				mLiteralIndexes[x] += (uint32_t) mNumberLiterals.size();
+			
+			CSymbolID	symbol = mSymbolIDs[x];
+			if( symbol == kNoSymbol || symbol < (CSymbolID) ELastIdentifier_Sentinel )	// Not an identifier, or a built-in one.
+				continue;
+			if( mSymbols == NULL )
+				mSymbolIDs[x] = kNoSymbol;
+			else
+			{
+				if( symbol >= symbolMap.size() )
+					symbolMap.resize( inTokensSymbols.size(), kNoSymbol );
+				if( symbolMap[symbol] == kNoSymbol )
+					symbolMap[symbol] = mSymbols->SymbolForString( inTokensSymbols.TextForSymbol( symbol ) );
+				mSymbolIDs[x] = symbolMap[symbol];
+			}
+		}
+		mNumberLiterals.insert( mNumberLiterals.end(), inTokens.mNumberLiterals.begin(), inTokens.mNumberLiterals.end() );
+		
+		if( mNumTokens > 0 )
+			mLastLineNum = mLineNums.back();
+	}
+	
+	
+	// One piece of a script being tokenized by TokenizeInParallel(). Each
+	//	piece starts right after a line break, where the tokenizer is usually
+	//	between tokens, and ends with the first line break token at or after
+	//	mStopOffset, which is usually right where the next piece starts:
+	struct CTokenizeChunk
+	{
+		const char*		mText;
+		size_t			mTextLength;
+		size_t			mStartOffset;
+		size_t			mStopOffset;
+		CSymbolTable	mSymbols;		// Each thread gets its own, AppendTokens() merges them.
+		CTokenList		mTokens;
+		size_t			mEndOffset;		// Where the next piece needs to start to continue where we stopped.
+		size_t			mEndLineNum;	// Line number of the last token, counting from 1 at mStartOffset.
+		std::string		mError;
+		
+		CTokenizeChunk() : mText(NULL), mTextLength(0), mStartOffset(0), mStopOffset(0), mEndOffset(0), mEndLineNum(1) {};
+		
+		void	Tokenize()
+		{
+			mTokens = CTokenList( mText, &mSymbols );
+			mEndOffset = mTextLength;
+			mEndLineNum = 1;
+			try
+			{
+				CTokenizer	tokenizer( mText, mTextLength, mStartOffset, 1 );
+				while( !tokenizer.IsAtEnd() )
+				{
+					tokenizer.ReadNextTokens( mTokens );
+					CToken	lastToken = mTokens.GetToken( mTokens.size() -1 );	// A line break is always the last token of a batch.
+					mEndLineNum = lastToken.mLineNum;
+					if( lastToken.mOffset >= mStopOffset && lastToken.IsIdentifier( ENewlineOperator ) )
+					{
+						mEndOffset = lastToken.mOffset +1;
+						break;
+					}
+				}
+			}
+			catch( std::exception& err )
+			{
+				mError = err.what();
+			}
+		}
+	};
+	
+	
+	static void*	TokenizeChunkThread( void* inChunk )
+	{
+		((CTokenizeChunk*) inChunk)->Tokenize();
+		return NULL;
+	}
+	
+	
+	void	CTokenList::TokenizeInParallel( size_t inMaxThreads )
+	{
+		if( mTokenizer == NULL || mNumTokens > 0 )
+			throw std::logic_error( "TokenizeInParallel needs a list whose tokenizer hasn't started yet." );
+		
+		size_t		textLength = mTokenizer->GetTextLength();
+		if( textLength < PARALLEL_TOKENIZE_MIN_TEXT_SIZE )
+			return;
+		
+		if( inMaxThreads == 0 )
+		{
+			long	numCPUs = sysconf( _SC_NPROCESSORS_ONLN );
+			inMaxThreads = (numCPUs > 0) ? numCPUs : 1;
+		}
+		size_t		numChunks = std::min( inMaxThreads, textLength / PARALLEL_TOKENIZE_MIN_CHUNK_SIZE );
+		if( numChunks < 2 )
+			return;
+		
+		// Split the text into roughly equal pieces, each starting after a line break:
+		std::vector<CTokenizeChunk>	chunks( numChunks );
+		size_t						chunkStart = 0;
+		for( size_t x = 0; x < numChunks; x++ )
+		{
+			size_t		chunkEnd = (x == (numChunks -1)) ? textLength : std::max( chunkStart, (textLength / numChunks) * (x +1) );
+			while( chunkEnd < textLength && mText[chunkEnd -1] != '\n' && mText[chunkEnd -1] != '\r' )
+				chunkEnd++;
+			
+			chunks[x].mText = mText;
+			chunks[x].mTextLength = textLength;
+			chunks[x].mStartOffset = chunkStart;
+			chunks[x].mStopOffset = (chunkEnd < textLength) ? (chunkEnd -1) : textLength;	// Stop at the line break before the next piece.
+			chunkStart = chunkEnd;
+		}
+		
+		// Tokenize the first piece on this thread, all others on their own:
+		std::vector<pthread_t>	threads( numChunks );
+		std::vector<bool>		threadStarted( numChunks, false );
+		for( size_t x = 1; x < numChunks; x++ )
+			threadStarted[x] = (pthread_create( &threads[x], NULL, TokenizeChunkThread, &chunks[x] ) == 0);
+		chunks[0].Tokenize();
+		for( size_t x = 1; x < numChunks; x++ )
+		{
+			if( threadStarted[x] )
+				pthread_join( threads[x], NULL );
+		}
+		
+		// Stitch the pieces together. If a string literal spanned a split, a
+		//	piece didn't start where the previous one stopped. That piece has
+		//	to be redone from the right place:
+		size_t		nextOffset = 0,
+					lineNumDelta = 0;
+		for( size_t x = 0; x < numChunks; x++ )
+		{
+			if( !threadStarted[x] && x > 0 )
+				chunks[x].mStartOffset = (size_t) -1;	// Never ran, force tokenizing it below.
+			if( chunks[x].mStartOffset != nextOffset )
+			{
+				chunks[x].mStartOffset = nextOffset;
+				chunks[x].Tokenize();
+			}
+			if( !chunks[x].mError.empty() )
+				throw std::runtime_error( chunks[x].mError );
+			
+			AppendTokens( chunks[x].mTokens, lineNumDelta, chunks[x].mSymbols );
+			nextOffset = chunks[x].mEndOffset;
+			lineNumDelta += chunks[x].mEndLineNum;	// The next piece starts on the line after our last line break.
+		}
+		
+		mTokenizer = NULL;		// We have all tokens, don't let HasTokenAtIndex() tokenize again.
+		mRingBufferSize = 0;
+	}
+	
+	
+	CTokenCursor	CTokenList::begin()
+	{
+		return CTokenCursor( this, 0 );
+	}
+	
+	
+	CTokenCursor	CTokenList::end()
+	{
+		return CTokenCursor( this, CTokenCursor::kEndIndex );
+	}
+	
+	
+	bool	CTokenCursor::operator==( const CTokenCursor& other ) const
+	{
+		if( mIndex == other.mIndex )
+			return true;
+		else if( other.mIndex == kEndIndex )	// Only the list knows where the end is, it may not have been tokenized yet.
+			return !mTokens->HasTokenAtIndex( mIndex );
+		else if( mIndex == kEndIndex )
+			return !other.mTokens->HasTokenAtIndex( other.mIndex );
+		else
+			return false;
+	}
+
 } /* namespace Carlson */
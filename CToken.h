@@ -10,8 +10,10 @@
 #pragma once
 
 #include "ForgeTypes.h"
+#include "CSymbolTable.h"
 #include <deque>
 #include <string>
+#include <vector>
 
 
 namespace Carlson
@@ -23,6 +25,7 @@ namespace Carlson
 		EStringToken,
 		EIdentifierToken,
 		ENumberToken,
+		EFloatNumberToken,
 		ECommentPseudoToken,
 		ELastToken_Sentinel
 	} TTokenType;
@@ -30,6 +33,10 @@ namespace Carlson
 	// These two need to be kept in sync with constants above:
 	extern const char*		gTokenTypeStrings[ELastToken_Sentinel];
 	extern const char*		gIdentifierStrings[ELastIdentifier_Sentinel];
+	
+	class CTokenList;
+	class CTokenCursor;
+	class CTokenizer;
 
 	class CToken
 	{
@@ -38,8 +45,9 @@ namespace Carlson
 		static const CToken&		KNewlineToken;	
 	
 	public:
-		static std::deque<CToken>	TokenListFromText( const char* str, size_t len );
+		static CTokenList			TokenListFromText( const char* str, size_t len, CSymbolTable* inSymbols = NULL );	// Tokens reference str, so keep it around as long as you use them.
 		static TIdentifierSubtype	IdentifierTypeFromText( const char* str );
+		static TIdentifierSubtype	IdentifierTypeFromText( const char* str, size_t len );	// Lowercases str itself, doesn't need to be zero-terminated.
 	
 	// Instance:
 	public:
@@ -47,12 +55,15 @@ namespace Carlson
 		TIdentifierSubtype		mSubType;		// What kind of identifier is it?
 		size_t					mOffset;		// Position of this token in text.
 		size_t					mLineNum;		// Line where this token is in the text.
-		std::string				mStringValue;	// String representation of this token.
+		const char*				mText;			// String representation of this token. Points into the text we were tokenized from, or at a string constant. *Not* zero-terminated.
+		size_t					mTextLength;	// Number of bytes at mText.
 		long					mNumberValue;	// Number representation of this token.
+		double					mFloatValue;	// Number representation of EFloatNumberToken tokens.
+		CSymbolID				mSymbolID;		// Interned case-folded text of identifiers, kNoSymbol for other tokens.
 		
 	public:
-		CToken( TTokenType type, TIdentifierSubtype subtype, size_t offs, size_t lineN, const std::string str, long n = 0 )
-			: mStringValue(str)
+		CToken( TTokenType type, TIdentifierSubtype subtype, size_t offs, size_t lineN, const char* str, size_t strLen, long n = 0, CSymbolID inSymbol = kNoSymbol )
+			: mText(str), mTextLength(strLen), mFloatValue(0.0), mSymbolID(inSymbol)
 		{
 			mType = type;
 			mSubType = subtype;
@@ -61,7 +72,9 @@ namespace Carlson
 			mLineNum = lineN;
 		}
 		
-		void			ExpectIdentifier( const std::string& inFileName, TIdentifierSubtype subType, TIdentifierSubtype precedingIdent = ELastIdentifier_Sentinel );
+		std::string		GetStringValue() const	{ return std::string( mText, mTextLength ); };	// Makes a copy of mText.
+		
+		void			ExpectIdentifier( const std::string& inFileName, TIdentifierSubtype subType, TIdentifierSubtype precedingIdent = ELastIdentifier_Sentinel ) const;
 		
 		std::string		GetDescription() const;			// All attributes of this token.
 		std::string		GetShortDescription() const;	// The token, pretty much in the form the user would see it.
@@ -78,14 +91,150 @@ namespace Carlson
 		bool				IsIdentifier( TIdentifierSubtype subType ) const;
 		const std::string	GetIdentifierText() const;			// Lowercased and otherwise normalised for easier compares.
 		TIdentifierSubtype	GetIdentifierSubType() const;		// Like mSubType, but throws if this isn't an identifier.
+		CSymbolID			GetIdentifierSymbol() const;		// Like mSymbolID, but throws if this isn't an identifier.
 		const std::string	GetOriginalIdentifierText() const;	// Original string as entered by user.
 	
 	public:
-		static void	GoNextToken( const char* fname, std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
-		static void	GoPrevToken( const char* fname, std::deque<CToken>::iterator& tokenItty, std::deque<CToken>& tokens );
+		static void	GoNextToken( const char* fname, CTokenCursor& tokenItty, CTokenList& tokens );
+		static void	GoPrevToken( const char* fname, CTokenCursor& tokenItty, CTokenList& tokens );
+	};
+	
+	
+	// Incremental tokenizer: Each call to ReadNextTokens() tokenizes just
+	//	enough text to add at least one token to the list (unless it hits the
+	//	end of the text). TokenListFromText() uses this to tokenize a whole
+	//	script, a streaming CTokenList uses it to tokenize as the parser goes.
+	class CTokenizer
+	{
+	public:
+		CTokenizer( const char* str, size_t len, size_t inStartOffset = 0, size_t inStartLineNum = 1 );	// str must stay around as long as the tokens are used. Only start right after a line break.
+		
+		void			ReadNextTokens( CTokenList& tokenList );
+		bool			IsAtEnd() const		{ return mAtEnd; };
+		const char*		GetText() const		{ return mText; };
+		size_t			GetTextLength() const	{ return mTextLength; };
+		
+	protected:
+		const char*		mText;
+		size_t			mTextLength;
+		size_t			mOffset;			// Where to continue tokenizing.
+		size_t			mCurrStartOffs;		// Start of token we're in the middle of.
+		TTokenType		mCurrType;			// Type of token we're in the middle of, EInvalidToken when between tokens.
+		size_t			mCurrLineNum;
+		bool			mAtEnd;				// All text has been tokenized.
+	};
+	
+	
+	#define TOKEN_RING_BUFFER_SIZE		64	// Number of tokens a streaming CTokenList keeps around for the parser to backtrack.
+	#define PARALLEL_TOKENIZE_MIN_TEXT_SIZE		(512 * 1024)	// Scripts smaller than this aren't worth starting threads for.
+	#define PARALLEL_TOKENIZE_MIN_CHUNK_SIZE	(128 * 1024)	// Don't give a thread less text than this.
+	
+	
+	// Value of a number token in CTokenList's literal pool:
+	typedef union
+	{
+		long		mInteger;	// ENumberToken.
+		double		mFloat;		// EFloatNumberToken.
+	} TNumberLiteral;
+	
+	
+	// Compact storage for all tokens of a script: Instead of one CToken per
+	//	token, this keeps one array per field, and CTokenCursor re-creates the
+	//	CToken for the current position on demand.
+	//	A streaming list is created from a CTokenizer, and tokenizes just ahead
+	//	of whatever index is requested, only keeping the last inRingBufferSize
+	//	tokens around. Pass 0 to keep all tokens while still tokenizing lazily.
+	class CTokenList
+	{
+	public:
+		explicit CTokenList( const char* inText = NULL, CSymbolTable* inSymbols = NULL ) : mText(inText), mTokenizer(NULL), mSymbols(inSymbols), mRingBufferSize(0), mNumTokens(0), mLastLineNum(1) {};	// Without a symbol table, only built-in identifiers get a symbol.
+		CTokenList( CTokenizer* inTokenizer, CSymbolTable* inSymbols, size_t inRingBufferSize = TOKEN_RING_BUFFER_SIZE );
+		
+		void			AddToken( const CToken& inToken );	// inToken's text must point into our text, or be its gIdentifierStrings entry. Interns identifiers.
+		CToken			GetToken( size_t inIndex );			// Gives an EInvalidToken if inIndex is past the end.
+		bool			HasTokenAtIndex( size_t inIndex );	// Tokenizes up to inIndex if needed.
+		void			TokenizeInParallel( size_t inMaxThreads = 0 );	// Tokenizes a big text right away, split at line breaks across inMaxThreads threads (0 for one per CPU), keeping all tokens. Leaves small texts to be tokenized while parsing.
+		
+		void			UpdateForEdit( const char* inNewText, size_t inNewTextLength, size_t inEditOffset, size_t inRemovedLength, size_t inInsertedLength );	// inNewText is the whole text after replacing inRemovedLength bytes at inEditOffset with inInsertedLength new ones.
+		
+		size_t			size() const	{ return mNumTokens; };	// Number of tokens added so far.
+		bool			empty() const	{ return mNumTokens == 0; };
+		bool			IsComplete() const	{ return mRingBufferSize == 0 && (mTokenizer == NULL || mTokenizer->IsAtEnd()); };	// All tokens are there and stay there, so several threads can read them at once.
+		void			clear();
+		
+		CTokenCursor	begin();
+		CTokenCursor	end();
+		
+		CSymbolTable*	GetSymbols()	{ return mSymbols; };
+	
+	protected:
+		bool			IsLineBreakTokenAtSlot( size_t inSlot ) const;
+		void			CompactNumberLiterals();
+		void			AppendTokens( const CTokenList& inTokens, size_t inLineNumDelta, CSymbolTable& inTokensSymbols );	// inTokens must be from the same text.
+	
+	protected:
+		const char*				mText;				// Text the tokens were created from. We don't own this.
+		CTokenizer*				mTokenizer;			// Where we get more tokens from when streaming, or NULL.
+		CSymbolTable*			mSymbols;			// Where identifiers get their mSymbolIDs from. We don't own this.
+		size_t					mRingBufferSize;	// Number of tokens we keep when streaming, 0 to keep all.
+		size_t					mNumTokens;			// Number of tokens added so far.
+		size_t					mLastLineNum;		// Line number of last token added.
+		std::vector<uint8_t>	mTypes;				// TTokenType for each token.
+		std::vector<uint8_t>	mSubTypes;			// TIdentifierSubtype for each token.
+		std::vector<uint32_t>	mOffsets;			// Offset of each token (and its text) in mText.
+		std::vector<uint32_t>	mTextLengths;		// Length of each token's text, or kTextIsIdentifierString.
+		std::vector<uint32_t>	mLineNums;			// Line number for each token.
+		std::vector<CSymbolID>	mSymbolIDs;			// Symbol of each identifier token, kNoSymbol for other tokens.
+		std::vector<uint32_t>	mLiteralIndexes;	// Index of each number token's value in mNumberLiterals, or kNoLiteral.
+		std::vector<TNumberLiteral>	mNumberLiterals;	// Value of each number token, so nobody needs to re-parse its text.
+	};
+	
+	
+	// Position in a CTokenList. Moving it around is just changing an index.
+	//	Dereferencing creates a CToken for the current position, which stays
+	//	valid until the cursor is moved and dereferenced again.
+	class CTokenCursor
+	{
+	public:
+		static const size_t		kEndIndex = (size_t) -1;	// Index of the cursor returned by CTokenList::end().
+		
+		CTokenCursor( CTokenList* inTokens = NULL, size_t inIndex = 0 )
+			: mTokens(inTokens), mIndex(inIndex), mCurrentTokenIndex((size_t) -1), mCurrentToken( EInvalidToken, ELastIdentifier_Sentinel, 0, 0, "", 0 ) {};
+		
+		const CToken&	operator*() const					{ return GetCurrentToken(); };
+		const CToken*	operator->() const					{ return &GetCurrentToken(); };
+		
+		CTokenCursor&	operator++()						{ mIndex++; return *this; };
+		CTokenCursor	operator++( int )					{ CTokenCursor oldPos( *this ); mIndex++; return oldPos; };
+		CTokenCursor&	operator--()						{ mIndex--; return *this; };
+		CTokenCursor	operator--( int )					{ CTokenCursor oldPos( *this ); mIndex--; return oldPos; };
+		
+		bool			operator==( const CTokenCursor& other ) const;
+		bool			operator!=( const CTokenCursor& other ) const	{ return !(*this == other); };
+		
+		size_t			GetIndex() const					{ return mIndex; };
+		CToken			PeekToken( size_t inDistance ) const	{ return mTokens->GetToken( mIndex +inDistance ); };	// Look ahead without moving.
+	
+	protected:
+		const CToken&	GetCurrentToken() const
+		{
+			if( mCurrentTokenIndex != mIndex )
+			{
+				mCurrentToken = mTokens->GetToken( mIndex );
+				mCurrentTokenIndex = mIndex;
+			}
+			return mCurrentToken;
+		};
+		
+	protected:
+		CTokenList*			mTokens;
+		size_t				mIndex;
+		mutable size_t		mCurrentTokenIndex;	// Index mCurrentToken was created for.
+		mutable CToken		mCurrentToken;
 	};
 
 
 	std::string	ToLowerString( const std::string& str );
+	size_t		ToLowerUTF8( const char* str, size_t len, char* outBuf );	// outBuf must hold len bytes, and may be str itself. Returns the length of the lowercased text.
 
 }	/* namespace Carlson */
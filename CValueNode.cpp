@@ -14,6 +14,7 @@
 #include "CValueNode.h"
 #include "CCodeBlock.h"
 #include "CCodeBlockNode.h"
+#include "CParseTreeArchive.h"
 
 
 namespace Carlson
@@ -25,35 +26,73 @@ void	CIntValueNode::GenerateCode( CCodeBlock* inCodeBlock )
 }
 
 
+void	CIntValueNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	ioWriter.WriteNumber( ENodeKindIntValue );
+	ioWriter.WriteSignedNumber( mIntValue );
+}
+
+
 void	CFloatValueNode::GenerateCode( CCodeBlock* inCodeBlock )
 {
 	inCodeBlock->GeneratePushFloatInstruction( mFloatValue );
 }
 
 
+void	CFloatValueNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	ioWriter.WriteNumber( ENodeKindFloatValue );
+	ioWriter.WriteFloat( mFloatValue );
+}
+
+
 void	CBoolValueNode::GenerateCode( CCodeBlock* inCodeBlock )
 {
 	inCodeBlock->GeneratePushBoolInstruction( mBoolValue );
 }
 
 
+void	CBoolValueNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	ioWriter.WriteNumber( ENodeKindBoolValue );
+	ioWriter.WriteBool( mBoolValue );
+}
+
+
 void	CStringValueNode::GenerateCode( CCodeBlock* inCodeBlock )
 {
 	inCodeBlock->GeneratePushStringInstruction( mStringValue );
 }
 
 
+void	CStringValueNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	ioWriter.WriteNumber( ENodeKindStringValue );
+	ioWriter.WriteString( mStringValue );
+}
+
+
 CLocalVariableRefValueNode::CLocalVariableRefValueNode( CParseTree* inTree, CCodeBlockNodeBase *inCodeBlockNode,
-														const std::string& inVarName, const std::string& inRealVarName )
+														CSymbolID inVarName, const std::string& inRealVarName )
 	: CValueNode(inTree), mCodeBlockNode(inCodeBlockNode), mVarName(inVarName), mRealVarName(inRealVarName)
 {
 	mCodeBlockNode->AddLocalVar( inVarName, inRealVarName, TVariantType_INVALID );
 }
 
 
-void	CLocalVariableRefValueNode::Simplify()
+void	CLocalVariableRefValueNode::DebugPrint( std::ostream& destStream, size_t indentLevel )
+{
+	INDENT_PREPARE(indentLevel);
+	
+	destStream << indentChars << "localVar( " << mParseTree->GetSymbols().TextForSymbol( mVarName ) << " )" << std::endl;
+}
+
+
+CValueNode*	CLocalVariableRefValueNode::Simplify()
 {
 	GetBPRelativeOffset();	// Make sure we are assigned a slot NOW, so we know how many variables we need by the time we generate the function prolog.
+	
+	return this;
 }
 
 
@@ -63,6 +102,15 @@ void	CLocalVariableRefValueNode::GenerateCode( CCodeBlock* inCodeBlock )
 }
 
 
+void	CLocalVariableRefValueNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	ioWriter.WriteNumber( ENodeKindLocalVariableRef );
+	ioWriter.WriteNodeReference( mCodeBlockNode );
+	ioWriter.WriteSymbol( mVarName );
+	ioWriter.WriteString( mRealVarName );
+}
+
+
 long	CLocalVariableRefValueNode::GetBPRelativeOffset()
 {
 	return mCodeBlockNode->GetBPRelativeOffsetForLocalVar(mVarName);
@@ -14,6 +14,7 @@
 // -----------------------------------------------------------------------------
 
 #include "CNode.h"
+#include "CSymbolTable.h"
 #include <math.h>
 #include <stdexcept>
 
@@ -37,7 +38,7 @@ public:
 
 	virtual void	GenerateCode( CCodeBlock* inCodeBlock )		{};	// Generate the actual bytecode so it leaves the result on the stack.
 	
-	virtual void	Simplify()			{};
+	virtual CValueNode*	Simplify()		{ return this; };	// Returns the node to use in our place, e.g. a constant it folded into.
 	
 	virtual bool	IsConstant()		{ return false; };
 	
@@ -56,10 +57,11 @@ public:
 	CIntValueNode( CParseTree* inTree, long n ) : CValueNode(inTree), mIntValue(n) {};
 	
 	virtual void			GenerateCode( CCodeBlock* inCodeBlock );	// Generate the actual bytecode so it leaves the result on the stack.
+	virtual void			WriteToArchive( CParseTreeWriter& ioWriter );
 
 	virtual bool			IsConstant()	{ return true; };
 
-	virtual CIntValueNode*	Copy()			{ return new CIntValueNode( mParseTree, mIntValue ); };
+	virtual CIntValueNode*	Copy()			{ return new( mParseTree ) CIntValueNode( mParseTree, mIntValue ); };
 
 	virtual void			DebugPrint( std::ostream& destStream, size_t indentLevel )
 	{
@@ -84,10 +86,11 @@ public:
 	CFloatValueNode( CParseTree* inTree, float n ) : CValueNode(inTree), mFloatValue(n) {};
 	
 	virtual void				GenerateCode( CCodeBlock* inCodeBlock );	// Generate the actual bytecode so it leaves the result on the stack.
+	virtual void				WriteToArchive( CParseTreeWriter& ioWriter );
 
 	virtual bool				IsConstant()		{ return true; };
 
-	virtual CFloatValueNode*	Copy()		{ return new CFloatValueNode( mParseTree, mFloatValue ); };
+	virtual CFloatValueNode*	Copy()		{ return new( mParseTree ) CFloatValueNode( mParseTree, mFloatValue ); };
 
 	virtual void				DebugPrint( std::ostream& destStream, size_t indentLevel )
 	{
@@ -118,10 +121,11 @@ public:
 	CBoolValueNode( CParseTree* inTree, bool n ) : CValueNode(inTree), mBoolValue(n) {};
 	
 	virtual void				GenerateCode( CCodeBlock* inCodeBlock );	// Generate the actual bytecode so it leaves the result on the stack.
+	virtual void				WriteToArchive( CParseTreeWriter& ioWriter );
 	
 	virtual bool				IsConstant()		{ return true; };
 
-	virtual CBoolValueNode*		Copy()		{ return new CBoolValueNode( mParseTree, mBoolValue ); };
+	virtual CBoolValueNode*		Copy()		{ return new( mParseTree ) CBoolValueNode( mParseTree, mBoolValue ); };
 
 	virtual void				DebugPrint( std::ostream& destStream, size_t indentLevel )
 	{
@@ -144,10 +148,11 @@ public:
 	CStringValueNode( CParseTree* inTree, const std::string& n ) : CValueNode(inTree), mStringValue(n) {};
 	
 	virtual void				GenerateCode( CCodeBlock* inCodeBlock );	// Generate the actual bytecode so it leaves the result on the stack.
+	virtual void				WriteToArchive( CParseTreeWriter& ioWriter );
 	
 	virtual bool				IsConstant()		{ return true; };
 
-	virtual CStringValueNode*	Copy()									{ return new CStringValueNode( mParseTree, mStringValue ); };
+	virtual CStringValueNode*	Copy()									{ return new( mParseTree ) CStringValueNode( mParseTree, mStringValue ); };
 
 	virtual void				DebugPrint( std::ostream& destStream, size_t indentLevel )
 	{
@@ -174,24 +179,22 @@ protected:
 class CLocalVariableRefValueNode : public CValueNode
 {
 public:
-	CLocalVariableRefValueNode( CParseTree* inTree, CCodeBlockNodeBase *inCodeBlockNode, const std::string& inVarName, const std::string& inRealVarName );
+	CLocalVariableRefValueNode( CParseTree* inTree, CCodeBlockNodeBase *inCodeBlockNode, CSymbolID inVarName, const std::string& inRealVarName );
 	
-	virtual void				Simplify();
+	virtual CValueNode*			Simplify();
 	virtual void				GenerateCode( CCodeBlock* inCodeBlock );	// Generate the actual bytecode so it leaves the result on the stack.
+	virtual void				WriteToArchive( CParseTreeWriter& ioWriter );
 	
-	virtual CLocalVariableRefValueNode*	Copy()							{ return new CLocalVariableRefValueNode( mParseTree, mCodeBlockNode, mVarName, mRealVarName ); };
+	virtual CLocalVariableRefValueNode*	Copy()							{ return new( mParseTree ) CLocalVariableRefValueNode( mParseTree, mCodeBlockNode, mVarName, mRealVarName ); };
 	
-	virtual void				DebugPrint( std::ostream& destStream, size_t indentLevel )
-	{
-		INDENT_PREPARE(indentLevel);
-		
-		destStream << indentChars << "localVar( " << mVarName.c_str() << " )" << std::endl;
-	};
+	virtual void				MoveToTree( CParseTree* inTree, const std::vector<CSymbolID>& inSymbolMap )	{ CValueNode::MoveToTree( inTree, inSymbolMap ); mVarName = inSymbolMap[mVarName]; };
+	
+	virtual void				DebugPrint( std::ostream& destStream, size_t indentLevel );
 	
 	long					GetBPRelativeOffset();
 
 protected:
-	std::string				mVarName;
+	CSymbolID				mVarName;
 	std::string				mRealVarName;
 	CCodeBlockNodeBase *	mCodeBlockNode;
 };
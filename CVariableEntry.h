@@ -68,17 +68,14 @@ public:
 	std::string		mRealName;			// Real name as the user sees it. User-defined variables internally get a prefix "var_" to avoid collisions with built-in system vars.
 	TVariantType	mVariableType;		// Type for this variable.
 	long			mBPRelativeOffset;	// Backpointer-relative offset of this variable, so we can find it.
-	static int		mTempCounterSeed;
 	
 public:
 	CVariableEntry( const std::string& realName, TVariantType theType, bool initWithName = false, bool isParam = false, bool isGlobal = false, bool dontDispose = false )
-		: mInitWithName( initWithName ), mIsParameter( isParam ), mIsGlobal( isGlobal ), mRealName( realName ), mDontDispose(dontDispose), mBPRelativeOffset(LONG_MAX) {};
+		: mInitWithName( initWithName ), mIsParameter( isParam ), mIsGlobal( isGlobal ), mRealName( realName ), mVariableType( theType ), mDontDispose(dontDispose), mBPRelativeOffset(LONG_MAX) {};
 	CVariableEntry( const std::string& realName, const std::string& initCode, bool dontDispose = false, bool initDirectly = false )
-		: mInitWithName( false ), mIsParameter( false ), mIsGlobal( false ), mRealName( realName ), mDontDispose(dontDispose), mBPRelativeOffset(LONG_MAX) {};
+		: mInitWithName( false ), mIsParameter( false ), mIsGlobal( false ), mRealName( realName ), mVariableType( TVariantType_INVALID ), mDontDispose(dontDispose), mBPRelativeOffset(LONG_MAX) {};
 	CVariableEntry()
-		: mInitWithName( false ), mIsParameter( false ), mIsGlobal( false ), mDontDispose( false ), mRealName(), mBPRelativeOffset(LONG_MAX) {};
-
-	static const std::string GetNewTempName();
+		: mInitWithName( false ), mIsParameter( false ), mIsGlobal( false ), mDontDispose( false ), mRealName(), mVariableType( TVariantType_INVALID ), mBPRelativeOffset(LONG_MAX) {};
 };
 	
 }
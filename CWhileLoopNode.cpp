@@ -9,6 +9,7 @@
 
 #include "CWhileLoopNode.h"
 #include "CCodeBlock.h"
+#include "CParseTreeArchive.h"
 
 
 namespace Carlson
@@ -39,10 +40,12 @@ void	CWhileLoopNode::GenerateCode( CCodeBlock* inBlock )
 }
 
 
-void	CWhileLoopNode::Simplify()
+CNode*	CWhileLoopNode::Simplify()
 {
-	mCondition->Simplify();
+	mCondition = mCondition->Simplify();
 	CCodeBlockNode::Simplify();
+	
+	return this;
 }
 
 
@@ -57,4 +60,15 @@ void	CWhileLoopNode::DebugPrint( std::ostream& destStream, size_t indentLevel )
 	DebugPrintInner( destStream, indentLevel );
 }
 
+
+void	CWhileLoopNode::WriteToArchive( CParseTreeWriter& ioWriter )
+{
+	ioWriter.WriteNumber( ENodeKindWhileLoop );
+	ioWriter.WriteNodeReference( mOwningBlock );
+	ioWriter.WriteNumber( mLineNum );
+	ioWriter.WriteNode( mCondition );
+	WriteCommandsToArchive( ioWriter );
+}
+
+
 } /*Carlson*/
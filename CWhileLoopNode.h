@@ -17,12 +17,12 @@ class CWhileLoopNode : public CCodeBlockNode
 {
 public:
 	CWhileLoopNode( CParseTree* inTree, size_t inLineNum, CCodeBlockNodeBase* owningBlock ) : CCodeBlockNode( inTree, inLineNum, owningBlock ), mCondition(NULL) {};
-	~CWhileLoopNode() { if( mCondition) delete mCondition; mCondition = NULL; };
 
-	virtual void	SetCondition( CValueNode* inCond )	{ if( mCondition ) delete mCondition; mCondition = inCond; };	// inCond is now owned by the CWhileLoopNode.
+	virtual void	SetCondition( CValueNode* inCond )	{ mCondition = inCond; };
 	
 	virtual void	GenerateCode( CCodeBlock* inBlock );
-	virtual void	Simplify();
+	virtual CNode*	Simplify();
+	virtual void	WriteToArchive( CParseTreeWriter& ioWriter );
 	
 	virtual void	DebugPrint( std::ostream& destStream, size_t indentLevel );
 protected:
@@ -15,37 +15,80 @@ extern "C" {
 #include "CParser.h"
 #include "CParseTree.h"
 #include "CCodeBlock.h"
+#include "CLazyScript.h"
+#include "CCompileBatch.h"
+#include "CBytecodeArchive.h"
+#include "CScriptBundle.h"
+#include "CParseTreeArchive.h"
+#include <strings.h>
 
 using namespace Carlson;
 
 
-char	gLEOLastErrorString[1024] = { 0 };
+extern "C" LEOCompilerContext*	LEOCompilerContextCreate( LEOCompilerContext* inTemplate )
+{
+	try
+	{
+		if( inTemplate )
+			return (LEOCompilerContext*) new CCompilerContext( *(CCompilerContext*)inTemplate );
+		else
+			return (LEOCompilerContext*) new CCompilerContext;
+	}
+	catch( std::exception& err )
+	{
+		printf( "Internal error in LEOCompilerContextCreate: \"%s\".\n", err.what() );
+	}
+	catch( ... )
+	{
+		printf( "Internal error in LEOCompilerContextCreate.\n" );
+	}
+	
+	return NULL;
+}
 
 
-extern "C" LEOParseTree*	LEOParseTreeCreateFromUTF8Characters( const char* inCode, size_t codeLength, const char* filename )
+extern "C" LEOCompilerContext*	LEOGetDefaultCompilerContext()
 {
-	CParseTree	*	parseTree = NULL;
-	gLEOLastErrorString[0] = 0;
+	return (LEOCompilerContext*) &CCompilerContext::GetDefault();
+}
+
+
+extern "C" void		LEOCleanUpCompilerContext( LEOCompilerContext* inContext )
+{
+	if( inContext == LEOGetDefaultCompilerContext() )
+		return;
+	
+	delete (CCompilerContext*)inContext;
+}
+
+
+extern "C" LEOParseTree*	LEOParseTreeCreateFromUTF8CharactersInContext( LEOCompilerContext* inContext, const char* inCode, size_t codeLength, const char* filename )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	CParseTree		*	parseTree = NULL;
+	context.SetLastErrorMessage( "" );
 	
 	try
 	{
 		parseTree = new CParseTree;
-		CParser				parser;
-		std::deque<CToken>	tokens = CToken::TokenListFromText( inCode, codeLength );
-		parser.Parse( filename, tokens, *parseTree );
+		CParser				parser( &context );
+		CTokenizer			tokenizer( inCode, codeLength );
+		CTokenList			tokens( &tokenizer, &parseTree->GetSymbols() );	// Tokenizes while parsing.
+		tokens.TokenizeInParallel();	// Unless it's big, then tokenize it on all cores right now.
+		parser.ParseInParallel( filename, tokens, *parseTree );	// Many handlers get parsed on all cores, too.
 		
 		parseTree->Simplify();
 	}
 	catch( std::exception& err )
 	{
-		strcpy( gLEOLastErrorString, err.what() );
+		context.SetLastErrorMessage( err.what() );
 		if( parseTree )
 			delete parseTree;
 		parseTree = NULL;
 	}
 	catch( ... )
 	{
-		strcpy( gLEOLastErrorString, "Unknown error." );
+		context.SetLastErrorMessage( "Unknown error." );
 		if( parseTree )
 			delete parseTree;
 		parseTree = NULL;
@@ -55,30 +98,46 @@ extern "C" LEOParseTree*	LEOParseTreeCreateFromUTF8Characters( const char* inCod
 }
 
 
-extern "C" LEOParseTree*	LEOParseTreeCreateForCommandOrExpressionFromUTF8Characters( const char* inCode, size_t codeLength, const char* filename )
+extern "C" LEOParseTree*	LEOParseTreeCreateFromUTF8Characters( const char* inCode, size_t codeLength, const char* filename )
 {
-	CParseTree	*	parseTree = NULL;
-	gLEOLastErrorString[0] = 0;
+	return LEOParseTreeCreateFromUTF8CharactersInContext( LEOGetDefaultCompilerContext(), inCode, codeLength, filename );
+}
+
+
+extern "C" LEOParseTree*	LEOParseTreeCreateForCommandOrExpressionFromUTF8CharactersInContext( LEOCompilerContext* inContext, const char* inCode, size_t codeLength, const char* filename )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	CParseTree		*	parseTree = NULL;
+	context.SetLastErrorMessage( "" );
 	
 	try
 	{
 		parseTree = new CParseTree;
-		CParser				parser;
-		std::deque<CToken>	tokens = CToken::TokenListFromText( inCode, codeLength );
+		CParser				parser( &context );
+		CTokenizer			tokenizer( inCode, codeLength );
+		CTokenList			tokens( &tokenizer, &parseTree->GetSymbols() );	// Tokenizes while parsing.
+		parser.SetThrowOnError( false );	// Typos in the message box are common, don't pay for unwinding on each one.
 		parser.ParseCommandOrExpression( filename, tokens, *parseTree );
 
+		if( parser.HadError() )
+		{
+			context.SetLastErrorMessage( parser.GetError().GetMessage().c_str() );
+			delete parseTree;
+			return NULL;
+		}
+
 		parseTree->Simplify();
 	}
 	catch( std::exception& err )
 	{
-		strcpy( gLEOLastErrorString, err.what() );
+		context.SetLastErrorMessage( err.what() );
 		if( parseTree )
 			delete parseTree;
 		parseTree = NULL;
 	}
 	catch( ... )
 	{
-		strcpy( gLEOLastErrorString, "Unknown error." );
+		context.SetLastErrorMessage( "Unknown error." );
 		if( parseTree )
 			delete parseTree;
 		parseTree = NULL;
@@ -88,6 +147,12 @@ extern "C" LEOParseTree*	LEOParseTreeCreateForCommandOrExpressionFromUTF8Charact
 }
 
 
+extern "C" LEOParseTree*	LEOParseTreeCreateForCommandOrExpressionFromUTF8Characters( const char* inCode, size_t codeLength, const char* filename )
+{
+	return LEOParseTreeCreateForCommandOrExpressionFromUTF8CharactersInContext( LEOGetDefaultCompilerContext(), inCode, codeLength, filename );
+}
+
+
 extern "C" void		LEOCleanUpParseTree( LEOParseTree* inTree )
 {
 	try
@@ -105,17 +170,198 @@ extern "C" void		LEOCleanUpParseTree( LEOParseTree* inTree )
 }
 
 
+extern "C" void*	LEOParseTreeCreateArchive( LEOParseTree* inTree, size_t* outLength )
+{
+	CCompilerContext&	context = CCompilerContext::GetDefault();
+	void			*	archive = NULL;
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		std::string		data;
+		CParseTreeWriter::WriteTree( *(CParseTree*)inTree, data );
+		archive = malloc( data.length() );
+		if( !archive )
+			throw std::bad_alloc();
+		memcpy( archive, data.data(), data.length() );
+		*outLength = data.length();
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+	
+	return archive;
+}
+
+
+extern "C" void	LEOParseTreeWriteArchiveFile( LEOParseTree* inTree, const char* archiveFilePath )
+{
+	CCompilerContext&	context = CCompilerContext::GetDefault();
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		CParseTreeWriter::WriteTreeToFile( *(CParseTree*)inTree, archiveFilePath );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+}
+
+
+static CParseTree*	CreateParseTreeFromArchive( CParseTreeReader& inReader, const char* handlerName )
+{
+	CParseTree	*	parseTree = new CParseTree;
+	try
+	{
+		if( !handlerName )
+			inReader.ReadTree( *parseTree );
+		else
+		{
+			for( size_t x = 0; x < inReader.GetNumHandlers(); x++ )
+			{
+				if( strcasecmp( inReader.GetHandlerName(x).c_str(), handlerName ) == 0 )
+					inReader.ReadHandler( x, *parseTree );
+			}
+			if( parseTree->GetNodeCount() == 0 )
+				throw std::runtime_error( std::string("No handler named \"") +handlerName +"\" in parse tree archive." );
+		}
+	}
+	catch( ... )
+	{
+		delete parseTree;
+		throw;
+	}
+	
+	return parseTree;
+}
+
+
+extern "C" LEOParseTree*	LEOParseTreeCreateFromArchive( const void* archive, size_t archiveLength, const char* handlerName )
+{
+	CCompilerContext&	context = CCompilerContext::GetDefault();
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		CParseTreeReader	reader( (const char*) archive, archiveLength );
+		return (LEOParseTree*) CreateParseTreeFromArchive( reader, handlerName );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+	
+	return NULL;
+}
+
+
+extern "C" LEOParseTree*	LEOParseTreeCreateFromArchiveFile( const char* archiveFilePath, const char* handlerName )
+{
+	CCompilerContext&	context = CCompilerContext::GetDefault();
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		CParseTreeReader	reader( archiveFilePath );
+		return (LEOParseTree*) CreateParseTreeFromArchive( reader, handlerName );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+	
+	return NULL;
+}
+
+
+extern "C" LEOScript*	LEOScriptCreateForCommandOrExpressionFromUTF8CharactersInContext( LEOCompilerContext* inContext, const char* inCode, size_t codeLength, const char* filename, LEOContextGroup* inGroup, LEOObjectID ownerObject, LEOObjectSeed ownerSeed )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	LEOScript		*	script = NULL;
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		script = context.GetSnippetCache().CompileCommandOrExpression( context, inCode, codeLength, filename, inGroup, ownerObject, ownerSeed );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+	
+	return script;
+}
+
+
+extern "C" LEOScript*	LEOScriptCreateForCommandOrExpressionFromUTF8Characters( const char* inCode, size_t codeLength, const char* filename, LEOContextGroup* inGroup, LEOObjectID ownerObject, LEOObjectSeed ownerSeed )
+{
+	return LEOScriptCreateForCommandOrExpressionFromUTF8CharactersInContext( LEOGetDefaultCompilerContext(), inCode, codeLength, filename, inGroup, ownerObject, ownerSeed );
+}
+
+
+extern "C" void	LEOSetSnippetCacheLimitsInContext( LEOCompilerContext* inContext, size_t maxEntries, size_t maxBytes )
+{
+	((CCompilerContext*)inContext)->GetSnippetCache().SetLimits( maxEntries, maxBytes );
+}
+
+
+extern "C" void	LEOGetSnippetCacheStatisticsInContext( LEOCompilerContext* inContext, LEOSnippetCacheStatistics* outStatistics )
+{
+	CSnippetCache&	cache = ((CCompilerContext*)inContext)->GetSnippetCache();
+	
+	outStatistics->hits = cache.GetNumHits();
+	outStatistics->misses = cache.GetNumMisses();
+	outStatistics->evictions = cache.GetNumEvictions();
+	outStatistics->numEntries = cache.GetNumEntries();
+	outStatistics->numBytes = cache.GetNumBytes();
+}
+
+
+extern "C" void	LEOFlushSnippetCacheInContext( LEOCompilerContext* inContext )
+{
+	((CCompilerContext*)inContext)->GetSnippetCache().Flush();
+}
+
+
+extern "C" const char*	LEOParserGetLastErrorMessageInContext( LEOCompilerContext* inContext )
+{
+	return ((CCompilerContext*)inContext)->GetLastErrorMessage();
+}
+
+
 extern "C" const char*	LEOParserGetLastErrorMessage()
 {
-	if( gLEOLastErrorString[0] == 0 )
-		return NULL;
-	return gLEOLastErrorString;
+	return CCompilerContext::GetDefault().GetLastErrorMessage();
 }
 
 
-extern "C" void		LEOScriptCompileAndAddParseTree( LEOScript* inScript, LEOContextGroup* inGroup, LEOParseTree* inTree )
+extern "C" void		LEOScriptCompileAndAddParseTreeInContext( LEOCompilerContext* inContext, LEOScript* inScript, LEOContextGroup* inGroup, LEOParseTree* inTree )
 {
-	gLEOLastErrorString[0] = 0;
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
 	
 	try
 	{
@@ -125,70 +371,615 @@ extern "C" void		LEOScriptCompileAndAddParseTree( LEOScript* inScript, LEOContex
 	}
 	catch( std::exception& err )
 	{
-		strcpy( gLEOLastErrorString, err.what() );
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+}
+
+
+extern "C" void		LEOScriptCompileAndAddParseTree( LEOScript* inScript, LEOContextGroup* inGroup, LEOParseTree* inTree )
+{
+	LEOScriptCompileAndAddParseTreeInContext( LEOGetDefaultCompilerContext(), inScript, inGroup, inTree );
+}
+
+
+extern "C" void		LEOScriptCompileAndAddUTF8CharactersInContext( LEOCompilerContext* inContext, LEOScript* inScript, LEOContextGroup* inGroup, const char* inCode, size_t codeLength, const char* filename )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		context.GetCompileCache().CompileAndAddScript( context, inScript, inGroup, inCode, codeLength, filename );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+}
+
+
+extern "C" void		LEOScriptCompileAndAddUTF8Characters( LEOScript* inScript, LEOContextGroup* inGroup, const char* inCode, size_t codeLength, const char* filename )
+{
+	LEOScriptCompileAndAddUTF8CharactersInContext( LEOGetDefaultCompilerContext(), inScript, inGroup, inCode, codeLength, filename );
+}
+
+
+extern "C" void*	LEOScriptCreateBytecodeInContext( LEOCompilerContext* inContext, LEOScript* inScript, LEOContextGroup* inGroup, const char* filename, size_t* outLength )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	void			*	bytecode = NULL;
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		std::string		data;
+		CBytecodeArchive::AppendScript( inScript, inGroup, filename, data );
+		bytecode = malloc( data.length() );
+		if( !bytecode )
+			throw std::bad_alloc();
+		memcpy( bytecode, data.data(), data.length() );
+		*outLength = data.length();
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+	
+	return bytecode;
+}
+
+
+extern "C" void*	LEOScriptCreateBytecode( LEOScript* inScript, LEOContextGroup* inGroup, const char* filename, size_t* outLength )
+{
+	return LEOScriptCreateBytecodeInContext( LEOGetDefaultCompilerContext(), inScript, inGroup, filename, outLength );
+}
+
+
+extern "C" void	LEOScriptWriteBytecodeFileInContext( LEOCompilerContext* inContext, LEOScript* inScript, LEOContextGroup* inGroup, const char* filename, const char* bytecodeFilePath )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		CBytecodeArchive::WriteScriptToFile( inScript, inGroup, filename, bytecodeFilePath );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+}
+
+
+extern "C" void	LEOScriptWriteBytecodeFile( LEOScript* inScript, LEOContextGroup* inGroup, const char* filename, const char* bytecodeFilePath )
+{
+	LEOScriptWriteBytecodeFileInContext( LEOGetDefaultCompilerContext(), inScript, inGroup, filename, bytecodeFilePath );
+}
+
+
+extern "C" void	LEOScriptAddHandlersFromBytecodeInContext( LEOCompilerContext* inContext, LEOScript* inScript, LEOContextGroup* inGroup, const void* bytecode, size_t bytecodeLength )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		CBytecodeArchive::AddHandlersFromData( (const char*) bytecode, bytecodeLength, inScript, inGroup );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+}
+
+
+extern "C" void	LEOScriptAddHandlersFromBytecode( LEOScript* inScript, LEOContextGroup* inGroup, const void* bytecode, size_t bytecodeLength )
+{
+	LEOScriptAddHandlersFromBytecodeInContext( LEOGetDefaultCompilerContext(), inScript, inGroup, bytecode, bytecodeLength );
+}
+
+
+extern "C" void	LEOScriptAddHandlersFromBytecodeFileInContext( LEOCompilerContext* inContext, LEOScript* inScript, LEOContextGroup* inGroup, const char* bytecodeFilePath )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		CBytecodeArchive::AddHandlersFromFile( bytecodeFilePath, inScript, inGroup );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+}
+
+
+extern "C" void	LEOScriptAddHandlersFromBytecodeFile( LEOScript* inScript, LEOContextGroup* inGroup, const char* bytecodeFilePath )
+{
+	LEOScriptAddHandlersFromBytecodeFileInContext( LEOGetDefaultCompilerContext(), inScript, inGroup, bytecodeFilePath );
+}
+
+
+extern "C" void	LEOSetCompileCacheDirectoryInContext( LEOCompilerContext* inContext, const char* directoryPath, size_t maxBytes )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		context.GetCompileCache().SetDirectory( directoryPath ? directoryPath : "", (maxBytes == 0) ? COMPILE_CACHE_DEFAULT_MAX_BYTES : maxBytes );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+}
+
+
+extern "C" void	LEOGetCompileCacheStatisticsInContext( LEOCompilerContext* inContext, LEOCompileCacheStatistics* outStatistics )
+{
+	CCompileCache&	cache = ((CCompilerContext*)inContext)->GetCompileCache();
+	
+	outStatistics->hits = cache.GetNumHits();
+	outStatistics->misses = cache.GetNumMisses();
+	outStatistics->evictions = cache.GetNumEvictions();
+}
+
+
+extern "C" void		LEOScriptAddHandlersLazilyFromUTF8Characters( LEOScript* inScript, LEOContextGroup* inGroup, const char* inCode, size_t codeLength, const char* filename )
+{
+	LEOScriptAddHandlersLazilyFromUTF8CharactersInContext( LEOGetDefaultCompilerContext(), inScript, inGroup, inCode, codeLength, filename );
+}
+
+
+extern "C" void		LEOScriptAddHandlersLazilyFromUTF8CharactersInContext( LEOCompilerContext* inContext, LEOScript* inScript, LEOContextGroup* inGroup, const char* inCode, size_t codeLength, const char* filename )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		CLazyScript::AddHandlers( context, inGroup, inScript, inCode, codeLength, filename );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+}
+
+
+extern "C" void		LEOScriptForgetLazyHandlers( LEOScript* inScript )
+{
+	try
+	{
+		CLazyScript::ForgetHandlers( inScript );
+	}
+	catch( std::exception& err )
+	{
+		printf( "Internal error in LEOScriptForgetLazyHandlers: \"%s\".\n", err.what() );
+	}
+	catch( ... )
+	{
+		printf( "Internal error in LEOScriptForgetLazyHandlers.\n" );
+	}
+}
+
+
+extern "C" void	LEOWriteScriptBundle( const char* bundleFilePath, LEOScript** scripts, const char** filenames, size_t numScripts, LEOContextGroup* inGroup )
+{
+	CCompilerContext&	context = CCompilerContext::GetDefault();
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		CScriptBundle::WriteBundle( bundleFilePath, scripts, filenames, numScripts, inGroup );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+}
+
+
+extern "C" LEOScriptBundle*	LEOScriptBundleOpen( const char* bundleFilePath )
+{
+	CCompilerContext&	context = CCompilerContext::GetDefault();
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		return (LEOScriptBundle*) new CScriptBundle( bundleFilePath );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+	
+	return NULL;
+}
+
+
+extern "C" void	LEOScriptBundleClose( LEOScriptBundle* inBundle )
+{
+	delete (CScriptBundle*)inBundle;
+}
+
+
+extern "C" size_t	LEOScriptBundleGetNumScripts( LEOScriptBundle* inBundle )
+{
+	return ((CScriptBundle*)inBundle)->GetNumScripts();
+}
+
+
+extern "C" const char*	LEOScriptBundleGetScriptFileName( LEOScriptBundle* inBundle, size_t scriptIndex )
+{
+	CCompilerContext&	context = CCompilerContext::GetDefault();
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		return ((CScriptBundle*)inBundle)->GetScriptFileName( scriptIndex );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+	
+	return NULL;
+}
+
+
+extern "C" LEOScript*	LEOScriptBundleCreateScript( LEOScriptBundle* inBundle, size_t scriptIndex, LEOContextGroup* inGroup, LEOObjectID ownerObject, LEOObjectSeed ownerSeed )
+{
+	CCompilerContext&	context = CCompilerContext::GetDefault();
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		return ((CScriptBundle*)inBundle)->CreateScript( scriptIndex, inGroup, ownerObject, ownerSeed );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+	
+	return NULL;
+}
+
+
+extern "C" void	LEOScriptBundleForgetScript( LEOScriptBundle* inBundle, LEOScript* inScript )
+{
+	((CScriptBundle*)inBundle)->ForgetScript( inScript );
+}
+
+
+extern "C" void	LEOAddGlobalPropertiesAndOffsetInstructionsInContext( LEOCompilerContext* inContext, struct TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		context.AddGlobalPropertiesAndOffsetInstructions( inEntries, firstGlobalPropertyInstruction );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
 	}
 	catch( ... )
 	{
-		strcpy( gLEOLastErrorString, "Unknown error." );
+		context.SetLastErrorMessage( "Unknown error." );
 	}
 }
 
 
 extern "C" void	LEOAddGlobalPropertiesAndOffsetInstructions( struct TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction )
 {
-	gLEOLastErrorString[0] = 0;
+	LEOAddGlobalPropertiesAndOffsetInstructionsInContext( LEOGetDefaultCompilerContext(), inEntries, firstGlobalPropertyInstruction );
+}
+
+
+extern "C" void	LEOReplaceGlobalPropertiesAndOffsetInstructionsInContext( LEOCompilerContext* inContext, struct TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		context.ReplaceGlobalPropertiesAndOffsetInstructions( inEntries, firstGlobalPropertyInstruction );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+}
+
+
+extern "C" void	LEOReplaceGlobalPropertiesAndOffsetInstructions( struct TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction )
+{
+	LEOReplaceGlobalPropertiesAndOffsetInstructionsInContext( LEOGetDefaultCompilerContext(), inEntries, firstGlobalPropertyInstruction );
+}
+
+
+extern "C" void	LEORemoveGlobalPropertyInContext( LEOCompilerContext* inContext, TIdentifierSubtype inType )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		context.RemoveGlobalProperty( inType );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+}
+
+
+extern "C" void	LEORemoveGlobalProperty( TIdentifierSubtype inType )
+{
+	LEORemoveGlobalPropertyInContext( LEOGetDefaultCompilerContext(), inType );
+}
+
+
+extern "C" void	LEOAddHostCommandsAndOffsetInstructionsInContext( LEOCompilerContext* inContext, struct THostCommandEntry* inEntries, size_t firstHostCommandInstruction )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
 	
 	try
 	{
-		CParser::AddGlobalPropertiesAndOffsetInstructions( inEntries, firstGlobalPropertyInstruction );
+		context.AddHostCommandsAndOffsetInstructions( inEntries, firstHostCommandInstruction );
 	}
 	catch( std::exception& err )
 	{
-		strcpy( gLEOLastErrorString, err.what() );
+		context.SetLastErrorMessage( err.what() );
 	}
 	catch( ... )
 	{
-		strcpy( gLEOLastErrorString, "Unknown error." );
+		context.SetLastErrorMessage( "Unknown error." );
 	}
 }
 
 
 extern "C" void	LEOAddHostCommandsAndOffsetInstructions( struct THostCommandEntry* inEntries, size_t firstHostCommandInstruction )
 {
-	gLEOLastErrorString[0] = 0;
+	LEOAddHostCommandsAndOffsetInstructionsInContext( LEOGetDefaultCompilerContext(), inEntries, firstHostCommandInstruction );
+}
+
+
+extern "C" void	LEOReplaceHostCommandsAndOffsetInstructionsInContext( LEOCompilerContext* inContext, struct THostCommandEntry* inEntries, size_t firstHostCommandInstruction )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		context.ReplaceHostCommandsAndOffsetInstructions( inEntries, firstHostCommandInstruction );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+}
+
+
+extern "C" void	LEOReplaceHostCommandsAndOffsetInstructions( struct THostCommandEntry* inEntries, size_t firstHostCommandInstruction )
+{
+	LEOReplaceHostCommandsAndOffsetInstructionsInContext( LEOGetDefaultCompilerContext(), inEntries, firstHostCommandInstruction );
+}
+
+
+extern "C" void	LEORemoveHostCommandInContext( LEOCompilerContext* inContext, TIdentifierSubtype inType )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
 	
 	try
 	{
-		CParser::AddHostCommandsAndOffsetInstructions( inEntries, firstHostCommandInstruction );
+		context.RemoveHostCommand( inType );
 	}
 	catch( std::exception& err )
 	{
-		strcpy( gLEOLastErrorString, err.what() );
+		context.SetLastErrorMessage( err.what() );
 	}
 	catch( ... )
 	{
-		strcpy( gLEOLastErrorString, "Unknown error." );
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+}
+
+
+extern "C" void	LEORemoveHostCommand( TIdentifierSubtype inType )
+{
+	LEORemoveHostCommandInContext( LEOGetDefaultCompilerContext(), inType );
+}
+
+
+extern "C" void	LEOAddHostFunctionsAndOffsetInstructionsInContext( LEOCompilerContext* inContext, struct THostCommandEntry* inEntries, size_t firstHostFunctionInstruction )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		context.AddHostFunctionsAndOffsetInstructions( inEntries, firstHostFunctionInstruction );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
 	}
 }
 
 
 extern "C" void	LEOAddHostFunctionsAndOffsetInstructions( struct THostCommandEntry* inEntries, size_t firstHostFunctionInstruction )
 {
-	gLEOLastErrorString[0] = 0;
+	LEOAddHostFunctionsAndOffsetInstructionsInContext( LEOGetDefaultCompilerContext(), inEntries, firstHostFunctionInstruction );
+}
+
+
+extern "C" void	LEOReplaceHostFunctionsAndOffsetInstructionsInContext( LEOCompilerContext* inContext, struct THostCommandEntry* inEntries, size_t firstHostFunctionInstruction )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
+	
+	try
+	{
+		context.ReplaceHostFunctionsAndOffsetInstructions( inEntries, firstHostFunctionInstruction );
+	}
+	catch( std::exception& err )
+	{
+		context.SetLastErrorMessage( err.what() );
+	}
+	catch( ... )
+	{
+		context.SetLastErrorMessage( "Unknown error." );
+	}
+}
+
+
+extern "C" void	LEOReplaceHostFunctionsAndOffsetInstructions( struct THostCommandEntry* inEntries, size_t firstHostFunctionInstruction )
+{
+	LEOReplaceHostFunctionsAndOffsetInstructionsInContext( LEOGetDefaultCompilerContext(), inEntries, firstHostFunctionInstruction );
+}
+
+
+extern "C" void	LEORemoveHostFunctionInContext( LEOCompilerContext* inContext, TIdentifierSubtype inType )
+{
+	CCompilerContext&	context = *(CCompilerContext*)inContext;
+	context.SetLastErrorMessage( "" );
 	
 	try
 	{
-		CParser::AddHostFunctionsAndOffsetInstructions( inEntries, firstHostFunctionInstruction );
+		context.RemoveHostFunction( inType );
 	}
 	catch( std::exception& err )
 	{
-		strcpy( gLEOLastErrorString, err.what() );
+		context.SetLastErrorMessage( err.what() );
 	}
 	catch( ... )
 	{
-		strcpy( gLEOLastErrorString, "Unknown error." );
+		context.SetLastErrorMessage( "Unknown error." );
 	}
 }
 
 
+extern "C" void	LEORemoveHostFunction( TIdentifierSubtype inType )
+{
+	LEORemoveHostFunctionInContext( LEOGetDefaultCompilerContext(), inType );
+}
+
+
+extern "C" size_t	LEOCompileScriptsBatch( LEOCompileBatchItem* ioItems, size_t numItems, LEOContextGroup* inGroup, LEOCompilerContext* inContext, size_t maxThreads )
+{
+	size_t		numFailed = 0;
+	
+	try
+	{
+		std::vector<CCompileBatchItem>	items;
+		items.reserve( numItems );
+		for( size_t x = 0; x < numItems; x++ )
+			items.push_back( CCompileBatchItem( ioItems[x].code, ioItems[x].codeLength, ioItems[x].filename, ioItems[x].script ) );
+		
+		CCompileBatch::Compile( items, inGroup, (CCompilerContext*)inContext, maxThreads );
+		
+		for( size_t x = 0; x < numItems; x++ )
+		{
+			ioItems[x].succeeded = items[x].mSucceeded;
+			strncpy( ioItems[x].errorMessage, items[x].mErrorMessage.c_str(), sizeof(ioItems[x].errorMessage) -1 );
+			ioItems[x].errorMessage[sizeof(ioItems[x].errorMessage) -1] = 0;
+			if( !items[x].mSucceeded )
+				numFailed++;
+		}
+	}
+	catch( std::exception& err )
+	{
+		for( size_t x = 0; x < numItems; x++ )
+		{
+			ioItems[x].succeeded = false;
+			strncpy( ioItems[x].errorMessage, err.what(), sizeof(ioItems[x].errorMessage) -1 );
+			ioItems[x].errorMessage[sizeof(ioItems[x].errorMessage) -1] = 0;
+		}
+		numFailed = numItems;
+	}
+	catch( ... )
+	{
+		for( size_t x = 0; x < numItems; x++ )
+		{
+			ioItems[x].succeeded = false;
+			strcpy( ioItems[x].errorMessage, "Unknown error." );
+		}
+		numFailed = numItems;
+	}
+	
+	return numFailed;
+}
+
+
 
@@ -26,12 +26,49 @@
 #include "LEOMsgInstructions.h"
 #include "LEOPropertyInstructions.h"
 
+// Forge headers for registering host commands, functions and properties:
+#include "ForgeTypes.h"
+
+// Forge's own instructions, add them to the instruction array to compile lazily:
+#include "ForgeInstructions.h"
+
 
 // -----------------------------------------------------------------------------
 //	Data types:
 // -----------------------------------------------------------------------------
 
 typedef struct LEOParseTree	LEOParseTree;	// Private internal data structure representing a parse tree.
+typedef struct LEOCompilerContext	LEOCompilerContext;	// Private internal data structure holding host commands, functions, global properties and the last error message.
+typedef struct LEOScriptBundle	LEOScriptBundle;	// Private internal data structure representing a mapped file of many compiled scripts.
+
+// One script to compile with LEOCompileScriptsBatch:
+typedef struct LEOCompileBatchItem
+{
+	const char*		code;				// UTF8 script text.
+	size_t			codeLength;
+	const char*		filename;
+	LEOScript*		script;				// Handlers get added to this.
+	bool			succeeded;			// Output: FALSE if there was an error.
+	char			errorMessage[1024];	// Output: What went wrong, if succeeded is FALSE.
+} LEOCompileBatchItem;
+
+// Counters of a compiler context's cache of compiled commands and expressions:
+typedef struct LEOSnippetCacheStatistics
+{
+	size_t		hits;
+	size_t		misses;
+	size_t		evictions;	// Entries dropped to stay within the limits.
+	size_t		numEntries;
+	size_t		numBytes;	// Source text and instructions of all entries.
+} LEOSnippetCacheStatistics;
+
+// Counters of a compiler context's cache of compiled scripts on disk:
+typedef struct LEOCompileCacheStatistics
+{
+	size_t		hits;
+	size_t		misses;
+	size_t		evictions;	// Files deleted to stay within the size limit.
+} LEOCompileCacheStatistics;
 
 
 
@@ -44,11 +81,91 @@ LEOParseTree*	LEOParseTreeCreateForCommandOrExpressionFromUTF8Characters( const
 
 void			LEOCleanUpParseTree( LEOParseTree* inTree );
 
+void*			LEOParseTreeCreateArchive( LEOParseTree* inTree, size_t* outLength );	// Flattens inTree into a buffer you must free(), or returns NULL on errors. Much quicker to load than parsing the script again.
+void			LEOParseTreeWriteArchiveFile( LEOParseTree* inTree, const char* archiveFilePath );	// Like LEOParseTreeCreateArchive, but writes to a file.
+LEOParseTree*	LEOParseTreeCreateFromArchive( const void* archive, size_t archiveLength, const char* handlerName );	// Recreates a tree from data made by LEOParseTreeCreateArchive. Pass a handlerName to only read the handlers of that name, NULL for the whole tree. Returns NULL on errors.
+LEOParseTree*	LEOParseTreeCreateFromArchiveFile( const char* archiveFilePath, const char* handlerName );	// Like LEOParseTreeCreateFromArchive, but maps the file into memory.
+
+LEOScript*		LEOScriptCreateForCommandOrExpressionFromUTF8Characters( const char* inCode, size_t codeLength, const char* filename, LEOContextGroup* inGroup, LEOObjectID ownerObject, LEOObjectSeed ownerSeed );	// Returns a new script with a ":run" handler compiled from inCode, or NULL on errors. Release it when you're done. Compiling the same text for the same group and owner again just hands out the same script again.
+
 void			LEOScriptCompileAndAddParseTree( LEOScript* inScript, LEOContextGroup* inGroup, LEOParseTree* inTree );
+void			LEOScriptCompileAndAddUTF8Characters( LEOScript* inScript, LEOContextGroup* inGroup, const char* inCode, size_t codeLength, const char* filename );	// Parses inCode and adds its handlers to inScript in one go. If you turned on the compile cache, unchanged scripts are loaded from there instead.
 
-const char*		LEOParserGetLastErrorMessage();	// Call this after LEOParseTreeCreateFromUTF8Characters or LEOScriptCompileAndAddParseTree to detect errors. If it returns NULL, everything was fine.
+void*			LEOScriptCreateBytecode( LEOScript* inScript, LEOContextGroup* inGroup, const char* filename, size_t* outLength );	// Flattens the handlers of inScript into a buffer you must free(), or returns NULL on errors. filename is the source file, it's just kept for tools.
+void			LEOScriptWriteBytecodeFile( LEOScript* inScript, LEOContextGroup* inGroup, const char* filename, const char* bytecodeFilePath );	// Like LEOScriptCreateBytecode, but writes to a file.
+void			LEOScriptAddHandlersFromBytecode( LEOScript* inScript, LEOContextGroup* inGroup, const void* bytecode, size_t bytecodeLength );	// Adds the handlers from data made by LEOScriptCreateBytecode to inScript, without tokenizing or parsing anything. Works across hosts and CPUs, as long as the host registered all instructions the script uses.
+void			LEOScriptAddHandlersFromBytecodeFile( LEOScript* inScript, LEOContextGroup* inGroup, const char* bytecodeFilePath );	// Like LEOScriptAddHandlersFromBytecode, but maps the file into memory.
+
+void			LEOScriptAddHandlersLazilyFromUTF8Characters( LEOScript* inScript, LEOContextGroup* inGroup, const char* inCode, size_t codeLength, const char* filename );	// Only finds the handlers in inCode and adds a stub for each to inScript, which parses and compiles the handler when it is first called. Syntax errors in a handler are reported when it is called. Needs gForgeInstructions.
+void			LEOScriptForgetLazyHandlers( LEOScript* inScript );	// Call this before you release a script you added handlers to lazily.
+
+void				LEOWriteScriptBundle( const char* bundleFilePath, LEOScript** scripts, const char** filenames, size_t numScripts, LEOContextGroup* inGroup );	// Writes the handlers of all scripts into one file that many processes can map. All scripts must have been compiled into inGroup. filenames may be NULL.
+LEOScriptBundle*	LEOScriptBundleOpen( const char* bundleFilePath );	// Maps a file written by LEOWriteScriptBundle or "forge --bundle". Returns NULL on errors.
+void				LEOScriptBundleClose( LEOScriptBundle* inBundle );	// Call LEOScriptBundleForgetScript for all scripts you created from the bundle first.
+size_t				LEOScriptBundleGetNumScripts( LEOScriptBundle* inBundle );
+const char*			LEOScriptBundleGetScriptFileName( LEOScriptBundle* inBundle, size_t scriptIndex );	// Name of the file the script was compiled from. Valid until you close the bundle.
+LEOScript*			LEOScriptBundleCreateScript( LEOScriptBundle* inBundle, size_t scriptIndex, LEOContextGroup* inGroup, LEOObjectID ownerObject, LEOObjectSeed ownerSeed );	// Returns a new script whose handlers use the instructions in the mapped file where they can, or NULL on errors. Open bundles before you compile anything else into inGroup, so it can give all handlers the IDs they were written with.
+void				LEOScriptBundleForgetScript( LEOScriptBundle* inBundle, LEOScript* inScript );	// Call this before you release a script created from a bundle.
+
+const char*		LEOParserGetLastErrorMessage();	// Call this after LEOParseTreeCreateFromUTF8Characters or LEOScriptCompileAndAddParseTree or LEOScriptCompileAndAddUTF8Characters or LEOScriptAddHandlersLazilyFromUTF8Characters or the bytecode, bundle or parse tree archive calls to detect errors. If it returns NULL, everything was fine.
 
 void	LEOAddGlobalPropertiesAndOffsetInstructions( struct TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction );
+void	LEOReplaceGlobalPropertiesAndOffsetInstructions( struct TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction );	// Like LEOAddGlobalProperties..., but first removes existing properties with the same identifiers.
+void	LEORemoveGlobalProperty( TIdentifierSubtype inType );
 
 void	LEOAddHostCommandsAndOffsetInstructions( struct THostCommandEntry* inEntries, size_t firstHostCommandInstruction );
+void	LEOReplaceHostCommandsAndOffsetInstructions( struct THostCommandEntry* inEntries, size_t firstHostCommandInstruction );	// Like LEOAddHostCommands..., but first removes existing commands with the same identifiers.
+void	LEORemoveHostCommand( TIdentifierSubtype inType );
 void	LEOAddHostFunctionsAndOffsetInstructions( struct THostCommandEntry* inEntries, size_t firstHostCommandInstruction );
+void	LEOReplaceHostFunctionsAndOffsetInstructions( struct THostCommandEntry* inEntries, size_t firstHostCommandInstruction );	// Like LEOAddHostFunctions..., but first removes existing functions with the same identifiers.
+void	LEORemoveHostFunction( TIdentifierSubtype inType );
+
+
+// -----------------------------------------------------------------------------
+//	Reentrant Forge methods:
+// -----------------------------------------------------------------------------
+
+// The calls above all use one default compiler context, so only one thread
+//	can compile at a time. To compile on several threads at once, give each
+//	thread its own context and use these variants. A context may only be used
+//	by one thread at a time.
+
+LEOCompilerContext*	LEOCompilerContextCreate( LEOCompilerContext* inTemplate );	// Pass NULL to get only the built-in global properties, or another context to start out with its host commands, functions and properties.
+LEOCompilerContext*	LEOGetDefaultCompilerContext();	// The one the calls above use.
+void				LEOCleanUpCompilerContext( LEOCompilerContext* inContext );	// Does nothing for the default context.
+
+LEOParseTree*	LEOParseTreeCreateFromUTF8CharactersInContext( LEOCompilerContext* inContext, const char* inCode, size_t codeLength, const char* filename );
+LEOParseTree*	LEOParseTreeCreateForCommandOrExpressionFromUTF8CharactersInContext( LEOCompilerContext* inContext, const char* inCode, size_t codeLength, const char* filename );
+
+LEOScript*		LEOScriptCreateForCommandOrExpressionFromUTF8CharactersInContext( LEOCompilerContext* inContext, const char* inCode, size_t codeLength, const char* filename, LEOContextGroup* inGroup, LEOObjectID ownerObject, LEOObjectSeed ownerSeed );
+void			LEOSetSnippetCacheLimitsInContext( LEOCompilerContext* inContext, size_t maxEntries, size_t maxBytes );	// Defaults are 256 scripts and 1MB. 0 entries turns off the cache.
+void			LEOGetSnippetCacheStatisticsInContext( LEOCompilerContext* inContext, LEOSnippetCacheStatistics* outStatistics );
+void			LEOFlushSnippetCacheInContext( LEOCompilerContext* inContext );	// Releases all cached scripts. The cache also flushes itself when host entries change.
+
+void			LEOScriptCompileAndAddParseTreeInContext( LEOCompilerContext* inContext, LEOScript* inScript, LEOContextGroup* inGroup, LEOParseTree* inTree );
+void			LEOScriptCompileAndAddUTF8CharactersInContext( LEOCompilerContext* inContext, LEOScript* inScript, LEOContextGroup* inGroup, const char* inCode, size_t codeLength, const char* filename );
+
+void*			LEOScriptCreateBytecodeInContext( LEOCompilerContext* inContext, LEOScript* inScript, LEOContextGroup* inGroup, const char* filename, size_t* outLength );
+void			LEOScriptWriteBytecodeFileInContext( LEOCompilerContext* inContext, LEOScript* inScript, LEOContextGroup* inGroup, const char* filename, const char* bytecodeFilePath );
+void			LEOScriptAddHandlersFromBytecodeInContext( LEOCompilerContext* inContext, LEOScript* inScript, LEOContextGroup* inGroup, const void* bytecode, size_t bytecodeLength );
+void			LEOScriptAddHandlersFromBytecodeFileInContext( LEOCompilerContext* inContext, LEOScript* inScript, LEOContextGroup* inGroup, const char* bytecodeFilePath );
+
+void			LEOScriptAddHandlersLazilyFromUTF8CharactersInContext( LEOCompilerContext* inContext, LEOScript* inScript, LEOContextGroup* inGroup, const char* inCode, size_t codeLength, const char* filename );	// inContext must stay around until you call LEOScriptForgetLazyHandlers().
+
+void			LEOSetCompileCacheDirectoryInContext( LEOCompilerContext* inContext, const char* directoryPath, size_t maxBytes );	// Turns on keeping scripts compiled by LEOScriptCompileAndAddUTF8Characters... in this folder, which is created if needed. Pass NULL to turn it off again, 0 maxBytes for the default of 64MB. Several processes may share a folder, as long as they register the same host instructions in the same order.
+void			LEOGetCompileCacheStatisticsInContext( LEOCompilerContext* inContext, LEOCompileCacheStatistics* outStatistics );
+
+const char*		LEOParserGetLastErrorMessageInContext( LEOCompilerContext* inContext );	// Like LEOParserGetLastErrorMessage, for the ...InContext calls.
+
+void	LEOAddGlobalPropertiesAndOffsetInstructionsInContext( LEOCompilerContext* inContext, struct TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction );
+void	LEOReplaceGlobalPropertiesAndOffsetInstructionsInContext( LEOCompilerContext* inContext, struct TGlobalPropertyEntry* inEntries, size_t firstGlobalPropertyInstruction );
+void	LEORemoveGlobalPropertyInContext( LEOCompilerContext* inContext, TIdentifierSubtype inType );
+
+void	LEOAddHostCommandsAndOffsetInstructionsInContext( LEOCompilerContext* inContext, struct THostCommandEntry* inEntries, size_t firstHostCommandInstruction );
+void	LEOReplaceHostCommandsAndOffsetInstructionsInContext( LEOCompilerContext* inContext, struct THostCommandEntry* inEntries, size_t firstHostCommandInstruction );
+void	LEORemoveHostCommandInContext( LEOCompilerContext* inContext, TIdentifierSubtype inType );
+void	LEOAddHostFunctionsAndOffsetInstructionsInContext( LEOCompilerContext* inContext, struct THostCommandEntry* inEntries, size_t firstHostCommandInstruction );
+void	LEOReplaceHostFunctionsAndOffsetInstructionsInContext( LEOCompilerContext* inContext, struct THostCommandEntry* inEntries, size_t firstHostCommandInstruction );
+void	LEORemoveHostFunctionInContext( LEOCompilerContext* inContext, TIdentifierSubtype inType );
+
+size_t	LEOCompileScriptsBatch( LEOCompileBatchItem* ioItems, size_t numItems, LEOContextGroup* inGroup, LEOCompilerContext* inContext, size_t maxThreads );	// Compiles all items into inGroup on up to maxThreads threads (0 for one per CPU). inContext may be NULL for the default one, and is only read. Items for the same script are compiled in order. Returns the number of items that failed.
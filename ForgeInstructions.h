@@ -0,0 +1,38 @@
+/*
+ *  ForgeInstructions.h
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+#ifndef FORGE_INSTRUCTIONS_H
+#define FORGE_INSTRUCTIONS_H		1
+
+#include "LEOInterpreter.h"
+
+
+// Instructions Forge itself needs at runtime. Hosts that compile handlers
+//	lazily must add them to the interpreter first, using:
+//	LEOAddInstructionsToInstructionArray( gForgeInstructions, gForgeInstructionNames, LEO_NUMBER_OF_FORGE_INSTRUCTIONS, &kFirstForgeInstruction );
+enum
+{
+	COMPILE_HANDLER_LAZILY_INSTR = 0,	// Only instruction of a lazy stub handler. param2 is the stub's number (see CLazyScript).
+	LEO_NUMBER_OF_FORGE_INSTRUCTIONS
+};
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern LEOInstructionFuncPtr	gForgeInstructions[LEO_NUMBER_OF_FORGE_INSTRUCTIONS];
+extern const char*				gForgeInstructionNames[LEO_NUMBER_OF_FORGE_INSTRUCTIONS];
+extern size_t					kFirstForgeInstruction;	// Set by LEOAddInstructionsToInstructionArray().
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*FORGE_INSTRUCTIONS_H*/
@@ -0,0 +1,124 @@
+/*
+ *  TokenListEditFuzzer.cpp
+ *  Forge
+ *
+ *  Created by Uli Kusterer on 16.10.26.
+ *  Copyright 2026 M. Uli Kusterer. All rights reserved.
+ *
+ */
+
+// Makes random edits to random scripts and checks that updating a
+//	CTokenList for each edit using UpdateForEdit() gives exactly the tokens
+//	that tokenizing the edited text from scratch gives. Build it from the
+//	Forge folder together with the tokenizer's sources, e.g.
+//
+//	c++ -I. -I../Leonie/common Tests/TokenListEditFuzzer.cpp CToken.cpp CSymbolTable.cpp ../Leonie/common/UTF8UTF32Utilities.c -o TokenListEditFuzzer -lpthread
+//
+//	and run it as TokenListEditFuzzer [<numScripts> [<seed>]]. Prints the
+//	first edit that gives different tokens and exits with 1, or exits with 0.
+
+#include "CToken.h"
+#include "CSymbolTable.h"
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <stdlib.h>
+
+
+using namespace Carlson;
+
+
+// Bits of text the scripts are made of. Lots of line breaks, quotes and
+//	comment starts, since those are what make tokens span or end lines:
+static const char*	sTextPieces[] = { "a", "b", "X", "1", "23", "12.5", "2e5", ".", "e", " ", "\t", "\n", "\r", "\r\n",
+									"\"", "\"str\"", "-", "--", "-- comment\n", "+", "(", ")", ",", "_", "é", "on ", "end ", "put " };
+
+
+static std::string	RandomText( size_t inNumPieces )
+{
+	std::string		text;
+	for( size_t x = 0; x < inNumPieces; x++ )
+		text.append( sTextPieces[ rand() % (sizeof(sTextPieces) / sizeof(sTextPieces[0])) ] );
+	return text;
+}
+
+
+// All we know about each token, one per line, so two lists can be compared:
+static std::string	DescriptionOfTokens( CTokenList& inTokens, CSymbolTable& inSymbols )
+{
+	std::string		description;
+	for( CTokenCursor itty = inTokens.begin(); itty != inTokens.end(); ++itty )
+	{
+		description.append( itty->GetDescription() );
+		description.append( "|" );
+		description.append( itty->GetStringValue() );
+		if( itty->mSymbolID != kNoSymbol )
+		{
+			description.append( "|" );
+			description.append( inSymbols.TextForSymbol( itty->mSymbolID ) );
+		}
+		description.append( "\n" );
+	}
+	return description;
+}
+
+
+// Offset into inText at or after inOffset that isn't in the middle of a
+//	UTF-8 sequence, so edits don't cut characters in half:
+static size_t	CharacterBoundary( const std::string& inText, size_t inOffset )
+{
+	while( inOffset < inText.length() && (inText[inOffset] & 0xC0) == 0x80 )
+		inOffset++;
+	return inOffset;
+}
+
+
+int main( int argc, char * const argv[] )
+{
+	unsigned long	numScripts = (argc > 1) ? strtoul( argv[1], NULL, 10 ) : 30000;
+	unsigned		seed = (argc > 2) ? (unsigned) strtoul( argv[2], NULL, 10 ) : 42;
+	CSymbolTable	symbols;
+	
+	srand( seed );
+	
+	for( unsigned long scriptIdx = 0; scriptIdx < numScripts; scriptIdx++ )
+	{
+		// Tokens reference the text, so each version has to stay around until
+		//	the list has been updated for the next one:
+		std::string*	text = new std::string( RandomText( rand() % 200 ) );
+		CTokenList		tokens = CToken::TokenListFromText( text->data(), text->length(), &symbols );
+		
+		for( int editIdx = 0; editIdx < 6; editIdx++ )
+		{
+			size_t			editOffset = CharacterBoundary( *text, text->empty() ? 0 : rand() % (text->length() +1) );
+			size_t			removedLength = 0;
+			if( editOffset < text->length() )
+				removedLength = rand() % std::min( (size_t) 8, text->length() -editOffset +1 );
+			removedLength = CharacterBoundary( *text, editOffset +removedLength ) -editOffset;
+			std::string		inserted = RandomText( rand() % 4 );
+			std::string*	newText = new std::string( text->substr( 0, editOffset ) +inserted +text->substr( editOffset +removedLength ) );
+			
+			tokens.UpdateForEdit( newText->data(), newText->length(), editOffset, removedLength, inserted.length() );
+			CTokenList		expectedTokens = CToken::TokenListFromText( newText->data(), newText->length(), &symbols );
+			std::string		updatedDescription = DescriptionOfTokens( tokens, symbols );
+			std::string		expectedDescription = DescriptionOfTokens( expectedTokens, symbols );
+			if( updatedDescription != expectedDescription )
+			{
+				std::cout << "Script " << scriptIdx << ", edit " << editIdx << ": Replacing " << removedLength << " bytes at "
+							<< editOffset << " with \"" << inserted << "\" in:" << std::endl << *text << std::endl
+							<< "---- updated tokens:" << std::endl << updatedDescription
+							<< "---- tokens of the whole text:" << std::endl << expectedDescription;
+				return 1;
+			}
+			
+			delete text;
+			text = newText;
+		}
+		
+		delete text;
+	}
+	
+	std::cout << "Updated " << numScripts << " scripts for 6 edits each, all tokens matched." << std::endl;
+	
+	return 0;
+}
@@ -0,0 +1,132 @@
+#!/bin/sh
+#
+#  roundtrip.sh
+#  Forge
+#
+#  Writes each testfile in the binary formats forge can write, loads it again
+#  and checks that --printinstructions gives the same as compiling the script
+#  directly. Also checks that a truncated and a damaged file of each format are
+#  rejected with an error instead of being loaded or crashing forge.
+#
+#  Run it from the Forge folder as Tests/roundtrip.sh [<path to forge>], the
+#  default is ./forge. Exits with 1 if anything didn't match.
+#
+
+FORGE=${1:-./forge}
+WORKDIR=`mktemp -d /tmp/forge_roundtrip.XXXXXX` || exit 1
+trap 'rm -rf "$WORKDIR"' EXIT
+NUMFAILED=0
+
+
+fail()
+{
+	echo "FAILED: $*"
+	NUMFAILED=`expr $NUMFAILED + 1`
+}
+
+
+# same_instructions <description> <file written directly> <file from round-trip>
+same_instructions()
+{
+	if ! cmp -s "$2" "$3"
+	then
+		fail "$1 doesn't give the same instructions:"
+		diff "$2" "$3" | head -20
+	fi
+}
+
+
+# Writes a copy of <file> to <truncated file> that stops halfway, and one to
+#	<damaged file> whose first 4 bytes (the magic number of every format) are
+#	wrong:
+# make_broken_copies <file> <truncated file> <damaged file>
+make_broken_copies()
+{
+	HALFSIZE=`wc -c < "$1"`
+	HALFSIZE=`expr $HALFSIZE / 2`
+	dd if="$1" of="$2" bs=1 count=$HALFSIZE 2>/dev/null
+	{ printf 'XXXX'; dd if="$1" bs=4 skip=1 2>/dev/null; } > "$3"
+}
+
+
+# Runs forge with the given parameters and fails unless it reports an error
+#	the way it does for damaged files, by exiting with 3. Anything else means
+#	it loaded the file, crashed, or a sanitizer stopped it:
+# expect_rejected <description> <forge parameters...>
+expect_rejected()
+{
+	DESCRIPTION=$1
+	shift
+	"$FORGE" --dontrun --printinstructions "$@" > "$WORKDIR/rejected.txt" 2>&1
+	RESULT=$?
+	if [ $RESULT -eq 0 ]
+	then
+		fail "$DESCRIPTION was loaded."
+	elif [ $RESULT -ne 3 ]
+	then
+		fail "$DESCRIPTION made forge exit with $RESULT:"
+		tail -5 "$WORKDIR/rejected.txt"
+	fi
+}
+
+
+for SCRIPT in testfile*.hc
+do
+	if ! "$FORGE" --dontrun --printinstructions "$SCRIPT" > "$WORKDIR/expected.txt" 2>/dev/null
+	then
+		echo "Skipping $SCRIPT, it doesn't compile."
+		continue
+	fi
+
+	# Bytecode files:
+	if "$FORGE" --dontrun --emit-bytecode "$WORKDIR/script.fbc" "$SCRIPT" > /dev/null 2>&1 \
+		&& "$FORGE" --dontrun --printinstructions --load-bytecode "$WORKDIR/script.fbc" > "$WORKDIR/actual.txt" 2>&1
+	then
+		same_instructions "$SCRIPT as bytecode" "$WORKDIR/expected.txt" "$WORKDIR/actual.txt"
+		make_broken_copies "$WORKDIR/script.fbc" "$WORKDIR/truncated.fbc" "$WORKDIR/damaged.fbc"
+		expect_rejected "Truncated bytecode of $SCRIPT" --load-bytecode "$WORKDIR/truncated.fbc"
+		expect_rejected "Damaged bytecode of $SCRIPT" --load-bytecode "$WORKDIR/damaged.fbc"
+	else
+		fail "Couldn't write and load $SCRIPT as bytecode."
+	fi
+
+	# Bundles, compiled from the script and made from its bytecode:
+	if "$FORGE" --bundle "$WORKDIR/script.fbundle" "$SCRIPT" > /dev/null 2>&1 \
+		&& "$FORGE" --dontrun --printinstructions --load-bundle "$WORKDIR/script.fbundle" > "$WORKDIR/actual.txt" 2>&1
+	then
+		same_instructions "$SCRIPT as a bundle" "$WORKDIR/expected.txt" "$WORKDIR/actual.txt"
+		make_broken_copies "$WORKDIR/script.fbundle" "$WORKDIR/truncated.fbundle" "$WORKDIR/damaged.fbundle"
+		expect_rejected "Truncated bundle of $SCRIPT" --load-bundle "$WORKDIR/truncated.fbundle"
+		expect_rejected "Damaged bundle of $SCRIPT" --load-bundle "$WORKDIR/damaged.fbundle"
+	else
+		fail "Couldn't write and load $SCRIPT as a bundle."
+	fi
+	if "$FORGE" --bundle "$WORKDIR/script.fbundle" --load-bytecode "$WORKDIR/script.fbc" > /dev/null 2>&1 \
+		&& "$FORGE" --dontrun --printinstructions --load-bundle "$WORKDIR/script.fbundle" > "$WORKDIR/actual.txt" 2>&1
+	then
+		same_instructions "$SCRIPT as a bundle made from bytecode" "$WORKDIR/expected.txt" "$WORKDIR/actual.txt"
+	else
+		fail "Couldn't make a bundle from the bytecode of $SCRIPT."
+	fi
+
+	# Parse tree files:
+	if "$FORGE" --dontrun --emit-parsetree "$WORKDIR/script.fpt" "$SCRIPT" > /dev/null 2>&1 \
+		&& "$FORGE" --dontrun --printinstructions --load-parsetree "$WORKDIR/script.fpt" > "$WORKDIR/actual.txt" 2>&1
+	then
+		same_instructions "$SCRIPT as a parse tree" "$WORKDIR/expected.txt" "$WORKDIR/actual.txt"
+		make_broken_copies "$WORKDIR/script.fpt" "$WORKDIR/truncated.fpt" "$WORKDIR/damaged.fpt"
+		expect_rejected "Truncated parse tree of $SCRIPT" --load-parsetree "$WORKDIR/truncated.fpt"
+		expect_rejected "Damaged parse tree of $SCRIPT" --load-parsetree "$WORKDIR/damaged.fpt"
+	else
+		fail "Couldn't write and load $SCRIPT as a parse tree."
+	fi
+done
+
+
+if [ $NUMFAILED -ne 0 ]
+then
+	echo "$NUMFAILED checks failed."
+	exit 1
+fi
+echo "All round-trips matched."
+exit 0
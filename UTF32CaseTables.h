@@ -7,1774 +7,377 @@
  *
  */
 
-static const unsigned short gUTF32CaseTableFrom0041[] =
-{
-	0x0061,
-	0x0062,
-	0x0063,
-	0x0064,
-	0x0065,
-	0x0066,
-	0x0067,
-	0x0068,
-	0x0069,
-	0x006A,
-	0x006B,
-	0x006C,
-	0x006D,
-	0x006E,
-	0x006F,
-	0x0070,
-	0x0071,
-	0x0072,
-	0x0073,
-	0x0074,
-	0x0075,
-	0x0076,
-	0x0077,
-	0x0078,
-	0x0079,
-	0x007A,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x00E0,
-	0x00E1,
-	0x00E2,
-	0x00E3,
-	0x00E4,
-	0x00E5,
-	0x00E6,
-	0x00E7,
-	0x00E8,
-	0x00E9,
-	0x00EA,
-	0x00EB,
-	0x00EC,
-	0x00ED,
-	0x00EE,
-	0x00EF,
-	0x00F0,
-	0x00F1,
-	0x00F2,
-	0x00F3,
-	0x00F4,
-	0x00F5,
-	0x00F6,
-	0,
-	0x00F8,
-	0x00F9,
-	0x00FA,
-	0x00FB,
-	0x00FC,
-	0x00FD,
-	0x00FE,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x0101,
-	0,
-	0x0103,
-	0,
-	0x0105,
-	0,
-	0x0107,
-	0,
-	0x0109,
-	0,
-	0x010B,
-	0,
-	0x010D,
-	0,
-	0x010F,
-	0,
-	0x0111,
-	0,
-	0x0113,
-	0,
-	0x0115,
-	0,
-	0x0117,
-	0,
-	0x0119,
-	0,
-	0x011B,
-	0,
-	0x011D,
-	0,
-	0x011F,
-	0,
-	0x0121,
-	0,
-	0x0123,
-	0,
-	0x0125,
-	0,
-	0x0127,
-	0,
-	0x0129,
-	0,
-	0x012B,
-	0,
-	0x012D,
-	0,
-	0x012F,
-	0,
-	0,
-	0,
-	0x0133,
-	0,
-	0x0135,
-	0,
-	0x0137,
-	0,
-	0,
-	0x013A,
-	0,
-	0x013C,
-	0,
-	0x013E,
-	0,
-	0x0140,
-	0,
-	0x0142,
-	0,
-	0x0144,
-	0,
-	0x0146,
-	0,
-	0x0148,
-	0,
-	0,
-	0x014B,
-	0,
-	0x014D,
-	0,
-	0x014F,
-	0,
-	0x0151,
-	0,
-	0x0153,
-	0,
-	0x0155,
-	0,
-	0x0157,
-	0,
-	0x0159,
-	0,
-	0x015B,
-	0,
-	0x015D,
-	0,
-	0x015F,
-	0,
-	0x0161,
-	0,
-	0x0163,
-	0,
-	0x0165,
-	0,
-	0x0167,
-	0,
-	0x0169,
-	0,
-	0x016B,
-	0,
-	0x016D,
-	0,
-	0x016F,
-	0,
-	0x0171,
-	0,
-	0x0173,
-	0,
-	0x0175,
-	0,
-	0x0177,
-	0,
-	0x00FF,
-	0x017A,
-	0,
-	0x017C,
-	0,
-	0x017E,
-	0,
-	0,
-	0,
-	0x0253,
-	0x0183,
-	0,
-	0x0185,
-	0,
-	0x0254,
-	0x0188,
-	0,
-	0,
-	0x0257,
-	0x018C,
-	0,
-	0,
-	0x0258,
-	0x0259,
-	0x025B,
-	0x0192,
-	0,
-	0x0260,
-	0x0263,
-	0,
-	0x0269,
-	0x0268,
-	0x0199,
-	0,
-	0,
-	0,
-	0x026F,
-	0x0272,
-	0,
-	0,
-	0x01A1,
-	0,
-	0x01A3,
-	0,
-	0x01A5,
-	0,
-	0,
-	0x01A8,
-	0,
-	0x0283,
-	0,
-	0,
-	0x01AD,
-	0,
-	0x0288,
-	0x01B0,
-	0,
-	0x028A,
-	0x028B,
-	0x01B4,
-	0,
-	0x01B6,
-	0,
-	0x0292,
-	0x01B9,
-	0,
-	0,
-	0,
-	0x01BD,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x01C6,
-	0,
-	0,
-	0x01C9,
-	0,
-	0,
-	0x01CC,
-	0,
-	0,
-	0x01CE,
-	0,
-	0x01D0,
-	0,
-	0x01D2,
-	0,
-	0x01D4,
-	0,
-	0x01D6,
-	0,
-	0x01D8,
-	0,
-	0x01DA,
-	0,
-	0x01DC,
-	0,
-	0,
-	0x01DF,
-	0,
-	0x01E1,
-	0,
-	0x01E3,
-	0,
-	0x01E5,
-	0,
-	0x01E7,
-	0,
-	0x01E9,
-	0,
-	0x01EB,
-	0,
-	0x01ED,
-	0,
-	0x01EF,
-	0,
-	0,
-	0x01F3,
-	0,
-	0,
-	0x01F5,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x01FB,
-	0,
-	0x01FD,
-	0,
-	0x01FF,
-	0,
-	0x0201,
-	0,
-	0x0203,
-	0,
-	0x0205,
-	0,
-	0x0207,
-	0,
-	0x0209,
-	0,
-	0x020B,
-	0,
-	0x020D,
-	0,
-	0x020F,
-	0,
-	0x0211,
-	0,
-	0x0213,
-	0,
-	0x0215,
-	0,
-	0x0217,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0
-};
+// Lowercase mappings for the Basic Multilingual Plane, as a two-stage table:
+//	gUTF32CaseBlockIndex[ch >> UTF32_CASE_BLOCK_SHIFT] is the number of a block
+//	in gUTF32CaseBlocks, and that block's entry (ch & UTF32_CASE_BLOCK_MASK) is
+//	what to add to ch to get its lowercase equivalent. Blocks are stored only
+//	once, so all blocks without uppercase characters share block 0, which is
+//	all zeroes. Characters outside the BMP don't change.
+//	No character's lowercase form takes more UTF-8 bytes than the original.
 
-static const unsigned short gUTF32CaseTableFrom0386[] =
-{
-	0x03AC,
-	0,
-	0x03AD,
-	0x03AE,
-	0x03AF,
-	0,
-	0x03CC,
-	0,
-	0x03CD,
-	0x03CE,
-	0,
-	0x03B1,
-	0x03B2,
-	0x03B3,
-	0x03B4,
-	0x03B5,
-	0x03B6,
-	0x03B7,
-	0x03B8,
-	0x03B9,
-	0x03BA,
-	0x03BB,
-	0x03BC,
-	0x03BD,
-	0x03BE,
-	0x03BF,
-	0x03C0,
-	0x03C1,
-	0,
-	0x03C3,
-	0x03C4,
-	0x03C5,
-	0x03C6,
-	0x03C7,
-	0x03C8,
-	0x03C9,
-	0x03CA,
-	0x03CB,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x03D2,
-	0x03D3,
-	0x03D4,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x03DA,
-	0,
-	0x03DC,
-	0,
-	0x03DE,
-	0,
-	0x03E0,
-	0,
-	0x03E3,
-	0,
-	0x03E5,
-	0,
-	0x03E7,
-	0,
-	0x03E9,
-	0,
-	0x03EB,
-	0,
-	0x03ED,
-	0,
-	0x03EF,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x0451,
-	0x0452,
-	0x0453,
-	0x0454,
-	0x0455,
-	0x0456,
-	0x0457,
-	0x0458,
-	0x0459,
-	0x045A,
-	0x045B,
-	0x045C,
-	0,
-	0x045E,
-	0x045F,
-	0x0430,
-	0x0431,
-	0x0432,
-	0x0433,
-	0x0434,
-	0x0435,
-	0x0436,
-	0x0437,
-	0x0438,
-	0x0439,
-	0x043A,
-	0x043B,
-	0x043C,
-	0x043D,
-	0x043E,
-	0x043F,
-	0x0440,
-	0x0441,
-	0x0442,
-	0x0443,
-	0x0444,
-	0x0445,
-	0x0446,
-	0x0447,
-	0x0448,
-	0x0449,
-	0x044A,
-	0x044B,
-	0x044C,
-	0x044D,
-	0x044E,
-	0x044F,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x0461,
-	0,
-	0x0463,
-	0,
-	0x0465,
-	0,
-	0x0467,
-	0,
-	0x0469,
-	0,
-	0x046B,
-	0,
-	0x046D,
-	0,
-	0x046F,
-	0,
-	0x0471,
-	0,
-	0x0473,
-	0,
-	0x0475,
-	0,
-	0x0477,
-	0,
-	0x0479,
-	0,
-	0x047B,
-	0,
-	0x047D,
-	0,
-	0x047F,
-	0,
-	0x0481,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x0491,
-	0,
-	0x0493,
-	0,
-	0x0495,
-	0,
-	0x0497,
-	0,
-	0x0499,
-	0,
-	0x049B,
-	0,
-	0x049D,
-	0,
-	0x049F,
-	0,
-	0x04A1,
-	0,
-	0x04A3,
-	0,
-	0x04A5,
-	0,
-	0x04A7,
-	0,
-	0x04A9,
-	0,
-	0x04AB,
-	0,
-	0x04AD,
-	0,
-	0x04AF,
-	0,
-	0x04B1,
-	0,
-	0x04B3,
-	0,
-	0x04B5,
-	0,
-	0x04B7,
-	0,
-	0x04B9,
-	0,
-	0x04BB,
-	0,
-	0x04BD,
-	0,
-	0x04BF,
-	0,
-	0,
-	0x04C2,
-	0,
-	0x04C4,
-	0,
-	0,
-	0,
-	0x04C8,
-	0,
-	0,
-	0,
-	0x04CC,
-	0,
-	0,
-	0,
-	0,
-	0x04D1,
-	0,
-	0x04D3,
-	0,
-	0x04D5,
-	0,
-	0x04D7,
-	0,
-	0x04D9,
-	0,
-	0x04DB,
-	0,
-	0x04DD,
-	0,
-	0x04DF,
-	0,
-	0x04E1,
-	0,
-	0x04E3,
-	0,
-	0x04E5,
-	0,
-	0x04E7,
-	0,
-	0x04E9,
-	0,
-	0x04EB,
-	0,
-	0,
-	0,
-	0x04EF,
-	0,
-	0x04F1,
-	0,
-	0x04F3,
-	0,
-	0x04F5,
-	0,
-	0,
-	0,
-	0x04F9,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x0561,
-	0x0562,
-	0x0563,
-	0x0564,
-	0x0565,
-	0x0566,
-	0x0567,
-	0x0568,
-	0x0569,
-	0x056A,
-	0x056B,
-	0x056C,
-	0x056D,
-	0x056E,
-	0x056F,
-	0x0570,
-	0x0571,
-	0x0572,
-	0x0573,
-	0x0574,
-	0x0575,
-	0x0576,
-	0x0577,
-	0x0578,
-	0x0579,
-	0x057A,
-	0x057B,
-	0x057C,
-	0x057D,
-	0x057E,
-	0x057F,
-	0x0580,
-	0x0581,
-	0x0582,
-	0x0583,
-	0x0584,
-	0x0585,
-	0x0586
-};
-
-static const unsigned short gUTF32CaseTableFrom10A0[] =
-{
-	0x10D0,
-	0x10D1,
-	0x10D2,
-	0x10D3,
-	0x10D4,
-	0x10D5,
-	0x10D6,
-	0x10D7,
-	0x10D8,
-	0x10D9,
-	0x10DA,
-	0x10DB,
-	0x10DC,
-	0x10DD,
-	0x10DE,
-	0x10DF,
-	0x10E0,
-	0x10E1,
-	0x10E2,
-	0x10E3,
-	0x10E4,
-	0x10E5,
-	0x10E6,
-	0x10E7,
-	0x10E8,
-	0x10E9,
-	0x10EA,
-	0x10EB,
-	0x10EC,
-	0x10ED,
-	0x10EE,
-	0x10EF,
-	0x10F0,
-	0x10F1,
-	0x10F2,
-	0x10F3,
-	0x10F4,
-	0x10F5
-};
-
-static const unsigned short gUTF32CaseTableFrom1E00[] =
-{
-	0x1E01,
-	0,
-	0x1E03,
-	0,
-	0x1E05,
-	0,
-	0x1E07,
-	0,
-	0x1E09,
-	0,
-	0x1E0B,
-	0,
-	0x1E0D,
-	0,
-	0x1E0F,
-	0,
-	0x1E11,
-	0,
-	0x1E13,
-	0,
-	0x1E15,
-	0,
-	0x1E17,
-	0,
-	0x1E19,
-	0,
-	0x1E1B,
-	0,
-	0x1E1D,
-	0,
-	0x1E1F,
-	0,
-	0x1E21,
-	0,
-	0x1E23,
-	0,
-	0x1E25,
-	0,
-	0x1E27,
-	0,
-	0x1E29,
-	0,
-	0x1E2B,
-	0,
-	0x1E2D,
-	0,
-	0x1E2F,
-	0,
-	0x1E31,
-	0,
-	0x1E33,
-	0,
-	0x1E35,
-	0,
-	0x1E37,
-	0,
-	0x1E39,
-	0,
-	0x1E3B,
-	0,
-	0x1E3D,
-	0,
-	0x1E3F,
-	0,
-	0x1E41,
-	0,
-	0x1E43,
-	0,
-	0x1E45,
-	0,
-	0x1E47,
-	0,
-	0x1E49,
-	0,
-	0x1E4B,
-	0,
-	0x1E4D,
-	0,
-	0x1E4F,
-	0,
-	0x1E51,
-	0,
-	0x1E53,
-	0,
-	0x1E55,
-	0,
-	0x1E57,
-	0,
-	0x1E59,
-	0,
-	0x1E5B,
-	0,
-	0x1E5D,
-	0,
-	0x1E5F,
-	0,
-	0x1E61,
-	0,
-	0x1E63,
-	0,
-	0x1E65,
-	0,
-	0x1E67,
-	0,
-	0x1E69,
-	0,
-	0x1E6B,
-	0,
-	0x1E6D,
-	0,
-	0x1E6F,
-	0,
-	0x1E71,
-	0,
-	0x1E73,
-	0,
-	0x1E75,
-	0,
-	0x1E77,
-	0,
-	0x1E79,
-	0,
-	0x1E7B,
-	0,
-	0x1E7D,
-	0,
-	0x1E7F,
-	0,
-	0x1E81,
-	0,
-	0x1E83,
-	0,
-	0x1E85,
-	0,
-	0x1E87,
-	0,
-	0x1E89,
-	0,
-	0x1E8B,
-	0,
-	0x1E8D,
-	0,
-	0x1E8F,
-	0,
-	0x1E91,
-	0,
-	0x1E93,
-	0,
-	0x1E95,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x1EA1,
-	0,
-	0x1EA3,
-	0,
-	0x1EA5,
-	0,
-	0x1EA7,
-	0,
-	0x1EA9,
-	0,
-	0x1EAB,
-	0,
-	0x1EAD,
-	0,
-	0x1EAF,
-	0,
-	0x1EB1,
-	0,
-	0x1EB3,
-	0,
-	0x1EB5,
-	0,
-	0x1EB7,
-	0,
-	0x1EB9,
-	0,
-	0x1EBB,
-	0,
-	0x1EBD,
-	0,
-	0x1EBF,
-	0,
-	0x1EC1,
-	0,
-	0x1EC3,
-	0,
-	0x1EC5,
-	0,
-	0x1EC7,
-	0,
-	0x1EC9,
-	0,
-	0x1ECB,
-	0,
-	0x1ECD,
-	0,
-	0x1ECF,
-	0,
-	0x1ED1,
-	0,
-	0x1ED3,
-	0,
-	0x1ED5,
-	0,
-	0x1ED7,
-	0,
-	0x1ED9,
-	0,
-	0x1EDB,
-	0,
-	0x1EDD,
-	0,
-	0x1EDF,
-	0,
-	0x1EE1,
-	0,
-	0x1EE3,
-	0,
-	0x1EE5,
-	0,
-	0x1EE7,
-	0,
-	0x1EE9,
-	0,
-	0x1EEB,
-	0,
-	0x1EED,
-	0,
-	0x1EEF,
-	0,
-	0x1EF1,
-	0,
-	0x1EF3,
-	0,
-	0x1EF5,
-	0,
-	0x1EF7,
-	0,
-	0x1EF9,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x1F00,
-	0x1F01,
-	0x1F02,
-	0x1F03,
-	0x1F04,
-	0x1F05,
-	0x1F06,
-	0x1F07,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x1F10,
-	0x1F11,
-	0x1F12,
-	0x1F13,
-	0x1F14,
-	0x1F15,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x1F20,
-	0x1F21,
-	0x1F22,
-	0x1F23,
-	0x1F24,
-	0x1F25,
-	0x1F26,
-	0x1F27,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x1F30,
-	0x1F31,
-	0x1F32,
-	0x1F33,
-	0x1F34,
-	0x1F35,
-	0x1F36,
-	0x1F37,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x1F40,
-	0x1F41,
-	0x1F42,
-	0x1F43,
-	0x1F44,
-	0x1F45,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x1F51,
-	0,
-	0x1F53,
-	0,
-	0x1F55,
-	0,
-	0x1F57,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x1F60,
-	0x1F61,
-	0x1F62,
-	0x1F63,
-	0x1F64,
-	0x1F65,
-	0x1F66,
-	0x1F67,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x1FB0,
-	0x1FB1,
-	0x1F70,
-	0x1F71,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x1F72,
-	0x1F73,
-	0x1F74,
-	0x1F75,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x1FD0,
-	0x1FD1,
-	0x1F76,
-	0x1F77,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x1FE0,
-	0x1FE1,
-	0x1F7A,
-	0x1F7B,
-	0x1FE5,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x1F78,
-	0x1F79,
-	0x1F7C,
-	0x1F7D,
-	0
-};
-
-static const unsigned short gUTF32CaseTableFrom2102[] =
-{
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x2113,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0,
-	0x212F,
-	0,
-	0,
-	0
-};
+#define UTF32_CASE_BLOCK_SHIFT		6
+#define UTF32_CASE_BLOCK_SIZE		(1 << UTF32_CASE_BLOCK_SHIFT)
+#define UTF32_CASE_BLOCK_MASK		(UTF32_CASE_BLOCK_SIZE -1)
+#define UTF32_CASE_NUM_BLOCKS		29
 
-static const unsigned short gUTF32CaseTableFrom24B6[] =
+static const unsigned char gUTF32CaseBlockIndex[0x10000 >> UTF32_CASE_BLOCK_SHIFT] =
 {
-	0x24D0,
-	0x24D1,
-	0x24D2,
-	0x24D3,
-	0x24D4,
-	0x24D5,
-	0x24D6,
-	0x24D7,
-	0x24D8,
-	0x24D9,
-	0x24DA,
-	0x24DB,
-	0x24DC,
-	0x24DD,
-	0x24DE,
-	0x24DF,
-	0x24E0,
-	0x24E1,
-	0x24E2,
-	0x24E3,
-	0x24E4,
-	0x24E5,
-	0x24E6,
-	0x24E7,
-	0x24E8,
-	0x24E9
+	  0,   1,   0,   2,   3,   4,   5,   6,   7,   0,   0,   0,   0,   0,   8,   9,
+	 10,  11,  12,  13,  14,  15,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,  16,  17,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,  18,  18,  19,  20,  21,  22,  23,  24,
+	  0,   0,   0,   0,  25,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,  26,  27,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  28,   0,   0,   0
 };
 
-static const unsigned short gUTF32CaseTableFromFF21[] =
+static const short gUTF32CaseBlocks[UTF32_CASE_NUM_BLOCKS][UTF32_CASE_BLOCK_SIZE] =
 {
-	0xFF41,
-	0xFF42,
-	0xFF43,
-	0xFF44,
-	0xFF45,
-	0xFF46,
-	0xFF47,
-	0xFF48,
-	0xFF49,
-	0xFF4A,
-	0xFF4B,
-	0xFF4C,
-	0xFF4D,
-	0xFF4E,
-	0xFF4F,
-	0xFF50,
-	0xFF51,
-	0xFF52,
-	0xFF53,
-	0xFF54,
-	0xFF55,
-	0xFF56,
-	0xFF57,
-	0xFF58,
-	0xFF59,
-	0xFF5A
+	{	// 0
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0
+	},
+	{	// 1
+		     0,     32,     32,     32,     32,     32,     32,     32,
+		    32,     32,     32,     32,     32,     32,     32,     32,
+		    32,     32,     32,     32,     32,     32,     32,     32,
+		    32,     32,     32,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0
+	},
+	{	// 2
+		    32,     32,     32,     32,     32,     32,     32,     32,
+		    32,     32,     32,     32,     32,     32,     32,     32,
+		    32,     32,     32,     32,     32,     32,     32,      0,
+		    32,     32,     32,     32,     32,     32,     32,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0
+	},
+	{	// 3
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     0,      0,      1,      0,      1,      0,      1,      0,
+		     0,      1,      0,      1,      0,      1,      0,      1
+	},
+	{	// 4
+		     0,      1,      0,      1,      0,      1,      0,      1,
+		     0,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		  -121,      1,      0,      1,      0,      1,      0,      0
+	},
+	{	// 5
+		     0,    210,      1,      0,      1,      0,    206,      1,
+		     0,      0,    205,      1,      0,      0,    202,    202,
+		   203,      1,      0,    205,    207,      0,    211,    209,
+		     1,      0,      0,      0,    211,    213,      0,      0,
+		     1,      0,      1,      0,      1,      0,      0,      1,
+		     0,    218,      0,      0,      1,      0,    218,      1,
+		     0,    217,    217,      1,      0,      1,      0,    219,
+		     1,      0,      0,      0,      1,      0,      0,      0
+	},
+	{	// 6
+		     0,      0,      0,      0,      2,      0,      0,      2,
+		     0,      0,      2,      0,      0,      1,      0,      1,
+		     0,      1,      0,      1,      0,      1,      0,      1,
+		     0,      1,      0,      1,      0,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     0,      2,      0,      0,      1,      0,      0,      0,
+		     0,      0,      1,      0,      1,      0,      1,      0
+	},
+	{	// 7
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0
+	},
+	{	// 8
+		     0,      0,      0,      0,      0,      0,     38,      0,
+		    37,     37,     37,      0,     64,      0,     63,     63,
+		     0,     32,     32,     32,     32,     32,     32,     32,
+		    32,     32,     32,     32,     32,     32,     32,     32,
+		    32,     32,      0,     32,     32,     32,     32,     32,
+		    32,     32,     32,     32,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0
+	},
+	{	// 9
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0
+	},
+	{	// 10
+		     0,     80,     80,     80,     80,     80,     80,     80,
+		    80,     80,     80,     80,     80,      0,     80,     80,
+		    32,     32,     32,     32,     32,     32,     32,     32,
+		    32,     32,     32,     32,     32,     32,     32,     32,
+		    32,     32,     32,     32,     32,     32,     32,     32,
+		    32,     32,     32,     32,     32,     32,     32,     32,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0
+	},
+	{	// 11
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0
+	},
+	{	// 12
+		     1,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0
+	},
+	{	// 13
+		     0,      1,      0,      1,      0,      0,      0,      1,
+		     0,      0,      0,      1,      0,      0,      0,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      0,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      0,      0,
+		     1,      0,      0,      0,      0,      0,      0,      0
+	},
+	{	// 14
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,     48,     48,     48,     48,     48,     48,     48,
+		    48,     48,     48,     48,     48,     48,     48,     48
+	},
+	{	// 15
+		    48,     48,     48,     48,     48,     48,     48,     48,
+		    48,     48,     48,     48,     48,     48,     48,     48,
+		    48,     48,     48,     48,     48,     48,     48,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0
+	},
+	{	// 16
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		    48,     48,     48,     48,     48,     48,     48,     48,
+		    48,     48,     48,     48,     48,     48,     48,     48,
+		    48,     48,     48,     48,     48,     48,     48,     48,
+		    48,     48,     48,     48,     48,     48,     48,     48
+	},
+	{	// 17
+		    48,     48,     48,     48,     48,     48,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0
+	},
+	{	// 18
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0
+	},
+	{	// 19
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0
+	},
+	{	// 20
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      1,      0,      1,      0,      1,      0,
+		     1,      0,      0,      0,      0,      0,      0,      0
+	},
+	{	// 21
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		    -8,     -8,     -8,     -8,     -8,     -8,     -8,     -8,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		    -8,     -8,     -8,     -8,     -8,     -8,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		    -8,     -8,     -8,     -8,     -8,     -8,     -8,     -8,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		    -8,     -8,     -8,     -8,     -8,     -8,     -8,     -8
+	},
+	{	// 22
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		    -8,     -8,     -8,     -8,     -8,     -8,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,     -8,      0,     -8,      0,     -8,      0,     -8,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		    -8,     -8,     -8,     -8,     -8,     -8,     -8,     -8,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0
+	},
+	{	// 23
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		    -8,     -8,    -74,    -74,      0,      0,      0,      0
+	},
+	{	// 24
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		   -86,    -86,    -86,    -86,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		    -8,     -8,   -100,   -100,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		    -8,     -8,   -112,   -112,     -7,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		  -128,   -128,   -126,   -126,      0,      0,      0,      0
+	},
+	{	// 25
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      1,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		    -1,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0
+	},
+	{	// 26
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,     26,     26,
+		    26,     26,     26,     26,     26,     26,     26,     26
+	},
+	{	// 27
+		    26,     26,     26,     26,     26,     26,     26,     26,
+		    26,     26,     26,     26,     26,     26,     26,     26,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0
+	},
+	{	// 28
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,      0,      0,      0,      0,      0,      0,      0,
+		     0,     32,     32,     32,     32,     32,     32,     32,
+		    32,     32,     32,     32,     32,     32,     32,     32,
+		    32,     32,     32,     32,     32,     32,     32,     32,
+		    32,     32,     32,      0,      0,      0,      0,      0
+	}
 };
@@ -2,33 +2,158 @@
 #include <stdexcept>
 #include "CToken.h"
 #include "CParser.h"
-#include "GetFileContents.h"
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <time.h>
 #include "CParseTree.h"
 #include "CCodeBlock.h"
+#include "CLazyScript.h"
+#include "CBytecodeArchive.h"
+#include "CParseTreeArchive.h"
+#include "CScriptBundle.h"
+#include "CCompileCache.h"
+#include <vector>
 extern "C" {
 #include "LEOScript.h"
 #include "LEOContextGroup.h"
 #include "LEORemoteDebugger.h"
 #include "LEOMsgInstructions.h"
 #include "LEOInterpreter.h"
+#include "ForgeInstructions.h"
 }
 
 
 using namespace Carlson;
 
+
+// Map the file read-only into memory, so we don't have to copy it into a
+//	buffer before tokenizing. Returns NULL if the file couldn't be opened.
+static const char*	MapFileContents( const char* inFilePath, size_t *outLength )
+{
+	int		fd = open( inFilePath, O_RDONLY );
+	if( fd < 0 )
+		return NULL;
+	
+	struct stat		fileInfo;
+	if( fstat( fd, &fileInfo ) != 0 )
+	{
+		close( fd );
+		return NULL;
+	}
+	
+	*outLength = (size_t) fileInfo.st_size;
+	if( *outLength == 0 )	// Can't map an empty file.
+	{
+		close( fd );
+		return "";
+	}
+	
+	void*	fileContents = mmap( NULL, *outLength, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );	// The mapping stays valid without the descriptor.
+	if( fileContents == MAP_FAILED )
+		return NULL;
+	
+	return (const char*) fileContents;
+}
+
+
+static void	UnmapFileContents( const char* inContents, size_t inLength )
+{
+	if( inLength > 0 )
+		munmap( (void*) inContents, inLength );
+}
+
+
+// Compiles each script (or loads its bytecode) into one context group and
+//	writes all of them to one bundle file:
+static int	BuildBundle( const char* inBundlePath, char * const inFilePaths[], int inNumFiles, bool inLoadBytecode, bool inVerbose )
+{
+	LEOContextGroup	*			group = LEOContextGroupCreate();
+	std::vector<LEOScript*>		scripts;
+	std::vector<std::string>	fileNames;
+	std::vector<const char*>	fileNamePointers;
+	int							result = 0;
+	
+	try
+	{
+		for( int x = 0; x < inNumFiles; x++ )
+		{
+			size_t			codeLength = 0;
+			const char*		code = MapFileContents( inFilePaths[x], &codeLength );
+			if( !code )
+			{
+				std::cerr << "error: Couldn't find file \"" << inFilePaths[x] << "\"." << std::endl;
+				result = 2;
+				break;
+			}
+			
+			if( inVerbose )
+				std::cout << (inLoadBytecode ? "Loading bytecode file \"" : "Compiling file \"") << inFilePaths[x] << "\"..." << std::endl;
+			scripts.push_back( LEOScriptCreateForOwner( 0, 0 ) );
+			fileNames.push_back( inFilePaths[x] );
+			try
+			{
+				std::string	sourceFileName;
+				if( inLoadBytecode )
+				{
+					CBytecodeArchive::AddHandlersFromData( code, codeLength, scripts.back(), group, &sourceFileName );
+					if( !sourceFileName.empty() )	// Keep the name of the script, not of the bytecode file.
+						fileNames.back() = sourceFileName;
+				}
+				else
+					CCompileCache::CompileScript( CCompilerContext::GetDefault(), scripts.back(), group, code, codeLength, inFilePaths[x] );
+			}
+			catch( ... )
+			{
+				UnmapFileContents( code, codeLength );
+				throw;
+			}
+			UnmapFileContents( code, codeLength );
+		}
+		
+		if( result == 0 )
+		{
+			if( inVerbose )
+				std::cout << "Writing bundle file \"" << inBundlePath << "\"..." << std::endl;
+			for( size_t x = 0; x < fileNames.size(); x++ )
+				fileNamePointers.push_back( fileNames[x].c_str() );
+			CScriptBundle::WriteBundle( inBundlePath, &scripts[0], &fileNamePointers[0], scripts.size(), group );
+		}
+	}
+	catch( std::exception& err )
+	{
+		std::cerr << err.what() << std::endl;
+		result = 3;
+	}
+	
+	for( size_t x = 0; x < scripts.size(); x++ )
+		LEOScriptRelease( scripts[x] );
+	LEOContextGroupRelease( group );
+	
+	return result;
+}
+
+
 int main( int argc, char * const argv[] )
 {
 	const char*	debuggerHost = NULL;
 	const char* messageName = "startUp";
+	const char*	bytecodeOutputPath = NULL;
+	const char*	bundleOutputPath = NULL;
+	const char*	parseTreeOutputPath = NULL;
 	bool		debuggerOn = false,
 				runCode = true,
 				printInstructions = false,
 				printTokens = false,
 				printParseTree = false,
-				verbose = false;
+				verbose = false,
+				compileLazily = false,
+				loadBytecode = false,
+				loadParseTree = false,
+				loadBundle = false;
 	
 	int			fnameIdx = 0;
 	for( int x = 1; x < argc; )
@@ -62,6 +187,52 @@ int main( int argc, char * const argv[] )
 			{
 				printParseTree = true;
 			}
+			else if( strcmp( argv[x], "--lazy" ) == 0 )
+			{
+				compileLazily = true;
+			}
+			else if( strcmp( argv[x], "--emit-bytecode" ) == 0 )
+			{
+				if( (argc -1) < (x +1) )	// No parameter after emit option?
+				{
+					std::cerr << "Error: Expected output file path after --emit-bytecode option." << std::endl;
+					return 8;
+				}
+				bytecodeOutputPath = argv[x+1];
+				x++;
+			}
+			else if( strcmp( argv[x], "--bundle" ) == 0 )
+			{
+				if( (argc -1) < (x +1) )	// No parameter after bundle option?
+				{
+					std::cerr << "Error: Expected output file path after --bundle option." << std::endl;
+					return 10;
+				}
+				bundleOutputPath = argv[x+1];
+				x++;
+			}
+			else if( strcmp( argv[x], "--load-bytecode" ) == 0 )
+			{
+				loadBytecode = true;
+			}
+			else if( strcmp( argv[x], "--emit-parsetree" ) == 0 )
+			{
+				if( (argc -1) < (x +1) )	// No parameter after emit option?
+				{
+					std::cerr << "Error: Expected output file path after --emit-parsetree option." << std::endl;
+					return 11;
+				}
+				parseTreeOutputPath = argv[x+1];
+				x++;
+			}
+			else if( strcmp( argv[x], "--load-parsetree" ) == 0 )
+			{
+				loadParseTree = true;
+			}
+			else if( strcmp( argv[x], "--load-bundle" ) == 0 )
+			{
+				loadBundle = true;
+			}
 			else if( strcmp( argv[x], "--verbose" ) == 0 )
 			{
 				verbose = true;
@@ -91,10 +262,54 @@ int main( int argc, char * const argv[] )
 		x++;
 	}
 	
+	if( bytecodeOutputPath && compileLazily )
+	{
+		std::cerr << "Error: Can't write bytecode for handlers that are only compiled when called, leave out --lazy." << std::endl;
+		return 9;
+	}
+	
+	if( bundleOutputPath && compileLazily )
+	{
+		std::cerr << "Error: Can't bundle handlers that are only compiled when called, leave out --lazy." << std::endl;
+		return 9;
+	}
+	
+	if( parseTreeOutputPath && (compileLazily || loadBytecode) )
+	{
+		std::cerr << "Error: Can't write a parse tree for a script that isn't parsed, leave out --lazy and --load-bytecode." << std::endl;
+		return 9;
+	}
+	
+	if( loadParseTree && (compileLazily || loadBytecode || bundleOutputPath) )
+	{
+		std::cerr << "Error: --load-parsetree can't be combined with --lazy, --load-bytecode or --bundle." << std::endl;
+		return 9;
+	}
+	
+	if( loadBundle && (compileLazily || loadBytecode || loadParseTree || bundleOutputPath || bytecodeOutputPath || parseTreeOutputPath) )
+	{
+		std::cerr << "Error: --load-bundle can't be combined with --lazy, --load-bytecode, --load-parsetree, --bundle, --emit-bytecode or --emit-parsetree." << std::endl;
+		return 9;
+	}
+	
+	LEOInitInstructionArray();
+	LEOAddInstructionsToInstructionArray( gMsgInstructions, gMsgInstructionNames, LEO_NUMBER_OF_MSG_INSTRUCTIONS, &kFirstMsgInstruction );
+	LEOAddInstructionsToInstructionArray( gForgeInstructions, gForgeInstructionNames, LEO_NUMBER_OF_FORGE_INSTRUCTIONS, &kFirstForgeInstruction );
+	
+	if( bundleOutputPath )	// All remaining parameters are scripts to bundle, not parameters for the handler.
+	{
+		if( fnameIdx == 0 )
+		{
+			std::cerr << "error: Expected names of scripts to bundle after the options." << std::endl;
+			return 2;
+		}
+		return BuildBundle( bundleOutputPath, argv +fnameIdx, argc -fnameIdx, loadBytecode, verbose );
+	}
+	
 	// Do actual work:
 	char*				filename = (fnameIdx > 0) ? argv[fnameIdx] : NULL;
-	char*				code = filename ? GetFileContents( filename ) : NULL;
-	std::deque<CToken>	tokens;
+	size_t				codeLength = 0;
+	const char*			code = filename ? MapFileContents( filename, &codeLength ) : NULL;
 	CParser				parser;
 	
 	if( !code )
@@ -110,33 +325,87 @@ int main( int argc, char * const argv[] )
 	{
 		CParseTree				parseTree;
 		
-		if( verbose )
-			std::cout << "Tokenizing file \"" << filename << "\"..." << std::endl;
-		tokens = CToken::TokenListFromText( code, strlen(code) );
-		if( printTokens )
+		if( loadParseTree )
 		{
-			for( std::deque<CToken>::iterator currToken = tokens.begin(); currToken != tokens.end(); currToken++ )
-				std::cout << "Token: " << currToken->GetDescription() << std::endl;
+			if( verbose )
+				std::cout << "Loading parse tree file \"" << filename << "\"..." << std::endl;
+			CParseTreeReader	reader( code, codeLength );
+			reader.ReadTree( parseTree );
+		}
+		else if( !compileLazily && !loadBytecode && !loadBundle )	// Otherwise CLazyScript tokenizes, and each handler gets parsed when it's called, or there's nothing to parse.
+		{
+			if( verbose )
+				std::cout << "Tokenizing file \"" << filename << "\"..." << std::endl;
+			CTokenizer		tokenizer( code, codeLength );	// Tokens point into code, so don't unmap it before we're done parsing.
+			CTokenList		tokens( &tokenizer, &parseTree.GetSymbols(), printTokens ? 0 : TOKEN_RING_BUFFER_SIZE );	// Keep all tokens if we print them, otherwise just tokenize while parsing.
+			tokens.TokenizeInParallel();	// Big scripts get tokenized up front on all cores instead.
+			if( printTokens )
+			{
+				for( CTokenCursor currToken = tokens.begin(); currToken != tokens.end(); ++currToken )
+					std::cout << "Token: " << currToken->GetDescription() << std::endl;
+			}
+			
+			if( verbose )
+				std::cout << "Parsing file \"" << filename << "\"..." << std::endl;
+			parser.ParseInParallel( filename, tokens, parseTree );
 		}
-		
-		if( verbose )
-			std::cout << "Parsing file \"" << filename << "\"..." << std::endl;
-		parser.Parse( filename, tokens, parseTree );
-		
-		LEOInitInstructionArray();
-		LEOAddInstructionsToInstructionArray( gMsgInstructions, gMsgInstructionNames, LEO_NUMBER_OF_MSG_INSTRUCTIONS, &kFirstMsgInstruction );
 		
 		if( printParseTree )
 			parseTree.DebugPrint( std::cout, 1 );
 		
-		LEOScript		*	script = LEOScriptCreateForOwner( 0, 0 );
 		LEOContextGroup	*	group = LEOContextGroupCreate();
+		CScriptBundle	*	bundle = NULL;
+		std::vector<LEOScript*>	bundleScripts;
+		if( loadBundle )
+		{
+			if( verbose )
+				std::cout << "Loading bundle file \"" << filename << "\"..." << std::endl;
+			bundle = new CScriptBundle( filename );
+			for( size_t x = 0; x < bundle->GetNumScripts(); x++ )
+				bundleScripts.push_back( bundle->CreateScript( x, group, 0, 0 ) );
+			if( bundleScripts.empty() )
+			{
+				delete bundle;
+				throw std::runtime_error( "Bundle contains no scripts." );
+			}
+		}
+		
+		LEOScript		*	script = loadBundle ? bundleScripts[0] : LEOScriptCreateForOwner( 0, 0 );	// The message goes to a bundle's first script.
 		CCodeBlock			block( group, script );
 		
-		parseTree.Simplify();
-		parseTree.GenerateCode( &block );
+		if( loadBytecode )
+		{
+			if( verbose )
+				std::cout << "Loading bytecode file \"" << filename << "\"..." << std::endl;
+			CBytecodeArchive::AddHandlersFromData( code, codeLength, script, group );	// Already mapped into memory, so this is just fixing up instructions.
+		}
+		else if( compileLazily )
+			CLazyScript::AddHandlers( CCompilerContext::GetDefault(), group, script, code, codeLength, filename );
+		else if( !loadBundle )	// Bundles were loaded above, we needed their first script.
+		{
+			parseTree.Simplify();
+			if( parseTreeOutputPath )
+			{
+				if( verbose )
+					std::cout << "Writing parse tree file \"" << parseTreeOutputPath << "\"..." << std::endl;
+				CParseTreeWriter::WriteTreeToFile( parseTree, parseTreeOutputPath );
+			}
+			parseTree.GenerateCode( &block );
+		}
+		
+		if( bytecodeOutputPath )
+		{
+			if( verbose )
+				std::cout << "Writing bytecode file \"" << bytecodeOutputPath << "\"..." << std::endl;
+			CBytecodeArchive::WriteScriptToFile( script, group, filename, bytecodeOutputPath );
+		}
 		
-		if( printInstructions )
+		if( printInstructions && loadBundle )
+		{
+			for( size_t x = 0; x < bundleScripts.size(); x++ )
+				LEODebugPrintScript( group, bundleScripts[x] );
+		}
+		else if( printInstructions )
 			LEODebugPrintScript( group, script );
 		
 		if( runCode )
@@ -154,15 +423,17 @@ int main( int argc, char * const argv[] )
 			else
 			{
 				LEOContext		ctx;
+				std::string		zeroTerminatedCode;	// The file is mapped, not read into a C string.
 				LEOInitContext( &ctx, group );
 				
-				if( debuggerOn )
+				if( debuggerOn && !loadBytecode && !loadParseTree && !loadBundle )	// The debugger needs the source code.
 				{
 					if( LEOInitRemoteDebugger( debuggerHost ) )
 					{
 						ctx.preInstructionProc = LEORemoteDebuggerPreInstructionProc;	// Activate the debugger.
 						LEORemoteDebuggerAddBreakpoint( theHandler->instructions );		// Set a breakpoint on the first instruction, so we can step through everything with the debugger.
-						LEORemoteDebuggerAddFile( filename, code, script );
+						zeroTerminatedCode.assign( code, codeLength );
+						LEORemoteDebuggerAddFile( filename, zeroTerminatedCode.c_str(), script );
 					}
 				}
 				
@@ -188,15 +459,31 @@ int main( int argc, char * const argv[] )
 			}
 		}
 		
-		LEOScriptRelease( script );
+		if( bundle )
+		{
+			for( size_t x = 0; x < bundleScripts.size(); x++ )
+			{
+				bundle->ForgetScript( bundleScripts[x] );
+				LEOScriptRelease( bundleScripts[x] );
+			}
+			delete bundle;
+		}
+		else
+		{
+			CLazyScript::ForgetHandlers( script );
+			LEOScriptRelease( script );
+		}
 		LEOContextGroupRelease( group );
 	}
 	catch( std::exception& err )
 	{
 		std::cerr << err.what() << std::endl;
+		UnmapFileContents( code, codeLength );
 		return 3;
 	}
 	
+	UnmapFileContents( code, codeLength );
+	
 	if( verbose )
 		std::cout << "Finished successfully." << std::endl;
 	